@@ -19,6 +19,7 @@
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
@@ -28,11 +29,14 @@ namespace api2 {
 
 // Concatenates several NormalizedLandmarkList protos following stream index
 // order. This class assumes that every input stream contains a
-// NormalizedLandmarkList proto object.
+// NormalizedLandmarkList proto object, or that every input stream contains a
+// NormalizedLandmarkArray, in which case the output is a
+// NormalizedLandmarkArray.
 class ConcatenateNormalizedLandmarkListCalculator : public Node {
  public:
-  static constexpr Input<NormalizedLandmarkList>::Multiple kIn{""};
-  static constexpr Output<NormalizedLandmarkList> kOut{""};
+  static constexpr Input<
+      OneOf<NormalizedLandmarkList, NormalizedLandmarkArray>>::Multiple kIn{""};
+  static constexpr Output<SameType<kIn>> kOut{""};
 
   MEDIAPIPE_NODE_CONTRACT(kIn, kOut);
 
@@ -55,15 +59,42 @@ class ConcatenateNormalizedLandmarkListCalculator : public Node {
       }
     }
 
+    bool has_arrays = false;
+    bool has_lists = false;
+    for (const auto& input : kIn(cc)) {
+      if (input.IsEmpty()) continue;
+      if (input.Has<NormalizedLandmarkArray>()) {
+        has_arrays = true;
+      } else {
+        has_lists = true;
+      }
+    }
+    RET_CHECK(!has_arrays || !has_lists)
+        << "Inputs must be either all NormalizedLandmarkList or all "
+           "NormalizedLandmarkArray.";
+
+    if (has_arrays) {
+      NormalizedLandmarkArray output;
+      for (const auto& input : kIn(cc)) {
+        if (input.IsEmpty()) continue;
+        output.Append(input.Get<NormalizedLandmarkArray>());
+      }
+      kOut(cc).Send(
+          api2::MakePacket<NormalizedLandmarkArray>(std::move(output))
+              .At(cc->InputTimestamp()));
+      return absl::OkStatus();
+    }
+
     NormalizedLandmarkList output;
     for (const auto& input : kIn(cc)) {
       if (input.IsEmpty()) continue;
-      const NormalizedLandmarkList& list = *input;
+      const NormalizedLandmarkList& list = input.Get<NormalizedLandmarkList>();
       for (int j = 0; j < list.landmark_size(); ++j) {
         *output.add_landmark() = list.landmark(j);
       }
     }
-    kOut(cc).Send(std::move(output));
+    kOut(cc).Send(api2::MakePacket<NormalizedLandmarkList>(std::move(output))
+                      .At(cc->InputTimestamp()));
     return absl::OkStatus();
   }
 
@@ -19,6 +19,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -181,4 +182,40 @@ TEST(ConcatenateNormalizedLandmarkListCalculatorTest, OneEmptyStreamNoOutput) {
   EXPECT_EQ(0, outputs.size());
 }
 
+TEST(ConcatenateNormalizedLandmarkListCalculatorTest, ArrayInputs) {
+  CalculatorRunner runner("ConcatenateNormalizedLandmarkListCalculator",
+                          /*options_string=*/"", /*num_inputs=*/3,
+                          /*num_outputs=*/1, /*num_side_packets=*/0);
+
+  std::vector<NormalizedLandmarkList> inputs = {
+      GenerateLandmarks(/*landmarks_size=*/3, /*value_multiplier=*/0),
+      GenerateLandmarks(/*landmarks_size=*/1, /*value_multiplier=*/1),
+      GenerateLandmarks(/*landmarks_size=*/2, /*value_multiplier=*/2)};
+  for (int i = 0; i < inputs.size(); ++i) {
+    runner.MutableInputs()->Index(i).packets.push_back(
+        MakePacket<NormalizedLandmarkArray>(inputs[i]).At(Timestamp(1)));
+  }
+  MP_ASSERT_OK(runner.Run());
+
+  const std::vector<Packet>& outputs = runner.Outputs().Index(0).packets;
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_EQ(Timestamp(1), outputs[0].Timestamp());
+  ValidateCombinedLandmarks(
+      inputs, outputs[0].Get<NormalizedLandmarkArray>().ToProto());
+}
+
+TEST(ConcatenateNormalizedLandmarkListCalculatorTest, MixedInputsFail) {
+  CalculatorRunner runner("ConcatenateNormalizedLandmarkListCalculator",
+                          /*options_string=*/"", /*num_inputs=*/2,
+                          /*num_outputs=*/1, /*num_side_packets=*/0);
+
+  NormalizedLandmarkList input =
+      GenerateLandmarks(/*landmarks_size=*/3, /*value_multiplier=*/0);
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<NormalizedLandmarkList>(input).At(Timestamp(1)));
+  runner.MutableInputs()->Index(1).packets.push_back(
+      MakePacket<NormalizedLandmarkArray>(input).At(Timestamp(1)));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
 }  // namespace mediapipe
@@ -13,11 +13,16 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include "absl/time/time.h"
 #include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/clock.h"
+#include "mediapipe/framework/deps/monotonic_clock.h"
+#include "mediapipe/framework/load_shedder.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/util/header_util.h"
@@ -28,6 +33,8 @@ constexpr char kFinishedTag[] = "FINISHED";
 constexpr char kAllowTag[] = "ALLOW";
 constexpr char kMaxInFlightTag[] = "MAX_IN_FLIGHT";
 constexpr char kOptionsTag[] = "OPTIONS";
+constexpr char kClockTag[] = "CLOCK";
+constexpr char kDecisionTag[] = "DECISION";
 
 // FlowLimiterCalculator is used to limit the number of frames in flight
 // by dropping input frames when necessary.
@@ -70,6 +77,43 @@ constexpr char kOptionsTag[] = "OPTIONS";
 // input streams are treated as auxiliary input streams.  The auxiliary input
 // streams are limited to timestamps passed on the main input stream.
 //
+// If `adaptive` options are specified, the number of frames in flight is
+// tuned at runtime instead of being fixed at `max_in_flight`.  The latency of
+// each frame is measured from its release until its "FINISHED" timestamp
+// arrives.  The in-flight window grows additively while the smoothed latency
+// stays below `target_latency_usec` and the finished frame rate stays below
+// `target_frame_rate`, and shrinks multiplicatively when the latency target is
+// exceeded or a frame times out.  Each update is reported as a
+// FlowLimiterDecision on the optional "DECISION" output stream.  The optional
+// "CLOCK" input side packet specifies the clock used to measure latency.
+//
+// Example config:
+// node {
+//   calculator: "FlowLimiterCalculator"
+//   input_stream: "raw_frames"
+//   input_stream: "FINISHED:finished"
+//   input_stream_info: {
+//     tag_index: 'FINISHED'
+//     back_edge: true
+//   }
+//   output_stream: "sampled_frames"
+//   output_stream: "DECISION:limiter_decisions"
+//   options: {
+//     [mediapipe.FlowLimiterCalculatorOptions.ext] {
+//       max_in_flight: 1
+//       max_in_queue: 1
+//       adaptive { target_latency_usec: 50000 max_in_flight: 4 }
+//     }
+//   }
+// }
+//
+// If the `load_shedding` option is set and the graph provides the LoadShedder
+// service, frames are also discarded before release in proportion to the
+// timestamps dropped downstream, e.g. by a FixedSizeInputStreamHandler in
+// front of a slow calculator.  The counters "LoadSheddingSaved" and
+// "LoadSheddingWasted" count the frames discarded here and the timestamps
+// dropped downstream after upstream work was spent on them.
+//
 class FlowLimiterCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
@@ -87,6 +131,12 @@ class FlowLimiterCalculator : public CalculatorBase {
     cc->Inputs().Get("FINISHED", 0).SetAny();
     cc->InputSidePackets().Tag(kMaxInFlightTag).Set<int>().Optional();
     cc->Outputs().Tag(kAllowTag).Set<bool>().Optional();
+    cc->InputSidePackets()
+        .Tag(kClockTag)
+        .Set<std::shared_ptr<::mediapipe::Clock>>()
+        .Optional();
+    cc->Outputs().Tag(kDecisionTag).Set<FlowLimiterDecision>().Optional();
+    cc->UseService(kLoadShedderService).Optional();
     cc->SetInputStreamHandler("ImmediateInputStreamHandler");
     cc->SetProcessTimestampBounds(true);
     return absl::OkStatus();
@@ -101,13 +151,151 @@ class FlowLimiterCalculator : public CalculatorBase {
     }
     input_queues_.resize(cc->Inputs().NumEntries(""));
     RET_CHECK_OK(CopyInputHeadersToOutputs(cc->Inputs(), &(cc->Outputs())));
+
+    if (options_.load_shedding() &&
+        cc->Service(kLoadShedderService).IsAvailable()) {
+      load_shedder_ = &cc->Service(kLoadShedderService).GetObject();
+      num_dropped_ = load_shedder_->GetStats().dropped_frames;
+    }
+
+    adaptive_ = options_.has_adaptive();
+    if (adaptive_) {
+      const auto& adaptive = options_.adaptive();
+      RET_CHECK_GE(adaptive.min_in_flight(), 1);
+      RET_CHECK_GE(adaptive.max_in_flight(), adaptive.min_in_flight());
+      RET_CHECK(adaptive.multiplicative_decrease() > 0 &&
+                adaptive.multiplicative_decrease() < 1);
+      RET_CHECK(adaptive.smoothing() > 0 && adaptive.smoothing() <= 1);
+      window_ = std::min(std::max(options_.max_in_flight(),
+                                  adaptive.min_in_flight()),
+                         adaptive.max_in_flight());
+      if (cc->InputSidePackets().HasTag(kClockTag)) {
+        clock_ = cc->InputSidePackets()
+                     .Tag(kClockTag)
+                     .Get<std::shared_ptr<::mediapipe::Clock>>();
+      } else {
+        clock_ = std::shared_ptr<::mediapipe::Clock>(
+            ::mediapipe::MonotonicClock::CreateSynchronizedMonotonicClock());
+      }
+    }
     return absl::OkStatus();
   }
 
+  // Returns the maximum number of frames released for processing at one time.
+  int MaxInFlight() {
+    return adaptive_ ? static_cast<int>(window_) : options_.max_in_flight();
+  }
+
   // Returns true if an additional frame can be released for processing.
   // The "ALLOW" output stream indicates this condition at each input frame.
-  bool ProcessingAllowed() {
-    return frames_in_flight_.size() < options_.max_in_flight();
+  bool ProcessingAllowed() { return frames_in_flight_.size() < MaxInFlight(); }
+
+  // Records a frame released for processing.
+  void AddInFlight(Timestamp timestamp) {
+    frames_in_flight_.push_back(timestamp);
+    if (adaptive_) {
+      release_times_.push_back(clock_->TimeNow());
+    }
+  }
+
+  // Removes the oldest frame in flight, either finished or abandoned after
+  // timeout, and updates the adaptive in-flight window accordingly.
+  void RemoveInFlight(bool timed_out, CalculatorContext* cc) {
+    const Timestamp timestamp = frames_in_flight_.front();
+    frames_in_flight_.pop_front();
+    if (adaptive_) {
+      const absl::Time release_time = release_times_.front();
+      release_times_.pop_front();
+      UpdateWindow(timestamp, release_time, timed_out, cc);
+    }
+  }
+
+  // Updates the in-flight window AIMD-style for a frame leaving flight, and
+  // outputs the decision.
+  void UpdateWindow(Timestamp timestamp, absl::Time release_time,
+                    bool timed_out, CalculatorContext* cc) {
+    const auto& adaptive = options_.adaptive();
+    const double alpha = adaptive.smoothing();
+    FlowLimiterDecision decision;
+    bool congested = timed_out;
+    if (!timed_out) {
+      const absl::Time now = clock_->TimeNow();
+      const absl::Duration latency = now - release_time;
+      if (num_finished_ == 0) {
+        smoothed_latency_ = latency;
+      } else {
+        smoothed_latency_ = alpha * latency + (1 - alpha) * smoothed_latency_;
+        const absl::Duration interval = now - last_finished_time_;
+        smoothed_interval_ =
+            num_finished_ == 1
+                ? interval
+                : alpha * interval + (1 - alpha) * smoothed_interval_;
+      }
+      last_finished_time_ = now;
+      ++num_finished_;
+      decision.set_latency_usec(absl::ToInt64Microseconds(latency));
+      congested = adaptive.target_latency_usec() > 0 &&
+                  smoothed_latency_ >
+                      absl::Microseconds(adaptive.target_latency_usec());
+    }
+    if (num_finished_ > 0) {
+      decision.set_smoothed_latency_usec(
+          absl::ToInt64Microseconds(smoothed_latency_));
+    }
+    const double frame_rate =
+        smoothed_interval_ > absl::ZeroDuration()
+            ? 1.0 / absl::ToDoubleSeconds(smoothed_interval_)
+            : 0.0;
+
+    // The window is decreased at most once per window of frames, i.e. not
+    // again until a frame released after the last decrease leaves flight.
+    const double previous_window = window_;
+    if (congested) {
+      if (timestamp > decrease_hold_) {
+        window_ = std::max<double>(
+            window_ * adaptive.multiplicative_decrease(),
+            adaptive.min_in_flight());
+        decrease_hold_ = last_released_;
+      }
+    } else if (adaptive.target_frame_rate() <= 0 ||
+               frame_rate < adaptive.target_frame_rate()) {
+      window_ = std::min<double>(
+          window_ + adaptive.additive_increase() / window_,
+          adaptive.max_in_flight());
+    }
+
+    if (cc->Outputs().HasTag(kDecisionTag)) {
+      decision.set_action(window_ > previous_window
+                              ? FlowLimiterDecision::INCREASE
+                              : window_ < previous_window
+                                    ? FlowLimiterDecision::DECREASE
+                                    : FlowLimiterDecision::HOLD);
+      decision.set_window(window_);
+      decision.set_frame_rate(frame_rate);
+      decision.set_frames_in_flight(frames_in_flight_.size());
+      decision.set_timed_out(timed_out);
+      cc->Outputs().Tag(kDecisionTag).AddPacket(
+          MakePacket<FlowLimiterDecision>(decision).At(timestamp));
+    }
+  }
+
+  // Returns true if the LoadShedder discards a frame about to be released,
+  // and updates the load shedding counters.
+  bool ShedFrame(CalculatorContext* cc) {
+    if (!load_shedder_) {
+      return false;
+    }
+    const bool shed = load_shedder_->ShouldShed();
+    if (shed) {
+      cc->GetCounter("LoadSheddingSaved")->Increment();
+    }
+    const int64 num_dropped = load_shedder_->GetStats().dropped_frames;
+    if (num_dropped > num_dropped_) {
+      cc->GetCounter("LoadSheddingWasted")
+          ->IncrementBy(num_dropped - num_dropped_);
+      num_dropped_ = num_dropped;
+    }
+    return shed;
   }
 
   // Outputs a packet indicating whether a frame was sent or dropped.
@@ -167,7 +355,7 @@ class FlowLimiterCalculator : public CalculatorBase {
     if (finished_packet.Timestamp() == cc->InputTimestamp()) {
       while (!frames_in_flight_.empty() &&
              frames_in_flight_.front() <= finished_packet.Timestamp()) {
-        frames_in_flight_.pop_front();
+        RemoveInFlight(/*timed_out=*/false, cc);
       }
     }
 
@@ -187,7 +375,7 @@ class FlowLimiterCalculator : public CalculatorBase {
         latest_ts < Timestamp::Max()) {
       while (!frames_in_flight_.empty() &&
              (latest_ts - frames_in_flight_.front()) > timeout) {
-        frames_in_flight_.pop_front();
+        RemoveInFlight(/*timed_out=*/true, cc);
       }
     }
 
@@ -196,9 +384,14 @@ class FlowLimiterCalculator : public CalculatorBase {
     while (ProcessingAllowed() && !input_queue.empty()) {
       Packet packet = input_queue.front();
       input_queue.pop_front();
+      if (ShedFrame(cc)) {
+        SendAllow(false, packet.Timestamp(), cc);
+        continue;
+      }
       cc->Outputs().Get("", 0).AddPacket(packet);
       SendAllow(true, packet.Timestamp(), cc);
-      frames_in_flight_.push_back(packet.Timestamp());
+      AddInFlight(packet.Timestamp());
+      last_released_ = packet.Timestamp();
     }
 
     // Limit the number of queued frames.
@@ -231,6 +424,24 @@ class FlowLimiterCalculator : public CalculatorBase {
   FlowLimiterCalculatorOptions options_;
   std::vector<std::deque<Packet>> input_queues_;
   std::deque<Timestamp> frames_in_flight_;
+
+  // State of adaptive admission.
+  bool adaptive_ = false;
+  std::shared_ptr<::mediapipe::Clock> clock_;
+  // Release times of frames_in_flight_.
+  std::deque<absl::Time> release_times_;
+  double window_ = 0;
+  int num_finished_ = 0;
+  absl::Time last_finished_time_;
+  absl::Duration smoothed_latency_;
+  absl::Duration smoothed_interval_;
+  Timestamp last_released_ = Timestamp::Unstarted();
+  Timestamp decrease_hold_ = Timestamp::Unstarted();
+
+  // State of load shedding.
+  LoadShedder* load_shedder_ = nullptr;
+  // The count of timestamps dropped downstream, as of the last frame.
+  int64 num_dropped_ = 0;
 };
 REGISTER_CALCULATOR(FlowLimiterCalculator);
 
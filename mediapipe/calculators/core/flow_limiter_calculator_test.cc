@@ -17,12 +17,14 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/load_shedder.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -768,5 +770,246 @@ TEST_F(FlowLimiterCalculatorTest, ZeroQueue) {
   EXPECT_EQ(out_2_packets, expected_output_2);
 }
 
+// Tests demonstrating adaptive admission by FlowLimiterCalculator.
+class FlowLimiterCalculatorAdaptiveTest : public FlowLimiterCalculatorTest {
+ protected:
+  CalculatorGraphConfig AdaptiveGraphConfig() {
+    return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+      input_stream: 'in_1'
+      node {
+        calculator: 'FlowLimiterCalculator'
+        input_side_packet: 'OPTIONS:limiter_options'
+        input_side_packet: 'CLOCK:limiter_clock'
+        input_stream: 'in_1'
+        input_stream: 'FINISHED:out_1'
+        input_stream_info: { tag_index: 'FINISHED' back_edge: true }
+        output_stream: 'in_1_sampled'
+        output_stream: 'DECISION:decision'
+      }
+      node {
+        calculator: 'SleepCalculator'
+        input_side_packet: 'WARMUP_TIME:sleep_time'
+        input_side_packet: 'SLEEP_TIME:sleep_time'
+        input_side_packet: 'CLOCK:clock'
+        input_stream: 'PACKET:in_1_sampled'
+        output_stream: 'PACKET:out_1'
+      }
+    )pb");
+  }
+
+  // Runs the graph in simulated time, adding one input packet every 10 ms.
+  void RunAdaptiveGraph(const FlowLimiterCalculatorOptions& limiter_options,
+                        int64 sleep_time, int num_packets) {
+    SetUpInputData();
+    SetUpSimulationClock();
+    std::map<std::string, Packet> side_packets = {
+        {"limiter_options",
+         MakePacket<FlowLimiterCalculatorOptions>(limiter_options)},
+        {"limiter_clock", MakePacket<std::shared_ptr<mediapipe::Clock>>(
+                              simulation_clock_)},
+        {"sleep_time", MakePacket<int64>(sleep_time)},
+        {"clock", MakePacket<mediapipe::Clock*>(clock_)},
+    };
+
+    MP_ASSERT_OK(graph_.Initialize(AdaptiveGraphConfig()));
+    MP_EXPECT_OK(graph_.ObserveOutputStream("out_1", [this](Packet p) {
+      out_1_packets_.push_back(p);
+      return absl::OkStatus();
+    }));
+    MP_EXPECT_OK(graph_.ObserveOutputStream("decision", [this](Packet p) {
+      decisions_.push_back(p.Get<FlowLimiterDecision>());
+      return absl::OkStatus();
+    }));
+    simulation_clock_->ThreadStart();
+    MP_ASSERT_OK(graph_.StartRun(side_packets));
+    for (int i = 0; i < num_packets; ++i) {
+      MP_EXPECT_OK(graph_.AddPacketToInputStream("in_1", input_packets_[i]));
+      clock_->Sleep(absl::Microseconds(10000));
+    }
+    MP_EXPECT_OK(graph_.CloseAllPacketSources());
+    clock_->Sleep(absl::Microseconds(200000));
+    MP_EXPECT_OK(graph_.WaitUntilDone());
+    simulation_clock_->ThreadFinish();
+  }
+
+  std::vector<FlowLimiterDecision> decisions_;
+};
+
+// Shows that the in-flight window shrinks when frames pile up in front of a
+// slow calculator.  SleepCalculator needs 22 ms per frame while frames arrive
+// every 10 ms, so each additional frame in flight adds 22 ms of latency.
+TEST_F(FlowLimiterCalculatorAdaptiveTest, DecreasesWindowAboveTargetLatency) {
+  auto limiter_options = ParseTextProtoOrDie<FlowLimiterCalculatorOptions>(R"pb(
+    max_in_flight: 4
+    max_in_queue: 1
+    adaptive { target_latency_usec: 30000 min_in_flight: 1 max_in_flight: 4 }
+  )pb");
+  RunAdaptiveGraph(limiter_options, 22000, 40);
+
+  ASSERT_FALSE(decisions_.empty());
+  EXPECT_LE(decisions_.size(), out_1_packets_.size());
+  int num_decreases = 0;
+  for (const auto& decision : decisions_) {
+    EXPECT_GE(decision.window(), 1.0);
+    EXPECT_LE(decision.window(), 4.0);
+    EXPECT_TRUE(decision.has_latency_usec());
+    EXPECT_FALSE(decision.timed_out());
+    if (decision.action() == FlowLimiterDecision::DECREASE) {
+      ++num_decreases;
+    }
+  }
+  EXPECT_GT(num_decreases, 0);
+  EXPECT_LT(decisions_.back().window(), 4.0);
+  // Latency is bounded by the shrunken window.
+  EXPECT_LT(decisions_.back().smoothed_latency_usec(), 4 * 22000);
+}
+
+// Shows that the in-flight window grows up to its maximum while the latency
+// target is met.
+TEST_F(FlowLimiterCalculatorAdaptiveTest, IncreasesWindowBelowTargetLatency) {
+  auto limiter_options = ParseTextProtoOrDie<FlowLimiterCalculatorOptions>(R"pb(
+    max_in_flight: 1
+    max_in_queue: 1
+    adaptive { target_latency_usec: 100000 min_in_flight: 1 max_in_flight: 3 }
+  )pb");
+  RunAdaptiveGraph(limiter_options, 5000, 20);
+
+  ASSERT_FALSE(decisions_.empty());
+  for (const auto& decision : decisions_) {
+    EXPECT_NE(decision.action(), FlowLimiterDecision::DECREASE);
+    EXPECT_NEAR(decision.latency_usec(), 5000, 100);
+  }
+  EXPECT_EQ(decisions_.back().window(), 3.0);
+  // All frames are processed in time, none are dropped.
+  EXPECT_EQ(out_1_packets_.size(), 20);
+}
+
+// Shows that the in-flight window stops growing once the target frame rate
+// is reached.  Frames finish every 10 ms, i.e. at 100 fps.
+TEST_F(FlowLimiterCalculatorAdaptiveTest, HoldsWindowAtTargetFrameRate) {
+  auto limiter_options = ParseTextProtoOrDie<FlowLimiterCalculatorOptions>(R"pb(
+    max_in_flight: 1
+    max_in_queue: 1
+    adaptive {
+      target_latency_usec: 100000
+      target_frame_rate: 50
+      min_in_flight: 1
+      max_in_flight: 8
+    }
+  )pb");
+  RunAdaptiveGraph(limiter_options, 5000, 20);
+
+  ASSERT_GT(decisions_.size(), 2);
+  // Only the first frame, before any frame rate is measured, grows the window.
+  EXPECT_EQ(decisions_[0].action(), FlowLimiterDecision::INCREASE);
+  for (int i = 1; i < decisions_.size(); ++i) {
+    EXPECT_EQ(decisions_[i].action(), FlowLimiterDecision::HOLD);
+    EXPECT_NEAR(decisions_[i].frame_rate(), 100.0, 1.0);
+  }
+  EXPECT_EQ(decisions_.back().window(), 2.0);
+}
+
+// Tests demonstrating load shedding by FlowLimiterCalculator.
+class FlowLimiterCalculatorLoadSheddingTest : public FlowLimiterCalculatorTest {
+ protected:
+  // The FixedSizeInputStreamHandler drops frames queued in front of the slow
+  // SleepCalculator.
+  CalculatorGraphConfig LoadSheddingGraphConfig(bool load_shedding) {
+    auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+      input_stream: 'in_1'
+      node {
+        calculator: 'FlowLimiterCalculator'
+        input_stream: 'in_1'
+        input_stream: 'FINISHED:out_1'
+        input_stream_info: { tag_index: 'FINISHED' back_edge: true }
+        output_stream: 'in_1_sampled'
+        options {
+          [mediapipe.FlowLimiterCalculatorOptions.ext] {
+            max_in_flight: 8
+            max_in_queue: 1
+          }
+        }
+      }
+      node {
+        calculator: 'SleepCalculator'
+        input_side_packet: 'WARMUP_TIME:sleep_time'
+        input_side_packet: 'SLEEP_TIME:sleep_time'
+        input_side_packet: 'CLOCK:clock'
+        input_stream: 'PACKET:in_1_sampled'
+        output_stream: 'PACKET:out_1'
+        input_stream_handler {
+          input_stream_handler: 'FixedSizeInputStreamHandler'
+        }
+      }
+    )pb");
+    config.mutable_node(0)
+        ->mutable_options()
+        ->MutableExtension(FlowLimiterCalculatorOptions::ext)
+        ->set_load_shedding(load_shedding);
+    return config;
+  }
+
+  // Runs the graph in simulated time, adding one input packet every 10 ms,
+  // while SleepCalculator needs 22 ms per frame.
+  void RunLoadSheddingGraph(bool load_shedding, int num_packets) {
+    SetUpInputData();
+    SetUpSimulationClock();
+    std::map<std::string, Packet> side_packets = {
+        {"sleep_time", MakePacket<int64>(22000)},
+        {"clock", MakePacket<mediapipe::Clock*>(clock_)},
+    };
+
+    MP_ASSERT_OK(graph_.Initialize(LoadSheddingGraphConfig(load_shedding)));
+    MP_ASSERT_OK(graph_.SetServiceObject(kLoadShedderService, shedder_));
+    MP_EXPECT_OK(graph_.ObserveOutputStream("out_1", [this](Packet p) {
+      out_1_packets_.push_back(p);
+      return absl::OkStatus();
+    }));
+    simulation_clock_->ThreadStart();
+    MP_ASSERT_OK(graph_.StartRun(side_packets));
+    for (int i = 0; i < num_packets; ++i) {
+      MP_EXPECT_OK(graph_.AddPacketToInputStream("in_1", input_packets_[i]));
+      clock_->Sleep(absl::Microseconds(10000));
+    }
+    MP_EXPECT_OK(graph_.CloseAllPacketSources());
+    clock_->Sleep(absl::Microseconds(200000));
+    MP_EXPECT_OK(graph_.WaitUntilDone());
+    simulation_clock_->ThreadFinish();
+  }
+
+  int64 GetCounter(const std::string& name) {
+    return graph_.GetCounterFactory()
+        ->GetCounter(absl::StrCat("FlowLimiterCalculator-", name))
+        ->Get();
+  }
+
+  std::shared_ptr<LoadShedder> shedder_ = std::make_shared<LoadShedder>();
+};
+
+// Shows that without load shedding, frames are dropped only in front of the
+// slow calculator, after the upstream work on them.
+TEST_F(FlowLimiterCalculatorLoadSheddingTest, DropsDownstreamWithoutShedding) {
+  RunLoadSheddingGraph(/*load_shedding=*/false, 40);
+
+  LoadShedder::Stats stats = shedder_->GetStats();
+  EXPECT_EQ(stats.admitted_frames + stats.shed_frames, 0);
+  EXPECT_GT(stats.dropped_frames, 10);
+  EXPECT_LT(out_1_packets_.size(), 40);
+}
+
+// Shows that with load shedding, most of the discarded frames are discarded
+// by the FlowLimiterCalculator, before any work is spent on them.
+TEST_F(FlowLimiterCalculatorLoadSheddingTest, ShedsFramesBeforeSlowCalculator) {
+  RunLoadSheddingGraph(/*load_shedding=*/true, 40);
+
+  LoadShedder::Stats stats = shedder_->GetStats();
+  EXPECT_GT(stats.shed_frames, stats.dropped_frames);
+  EXPECT_EQ(GetCounter("LoadSheddingSaved"), stats.shed_frames);
+  EXPECT_LE(GetCounter("LoadSheddingWasted"), stats.dropped_frames);
+  // Each frame is either processed, shed, or dropped downstream.
+  EXPECT_EQ(out_1_packets_.size() + stats.shed_frames + stats.dropped_frames,
+            40);
+}
+
 }  // anonymous namespace
 }  // namespace mediapipe
@@ -18,6 +18,7 @@
 #include "mediapipe/calculators/core/split_vector_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/resource_util.h"
@@ -33,21 +34,27 @@ namespace mediapipe {
 // If the option "combine_outputs" is set to true, only one output stream can be
 // specified and all ranges of elements will be combined into one
 // LandmarkListType.
-template <typename LandmarkType, typename LandmarkListType>
+// InputType is either LandmarkListType, or its BasicLandmarkArray. In the
+// latter case the outputs are landmark arrays as well, except for
+// element_only outputs, which are always of type LandmarkType.
+template <typename LandmarkType, typename LandmarkListType,
+          typename InputType = LandmarkListType>
 class SplitLandmarksCalculator : public CalculatorBase {
  public:
+  using LandmarkArrayType = BasicLandmarkArray<LandmarkListType>;
+
   static absl::Status GetContract(CalculatorContract* cc) {
     RET_CHECK(cc->Inputs().NumEntries() == 1);
     RET_CHECK(cc->Outputs().NumEntries() != 0);
 
-    cc->Inputs().Index(0).Set<LandmarkListType>();
+    cc->Inputs().Index(0).Set<InputType>();
 
     const auto& options =
         cc->Options<::mediapipe::SplitVectorCalculatorOptions>();
 
     if (options.combine_outputs()) {
       RET_CHECK_EQ(cc->Outputs().NumEntries(), 1);
-      cc->Outputs().Index(0).Set<LandmarkListType>();
+      cc->Outputs().Index(0).Set<InputType>();
       for (int i = 0; i < options.ranges_size() - 1; ++i) {
         for (int j = i + 1; j < options.ranges_size(); ++j) {
           const auto& range_0 = options.ranges(i);
@@ -84,7 +91,7 @@ class SplitLandmarksCalculator : public CalculatorBase {
           }
           cc->Outputs().Index(i).Set<LandmarkType>();
         } else {
-          cc->Outputs().Index(i).Set<LandmarkListType>();
+          cc->Outputs().Index(i).Set<InputType>();
         }
       }
     }
@@ -111,8 +118,11 @@ class SplitLandmarksCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    const LandmarkListType& input =
-        cc->Inputs().Index(0).Get<LandmarkListType>();
+    return Split(cc, cc->Inputs().Index(0).Get<InputType>());
+  }
+
+ private:
+  absl::Status Split(CalculatorContext* cc, const LandmarkListType& input) {
     RET_CHECK_GE(input.landmark_size(), max_range_end_)
         << "Max range end " << max_range_end_ << " exceeds landmarks size "
         << input.landmark_size();
@@ -151,7 +161,39 @@ class SplitLandmarksCalculator : public CalculatorBase {
     return absl::OkStatus();
   }
 
- private:
+  absl::Status Split(CalculatorContext* cc, const LandmarkArrayType& input) {
+    RET_CHECK_GE(input.size(), max_range_end_)
+        << "Max range end " << max_range_end_ << " exceeds landmarks size "
+        << input.size();
+
+    if (combine_outputs_) {
+      LandmarkArrayType output;
+      for (const auto& range : ranges_) {
+        output.Append(input, range.first, range.second);
+      }
+      RET_CHECK_EQ(output.size(), total_elements_);
+      cc->Outputs().Index(0).AddPacket(
+          MakePacket<LandmarkArrayType>(std::move(output))
+              .At(cc->InputTimestamp()));
+    } else if (element_only_) {
+      for (int i = 0; i < ranges_.size(); ++i) {
+        cc->Outputs().Index(i).AddPacket(
+            MakePacket<LandmarkType>(input.landmark(ranges_[i].first))
+                .At(cc->InputTimestamp()));
+      }
+    } else {
+      for (int i = 0; i < ranges_.size(); ++i) {
+        LandmarkArrayType output;
+        output.Append(input, ranges_[i].first, ranges_[i].second);
+        cc->Outputs().Index(i).AddPacket(
+            MakePacket<LandmarkArrayType>(std::move(output))
+                .At(cc->InputTimestamp()));
+      }
+    }
+
+    return absl::OkStatus();
+  }
+
   std::vector<std::pair<int32, int32>> ranges_;
   int32 max_range_end_ = -1;
   int32 total_elements_ = 0;
@@ -167,6 +209,15 @@ typedef SplitLandmarksCalculator<Landmark, LandmarkList>
     SplitLandmarkListCalculator;
 REGISTER_CALCULATOR(SplitLandmarkListCalculator);
 
+typedef SplitLandmarksCalculator<NormalizedLandmark, NormalizedLandmarkList,
+                                 NormalizedLandmarkArray>
+    SplitNormalizedLandmarkArrayCalculator;
+REGISTER_CALCULATOR(SplitNormalizedLandmarkArrayCalculator);
+
+typedef SplitLandmarksCalculator<Landmark, LandmarkList, LandmarkArray>
+    SplitLandmarkArrayCalculator;
+REGISTER_CALCULATOR(SplitLandmarkArrayCalculator);
+
 }  // namespace mediapipe
 
 // NOLINTNEXTLINE
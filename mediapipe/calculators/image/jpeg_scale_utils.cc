@@ -0,0 +1,93 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/jpeg_scale_utils.h"
+
+#include <cstdint>
+
+namespace mediapipe {
+namespace jpeg_scale {
+
+namespace {
+
+constexpr uint8_t kMarkerPrefix = 0xFF;
+constexpr uint8_t kStartOfImage = 0xD8;
+constexpr uint8_t kStartOfScan = 0xDA;
+
+int ReadUint16(absl::string_view data, size_t pos) {
+  return (static_cast<uint8_t>(data[pos]) << 8) |
+         static_cast<uint8_t>(data[pos + 1]);
+}
+
+// Returns true for the start of frame markers SOF0 to SOF15. 0xC4 (DHT),
+// 0xC8 (JPG) and 0xCC (DAC) share the range but are not frame headers.
+bool IsStartOfFrame(uint8_t marker) {
+  return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 &&
+         marker != 0xC8 && marker != 0xCC;
+}
+
+// Returns true for markers that are not followed by a segment length.
+bool IsStandalone(uint8_t marker) {
+  return marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8);
+}
+
+}  // namespace
+
+bool ReadJpegHeader(absl::string_view data, JpegHeader* header) {
+  if (data.size() < 2 || static_cast<uint8_t>(data[0]) != kMarkerPrefix ||
+      static_cast<uint8_t>(data[1]) != kStartOfImage) {
+    return false;
+  }
+  size_t pos = 2;
+  while (pos < data.size()) {
+    if (static_cast<uint8_t>(data[pos]) != kMarkerPrefix) return false;
+    // Any number of fill bytes may precede a marker.
+    while (pos < data.size() &&
+           static_cast<uint8_t>(data[pos]) == kMarkerPrefix) {
+      ++pos;
+    }
+    if (pos >= data.size()) return false;
+    const uint8_t marker = static_cast<uint8_t>(data[pos++]);
+    if (IsStandalone(marker)) continue;
+    if (marker == kStartOfScan || pos + 2 > data.size()) return false;
+    const int length = ReadUint16(data, pos);
+    if (length < 2) return false;
+    if (IsStartOfFrame(marker)) {
+      // Precision (1 byte), height, width (2 bytes each), components.
+      if (length < 8 || pos + 8 > data.size()) return false;
+      header->height = ReadUint16(data, pos + 3);
+      header->width = ReadUint16(data, pos + 5);
+      header->num_components = static_cast<uint8_t>(data[pos + 7]);
+      return header->width > 0 && header->height > 0;
+    }
+    pos += length;
+  }
+  return false;
+}
+
+int FindScaleDenominator(int width, int height, int min_width,
+                         int min_height) {
+  for (int denominator = 8; denominator > 1; denominator /= 2) {
+    // libjpeg rounds the scaled dimensions up.
+    const int scaled_width = (width + denominator - 1) / denominator;
+    const int scaled_height = (height + denominator - 1) / denominator;
+    if (scaled_width >= min_width && scaled_height >= min_height) {
+      return denominator;
+    }
+  }
+  return 1;
+}
+
+}  // namespace jpeg_scale
+}  // namespace mediapipe
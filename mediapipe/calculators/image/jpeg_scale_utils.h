@@ -0,0 +1,47 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Utilities for reduced-resolution JPEG decoding. libjpeg can skip the
+// higher DCT coefficients and decode directly at 1/2, 1/4 or 1/8 of the
+// encoded size, which is considerably cheaper than a full decode followed by
+// a resize.
+#ifndef MEDIAPIPE_CALCULATORS_IMAGE_JPEG_SCALE_UTILS_H_
+#define MEDIAPIPE_CALCULATORS_IMAGE_JPEG_SCALE_UTILS_H_
+
+#include "absl/strings/string_view.h"
+
+namespace mediapipe {
+namespace jpeg_scale {
+
+// Dimensions and number of color components of a JPEG image.
+struct JpegHeader {
+  int width = 0;
+  int height = 0;
+  int num_components = 0;
+};
+
+// Reads the frame header of a JPEG image without decoding it. Returns false
+// if data is not a JPEG image or is truncated before the frame header.
+bool ReadJpegHeader(absl::string_view data, JpegHeader* header);
+
+// Returns the largest scale denominator among 8, 4 and 2 such that a
+// width x height image decoded at that scale is still at least
+// min_width x min_height, or 1 if no reduction is possible. Non-positive
+// minimums are not constrained.
+int FindScaleDenominator(int width, int height, int min_width, int min_height);
+
+}  // namespace jpeg_scale
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_IMAGE_JPEG_SCALE_UTILS_H_
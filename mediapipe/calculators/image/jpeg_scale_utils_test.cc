@@ -0,0 +1,83 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/image/jpeg_scale_utils.h"
+
+#include <string>
+
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace jpeg_scale {
+namespace {
+
+// SOI, an APP0 segment, a fill byte and a baseline SOF0 frame header for a
+// 3-component 640x480 image.
+const char kHeader[] =
+    "\xFF\xD8"
+    "\xFF\xE0\x00\x06JFIF"
+    "\xFF"
+    "\xFF\xC0\x00\x11\x08\x01\xE0\x02\x80\x03";
+
+TEST(JpegScaleUtilsTest, ReadsFrameHeader) {
+  JpegHeader header;
+  ASSERT_TRUE(
+      ReadJpegHeader(absl::string_view(kHeader, sizeof(kHeader) - 1), &header));
+  EXPECT_EQ(header.width, 640);
+  EXPECT_EQ(header.height, 480);
+  EXPECT_EQ(header.num_components, 3);
+}
+
+TEST(JpegScaleUtilsTest, RejectsOtherData) {
+  JpegHeader header;
+  EXPECT_FALSE(ReadJpegHeader("", &header));
+  EXPECT_FALSE(ReadJpegHeader("\x89PNG\r\n\x1A\n", &header));
+  // Truncated before the frame header.
+  EXPECT_FALSE(ReadJpegHeader(absl::string_view(kHeader, 14), &header));
+  // Scan data before any frame header.
+  EXPECT_FALSE(ReadJpegHeader("\xFF\xD8\xFF\xDA\x00\x02", &header));
+}
+
+// The EXIF segment of the test image embeds a thumbnail, which must be
+// skipped.
+TEST(JpegScaleUtilsTest, ReadsTestImage) {
+  std::string contents;
+  MP_ASSERT_OK(file::GetContents(
+      file::JoinPath("./", "/mediapipe/calculators/image/testdata/dino.jpg"),
+      &contents));
+  JpegHeader header;
+  ASSERT_TRUE(ReadJpegHeader(contents, &header));
+  EXPECT_EQ(header.width, 2876);
+  EXPECT_EQ(header.height, 1699);
+  EXPECT_EQ(header.num_components, 3);
+}
+
+TEST(JpegScaleUtilsTest, FindScaleDenominator) {
+  EXPECT_EQ(FindScaleDenominator(640, 480, 0, 0), 8);
+  EXPECT_EQ(FindScaleDenominator(640, 480, 80, 60), 8);
+  EXPECT_EQ(FindScaleDenominator(640, 480, 81, 60), 4);
+  EXPECT_EQ(FindScaleDenominator(640, 480, 256, 192), 2);
+  EXPECT_EQ(FindScaleDenominator(640, 480, 640, 1), 1);
+  // Scaled dimensions are rounded up.
+  EXPECT_EQ(FindScaleDenominator(2876, 1699, 360, 213), 8);
+  EXPECT_EQ(FindScaleDenominator(2876, 1699, 360, 214), 4);
+}
+
+}  // namespace
+}  // namespace jpeg_scale
+}  // namespace mediapipe
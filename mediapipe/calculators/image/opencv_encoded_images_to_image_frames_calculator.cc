@@ -0,0 +1,280 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/calculators/image/jpeg_scale_utils.h"
+#include "mediapipe/calculators/image/opencv_encoded_images_to_image_frames_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Pools of distinct image sizes and formats kept at a time. Beyond that, the
+// pools are dropped and recreated on demand; frames still in use are then
+// released instead of being returned.
+constexpr int kMaxFramePools = 8;
+
+// Returns the imdecode() flags decoding a JPEG at 1/denominator of its size.
+int ReducedReadFlags(int denominator, bool grayscale) {
+  switch (denominator) {
+    case 2:
+      return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_2
+                       : cv::IMREAD_REDUCED_COLOR_2;
+    case 4:
+      return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_4
+                       : cv::IMREAD_REDUCED_COLOR_4;
+    default:
+      return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_8
+                       : cv::IMREAD_REDUCED_COLOR_8;
+  }
+}
+
+}  // namespace
+
+// Batch version of OpenCvEncodedImageToImageFrameCalculator. Takes in a vector
+// of encoded image strings and decodes them by OpenCV across a thread pool
+// into ImageFrames. The output frames are taken from pools of buffers that
+// are reused once downstream calculators release them, and the encoded
+// strings are decoded in place rather than copied.
+//
+// If min_width or min_height is set, JPEG images are decoded at a reduced
+// resolution by DCT scaling, down to 1/8 of their size, as long as they stay
+// at least as large as requested. Decoding at 1/8 is several times faster
+// than a full decode. The aspect ratio is preserved, so downstream
+// calculators such as ImageToTensorCalculator still see the whole image.
+//
+// Example config:
+// node {
+//   calculator: "OpenCvEncodedImagesToImageFramesCalculator"
+//   input_stream: "encoded_images"
+//   output_stream: "image_frames"
+//   options {
+//     [mediapipe.OpenCvEncodedImagesToImageFramesCalculatorOptions.ext] {
+//       num_threads: 4
+//       min_width: 256
+//       min_height: 256
+//     }
+//   }
+// }
+class OpenCvEncodedImagesToImageFramesCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  // Decodes contents into output, using decoded as scratch.
+  absl::Status DecodeImage(const std::string& contents, cv::Mat* decoded,
+                           ImageFrame* output);
+
+  // Returns a pooled frame, may be called from any thread.
+  ImageFrameSharedPtr GetBuffer(int width, int height,
+                                ImageFormat::Format format);
+
+  mediapipe::OpenCvEncodedImagesToImageFramesCalculatorOptions options_;
+  std::unique_ptr<ThreadPool> pool_;
+
+  // Decoding scratch of each task of a batch.
+  std::vector<cv::Mat> scratch_;
+
+  absl::Mutex frame_pools_mutex_;
+  absl::flat_hash_map<std::tuple<int, int, int>,
+                      std::shared_ptr<ImageFramePool>>
+      frame_pools_ ABSL_GUARDED_BY(frame_pools_mutex_);
+};
+
+absl::Status OpenCvEncodedImagesToImageFramesCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Index(0).Set<std::vector<std::string>>();
+  cc->Outputs().Index(0).Set<std::vector<ImageFrame>>();
+  return absl::OkStatus();
+}
+
+absl::Status OpenCvEncodedImagesToImageFramesCalculator::Open(
+    CalculatorContext* cc) {
+  options_ = cc->Options<
+      mediapipe::OpenCvEncodedImagesToImageFramesCalculatorOptions>();
+  RET_CHECK_GE(options_.num_threads(), 1);
+  RET_CHECK_GE(options_.frame_pool_size(), 0);
+  scratch_.resize(options_.num_threads());
+  if (options_.num_threads() > 1) {
+    pool_ = absl::make_unique<ThreadPool>("image_decoder",
+                                          options_.num_threads());
+    pool_->StartWorkers();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status OpenCvEncodedImagesToImageFramesCalculator::Process(
+    CalculatorContext* cc) {
+  const auto& contents =
+      cc->Inputs().Index(0).Get<std::vector<std::string>>();
+  const int num_images = contents.size();
+  auto output_frames = absl::make_unique<std::vector<ImageFrame>>(num_images);
+  std::vector<absl::Status> statuses(num_images);
+
+  // Each task decodes every num_tasks-th image with its own scratch.
+  const int num_tasks = std::min<int>(num_images, scratch_.size());
+  auto decode_task = [&](int task) {
+    for (int i = task; i < num_images; i += num_tasks) {
+      statuses[i] =
+          DecodeImage(contents[i], &scratch_[task], &(*output_frames)[i]);
+    }
+  };
+  if (pool_ && num_tasks > 1) {
+    absl::BlockingCounter counter(num_tasks);
+    for (int task = 0; task < num_tasks; ++task) {
+      pool_->Schedule([&decode_task, &counter, task] {
+        decode_task(task);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  } else {
+    for (int task = 0; task < num_tasks; ++task) decode_task(task);
+  }
+
+  for (int i = 0; i < num_images; ++i) {
+    if (!statuses[i].ok()) {
+      return mediapipe::StatusBuilder(statuses[i], MEDIAPIPE_LOC)
+             << "Failed to decode image " << i << " of the batch.";
+    }
+  }
+  cc->Outputs().Index(0).Add(output_frames.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+absl::Status OpenCvEncodedImagesToImageFramesCalculator::DecodeImage(
+    const std::string& contents, cv::Mat* decoded, ImageFrame* output) {
+  int flags;
+  if (options_.apply_orientation_from_exif_data()) {
+    // See OpenCvEncodedImageToImageFrameCalculator.
+    flags = cv::IMREAD_ANYCOLOR | cv::IMREAD_ANYDEPTH;
+  } else {
+    flags = cv::IMREAD_UNCHANGED;
+  }
+  jpeg_scale::JpegHeader header;
+  if ((options_.min_width() > 0 || options_.min_height() > 0) &&
+      jpeg_scale::ReadJpegHeader(contents, &header)) {
+    int denominator = jpeg_scale::FindScaleDenominator(
+        header.width, header.height, options_.min_width(),
+        options_.min_height());
+    if (options_.apply_orientation_from_exif_data()) {
+      // The orientation may swap width and height, which isn't known until
+      // the image is decoded.
+      denominator = std::min(
+          denominator, jpeg_scale::FindScaleDenominator(
+                           header.width, header.height, options_.min_height(),
+                           options_.min_width()));
+    }
+    if (denominator > 1) {
+      // Reduced reads respect the EXIF orientation unless told otherwise.
+      flags = ReducedReadFlags(denominator, header.num_components == 1);
+      if (!options_.apply_orientation_from_exif_data()) {
+        flags |= cv::IMREAD_IGNORE_ORIENTATION;
+      }
+    }
+  }
+
+  // imdecode() only reads the buffer, so it can wrap the string.
+  const cv::Mat encoded(1, contents.size(), CV_8UC1,
+                        const_cast<char*>(contents.data()));
+  cv::imdecode(encoded, flags, decoded);
+  RET_CHECK(!decoded->empty()) << "Unable to decode the image.";
+  RET_CHECK_EQ(decoded->depth(), CV_8U) << "Only 8-bit images are supported.";
+
+  ImageFormat::Format image_format = ImageFormat::UNKNOWN;
+  switch (decoded->channels()) {
+    case 1:
+      image_format = ImageFormat::GRAY8;
+      break;
+    case 3:
+      image_format = ImageFormat::SRGB;
+      break;
+    case 4:
+      image_format = ImageFormat::SRGBA;
+      break;
+    default:
+      return mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
+             << "Unsupported number of channels: " << decoded->channels();
+  }
+  ImageFrameSharedPtr buffer =
+      GetBuffer(decoded->cols, decoded->rows, image_format);
+  RET_CHECK(buffer);
+  // The view matches the decoded size and type, so the conversion writes
+  // into the pooled buffer.
+  cv::Mat view = formats::MatView(buffer.get());
+  switch (decoded->channels()) {
+    case 1:
+      decoded->copyTo(view);
+      break;
+    case 3:
+      cv::cvtColor(*decoded, view, cv::COLOR_BGR2RGB);
+      break;
+    case 4:
+      cv::cvtColor(*decoded, view, cv::COLOR_BGR2RGBA);
+      break;
+  }
+
+  // The output frame shares the pixels of the pooled buffer, and returns it
+  // to the pool once released.
+  ImageFrame* pooled = buffer.get();
+  *output = ImageFrame(image_format, pooled->Width(), pooled->Height(),
+                       pooled->WidthStep(), pooled->MutablePixelData(),
+                       [buffer = std::move(buffer)](uint8*) {});
+  return absl::OkStatus();
+}
+
+ImageFrameSharedPtr OpenCvEncodedImagesToImageFramesCalculator::GetBuffer(
+    int width, int height, ImageFormat::Format format) {
+  std::shared_ptr<ImageFramePool> frame_pool;
+  {
+    absl::MutexLock lock(&frame_pools_mutex_);
+    const auto key = std::make_tuple(width, height, static_cast<int>(format));
+    auto it = frame_pools_.find(key);
+    if (it == frame_pools_.end()) {
+      if (frame_pools_.size() >= kMaxFramePools) frame_pools_.clear();
+      it = frame_pools_
+               .emplace(key, ImageFramePool::Create(width, height, format,
+                                                    options_.frame_pool_size()))
+               .first;
+    }
+    frame_pool = it->second;
+  }
+  return frame_pool->GetBuffer();
+}
+
+REGISTER_CALCULATOR(OpenCvEncodedImagesToImageFramesCalculator);
+
+}  // namespace mediapipe
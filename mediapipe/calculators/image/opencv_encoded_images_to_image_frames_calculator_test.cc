@@ -0,0 +1,162 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+
+namespace {
+
+std::string Encode(const std::string& extension, const cv::Mat& mat) {
+  std::vector<uchar> encode_buffer;
+  cv::imencode(extension, mat, encode_buffer);
+  return std::string(encode_buffer.begin(), encode_buffer.end());
+}
+
+std::string GetTestJpeg() {
+  std::string contents;
+  MEDIAPIPE_CHECK_OK(file::GetContents(
+      file::JoinPath("./", "/mediapipe/calculators/image/testdata/dino.jpg"),
+      &contents));
+  return contents;
+}
+
+// Decodes a batch of contents with the given options and returns the frames.
+std::vector<ImageFrame> DecodeBatch(const std::vector<std::string>& contents,
+                                    const std::string& options) {
+  CalculatorRunner runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          R"(
+        calculator: "OpenCvEncodedImagesToImageFramesCalculator"
+        input_stream: "encoded_images"
+        output_stream: "image_frames"
+        node_options {
+          [type.googleapis.com/mediapipe.OpenCvEncodedImagesToImageFramesCalculatorOptions]: {
+            $0
+          }
+        })",
+          options)));
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<std::vector<std::string>>(contents).At(Timestamp(0)));
+  MEDIAPIPE_CHECK_OK(runner.Run());
+  const std::vector<Packet>& packets = runner.Outputs().Index(0).packets;
+  CHECK_EQ(1, packets.size());
+  // The runner owns the output packet, so return copies of the frames.
+  std::vector<ImageFrame> frames;
+  for (const ImageFrame& frame : packets[0].Get<std::vector<ImageFrame>>()) {
+    ImageFrame copy;
+    copy.CopyFrom(frame, ImageFrame::kDefaultAlignmentBoundary);
+    frames.push_back(std::move(copy));
+  }
+  return frames;
+}
+
+double MaxDiff(const cv::Mat& expected, const ImageFrame& frame) {
+  cv::Mat diff;
+  cv::absdiff(expected, formats::MatView(&frame), diff);
+  double max_val;
+  cv::minMaxLoc(diff, nullptr, &max_val);
+  return max_val;
+}
+
+TEST(OpenCvEncodedImagesToImageFramesCalculatorTest, TestMixedBatch) {
+  const std::string jpeg = GetTestJpeg();
+  cv::Mat bgr = cv::imdecode(
+      std::vector<char>(jpeg.begin(), jpeg.end()), cv::IMREAD_UNCHANGED);
+  cv::Mat rgb, gray, bgra, rgba;
+  cv::cvtColor(bgr, rgb, cv::COLOR_BGR2RGB);
+  cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+  cv::cvtColor(bgr, bgra, cv::COLOR_BGR2BGRA);
+  cv::cvtColor(bgra, rgba, cv::COLOR_BGRA2RGBA);
+
+  // More images than threads, so that threads decode several images each.
+  const std::vector<std::string> contents = {
+      jpeg, Encode(".png", gray), Encode(".png", bgra), jpeg, jpeg};
+  const std::vector<ImageFrame> frames =
+      DecodeBatch(contents, "num_threads: 2");
+  ASSERT_EQ(frames.size(), contents.size());
+  for (int i : {0, 3, 4}) {
+    EXPECT_EQ(frames[i].Format(), ImageFormat::SRGB);
+    EXPECT_EQ(MaxDiff(rgb, frames[i]), 0);
+  }
+  EXPECT_EQ(frames[1].Format(), ImageFormat::GRAY8);
+  EXPECT_EQ(MaxDiff(gray, frames[1]), 0);
+  EXPECT_EQ(frames[2].Format(), ImageFormat::SRGBA);
+  EXPECT_EQ(MaxDiff(rgba, frames[2]), 0);
+
+  // Decoding on the calling thread gives the same frames.
+  const std::vector<ImageFrame> serial_frames =
+      DecodeBatch(contents, "num_threads: 1");
+  ASSERT_EQ(serial_frames.size(), contents.size());
+  for (int i = 0; i < contents.size(); ++i) {
+    EXPECT_EQ(MaxDiff(formats::MatView(&frames[i]), serial_frames[i]), 0);
+  }
+}
+
+TEST(OpenCvEncodedImagesToImageFramesCalculatorTest, TestReducedJpeg) {
+  const std::string jpeg = GetTestJpeg();
+  // The 2876x1699 image is decoded at 1/4, as 1/8 would be too short.
+  const std::vector<ImageFrame> frames =
+      DecodeBatch({jpeg}, "min_width: 256 min_height: 256");
+  ASSERT_EQ(frames.size(), 1);
+  EXPECT_EQ(frames[0].Width(), 719);
+  EXPECT_EQ(frames[0].Height(), 425);
+
+  cv::Mat expected;
+  cv::cvtColor(cv::imdecode(std::vector<char>(jpeg.begin(), jpeg.end()),
+                            cv::IMREAD_REDUCED_COLOR_4 |
+                                cv::IMREAD_IGNORE_ORIENTATION),
+               expected, cv::COLOR_BGR2RGB);
+  EXPECT_EQ(MaxDiff(expected, frames[0]), 0);
+
+  // Other formats are decoded at full size.
+  cv::Mat small;
+  cv::resize(expected, small, cv::Size(320, 240));
+  const std::vector<ImageFrame> png_frames =
+      DecodeBatch({Encode(".png", small)}, "min_width: 16 min_height: 16");
+  ASSERT_EQ(png_frames.size(), 1);
+  EXPECT_EQ(png_frames[0].Width(), 320);
+  EXPECT_EQ(png_frames[0].Height(), 240);
+}
+
+TEST(OpenCvEncodedImagesToImageFramesCalculatorTest, TestInvalidImageFails) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      R"pb(
+        calculator: "OpenCvEncodedImagesToImageFramesCalculator"
+        input_stream: "encoded_images"
+        output_stream: "image_frames"
+      )pb"));
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<std::vector<std::string>>(
+          std::vector<std::string>{GetTestJpeg(), "not an image"})
+          .At(Timestamp(0)));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,199 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "mediapipe/calculators/image/opencv_image_encoder_calculator.pb.h"
+#include "mediapipe/calculators/image/opencv_images_encoder_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_builder.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// Batch version of OpenCvImageEncoderCalculator. Takes in a vector of image
+// frames and encodes them to JPEG or PNG by OpenCV across a thread pool. The
+// color conversion and encoding buffers of each thread are reused from batch
+// to batch.
+//
+// Grayscale, RGB and RGBA frames are supported. JPEG drops the alpha channel
+// of RGBA frames.
+//
+// Example config:
+// node {
+//   calculator: "OpenCvImagesEncoderCalculator"
+//   input_stream: "image_frames"
+//   output_stream: "encoded_images"
+//   options {
+//     [mediapipe.OpenCvImagesEncoderCalculatorOptions.ext] {
+//       format: JPEG
+//       quality: 80
+//     }
+//   }
+// }
+class OpenCvImagesEncoderCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  // Buffers of each task of a batch.
+  struct Scratch {
+    cv::Mat bgr;
+    std::vector<uchar> encoded;
+  };
+
+  absl::Status EncodeImage(const ImageFrame& image_frame, Scratch* scratch,
+                           OpenCvImageEncoderCalculatorResults* result);
+
+  mediapipe::OpenCvImagesEncoderCalculatorOptions options_;
+  const char* extension_ = nullptr;
+  std::vector<int> parameters_;
+  std::unique_ptr<ThreadPool> pool_;
+  std::vector<Scratch> scratch_;
+};
+
+absl::Status OpenCvImagesEncoderCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Index(0).Set<std::vector<ImageFrame>>();
+  cc->Outputs()
+      .Index(0)
+      .Set<std::vector<OpenCvImageEncoderCalculatorResults>>();
+  return absl::OkStatus();
+}
+
+absl::Status OpenCvImagesEncoderCalculator::Open(CalculatorContext* cc) {
+  options_ = cc->Options<mediapipe::OpenCvImagesEncoderCalculatorOptions>();
+  RET_CHECK_GE(options_.num_threads(), 1);
+  switch (options_.format()) {
+    case OpenCvImagesEncoderCalculatorOptions::JPEG:
+      RET_CHECK(options_.quality() > 0 && options_.quality() <= 100);
+      extension_ = ".jpg";
+      parameters_ = {cv::IMWRITE_JPEG_QUALITY, options_.quality()};
+      break;
+    case OpenCvImagesEncoderCalculatorOptions::PNG:
+      RET_CHECK(options_.png_compression_level() >= 0 &&
+                options_.png_compression_level() <= 9);
+      extension_ = ".png";
+      parameters_ = {cv::IMWRITE_PNG_COMPRESSION,
+                     options_.png_compression_level()};
+      break;
+  }
+  scratch_.resize(options_.num_threads());
+  if (options_.num_threads() > 1) {
+    pool_ = absl::make_unique<ThreadPool>("image_encoder",
+                                          options_.num_threads());
+    pool_->StartWorkers();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status OpenCvImagesEncoderCalculator::Process(CalculatorContext* cc) {
+  const auto& image_frames =
+      cc->Inputs().Index(0).Get<std::vector<ImageFrame>>();
+  const int num_images = image_frames.size();
+  auto results = absl::make_unique<
+      std::vector<OpenCvImageEncoderCalculatorResults>>(num_images);
+  std::vector<absl::Status> statuses(num_images);
+
+  // Each task encodes every num_tasks-th image with its own scratch.
+  const int num_tasks = std::min<int>(num_images, scratch_.size());
+  auto encode_task = [&](int task) {
+    for (int i = task; i < num_images; i += num_tasks) {
+      statuses[i] =
+          EncodeImage(image_frames[i], &scratch_[task], &(*results)[i]);
+    }
+  };
+  if (pool_ && num_tasks > 1) {
+    absl::BlockingCounter counter(num_tasks);
+    for (int task = 0; task < num_tasks; ++task) {
+      pool_->Schedule([&encode_task, &counter, task] {
+        encode_task(task);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  } else {
+    for (int task = 0; task < num_tasks; ++task) encode_task(task);
+  }
+
+  for (int i = 0; i < num_images; ++i) {
+    if (!statuses[i].ok()) {
+      return mediapipe::StatusBuilder(statuses[i], MEDIAPIPE_LOC)
+             << "Failed to encode image " << i << " of the batch.";
+    }
+  }
+  cc->Outputs().Index(0).Add(results.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+absl::Status OpenCvImagesEncoderCalculator::EncodeImage(
+    const ImageFrame& image_frame, Scratch* scratch,
+    OpenCvImageEncoderCalculatorResults* result) {
+  RET_CHECK_EQ(image_frame.ByteDepth(), 1);
+  const bool png =
+      options_.format() == OpenCvImagesEncoderCalculatorOptions::PNG;
+  const cv::Mat original_mat = formats::MatView(&image_frame);
+  const cv::Mat* input_mat = &original_mat;
+  // OpenCV assumes the image to be BGR order. To use imencode(), do color
+  // conversion first.
+  switch (original_mat.channels()) {
+    case 1:
+      result->set_colorspace(OpenCvImageEncoderCalculatorResults::GRAYSCALE);
+      break;
+    case 3:
+      cv::cvtColor(original_mat, scratch->bgr, cv::COLOR_RGB2BGR);
+      input_mat = &scratch->bgr;
+      result->set_colorspace(OpenCvImageEncoderCalculatorResults::RGB);
+      break;
+    case 4:
+      if (png) {
+        cv::cvtColor(original_mat, scratch->bgr, cv::COLOR_RGBA2BGRA);
+        result->set_colorspace(OpenCvImageEncoderCalculatorResults::RGBA);
+      } else {
+        cv::cvtColor(original_mat, scratch->bgr, cv::COLOR_RGBA2BGR);
+        result->set_colorspace(OpenCvImageEncoderCalculatorResults::RGB);
+      }
+      input_mat = &scratch->bgr;
+      break;
+    default:
+      return mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
+             << "Unsupported number of channels: " << original_mat.channels();
+  }
+
+  if (!cv::imencode(extension_, *input_mat, scratch->encoded, parameters_)) {
+    return mediapipe::InternalErrorBuilder(MEDIAPIPE_LOC)
+           << "Fail to encode the image to " << extension_ << " format.";
+  }
+  result->set_width(image_frame.Width());
+  result->set_height(image_frame.Height());
+  result->set_encoded_image(scratch->encoded.data(), scratch->encoded.size());
+  return absl::OkStatus();
+}
+
+REGISTER_CALCULATOR(OpenCvImagesEncoderCalculator);
+
+}  // namespace mediapipe
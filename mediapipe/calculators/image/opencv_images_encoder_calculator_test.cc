@@ -0,0 +1,132 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/substitute.h"
+#include "mediapipe/calculators/image/opencv_image_encoder_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_imgcodecs_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+
+namespace {
+
+ImageFrame MakeFrame(ImageFormat::Format format, const cv::Mat& mat) {
+  ImageFrame frame(format, mat.cols, mat.rows);
+  mat.copyTo(formats::MatView(&frame));
+  return frame;
+}
+
+// Encodes RGB, grayscale and RGBA versions of the test image, each twice so
+// that threads encode several images.
+std::vector<OpenCvImageEncoderCalculatorResults> EncodeBatch(
+    const std::string& options, std::vector<cv::Mat>* bgr_mats) {
+  cv::Mat bgr = cv::imread(
+      file::JoinPath("./", "/mediapipe/calculators/image/testdata/dino.jpg"));
+  cv::Mat rgb, gray, rgba;
+  cv::cvtColor(bgr, rgb, cv::COLOR_BGR2RGB);
+  cv::cvtColor(bgr, gray, cv::COLOR_BGR2GRAY);
+  cv::cvtColor(bgr, rgba, cv::COLOR_BGR2RGBA);
+  cv::Mat bgra;
+  cv::cvtColor(bgr, bgra, cv::COLOR_BGR2BGRA);
+  *bgr_mats = {bgr, gray, bgra, bgr, gray, bgra};
+
+  std::vector<ImageFrame> frames;
+  for (int i = 0; i < 2; ++i) {
+    frames.push_back(MakeFrame(ImageFormat::SRGB, rgb));
+    frames.push_back(MakeFrame(ImageFormat::GRAY8, gray));
+    frames.push_back(MakeFrame(ImageFormat::SRGBA, rgba));
+  }
+
+  CalculatorRunner runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(absl::Substitute(
+          R"(
+        calculator: "OpenCvImagesEncoderCalculator"
+        input_stream: "image_frames"
+        output_stream: "encoded_images"
+        node_options {
+          [type.googleapis.com/mediapipe.OpenCvImagesEncoderCalculatorOptions]: {
+            num_threads: 2
+            $0
+          }
+        })",
+          options)));
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<std::vector<ImageFrame>>(std::move(frames)).At(Timestamp(0)));
+  MEDIAPIPE_CHECK_OK(runner.Run());
+  const std::vector<Packet>& packets = runner.Outputs().Index(0).packets;
+  CHECK_EQ(1, packets.size());
+  return packets[0].Get<std::vector<OpenCvImageEncoderCalculatorResults>>();
+}
+
+cv::Mat Decode(const OpenCvImageEncoderCalculatorResults& result) {
+  const std::vector<char> contents_vector(result.encoded_image().begin(),
+                                          result.encoded_image().end());
+  return cv::imdecode(contents_vector, cv::IMREAD_UNCHANGED);
+}
+
+double MaxDiff(const cv::Mat& expected, const cv::Mat& actual) {
+  cv::Mat diff;
+  cv::absdiff(expected, actual, diff);
+  double max_val;
+  cv::minMaxLoc(diff, nullptr, &max_val);
+  return max_val;
+}
+
+TEST(OpenCvImagesEncoderCalculatorTest, TestPngIsLossless) {
+  std::vector<cv::Mat> bgr_mats;
+  const auto results = EncodeBatch("format: PNG", &bgr_mats);
+  ASSERT_EQ(results.size(), bgr_mats.size());
+  for (int i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].width(), bgr_mats[i].cols);
+    EXPECT_EQ(results[i].height(), bgr_mats[i].rows);
+    const cv::Mat decoded = Decode(results[i]);
+    ASSERT_EQ(decoded.channels(), bgr_mats[i].channels());
+    EXPECT_EQ(MaxDiff(bgr_mats[i], decoded), 0);
+  }
+  EXPECT_EQ(results[0].colorspace(), OpenCvImageEncoderCalculatorResults::RGB);
+  EXPECT_EQ(results[1].colorspace(),
+            OpenCvImageEncoderCalculatorResults::GRAYSCALE);
+  EXPECT_EQ(results[2].colorspace(),
+            OpenCvImageEncoderCalculatorResults::RGBA);
+}
+
+TEST(OpenCvImagesEncoderCalculatorTest, TestJpegMatchesSingleEncoder) {
+  std::vector<cv::Mat> bgr_mats;
+  const auto results = EncodeBatch("format: JPEG quality: 80", &bgr_mats);
+  ASSERT_EQ(results.size(), bgr_mats.size());
+  const cv::Mat expected_output = cv::imread(file::JoinPath(
+      "./", "/mediapipe/calculators/image/testdata/dino_quality_80.jpg"));
+  // The alpha channel is dropped.
+  EXPECT_EQ(results[2].colorspace(), OpenCvImageEncoderCalculatorResults::RGB);
+  for (int i : {0, 2, 3, 5}) {
+    // Expects that the maximum absolute pixel-by-pixel difference is less
+    // than 10.
+    EXPECT_LE(MaxDiff(expected_output, Decode(results[i])), 10);
+  }
+  EXPECT_EQ(Decode(results[1]).channels(), 1);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -64,6 +64,10 @@ enum { ATTRIB_VERTEX, ATTRIB_TEXTURE_POSITION, NUM_ATTRIBUTES };
 // Options:
 //   combine_with_previous_ratio - Amount of previous to blend with current.
 //
+// On CPU, TensorsToSegmentationCalculator can blend in the previous mask
+// while producing the current one, see its combine_with_previous_ratio
+// option, which avoids a separate pass over the mask.
+//
 // Example:
 //  node {
 //    calculator: "SegmentationSmoothingCalculator"
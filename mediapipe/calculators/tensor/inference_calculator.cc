@@ -22,6 +22,7 @@
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/framework/tool/subgraph_expansion.h"
+#include "mediapipe/util/tflite/tflite_interpreter_cache.h"
 
 namespace mediapipe {
 namespace api2 {
@@ -59,6 +60,10 @@ absl::StatusOr<Packet<TfLiteModelPtr>> InferenceCalculator::GetModelAsPacket(
     CalculatorContext* cc) {
   const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
   if (!options.model_path().empty()) {
+    if (options.reuse_interpreter()) {
+      return TfLiteInterpreterCache::GetInstance().GetModel(
+          options.model_path());
+    }
     return TfLiteModelLoader::LoadFromPath(options.model_path());
   }
   if (!kSideInModel(cc).IsEmpty()) return kSideInModel(cc);
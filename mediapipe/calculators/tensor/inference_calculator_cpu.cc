@@ -17,8 +17,12 @@
 #include <string>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
+#include "mediapipe/util/tflite/tflite_interpreter_cache.h"
 
 #if defined(MEDIAPIPE_ANDROID)
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
@@ -73,11 +77,17 @@ class InferenceCalculatorCpuImpl
  private:
   absl::Status LoadModel(CalculatorContext* cc);
   absl::Status LoadDelegate(CalculatorContext* cc);
+  // Takes a cached interpreter for the model and options, if reuse is
+  // requested. Returns true if an interpreter was found.
+  absl::StatusOr<bool> AcquireCachedInterpreter(CalculatorContext* cc);
 
   // TfLite requires us to keep the model alive as long as the interpreter is.
   Packet<TfLiteModelPtr> model_packet_;
   std::unique_ptr<tflite::Interpreter> interpreter_;
   TfLiteDelegatePtr delegate_;
+  // The key under which the interpreter is returned to the
+  // TfLiteInterpreterCache on Close, or empty if it is not cached.
+  std::string interpreter_cache_key_;
 };
 
 absl::Status InferenceCalculatorCpuImpl::UpdateContract(
@@ -90,6 +100,10 @@ absl::Status InferenceCalculatorCpuImpl::UpdateContract(
 }
 
 absl::Status InferenceCalculatorCpuImpl::Open(CalculatorContext* cc) {
+  ASSIGN_OR_RETURN(bool acquired, AcquireCachedInterpreter(cc));
+  if (acquired) {
+    return absl::OkStatus();
+  }
   MP_RETURN_IF_ERROR(LoadModel(cc));
   MP_RETURN_IF_ERROR(LoadDelegate(cc));
   return absl::OkStatus();
@@ -134,13 +148,61 @@ absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
 }
 
 absl::Status InferenceCalculatorCpuImpl::Close(CalculatorContext* cc) {
+  if (!interpreter_cache_key_.empty() && interpreter_) {
+    TfLiteInterpreterCache::GetInstance().Release(
+        interpreter_cache_key_,
+        {std::move(model_packet_), std::move(delegate_),
+         std::move(interpreter_)});
+  }
   interpreter_ = nullptr;
   delegate_ = nullptr;
   return absl::OkStatus();
 }
 
-absl::Status InferenceCalculatorCpuImpl::LoadModel(CalculatorContext* cc) {
+absl::StatusOr<bool> InferenceCalculatorCpuImpl::AcquireCachedInterpreter(
+    CalculatorContext* cc) {
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  // Side packets that change how the interpreter is prepared are not part of
+  // the key, so interpreters prepared with them are not reused.
+  if (!options.reuse_interpreter() ||
+      kSideInCustomOpResolver(cc).IsConnected() ||
+      kNnApiDelegateCacheDir(cc).IsConnected() ||
+      kNnApiDelegateModelToken(cc).IsConnected()) {
+    return false;
+  }
   ASSIGN_OR_RETURN(model_packet_, GetModelAsPacket(cc));
+  std::string model_key;
+  if (!options.model_path().empty()) {
+    model_key = absl::StrCat("path:", options.model_path());
+  } else {
+    // A model side packet is usually loaded again on every run, so it is
+    // identified by its contents rather than its address.
+    const tflite::Allocation* allocation = model_packet_.Get()->allocation();
+    RET_CHECK(allocation);
+    const absl::string_view contents(
+        static_cast<const char*>(allocation->base()), allocation->bytes());
+    model_key = absl::StrCat("model:", contents.size(), ":",
+                             absl::Hash<absl::string_view>()(contents));
+  }
+  interpreter_cache_key_ =
+      absl::StrCat(model_key, ":", options.SerializeAsString());
+  auto entry =
+      TfLiteInterpreterCache::GetInstance().Acquire(interpreter_cache_key_);
+  if (!entry) {
+    return false;
+  }
+  model_packet_ = std::move(entry->model);
+  delegate_ = std::move(entry->delegate);
+  interpreter_ = std::move(entry->interpreter);
+  // Stateful models must not see the state left by the previous run.
+  RET_CHECK_EQ(interpreter_->ResetVariableTensors(), kTfLiteOk);
+  return true;
+}
+
+absl::Status InferenceCalculatorCpuImpl::LoadModel(CalculatorContext* cc) {
+  if (model_packet_.IsEmpty()) {
+    ASSIGN_OR_RETURN(model_packet_, GetModelAsPacket(cc));
+  }
   const auto& model = *model_packet_.Get();
   tflite::ops::builtin::BuiltinOpResolver op_resolver =
       kSideInCustomOpResolver(cc).GetOr(
@@ -29,6 +29,7 @@
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status_matchers.h"  // NOLINT
 #include "mediapipe/framework/tool/validate_type.h"
+#include "mediapipe/util/tflite/tflite_interpreter_cache.h"
 #include "tensorflow/lite/error_reporter.h"
 #include "tensorflow/lite/kernels/register.h"
 #include "tensorflow/lite/model.h"
@@ -118,6 +119,97 @@ TEST(InferenceCalculatorTest, SmokeTest) {
       {{"$delegate", "delegate { xnnpack { num_threads: 10 } }"}}));
 }
 
+TEST(InferenceCalculatorTest, SmokeTest_ReuseInterpreter) {
+  std::string graph_proto = R"(
+    input_stream: "tensor_in"
+    node {
+      calculator: "InferenceCalculator"
+      input_stream: "TENSORS:tensor_in"
+      output_stream: "TENSORS:tensor_out"
+      options {
+        [mediapipe.InferenceCalculatorOptions.ext] {
+          model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+          delegate { xnnpack {} }
+          reuse_interpreter: true
+        }
+      }
+    }
+  )";
+  TfLiteInterpreterCache& cache = TfLiteInterpreterCache::GetInstance();
+  cache.Clear();
+  // The interpreter is returned to the cache when the graph is done, and the
+  // next graph takes it back instead of preparing another one.
+  DoSmokeTest(graph_proto);
+  EXPECT_EQ(cache.NumIdleInterpreters(), 1);
+  DoSmokeTest(graph_proto);
+  EXPECT_EQ(cache.NumIdleInterpreters(), 1);
+  cache.Clear();
+  EXPECT_EQ(cache.NumIdleInterpreters(), 0);
+}
+
+TEST(InferenceCalculatorTest, SmokeTest_ReuseInterpreterWithModelSidePacket) {
+  std::string graph_proto = R"(
+    input_stream: "tensor_in"
+
+    node {
+      calculator: "ConstantSidePacketCalculator"
+      output_side_packet: "PACKET:model_path"
+      options: {
+        [mediapipe.ConstantSidePacketCalculatorOptions.ext]: {
+          packet { string_value: "mediapipe/calculators/tensor/testdata/add.bin" }
+        }
+      }
+    }
+
+    node {
+      calculator: "LocalFileContentsCalculator"
+      input_side_packet: "FILE_PATH:model_path"
+      output_side_packet: "CONTENTS:model_blob"
+    }
+
+    node {
+      calculator: "TfLiteModelCalculator"
+      input_side_packet: "MODEL_BLOB:model_blob"
+      output_side_packet: "MODEL:model"
+    }
+
+    node {
+      calculator: "InferenceCalculator"
+      input_stream: "TENSORS:tensor_in"
+      output_stream: "TENSORS:tensor_out"
+      input_side_packet: "MODEL:model"
+      options {
+        [mediapipe.InferenceCalculatorOptions.ext] {
+          delegate { xnnpack {} }
+          reuse_interpreter: true
+        }
+      }
+    }
+  )";
+  TfLiteInterpreterCache& cache = TfLiteInterpreterCache::GetInstance();
+  cache.Clear();
+  // Every run loads the model again, at a new address. The interpreter is
+  // still found by the model contents, so the cache does not grow.
+  for (int i = 0; i < 3; ++i) {
+    DoSmokeTest(graph_proto);
+    EXPECT_EQ(cache.NumIdleInterpreters(), 1);
+  }
+  cache.Clear();
+}
+
+TEST(InferenceCalculatorTest, InterpreterCacheBoundsIdleInterpreters) {
+  TfLiteInterpreterCache& cache = TfLiteInterpreterCache::GetInstance();
+  cache.Clear();
+  for (int i = 0; i < TfLiteInterpreterCache::kMaxIdleInterpretersPerKey + 2;
+       ++i) {
+    cache.Release("key", TfLiteInterpreterCache::Entry());
+  }
+  cache.Release("other_key", TfLiteInterpreterCache::Entry());
+  EXPECT_EQ(cache.NumIdleInterpreters(),
+            TfLiteInterpreterCache::kMaxIdleInterpretersPerKey + 1);
+  cache.Clear();
+}
+
 TEST(InferenceCalculatorTest, SmokeTest_ModelAsInputSidePacket) {
   std::string graph_proto = R"(
     input_stream: "tensor_in"
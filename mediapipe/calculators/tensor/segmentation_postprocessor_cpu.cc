@@ -0,0 +1,203 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/segmentation_postprocessor_cpu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "Eigen/Core"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Computes the source index and weight of every destination index as
+// cv::resize does for cv::INTER_LINEAR.
+void LinearTable(int src_size, int dst_size, std::vector<int>* index,
+                 std::vector<int>* step, std::vector<float>* weight) {
+  index->resize(dst_size);
+  step->resize(dst_size);
+  weight->resize(dst_size);
+  const float scale = static_cast<float>(src_size) / dst_size;
+  for (int i = 0; i < dst_size; ++i) {
+    const float src = (i + 0.5f) * scale - 0.5f;
+    int i0 = static_cast<int>(std::floor(src));
+    float w = src - i0;
+    if (i0 < 0) {
+      i0 = 0;
+      w = 0.0f;
+    }
+    if (i0 >= src_size - 1) {
+      i0 = src_size - 1;
+      w = 0.0f;
+    }
+    (*index)[i] = i0;
+    (*step)[i] = i0 < src_size - 1 ? 1 : 0;
+    (*weight)[i] = w;
+  }
+}
+
+// Blends previous into current where current is uncertain. Matches
+// SegmentationSmoothingCalculator on CPU.
+void BlendWithPrevious(const float* previous, float ratio, int size,
+                       float* mask) {
+  // Polynomial approximation of the uncertainty of a value p as a function of
+  // (p - 0.5)^2, see SegmentationSmoothingCalculator.
+  constexpr float c1 = 5.68842f;
+  constexpr float c2 = -0.748699f;
+  constexpr float c3 = -57.8051f;
+  constexpr float c4 = 291.309f;
+  constexpr float c5 = -624.717f;
+  Eigen::Map<Eigen::ArrayXf> current(mask, size);
+  const Eigen::Map<const Eigen::ArrayXf> prev(previous, size);
+  // Expressions rather than arrays, so the row is blended in a single pass
+  // without temporaries.
+  const auto t2 = (current - 0.5f).square();
+  const auto uncertainty =
+      (1.0f - t2 * (c1 + t2 * (c2 + t2 * (c3 + t2 * (c4 + t2 * c5)))))
+          .max(0.0f);
+  current += (prev - current) * (uncertainty * ratio);
+}
+
+}  // namespace
+
+void SegmentationPostprocessorCpu::UpdateTables(int tensor_width,
+                                                int tensor_height,
+                                                int mask_width,
+                                                int mask_height) {
+  if (tensor_width != tensor_width_ || mask_width != mask_width_) {
+    LinearTable(tensor_width, mask_width, &x0_, &dx_, &wx_);
+    activated_.resize(tensor_width);
+    rows_[0].resize(mask_width);
+    rows_[1].resize(mask_width);
+  }
+  if (tensor_height != tensor_height_ || mask_height != mask_height_) {
+    LinearTable(tensor_height, mask_height, &y0_, &dy_, &wy_);
+  }
+  tensor_width_ = tensor_width;
+  tensor_height_ = tensor_height;
+  mask_width_ = mask_width;
+  mask_height_ = mask_height;
+}
+
+void SegmentationPostprocessorCpu::FillRow(const float* tensor,
+                                           int tensor_width,
+                                           int tensor_channels, int y,
+                                           int slot) {
+  const float* in = tensor + y * tensor_width * tensor_channels;
+  const float* activated = in;
+  Eigen::Map<Eigen::ArrayXf> activation(activated_.data(), tensor_width);
+  // Channel 0, which is strided in a 2-channel tensor.
+  const Eigen::Map<const Eigen::ArrayXf, 0, Eigen::InnerStride<>> channel0(
+      in, tensor_width, Eigen::InnerStride<>(tensor_channels));
+  switch (options_.activation) {
+    case Activation::kNone:
+      if (tensor_channels > 1) {
+        activation = channel0;
+        activated = activated_.data();
+      }
+      break;
+    case Activation::kSigmoid:
+      activation = 1.0f / (1.0f + (-channel0).exp());
+      activated = activated_.data();
+      break;
+    case Activation::kSoftmax: {
+      // The softmax of two channels is the sigmoid of their difference.
+      const int c = options_.output_layer_index;
+      const Eigen::Map<const Eigen::Array2Xf> channels(in, 2, tensor_width);
+      activation = (channels.row(1 - c) - channels.row(c)).transpose();
+      activation = 1.0f / (1.0f + activation.exp());
+      activated = activated_.data();
+      break;
+    }
+  }
+
+  const int* __restrict x0 = x0_.data();
+  const int* __restrict dx = dx_.data();
+  const float* __restrict wx = wx_.data();
+  float* __restrict row = rows_[slot].data();
+  for (int x = 0; x < mask_width_; ++x) {
+    const float a = activated[x0[x]];
+    const float b = activated[x0[x] + dx[x]];
+    row[x] = a + (b - a) * wx[x];
+  }
+  row_y_[slot] = y;
+}
+
+absl::Status SegmentationPostprocessorCpu::Process(
+    const float* tensor, int tensor_width, int tensor_height,
+    int tensor_channels, const ImageFrame* previous_mask, ImageFrame* mask) {
+  RET_CHECK(tensor);
+  RET_CHECK(mask);
+  RET_CHECK_GT(tensor_width, 0);
+  RET_CHECK_GT(tensor_height, 0);
+  // Like the OpenCV implementation this replaces, kNone and kSigmoid read
+  // channel 0 of either tensor, kSoftmax requires two channels.
+  RET_CHECK(tensor_channels == 1 || tensor_channels == 2)
+      << "Unsupported number of tensor channels " << tensor_channels;
+  RET_CHECK(tensor_channels == 2 || options_.activation != Activation::kSoftmax)
+      << "Softmax activation requires 2 tensor channels";
+  RET_CHECK(options_.output_layer_index == 0 ||
+            options_.output_layer_index == 1 ||
+            options_.activation != Activation::kSoftmax);
+  RET_CHECK_EQ(mask->Format(), ImageFormat::VEC32F1);
+  const bool blend =
+      previous_mask != nullptr && options_.combine_with_previous_ratio > 0.0f;
+  if (blend) {
+    RET_CHECK_EQ(previous_mask->Format(), ImageFormat::VEC32F1);
+    RET_CHECK_EQ(previous_mask->Width(), mask->Width());
+    RET_CHECK_EQ(previous_mask->Height(), mask->Height());
+  }
+
+  UpdateTables(tensor_width, tensor_height, mask->Width(), mask->Height());
+  row_y_[0] = row_y_[1] = -1;
+  for (int y = 0; y < mask_height_; ++y) {
+    const int y0 = y0_[y];
+    const int y1 = y0 + dy_[y];
+    // Output rows advance monotonically over tensor rows, so the lower row
+    // of the previous output row is usually the upper row of this one.
+    if (row_y_[0] != y0) {
+      if (row_y_[1] == y0) {
+        std::swap(rows_[0], rows_[1]);
+        std::swap(row_y_[0], row_y_[1]);
+      } else {
+        FillRow(tensor, tensor_width, tensor_channels, y0, 0);
+      }
+    }
+    if (row_y_[1] != y1) {
+      FillRow(tensor, tensor_width, tensor_channels, y1, 1);
+    }
+
+    const Eigen::Map<const Eigen::ArrayXf> top(rows_[0].data(), mask_width_);
+    const Eigen::Map<const Eigen::ArrayXf> bottom(rows_[1].data(),
+                                                  mask_width_);
+    float* out = reinterpret_cast<float*>(mask->MutablePixelData() +
+                                          y * mask->WidthStep());
+    Eigen::Map<Eigen::ArrayXf>(out, mask_width_) =
+        top + (bottom - top) * wy_[y];
+    if (blend) {
+      const float* previous = reinterpret_cast<const float*>(
+          previous_mask->PixelData() + y * previous_mask->WidthStep());
+      BlendWithPrevious(previous, options_.combine_with_previous_ratio,
+                        mask_width_, out);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,97 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_SEGMENTATION_POSTPROCESSOR_CPU_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_SEGMENTATION_POSTPROCESSOR_CPU_H_
+
+#include <vector>
+
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+// Turns a segmentation tensor into a mask on CPU in a single pass over the
+// output. The activation is applied to each tensor row once, the activated row
+// is upsampled horizontally into a row cache, and every output row is then the
+// vertical interpolation of two cached rows, optionally blended with the
+// previous mask. Interpolation follows cv::resize with cv::INTER_LINEAR.
+//
+// Row buffers and interpolation tables are kept between calls, so an instance
+// should be reused across frames. Not thread-safe.
+class SegmentationPostprocessorCpu {
+ public:
+  enum class Activation {
+    kNone,     // Channel 0 of a 1- or 2-channel tensor.
+    kSigmoid,  // Channel 0 of a 1- or 2-channel tensor.
+    kSoftmax,  // 2-channel tensor.
+  };
+
+  struct Options {
+    Activation activation = Activation::kNone;
+
+    // Channel of a 2-channel tensor used as mask by kSoftmax.
+    int output_layer_index = 1;
+
+    // Amount of the previous mask to blend in where the current mask is
+    // uncertain, see SegmentationSmoothingCalculatorOptions. 0 disables
+    // blending.
+    float combine_with_previous_ratio = 0.0f;
+  };
+
+  explicit SegmentationPostprocessorCpu(const Options& options)
+      : options_(options) {}
+
+  // Writes the mask for the HWC float tensor into the VEC32F1 frame mask,
+  // resizing to the dimensions of mask. previous_mask is optional and, if
+  // set, must be a VEC32F1 frame with the dimensions of mask.
+  absl::Status Process(const float* tensor, int tensor_width,
+                       int tensor_height, int tensor_channels,
+                       const ImageFrame* previous_mask, ImageFrame* mask);
+
+ private:
+  // Fills rows_[slot] with tensor row y, activated and upsampled to the
+  // output width.
+  void FillRow(const float* tensor, int tensor_width, int tensor_channels,
+               int y, int slot);
+
+  void UpdateTables(int tensor_width, int tensor_height, int mask_width,
+                    int mask_height);
+
+  const Options options_;
+
+  int tensor_width_ = 0;
+  int tensor_height_ = 0;
+  int mask_width_ = 0;
+  int mask_height_ = 0;
+
+  // Horizontal interpolation: output column x blends x0 and x0 + dx.
+  std::vector<int> x0_;
+  std::vector<int> dx_;
+  std::vector<float> wx_;
+
+  // Vertical interpolation: output row y blends y0 and y0 + dy.
+  std::vector<int> y0_;
+  std::vector<int> dy_;
+  std::vector<float> wy_;
+
+  // Activated tensor row, and two upsampled rows with their tensor row.
+  std::vector<float> activated_;
+  std::vector<float> rows_[2];
+  int row_y_[2] = {-1, -1};
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_SEGMENTATION_POSTPROCESSOR_CPU_H_
@@ -0,0 +1,226 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/segmentation_postprocessor_cpu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using Activation = SegmentationPostprocessorCpu::Activation;
+
+std::vector<float> RandomTensor(int size, int seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-6.0f, 6.0f);
+  std::vector<float> tensor(size);
+  for (float& value : tensor) value = dist(rng);
+  return tensor;
+}
+
+float MaskAt(const ImageFrame& mask, int x, int y) {
+  return reinterpret_cast<const float*>(mask.PixelData() +
+                                        y * mask.WidthStep())[x];
+}
+
+// Unfused reference: activation into a tensor sized mask, bilinear resize as
+// cv::resize does, then blending as SegmentationSmoothingCalculator does.
+std::vector<float> Reference(const std::vector<float>& tensor, int width,
+                             int height, int channels, Activation activation,
+                             int output_layer_index,
+                             const std::vector<float>* previous, float ratio,
+                             int out_width, int out_height) {
+  std::vector<float> small(width * height);
+  for (int i = 0; i < width * height; ++i) {
+    switch (activation) {
+      case Activation::kNone:
+        small[i] = tensor[channels * i];
+        break;
+      case Activation::kSigmoid:
+        small[i] = 1.0f / (std::exp(-tensor[channels * i]) + 1.0f);
+        break;
+      case Activation::kSoftmax: {
+        const float p0 = tensor[2 * i];
+        const float p1 = tensor[2 * i + 1];
+        const float max_p = std::max(p0, p1);
+        const float denom = 1.0f + std::exp(std::min(p0, p1) - max_p);
+        small[i] = std::exp(tensor[2 * i + output_layer_index] - max_p) / denom;
+        break;
+      }
+    }
+  }
+  auto source = [](int i, int src_size, int dst_size, int* i0, int* i1,
+                   float* w) {
+    const float src =
+        (i + 0.5f) * static_cast<float>(src_size) / dst_size - 0.5f;
+    *i0 = std::min(std::max(static_cast<int>(std::floor(src)), 0),
+                   src_size - 1);
+    *i1 = std::min(*i0 + 1, src_size - 1);
+    *w = std::min(std::max(src - *i0, 0.0f), 1.0f);
+    if (src < 0 || src >= src_size - 1) *w = 0.0f;
+  };
+  std::vector<float> out(out_width * out_height);
+  for (int y = 0; y < out_height; ++y) {
+    int y0, y1;
+    float wy;
+    source(y, height, out_height, &y0, &y1, &wy);
+    for (int x = 0; x < out_width; ++x) {
+      int x0, x1;
+      float wx;
+      source(x, width, out_width, &x0, &x1, &wx);
+      const float top =
+          small[y0 * width + x0] * (1 - wx) + small[y0 * width + x1] * wx;
+      const float bottom =
+          small[y1 * width + x0] * (1 - wx) + small[y1 * width + x1] * wx;
+      float value = top * (1 - wy) + bottom * wy;
+      if (previous) {
+        const float t = value - 0.5f;
+        const float t2 = t * t;
+        const float uncertainty =
+            1.0f - std::min(1.0f, t2 * (5.68842f +
+                                        t2 * (-0.748699f +
+                                              t2 * (-57.8051f +
+                                                    t2 * (291.309f +
+                                                          t2 * -624.717f)))));
+        const float prev = (*previous)[y * out_width + x];
+        value = value + (prev - value) * (uncertainty * ratio);
+      }
+      out[y * out_width + x] = value;
+    }
+  }
+  return out;
+}
+
+void ExpectMatchesReference(Activation activation, int output_layer_index,
+                            int channels, int width, int height, int out_width,
+                            int out_height, float ratio) {
+  const std::vector<float> tensor =
+      RandomTensor(width * height * channels, /*seed=*/1);
+  SegmentationPostprocessorCpu::Options options;
+  options.activation = activation;
+  options.output_layer_index = output_layer_index;
+  options.combine_with_previous_ratio = ratio;
+  SegmentationPostprocessorCpu postprocessor(options);
+
+  std::vector<float> previous_values;
+  ImageFrame previous(ImageFormat::VEC32F1, out_width, out_height);
+  if (ratio > 0) {
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (int y = 0; y < out_height; ++y) {
+      float* row = reinterpret_cast<float*>(previous.MutablePixelData() +
+                                            y * previous.WidthStep());
+      for (int x = 0; x < out_width; ++x) {
+        row[x] = dist(rng);
+        previous_values.push_back(row[x]);
+      }
+    }
+  }
+
+  ImageFrame mask(ImageFormat::VEC32F1, out_width, out_height);
+  // Run twice to check that cached rows don't leak across frames.
+  for (int run = 0; run < 2; ++run) {
+    MP_ASSERT_OK(postprocessor.Process(tensor.data(), width, height, channels,
+                                       ratio > 0 ? &previous : nullptr,
+                                       &mask));
+  }
+  const std::vector<float> expected = Reference(
+      tensor, width, height, channels, activation, output_layer_index,
+      ratio > 0 ? &previous_values : nullptr, ratio, out_width, out_height);
+  for (int y = 0; y < out_height; ++y) {
+    for (int x = 0; x < out_width; ++x) {
+      ASSERT_NEAR(MaskAt(mask, x, y), expected[y * out_width + x], 1e-5)
+          << "at (" << x << ", " << y << ")";
+    }
+  }
+}
+
+TEST(SegmentationPostprocessorCpuTest, NoActivationSameSize) {
+  ExpectMatchesReference(Activation::kNone, 1, 1, 16, 12, 16, 12, 0.0f);
+}
+
+TEST(SegmentationPostprocessorCpuTest, SigmoidUpsample) {
+  ExpectMatchesReference(Activation::kSigmoid, 1, 1, 16, 12, 61, 37, 0.0f);
+}
+
+TEST(SegmentationPostprocessorCpuTest, SoftmaxUpsample) {
+  ExpectMatchesReference(Activation::kSoftmax, 1, 2, 16, 12, 64, 48, 0.0f);
+  ExpectMatchesReference(Activation::kSoftmax, 0, 2, 16, 12, 50, 13, 0.0f);
+}
+
+// Like the OpenCV implementation, kNone and kSigmoid read channel 0 of a
+// 2-channel tensor.
+TEST(SegmentationPostprocessorCpuTest, TwoChannelSigmoid) {
+  ExpectMatchesReference(Activation::kSigmoid, 1, 2, 16, 12, 61, 37, 0.0f);
+  ExpectMatchesReference(Activation::kNone, 1, 2, 16, 12, 16, 12, 0.0f);
+}
+
+TEST(SegmentationPostprocessorCpuTest, Downsample) {
+  ExpectMatchesReference(Activation::kSigmoid, 1, 1, 32, 24, 8, 6, 0.0f);
+}
+
+TEST(SegmentationPostprocessorCpuTest, BlendsWithPrevious) {
+  ExpectMatchesReference(Activation::kSoftmax, 1, 2, 16, 12, 40, 30, 0.9f);
+}
+
+TEST(SegmentationPostprocessorCpuTest, RejectsMismatchedInputs) {
+  SegmentationPostprocessorCpu::Options options;
+  options.activation = Activation::kSoftmax;
+  options.combine_with_previous_ratio = 0.5f;
+  SegmentationPostprocessorCpu postprocessor(options);
+  const std::vector<float> tensor(4 * 4 * 2);
+  ImageFrame mask(ImageFormat::VEC32F1, 8, 8);
+  EXPECT_FALSE(
+      postprocessor.Process(tensor.data(), 4, 4, 1, nullptr, &mask).ok());
+  EXPECT_FALSE(
+      postprocessor.Process(tensor.data(), 4, 2, 3, nullptr, &mask).ok());
+  ImageFrame previous(ImageFormat::VEC32F1, 4, 4);
+  EXPECT_FALSE(
+      postprocessor.Process(tensor.data(), 4, 4, 2, &previous, &mask).ok());
+  ImageFrame rgb_mask(ImageFormat::SRGB, 8, 8);
+  EXPECT_FALSE(
+      postprocessor.Process(tensor.data(), 4, 4, 2, nullptr, &rgb_mask).ok());
+  MP_EXPECT_OK(postprocessor.Process(tensor.data(), 4, 4, 2, nullptr, &mask));
+}
+
+// Selfie segmentation: a 256x256 softmax tensor upsampled to 720p and blended
+// with the previous mask.
+void BM_SegmentationPostprocessorCpu(benchmark::State& state) {
+  const std::vector<float> tensor = RandomTensor(256 * 256 * 2, /*seed=*/1);
+  SegmentationPostprocessorCpu::Options options;
+  options.activation = Activation::kSoftmax;
+  options.combine_with_previous_ratio = state.range(0) ? 0.9f : 0.0f;
+  SegmentationPostprocessorCpu postprocessor(options);
+  ImageFrame previous(ImageFormat::VEC32F1, 1280, 720);
+  previous.SetToZero();
+  ImageFrame mask(ImageFormat::VEC32F1, 1280, 720);
+  for (auto _ : state) {
+    MEDIAPIPE_CHECK_OK(postprocessor.Process(
+        tensor.data(), 256, 256, 2, state.range(0) ? &previous : nullptr,
+        &mask));
+  }
+}
+BENCHMARK(BM_SegmentationPostprocessorCpu)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,18 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/segmentation_postprocessor_cpu.h"
 #include "mediapipe/calculators/tensor/tensors_to_segmentation_calculator.pb.h"
 #include "mediapipe/framework/calculator_context.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image.h"
-#include "mediapipe/framework/formats/image_opencv.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
 #include "mediapipe/framework/formats/tensor.h"
 #include "mediapipe/framework/port.h"
-#include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/statusor.h"
 #include "mediapipe/gpu/gpu_origin.pb.h"
@@ -76,6 +81,11 @@ bool CanUseGpu() {
 constexpr char kTensorsTag[] = "TENSORS";
 constexpr char kOutputSizeTag[] = "OUTPUT_SIZE";
 constexpr char kMaskTag[] = "MASK";
+constexpr char kPreviousMaskTag[] = "MASK_PREVIOUS";
+
+// Number of unused CPU masks kept for reuse. Masks are usually held by the
+// consumers of the current frame and by a loopback providing MASK_PREVIOUS.
+constexpr int kMaskPoolKeepCount = 2;
 
 absl::StatusOr<std::tuple<int, int, int>> GetHwcFromDims(
     const std::vector<int>& dims) {
@@ -117,6 +127,9 @@ using ::tflite::gpu::gl::GlShader;
 //            The tensor dimensions are specified in this calculator's options.
 //   OUTPUT_SIZE(optional): std::pair<int, int>,
 //                          If provided, the size to upscale mask to.
+//   MASK_PREVIOUS(optional): Image, the previous output mask, to be blended
+//                            in per combine_with_previous_ratio. CPU only,
+//                            ignored if its size differs from the output.
 //
 // Output:
 //   MASK: An Image output mask, RGBA(GPU) / VEC32F1(CPU).
@@ -138,6 +151,9 @@ using ::tflite::gpu::gl::GlShader;
 //   }
 // }
 //
+// On CPU, activation, upsampling and blending with MASK_PREVIOUS are done in a
+// single pass into a pooled output frame, see SegmentationPostprocessorCpu.
+//
 // Currently only OpenGLES 3.1 and CPU backends supported.
 // TODO Refactor and add support for other backends/platforms.
 //
@@ -156,15 +172,19 @@ class TensorsToSegmentationCalculator : public CalculatorBase {
   absl::Status ProcessCpu(CalculatorContext* cc);
   void GlRender();
 
+  // Returns the output mask (width, height).
+  std::pair<int, int> GetOutputSize(CalculatorContext* cc, int tensor_width,
+                                    int tensor_height);
+
   bool DoesGpuTextureStartAtBottom() {
     return options_.gpu_origin() != mediapipe::GpuOrigin_Mode_TOP_LEFT;
   }
 
-  template <class T>
-  absl::Status ApplyActivation(cv::Mat& tensor_mat, cv::Mat* small_mask_mat);
-
   ::mediapipe::TensorsToSegmentationCalculatorOptions options_;
 
+  std::unique_ptr<SegmentationPostprocessorCpu> cpu_postprocessor_;
+  std::shared_ptr<ImageFramePool> mask_pool_;
+
 #if !MEDIAPIPE_DISABLE_GPU
   mediapipe::GlCalculatorHelper gpu_helper_;
   GLuint upsample_program_;
@@ -192,6 +212,9 @@ absl::Status TensorsToSegmentationCalculator::GetContract(
   if (cc->Inputs().HasTag(kOutputSizeTag)) {
     cc->Inputs().Tag(kOutputSizeTag).Set<std::pair<int, int>>();
   }
+  if (cc->Inputs().HasTag(kPreviousMaskTag)) {
+    cc->Inputs().Tag(kPreviousMaskTag).Set<Image>();
+  }
 
   // Outputs.
   cc->Outputs().Tag(kMaskTag).Set<Image>();
@@ -310,13 +333,8 @@ absl::Status TensorsToSegmentationCalculator::Close(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
-absl::Status TensorsToSegmentationCalculator::ProcessCpu(
-    CalculatorContext* cc) {
-  // Get input streams, and dimensions.
-  const auto& input_tensors =
-      cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
-  ASSIGN_OR_RETURN(auto hwc, GetHwcFromDims(input_tensors[0].shape().dims));
-  auto [tensor_height, tensor_width, tensor_channels] = hwc;
+std::pair<int, int> TensorsToSegmentationCalculator::GetOutputSize(
+    CalculatorContext* cc, int tensor_width, int tensor_height) {
   int output_width = tensor_width, output_height = tensor_height;
   if (cc->Inputs().HasTag(kOutputSizeTag)) {
     const auto& size =
@@ -324,91 +342,52 @@ absl::Status TensorsToSegmentationCalculator::ProcessCpu(
     output_width = size.first;
     output_height = size.second;
   }
-
-  // Create initial working mask.
-  cv::Mat small_mask_mat(cv::Size(tensor_width, tensor_height), CV_32FC1);
-
-  // Wrap input tensor.
-  auto raw_input_tensor = &input_tensors[0];
-  auto raw_input_view = raw_input_tensor->GetCpuReadView();
-  const float* raw_input_data = raw_input_view.buffer<float>();
-  cv::Mat tensor_mat(cv::Size(tensor_width, tensor_height),
-                     CV_MAKETYPE(CV_32F, tensor_channels),
-                     const_cast<float*>(raw_input_data));
-
-  // Process mask tensor and apply activation function.
-  if (tensor_channels == 2) {
-    MP_RETURN_IF_ERROR(ApplyActivation<cv::Vec2f>(tensor_mat, &small_mask_mat));
-  } else if (tensor_channels == 1) {
-    RET_CHECK(mediapipe::TensorsToSegmentationCalculatorOptions::SOFTMAX !=
-              options_.activation());  // Requires 2 channels.
-    if (mediapipe::TensorsToSegmentationCalculatorOptions::NONE ==
-        options_.activation())  // Pass-through optimization.
-      tensor_mat.copyTo(small_mask_mat);
-    else
-      MP_RETURN_IF_ERROR(ApplyActivation<float>(tensor_mat, &small_mask_mat));
-  } else {
-    RET_CHECK_FAIL() << "Unsupported number of tensor channels "
-                     << tensor_channels;
-  }
-
-  // Send out image as CPU packet.
-  std::shared_ptr<ImageFrame> mask_frame = std::make_shared<ImageFrame>(
-      ImageFormat::VEC32F1, output_width, output_height);
-  std::unique_ptr<Image> output_mask = absl::make_unique<Image>(mask_frame);
-  cv::Mat output_mat = formats::MatView(output_mask.get());
-  // Upsample small mask into output.
-  cv::resize(small_mask_mat, output_mat, cv::Size(output_width, output_height));
-  cc->Outputs().Tag(kMaskTag).Add(output_mask.release(), cc->InputTimestamp());
-
-  return absl::OkStatus();
+  const int factor = options_.output_downscale_factor();
+  return {std::max(1, (output_width + factor - 1) / factor),
+          std::max(1, (output_height + factor - 1) / factor)};
 }
 
-template <class T>
-absl::Status TensorsToSegmentationCalculator::ApplyActivation(
-    cv::Mat& tensor_mat, cv::Mat* small_mask_mat) {
-  // Configure activation function.
-  const int output_layer_index = options_.output_layer_index();
-  typedef mediapipe::TensorsToSegmentationCalculatorOptions Options;
-  const auto activation_fn = [&](const cv::Vec2f& mask_value) {
-    float new_mask_value = 0;
-    // TODO consider moving switch out of the loop,
-    // and also avoid float/Vec2f casting.
-    switch (options_.activation()) {
-      case Options::NONE: {
-        new_mask_value = mask_value[0];
-        break;
-      }
-      case Options::SIGMOID: {
-        const float pixel0 = mask_value[0];
-        new_mask_value = 1.0 / (std::exp(-pixel0) + 1.0);
-        break;
-      }
-      case Options::SOFTMAX: {
-        const float pixel0 = mask_value[0];
-        const float pixel1 = mask_value[1];
-        const float max_pixel = std::max(pixel0, pixel1);
-        const float min_pixel = std::min(pixel0, pixel1);
-        const float softmax_denom =
-            /*exp(max_pixel - max_pixel)=*/1.0f +
-            std::exp(min_pixel - max_pixel);
-        new_mask_value = std::exp(mask_value[output_layer_index] - max_pixel) /
-                         softmax_denom;
-        break;
-      }
-    }
-    return new_mask_value;
-  };
-
-  // Process mask tensor.
-  for (int i = 0; i < tensor_mat.rows; ++i) {
-    for (int j = 0; j < tensor_mat.cols; ++j) {
-      const T& input_pix = tensor_mat.at<T>(i, j);
-      const float mask_value = activation_fn(input_pix);
-      small_mask_mat->at<float>(i, j) = mask_value;
+absl::Status TensorsToSegmentationCalculator::ProcessCpu(
+    CalculatorContext* cc) {
+  // Get input streams, and dimensions.
+  const auto& input_tensors =
+      cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
+  ASSIGN_OR_RETURN(auto hwc, GetHwcFromDims(input_tensors[0].shape().dims));
+  auto [tensor_height, tensor_width, tensor_channels] = hwc;
+  auto [output_width, output_height] =
+      GetOutputSize(cc, tensor_width, tensor_height);
+
+  // Get output mask, which is overwritten entirely below.
+  if (!mask_pool_ || mask_pool_->width() != output_width ||
+      mask_pool_->height() != output_height) {
+    mask_pool_ = ImageFramePool::Create(output_width, output_height,
+                                        ImageFormat::VEC32F1,
+                                        kMaskPoolKeepCount);
+  }
+  ImageFrameSharedPtr mask_frame = mask_pool_->GetBuffer();
+
+  // Previous mask to blend with, skipped after changes of the output size.
+  const ImageFrame* previous_mask = nullptr;
+  if (cc->Inputs().HasTag(kPreviousMaskTag) &&
+      !cc->Inputs().Tag(kPreviousMaskTag).IsEmpty()) {
+    const auto& previous = cc->Inputs().Tag(kPreviousMaskTag).Get<Image>();
+    RET_CHECK(!previous.UsesGpu()) << "MASK_PREVIOUS must be a CPU image.";
+    const ImageFrame* frame = previous.GetImageFrameSharedPtr().get();
+    if (frame->Width() == output_width && frame->Height() == output_height) {
+      previous_mask = frame;
     }
   }
 
+  // Apply activation, upsample and blend into the output mask.
+  auto raw_input_view = input_tensors[0].GetCpuReadView();
+  MP_RETURN_IF_ERROR(cpu_postprocessor_->Process(
+      raw_input_view.buffer<float>(), tensor_width, tensor_height,
+      tensor_channels, previous_mask, mask_frame.get()));
+
+  // Send out image as CPU packet.
+  cc->Outputs().Tag(kMaskTag).Add(new Image(std::move(mask_frame)),
+                                  cc->InputTimestamp());
+
   return absl::OkStatus();
 }
 
@@ -424,13 +403,8 @@ absl::Status TensorsToSegmentationCalculator::ProcessGpu(
       cc->Inputs().Tag(kTensorsTag).Get<std::vector<Tensor>>();
   ASSIGN_OR_RETURN(auto hwc, GetHwcFromDims(input_tensors[0].shape().dims));
   auto [tensor_height, tensor_width, tensor_channels] = hwc;
-  int output_width = tensor_width, output_height = tensor_height;
-  if (cc->Inputs().HasTag(kOutputSizeTag)) {
-    const auto& size =
-        cc->Inputs().Tag(kOutputSizeTag).Get<std::pair<int, int>>();
-    output_width = size.first;
-    output_height = size.second;
-  }
+  auto [output_width, output_height] =
+      GetOutputSize(cc, tensor_width, tensor_height);
 
   // Create initial working mask texture.
 #if MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_31
@@ -605,6 +579,30 @@ absl::Status TensorsToSegmentationCalculator::LoadOptions(
     CalculatorContext* cc) {
   // Get calculator options specified in the graph.
   options_ = cc->Options<::mediapipe::TensorsToSegmentationCalculatorOptions>();
+  RET_CHECK_GE(options_.output_downscale_factor(), 1);
+  RET_CHECK_GE(options_.combine_with_previous_ratio(), 0.0f);
+  RET_CHECK_LE(options_.combine_with_previous_ratio(), 1.0f);
+
+  typedef mediapipe::TensorsToSegmentationCalculatorOptions Options;
+  SegmentationPostprocessorCpu::Options cpu_options;
+  switch (options_.activation()) {
+    case Options::NONE:
+      cpu_options.activation = SegmentationPostprocessorCpu::Activation::kNone;
+      break;
+    case Options::SIGMOID:
+      cpu_options.activation =
+          SegmentationPostprocessorCpu::Activation::kSigmoid;
+      break;
+    case Options::SOFTMAX:
+      cpu_options.activation =
+          SegmentationPostprocessorCpu::Activation::kSoftmax;
+      break;
+  }
+  cpu_options.output_layer_index = options_.output_layer_index();
+  cpu_options.combine_with_previous_ratio =
+      options_.combine_with_previous_ratio();
+  cpu_postprocessor_ =
+      absl::make_unique<SegmentationPostprocessorCpu>(cpu_options);
 
   return absl::OkStatus();
 }
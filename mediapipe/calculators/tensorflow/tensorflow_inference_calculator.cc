@@ -128,6 +128,9 @@ class InferenceState {
 // and the output tensors sent out on the output streams with timestamps
 // corresponding to the input stream packets. Setting the batch_size to 1
 // completely disables batching, but is indepdent of add_batch_dim_to_tensors.
+// With batch_ready_timestamps, the calculator doesn't wait for batch_size
+// inputs: it receives all the ready input timestamps, up to batch_size, in one
+// call to Process and runs them right away as one batch, without padding.
 //
 // The TensorFlowInferenceCalculator also support feeding states recurrently for
 // RNNs and LSTMs. Simply set the recurrent_tag_pair options to define the
@@ -255,6 +258,9 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
       // with channels set to 0.
       cc->Outputs().Tag(tag).Set<tf::Tensor>();
     }
+    if (options.batch_ready_timestamps()) {
+      cc->SetMaxBatchSize(options.batch_size());
+    }
     // A mediapipe::TensorFlowSession with a model loaded and ready for use.
     // For this calculator it must include a tag_to_tensor_map.
     cc->InputSidePackets().Tag(kSessionTag).Set<TensorFlowSession>();
@@ -333,7 +339,14 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
       inference_state_ = std::unique_ptr<InferenceState>();
     }
 
-    if (options_.batch_size() == 1 || options_.batched_input()) {
+    RET_CHECK(!options_.batch_ready_timestamps() ||
+              (!options_.batched_input() &&
+               options_.recurrent_tag_pair().empty()))
+        << "batch_ready_timestamps cannot be combined with batched_input or "
+           "recurrent_tag_pair.";
+
+    if (options_.batch_size() == 1 || options_.batched_input() ||
+        options_.batch_ready_timestamps()) {
       cc->SetOffset(0);
     }
 
@@ -394,36 +407,48 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
       }
       std::map<Timestamp, std::map<std::string, tf::Tensor>>
           input_tensors_by_tag_by_timestamp;
-      for (const std::string& tag_as_node_name : cc->Inputs().GetTags()) {
-        if (cc->Inputs().Tag(tag_as_node_name).IsEmpty()) {
-          // Recurrent tensors can be empty.
-          if (!mediapipe::ContainsKey(recurrent_feed_tags_, tag_as_node_name)) {
-            if (options_.skip_on_missing_features()) {
-              return absl::OkStatus();
-            } else {
+      // Without batch_ready_timestamps, BatchSize() is 1.
+      for (int i = 0; i < cc->BatchSize(); ++i) {
+        const Timestamp input_timestamp = cc->BatchInputTimestamp(i);
+        for (const std::string& tag_as_node_name : cc->Inputs().GetTags()) {
+          const Packet& input_packet =
+              cc->Inputs().Tag(tag_as_node_name).BatchValue(i);
+          if (input_packet.IsEmpty()) {
+            // Recurrent tensors can be empty.
+            if (!mediapipe::ContainsKey(recurrent_feed_tags_,
+                                        tag_as_node_name)) {
+              if (!options_.skip_on_missing_features()) {
+                return absl::InvalidArgumentError(
+                    absl::StrCat("Tag ", tag_as_node_name,
+                                 " not present at timestamp: ",
+                                 input_timestamp.Value()));
+              }
+              if (cc->BatchSize() == 1) {
+                return absl::OkStatus();
+              }
+              // Skips this timestamp only, the rest of the batch is run.
+              input_tensors_by_tag_by_timestamp.erase(input_timestamp);
+              break;
+            }
+          } else if (options_.batched_input()) {
+            const auto& tensor_packets =
+                input_packet.Get<std::vector<Packet>>();
+            if (tensor_packets.size() > options_.batch_size()) {
               return absl::InvalidArgumentError(absl::StrCat(
-                  "Tag ", tag_as_node_name,
-                  " not present at timestamp: ", cc->InputTimestamp().Value()));
+                  "Batch for tag ", tag_as_node_name,
+                  " has more packets than batch capacity. batch_size: ",
+                  options_.batch_size(), " packets: ", tensor_packets.size()));
             }
-          }
-        } else if (options_.batched_input()) {
-          const auto& tensor_packets =
-              cc->Inputs().Tag(tag_as_node_name).Get<std::vector<Packet>>();
-          if (tensor_packets.size() > options_.batch_size()) {
-            return absl::InvalidArgumentError(absl::StrCat(
-                "Batch for tag ", tag_as_node_name,
-                " has more packets than batch capacity. batch_size: ",
-                options_.batch_size(), " packets: ", tensor_packets.size()));
-          }
-          for (const auto& packet : tensor_packets) {
+            for (const auto& packet : tensor_packets) {
+              RET_CHECK_OK(AggregateTensorPacket(
+                  tag_as_node_name, packet, &input_tensors_by_tag_by_timestamp,
+                  inference_state_.get()));
+            }
+          } else {
             RET_CHECK_OK(AggregateTensorPacket(
-                tag_as_node_name, packet, &input_tensors_by_tag_by_timestamp,
-                inference_state_.get()));
+                tag_as_node_name, input_packet,
+                &input_tensors_by_tag_by_timestamp, inference_state_.get()));
           }
-        } else {
-          RET_CHECK_OK(AggregateTensorPacket(
-              tag_as_node_name, cc->Inputs().Tag(tag_as_node_name).Value(),
-              &input_tensors_by_tag_by_timestamp, inference_state_.get()));
         }
       }
       for (const auto& timestamp_and_input_tensors_by_tag :
@@ -437,7 +462,9 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
         }
       }
       if (inference_state_->batch_timestamps_.size() == options_.batch_size() ||
-          options_.batched_input()) {
+          options_.batched_input() ||
+          (options_.batch_ready_timestamps() &&
+           !inference_state_->batch_timestamps_.empty())) {
         inference_state_to_process = std::move(inference_state_);
         inference_state_ = std::unique_ptr<InferenceState>();
       }
@@ -479,10 +506,15 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
   absl::Status OutputBatch(CalculatorContext* cc,
                            std::unique_ptr<InferenceState> inference_state) {
     const int64 start_time = absl::ToUnixMicros(clock_->TimeNow());
+    // Batches of ready timestamps are run without padding.
+    const int batch_size =
+        options_.batch_ready_timestamps()
+            ? static_cast<int>(inference_state->batch_timestamps_.size())
+            : options_.batch_size();
     std::vector<std::pair<mediapipe::ProtoString, tf::Tensor>> input_tensors;
 
     for (auto& keyed_tensors : inference_state->input_tensor_batches_) {
-      if (options_.batch_size() == 1) {
+      if (batch_size == 1) {
         // Short circuit to avoid the cost of deep copying tensors in concat.
         if (!keyed_tensors.second.empty()) {
           input_tensors.emplace_back(tag_to_tensor_map_[keyed_tensors.first],
@@ -496,7 +528,7 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
         }
       } else {
         // Pad by replicating the first tensor, then ignore the values.
-        keyed_tensors.second.resize(options_.batch_size());
+        keyed_tensors.second.resize(batch_size);
         std::fill(keyed_tensors.second.begin() +
                       inference_state->batch_timestamps_.size(),
                   keyed_tensors.second.end(), keyed_tensors.second[0]);
@@ -566,9 +598,9 @@ class TensorFlowInferenceCalculator : public CalculatorBase {
 
     absl::WriterMutexLock l(&mutex_);
     // Set that we want to split on each index of the 0th dimension.
-    std::vector<tf::int64> split_vector(options_.batch_size(), 1);
+    std::vector<tf::int64> split_vector(batch_size, 1);
     for (int i = 0; i < output_tensor_names.size(); ++i) {
-      if (options_.batch_size() == 1) {
+      if (batch_size == 1) {
         if (cc->Outputs().HasTag(output_name_in_signature[i])) {
           tf::Tensor output_tensor(outputs[i]);
           RET_CHECK_OK(RemoveBatchDimension(&output_tensor));
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <memory>
+#include <utility>
 
 #include "absl/strings/str_cat.h"
 #include "mediapipe/calculators/util/annotation_overlay_calculator.pb.h"
@@ -132,17 +133,20 @@ class AnnotationOverlayCalculator : public CalculatorBase {
   absl::Status Close(CalculatorContext* cc) override;
 
  private:
-  absl::Status CreateRenderTargetCpu(CalculatorContext* cc,
-                                     std::unique_ptr<cv::Mat>& image_mat,
-                                     ImageFormat::Format* target_format);
+  absl::Status CreateRenderTargetCpu(
+      CalculatorContext* cc, std::unique_ptr<cv::Mat>& image_mat,
+      std::unique_ptr<ImageFrame>& output_frame);
   template <typename Type, const char* Tag>
   absl::Status CreateRenderTargetGpu(CalculatorContext* cc,
                                      std::unique_ptr<cv::Mat>& image_mat);
   template <typename Type, const char* Tag>
   absl::Status RenderToGpu(CalculatorContext* cc, uchar* overlay_image);
   absl::Status RenderToCpu(CalculatorContext* cc,
-                           const ImageFormat::Format& target_format,
-                           uchar* data_image);
+                           std::unique_ptr<ImageFrame> output_frame);
+
+  // Returns true if any render data input at the current timestamp has
+  // annotations to draw.
+  bool HasAnnotations(CalculatorContext* cc) const;
 
   absl::Status GlRender(CalculatorContext* cc);
   template <typename Type, const char* Tag>
@@ -252,6 +256,8 @@ absl::Status AnnotationOverlayCalculator::Open(CalculatorContext* cc) {
   renderer_ = absl::make_unique<AnnotationRenderer>();
   renderer_->SetFlipTextVertically(options_.flip_text_vertically());
   if (use_gpu_) renderer_->SetScaleFactor(options_.gpu_scale_factor());
+  renderer_->SetNumThreads(options_.num_render_threads(),
+                           options_.render_tile_size());
 
   // Set the output header based on the input header (if present).
   const char* tag = use_gpu_ ? kGpuBufferTag : kImageFrameTag;
@@ -281,9 +287,20 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
     return absl::OkStatus();
   }
 
+  // Without annotations the input frame is forwarded as is, unless its
+  // format is changed by rendering.
+  if (!use_gpu_ && image_frame_available_ && !HasAnnotations(cc) &&
+      cc->Outputs().HasTag(kImageFrameTag)) {
+    const Packet& input = cc->Inputs().Tag(kImageFrameTag).Value();
+    if (input.Get<ImageFrame>().Format() != ImageFormat::GRAY8) {
+      cc->Outputs().Tag(kImageFrameTag).AddPacket(input);
+      return absl::OkStatus();
+    }
+  }
+
   // Initialize render target, drawn with OpenCV.
   std::unique_ptr<cv::Mat> image_mat;
-  ImageFormat::Format target_format;
+  std::unique_ptr<ImageFrame> output_frame;
   if (use_gpu_) {
 #if !MEDIAPIPE_DISABLE_GPU
     if (!gpu_initialized_) {
@@ -301,14 +318,15 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
 #endif  // !MEDIAPIPE_DISABLE_GPU
   } else {
     if (cc->Outputs().HasTag(kImageFrameTag)) {
-      MP_RETURN_IF_ERROR(CreateRenderTargetCpu(cc, image_mat, &target_format));
+      MP_RETURN_IF_ERROR(CreateRenderTargetCpu(cc, image_mat, output_frame));
     }
   }
 
   // Reset the renderer with the image_mat. No copy here.
   renderer_->AdoptImage(image_mat.get());
 
-  // Render streams onto render target.
+  // Collect the annotations of all streams, then render them onto the render
+  // target at once.
   for (CollectionItemId id = cc->Inputs().BeginId(); id < cc->Inputs().EndId();
        ++id) {
     auto tag_and_index = cc->Inputs().TagAndIndexFromId(id);
@@ -322,16 +340,17 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
     if (tag.empty()) {
       // Empty tag defaults to accepting a single object of RenderData type.
       const RenderData& render_data = cc->Inputs().Get(id).Get<RenderData>();
-      renderer_->RenderDataOnImage(render_data);
+      renderer_->AddRenderData(render_data);
     } else {
       RET_CHECK_EQ(kVectorTag, tag);
       const std::vector<RenderData>& render_data_vec =
           cc->Inputs().Get(id).Get<std::vector<RenderData>>();
       for (const RenderData& render_data : render_data_vec) {
-        renderer_->RenderDataOnImage(render_data);
+        renderer_->AddRenderData(render_data);
       }
     }
   }
+  renderer_->Render();
 
   if (use_gpu_) {
 #if !MEDIAPIPE_DISABLE_GPU
@@ -344,9 +363,8 @@ absl::Status AnnotationOverlayCalculator::Process(CalculatorContext* cc) {
         }));
 #endif  // !MEDIAPIPE_DISABLE_GPU
   } else {
-    // Copy the rendered image to output.
-    uchar* image_mat_ptr = image_mat->data;
-    MP_RETURN_IF_ERROR(RenderToCpu(cc, target_format, image_mat_ptr));
+    // The render target is a view of the output frame.
+    MP_RETURN_IF_ERROR(RenderToCpu(cc, std::move(output_frame)));
   }
 
   return absl::OkStatus();
@@ -366,21 +384,7 @@ absl::Status AnnotationOverlayCalculator::Close(CalculatorContext* cc) {
 }
 
 absl::Status AnnotationOverlayCalculator::RenderToCpu(
-    CalculatorContext* cc, const ImageFormat::Format& target_format,
-    uchar* data_image) {
-  auto output_frame = absl::make_unique<ImageFrame>(
-      target_format, renderer_->GetImageWidth(), renderer_->GetImageHeight());
-
-#if !MEDIAPIPE_DISABLE_GPU
-  output_frame->CopyPixelData(target_format, renderer_->GetImageWidth(),
-                              renderer_->GetImageHeight(), data_image,
-                              ImageFrame::kGlDefaultAlignmentBoundary);
-#else
-  output_frame->CopyPixelData(target_format, renderer_->GetImageWidth(),
-                              renderer_->GetImageHeight(), data_image,
-                              ImageFrame::kDefaultAlignmentBoundary);
-#endif  // !MEDIAPIPE_DISABLE_GPU
-
+    CalculatorContext* cc, std::unique_ptr<ImageFrame> output_frame) {
   if (cc->Outputs().HasTag(kImageFrameTag)) {
     cc->Outputs()
         .Tag(kImageFrameTag)
@@ -390,6 +394,29 @@ absl::Status AnnotationOverlayCalculator::RenderToCpu(
   return absl::OkStatus();
 }
 
+bool AnnotationOverlayCalculator::HasAnnotations(
+    CalculatorContext* cc) const {
+  for (CollectionItemId id = cc->Inputs().BeginId(); id < cc->Inputs().EndId();
+       ++id) {
+    const std::string& tag = cc->Inputs().TagAndIndexFromId(id).first;
+    if ((!tag.empty() && tag != kVectorTag) || cc->Inputs().Get(id).IsEmpty()) {
+      continue;
+    }
+    if (tag.empty()) {
+      if (cc->Inputs().Get(id).Get<RenderData>().render_annotations_size() >
+          0) {
+        return true;
+      }
+    } else {
+      for (const RenderData& render_data :
+           cc->Inputs().Get(id).Get<std::vector<RenderData>>()) {
+        if (render_data.render_annotations_size() > 0) return true;
+      }
+    }
+  }
+  return false;
+}
+
 template <typename Type, const char* Tag>
 absl::Status AnnotationOverlayCalculator::RenderToGpu(CalculatorContext* cc,
                                                       uchar* overlay_image) {
@@ -441,47 +468,62 @@ absl::Status AnnotationOverlayCalculator::RenderToGpu(CalculatorContext* cc,
 
 absl::Status AnnotationOverlayCalculator::CreateRenderTargetCpu(
     CalculatorContext* cc, std::unique_ptr<cv::Mat>& image_mat,
-    ImageFormat::Format* target_format) {
+    std::unique_ptr<ImageFrame>& output_frame) {
+#if !MEDIAPIPE_DISABLE_GPU
+  constexpr uint32 kAlignmentBoundary = ImageFrame::kGlDefaultAlignmentBoundary;
+#else
+  constexpr uint32 kAlignmentBoundary = ImageFrame::kDefaultAlignmentBoundary;
+#endif  // !MEDIAPIPE_DISABLE_GPU
+
   if (image_frame_available_) {
     const auto& input_frame =
         cc->Inputs().Tag(kImageFrameTag).Get<ImageFrame>();
 
-    int target_mat_type;
+    ImageFormat::Format target_format;
     switch (input_frame.Format()) {
       case ImageFormat::SRGBA:
-        *target_format = ImageFormat::SRGBA;
-        target_mat_type = CV_8UC4;
-        break;
-      case ImageFormat::SRGB:
-        *target_format = ImageFormat::SRGB;
-        target_mat_type = CV_8UC3;
+      case ImageFormat::SRGB: {
+        // Draw directly onto the input frame if nothing else holds it.
+        auto consumed =
+            cc->Inputs().Tag(kImageFrameTag).Value().Consume<ImageFrame>();
+        if (consumed.ok()) {
+          output_frame = std::move(consumed).value();
+          image_mat =
+              absl::make_unique<cv::Mat>(formats::MatView(output_frame.get()));
+          return absl::OkStatus();
+        }
+        target_format = input_frame.Format();
         break;
+      }
       case ImageFormat::GRAY8:
-        *target_format = ImageFormat::SRGB;
-        target_mat_type = CV_8UC3;
+        target_format = ImageFormat::SRGB;
         break;
       default:
         return absl::UnknownError("Unexpected image frame format.");
         break;
     }
 
-    image_mat = absl::make_unique<cv::Mat>(
-        input_frame.Height(), input_frame.Width(), target_mat_type);
+    output_frame = absl::make_unique<ImageFrame>(
+        target_format, input_frame.Width(), input_frame.Height(),
+        kAlignmentBoundary);
+    image_mat =
+        absl::make_unique<cv::Mat>(formats::MatView(output_frame.get()));
 
     auto input_mat = formats::MatView(&input_frame);
     if (input_frame.Format() == ImageFormat::GRAY8) {
-      cv::Mat rgb_mat;
-      cv::cvtColor(input_mat, rgb_mat, CV_GRAY2RGB);
-      rgb_mat.copyTo(*image_mat);
+      cv::cvtColor(input_mat, *image_mat, CV_GRAY2RGB);
     } else {
       input_mat.copyTo(*image_mat);
     }
   } else {
-    image_mat = absl::make_unique<cv::Mat>(
-        options_.canvas_height_px(), options_.canvas_width_px(), CV_8UC3,
-        cv::Scalar(options_.canvas_color().r(), options_.canvas_color().g(),
-                   options_.canvas_color().b()));
-    *target_format = ImageFormat::SRGB;
+    output_frame = absl::make_unique<ImageFrame>(
+        ImageFormat::SRGB, options_.canvas_width_px(),
+        options_.canvas_height_px(), kAlignmentBoundary);
+    image_mat =
+        absl::make_unique<cv::Mat>(formats::MatView(output_frame.get()));
+    image_mat->setTo(cv::Scalar(options_.canvas_color().r(),
+                                options_.canvas_color().g(),
+                                options_.canvas_color().b()));
   }
 
   return absl::OkStatus();
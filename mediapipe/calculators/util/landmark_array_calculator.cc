@@ -0,0 +1,97 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/api2/node.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace api2 {
+
+// Converts a landmark list proto to the corresponding landmark array, so that
+// the following array-aware calculators work on flat coordinate arrays.
+//
+// Input:
+//   LandmarkListT proto.
+// Output:
+//   BasicLandmarkArray<LandmarkListT> with the same landmarks.
+template <typename LandmarkListT>
+class LandmarkListToArrayCalculatorImpl : public Node {
+ public:
+  static constexpr Input<LandmarkListT> kIn{""};
+  static constexpr Output<BasicLandmarkArray<LandmarkListT>> kOut{""};
+
+  MEDIAPIPE_NODE_CONTRACT(kIn, kOut);
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kIn(cc).IsEmpty()) return absl::OkStatus();
+    kOut(cc).Send(BasicLandmarkArray<LandmarkListT>(*kIn(cc)));
+    return absl::OkStatus();
+  }
+};
+
+// Converts a landmark array back to the corresponding landmark list proto.
+// Fields that were unset in the original proto stay unset.
+//
+// Input:
+//   BasicLandmarkArray<LandmarkListT>.
+// Output:
+//   LandmarkListT proto with the same landmarks.
+template <typename LandmarkListT>
+class LandmarkArrayToListCalculatorImpl : public Node {
+ public:
+  static constexpr Input<BasicLandmarkArray<LandmarkListT>> kIn{""};
+  static constexpr Output<LandmarkListT> kOut{""};
+
+  MEDIAPIPE_NODE_CONTRACT(kIn, kOut);
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (kIn(cc).IsEmpty()) return absl::OkStatus();
+    kOut(cc).Send(kIn(cc).Get().ToProto());
+    return absl::OkStatus();
+  }
+};
+
+// Example config:
+// node {
+//   calculator: "NormalizedLandmarkListToArrayCalculator"
+//   input_stream: "landmarks"
+//   output_stream: "landmark_array"
+// }
+typedef LandmarkListToArrayCalculatorImpl<NormalizedLandmarkList>
+    NormalizedLandmarkListToArrayCalculator;
+MEDIAPIPE_REGISTER_NODE(NormalizedLandmarkListToArrayCalculator);
+
+// Example config:
+// node {
+//   calculator: "NormalizedLandmarkArrayToListCalculator"
+//   input_stream: "landmark_array"
+//   output_stream: "landmarks"
+// }
+typedef LandmarkArrayToListCalculatorImpl<NormalizedLandmarkList>
+    NormalizedLandmarkArrayToListCalculator;
+MEDIAPIPE_REGISTER_NODE(NormalizedLandmarkArrayToListCalculator);
+
+typedef LandmarkListToArrayCalculatorImpl<LandmarkList>
+    LandmarkListToArrayCalculator;
+MEDIAPIPE_REGISTER_NODE(LandmarkListToArrayCalculator);
+
+typedef LandmarkArrayToListCalculatorImpl<LandmarkList>
+    LandmarkArrayToListCalculator;
+MEDIAPIPE_REGISTER_NODE(LandmarkArrayToListCalculator);
+
+}  // namespace api2
+}  // namespace mediapipe
@@ -0,0 +1,148 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/deps/message_matchers.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/sink.h"
+
+namespace mediapipe {
+namespace {
+
+// Letterbox removal and projection on landmark lists.
+constexpr char kListGraph[] = R"pb(
+  input_stream: "landmarks"
+  input_stream: "letterbox_padding"
+  input_stream: "rect"
+  node {
+    calculator: "LandmarkLetterboxRemovalCalculator"
+    input_stream: "LANDMARKS:landmarks"
+    input_stream: "LETTERBOX_PADDING:letterbox_padding"
+    output_stream: "LANDMARKS:adjusted_landmarks"
+  }
+  node {
+    calculator: "LandmarkProjectionCalculator"
+    input_stream: "NORM_LANDMARKS:adjusted_landmarks"
+    input_stream: "NORM_RECT:rect"
+    output_stream: "NORM_LANDMARKS:output_landmarks"
+  }
+)pb";
+
+// The same on landmark arrays, converted from and back to lists.
+constexpr char kArrayGraph[] = R"pb(
+  input_stream: "landmarks"
+  input_stream: "letterbox_padding"
+  input_stream: "rect"
+  node {
+    calculator: "NormalizedLandmarkListToArrayCalculator"
+    input_stream: "landmarks"
+    output_stream: "landmark_array"
+  }
+  node {
+    calculator: "LandmarkLetterboxRemovalCalculator"
+    input_stream: "LANDMARK_ARRAY:landmark_array"
+    input_stream: "LETTERBOX_PADDING:letterbox_padding"
+    output_stream: "LANDMARK_ARRAY:adjusted_landmark_array"
+  }
+  node {
+    calculator: "LandmarkProjectionCalculator"
+    input_stream: "NORM_LANDMARK_ARRAY:adjusted_landmark_array"
+    input_stream: "NORM_RECT:rect"
+    output_stream: "NORM_LANDMARK_ARRAY:output_landmark_array"
+  }
+  node {
+    calculator: "NormalizedLandmarkArrayToListCalculator"
+    input_stream: "output_landmark_array"
+    output_stream: "output_landmarks"
+  }
+)pb";
+
+// Runs input through the specified graph and returns the output landmarks.
+NormalizedLandmarkList RunLandmarkGraph(const std::string& graph_text,
+                                        const NormalizedLandmarkList& input) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(graph_text);
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("output_landmarks", &config, &output_packets);
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  MP_EXPECT_OK(graph.StartRun({}));
+  MP_EXPECT_OK(graph.AddPacketToInputStream(
+      "landmarks", MakePacket<NormalizedLandmarkList>(input).At(Timestamp(0))));
+  MP_EXPECT_OK(graph.AddPacketToInputStream(
+      "letterbox_padding", MakePacket<std::array<float, 4>>(
+                               std::array<float, 4>{0.1f, 0.2f, 0.3f, 0.f})
+                               .At(Timestamp(0))));
+  MP_EXPECT_OK(graph.AddPacketToInputStream(
+      "rect", MakePacket<NormalizedRect>(
+                  ParseTextProtoOrDie<NormalizedRect>(R"pb(
+                    x_center: 0.4 y_center: 0.6 width: 0.5 height: 0.8
+                    rotation: 0.5
+                  )pb"))
+                  .At(Timestamp(0))));
+  MP_EXPECT_OK(graph.CloseAllInputStreams());
+  MP_EXPECT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(output_packets.size(), 1);
+  if (output_packets.empty()) return NormalizedLandmarkList();
+  return output_packets[0].Get<NormalizedLandmarkList>();
+}
+
+TEST(LandmarkArrayCalculatorTest, ArrayChainMatchesListChain) {
+  const NormalizedLandmarkList landmarks =
+      ParseTextProtoOrDie<NormalizedLandmarkList>(R"pb(
+        landmark { x: 0.1 y: 0.2 z: -0.5 visibility: 0.9 }
+        landmark { x: 0.7 y: 0.4 z: 0.25 presence: 0.5 }
+      )pb");
+
+  const NormalizedLandmarkList expected =
+      RunLandmarkGraph(kListGraph, landmarks);
+  const NormalizedLandmarkList actual =
+      RunLandmarkGraph(kArrayGraph, landmarks);
+  ASSERT_EQ(actual.landmark_size(), 2);
+  EXPECT_THAT(actual, EqualsProto(expected));
+}
+
+TEST(LandmarkArrayCalculatorTest, RejectsListsOnArrayStreams) {
+  CalculatorGraphConfig config = ParseTextProtoOrDie<CalculatorGraphConfig>(
+      R"pb(
+        input_stream: "landmarks"
+        input_stream: "rect"
+        node {
+          calculator: "NormalizedLandmarkArrayToListCalculator"
+          input_stream: "landmarks"
+          output_stream: "landmark_list"
+        }
+        node {
+          calculator: "LandmarkProjectionCalculator"
+          input_stream: "NORM_LANDMARK_ARRAY:landmark_list"
+          input_stream: "NORM_RECT:rect"
+          output_stream: "NORM_LANDMARK_ARRAY:projected_landmarks"
+        }
+      )pb");
+  CalculatorGraph graph;
+  EXPECT_FALSE(graph.Initialize(config).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -13,10 +13,12 @@
 // limitations under the License.
 
 #include <cmath>
+#include <string>
 #include <vector>
 
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
@@ -24,6 +26,7 @@ namespace mediapipe {
 namespace {
 
 constexpr char kLandmarksTag[] = "LANDMARKS";
+constexpr char kLandmarkArrayTag[] = "LANDMARK_ARRAY";
 constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 
 }  // namespace
@@ -38,6 +41,9 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 //   LANDMARKS: A NormalizedLandmarkList representing landmarks on an
 //   letterboxed image.
 //
+//   LANDMARK_ARRAY: The same landmarks as a NormalizedLandmarkArray, used
+//   instead of LANDMARKS.
+//
 //   LETTERBOX_PADDING: An std::array<float, 4> representing the letterbox
 //   padding from the 4 sides ([left, top, right, bottom]) of the letterboxed
 //   image, normalized to [0.f, 1.f] by the letterboxed image dimensions.
@@ -46,6 +52,9 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 //   LANDMARKS: An NormalizedLandmarkList proto representing landmarks with
 //   their locations adjusted to the letterbox-removed (non-padded) image.
 //
+//   LANDMARK_ARRAY: The same as a NormalizedLandmarkArray, when the input
+//   landmarks are given as LANDMARK_ARRAY.
+//
 // Usage example:
 // node {
 //   calculator: "LandmarkLetterboxRemovalCalculator"
@@ -65,34 +74,45 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
-    RET_CHECK(cc->Inputs().HasTag(kLandmarksTag) &&
+    RET_CHECK((cc->Inputs().HasTag(kLandmarksTag) ^
+               cc->Inputs().HasTag(kLandmarkArrayTag)) &&
               cc->Inputs().HasTag(kLetterboxPaddingTag))
         << "Missing one or more input streams.";
+    const std::string tag = LandmarksTag(*cc);
 
-    RET_CHECK_EQ(cc->Inputs().NumEntries(kLandmarksTag),
-                 cc->Outputs().NumEntries(kLandmarksTag))
+    RET_CHECK_EQ(cc->Inputs().NumEntries(tag), cc->Outputs().NumEntries(tag))
         << "Same number of input and output landmarks is required.";
 
-    for (CollectionItemId id = cc->Inputs().BeginId(kLandmarksTag);
-         id != cc->Inputs().EndId(kLandmarksTag); ++id) {
-      cc->Inputs().Get(id).Set<NormalizedLandmarkList>();
+    for (CollectionItemId in_id = cc->Inputs().BeginId(tag),
+                          out_id = cc->Outputs().BeginId(tag);
+         in_id != cc->Inputs().EndId(tag); ++in_id, ++out_id) {
+      if (tag == kLandmarkArrayTag) {
+        cc->Inputs().Get(in_id).Set<NormalizedLandmarkArray>();
+        cc->Outputs().Get(out_id).Set<NormalizedLandmarkArray>();
+      } else {
+        cc->Inputs().Get(in_id).Set<NormalizedLandmarkList>();
+        cc->Outputs().Get(out_id).Set<NormalizedLandmarkList>();
+      }
     }
     cc->Inputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
 
-    for (CollectionItemId id = cc->Outputs().BeginId(kLandmarksTag);
-         id != cc->Outputs().EndId(kLandmarksTag); ++id) {
-      cc->Outputs().Get(id).Set<NormalizedLandmarkList>();
-    }
-
     return absl::OkStatus();
   }
 
   absl::Status Open(CalculatorContext* cc) override {
     cc->SetOffset(TimestampDiff(0));
+    landmarks_tag_ = LandmarksTag(*cc);
 
     return absl::OkStatus();
   }
 
+  // Returns the tag of the landmark streams, which determines their type.
+  template <typename CC>
+  static std::string LandmarksTag(const CC& cc) {
+    return cc.Inputs().HasTag(kLandmarkArrayTag) ? kLandmarkArrayTag
+                                                 : kLandmarksTag;
+  }
+
   absl::Status Process(CalculatorContext* cc) override {
     if (cc->Inputs().Tag(kLetterboxPaddingTag).IsEmpty()) {
       return absl::OkStatus();
@@ -104,16 +124,34 @@ class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
     const float left_and_right = letterbox_padding[0] + letterbox_padding[2];
     const float top_and_bottom = letterbox_padding[1] + letterbox_padding[3];
 
-    CollectionItemId input_id = cc->Inputs().BeginId(kLandmarksTag);
-    CollectionItemId output_id = cc->Outputs().BeginId(kLandmarksTag);
+    CollectionItemId input_id = cc->Inputs().BeginId(landmarks_tag_);
+    CollectionItemId output_id = cc->Outputs().BeginId(landmarks_tag_);
     // Number of inputs and outpus is the same according to the contract.
-    for (; input_id != cc->Inputs().EndId(kLandmarksTag);
+    for (; input_id != cc->Inputs().EndId(landmarks_tag_);
          ++input_id, ++output_id) {
       const auto& input_packet = cc->Inputs().Get(input_id);
       if (input_packet.IsEmpty()) {
         continue;
       }
 
+      if (landmarks_tag_ == kLandmarkArrayTag) {
+        NormalizedLandmarkArray output_landmarks =
+            input_packet.Get<NormalizedLandmarkArray>();
+        float* __restrict xs = output_landmarks.x();
+        float* __restrict ys = output_landmarks.y();
+        float* __restrict zs = output_landmarks.z();
+        for (int i = 0; i < output_landmarks.size(); ++i) {
+          xs[i] = (xs[i] - left) / (1.0f - left_and_right);
+          ys[i] = (ys[i] - top) / (1.0f - top_and_bottom);
+          zs[i] = zs[i] / (1.0f - left_and_right);  // Scale Z coordinate as X.
+        }
+        output_landmarks.MarkCoordinatesSet();
+        cc->Outputs().Get(output_id).AddPacket(
+            MakePacket<NormalizedLandmarkArray>(std::move(output_landmarks))
+                .At(cc->InputTimestamp()));
+        continue;
+      }
+
       const NormalizedLandmarkList& input_landmarks =
           input_packet.Get<NormalizedLandmarkList>();
       NormalizedLandmarkList output_landmarks;
@@ -136,6 +174,9 @@ class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
     }
     return absl::OkStatus();
   }
+
+ private:
+  std::string landmarks_tag_;
 };
 REGISTER_CALCULATOR(LandmarkLetterboxRemovalCalculator);
 
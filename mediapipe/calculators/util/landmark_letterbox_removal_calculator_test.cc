@@ -15,6 +15,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -26,6 +27,7 @@ namespace mediapipe {
 
 constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 constexpr char kLandmarksTag[] = "LANDMARKS";
+constexpr char kLandmarkArrayTag[] = "LANDMARK_ARRAY";
 
 NormalizedLandmark CreateLandmark(float x, float y) {
   NormalizedLandmark landmark;
@@ -114,4 +116,43 @@ TEST(LandmarkLetterboxRemovalCalculatorTest, PaddingTopBottom) {
   EXPECT_THAT(output_landmarks.landmark(2).y(), testing::FloatNear(1.0f, 1e-5));
 }
 
+TEST(LandmarkLetterboxRemovalCalculatorTest, PaddingLeftRightArray) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "LandmarkLetterboxRemovalCalculator"
+    input_stream: "LANDMARK_ARRAY:landmarks"
+    input_stream: "LETTERBOX_PADDING:letterbox_padding"
+    output_stream: "LANDMARK_ARRAY:adjusted_landmarks"
+  )pb"));
+
+  NormalizedLandmarkList landmarks;
+  *landmarks.add_landmark() = CreateLandmark(0.5f, 0.5f);
+  *landmarks.add_landmark() = CreateLandmark(0.2f, 0.2f);
+  *landmarks.add_landmark() = CreateLandmark(0.7f, 0.7f);
+  runner.MutableInputs()
+      ->Tag(kLandmarkArrayTag)
+      .packets.push_back(MakePacket<NormalizedLandmarkArray>(landmarks).At(
+          Timestamp::PostStream()));
+
+  auto padding = absl::make_unique<std::array<float, 4>>(
+      std::array<float, 4>{0.2f, 0.f, 0.3f, 0.f});
+  runner.MutableInputs()
+      ->Tag(kLetterboxPaddingTag)
+      .packets.push_back(Adopt(padding.release()).At(Timestamp::PostStream()));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const std::vector<Packet>& output =
+      runner.Outputs().Tag(kLandmarkArrayTag).packets;
+  ASSERT_EQ(1, output.size());
+  const auto& output_landmarks = output[0].Get<NormalizedLandmarkArray>();
+
+  EXPECT_EQ(output_landmarks.size(), 3);
+
+  EXPECT_THAT(output_landmarks.x()[0], testing::FloatNear(0.6f, 1e-5));
+  EXPECT_THAT(output_landmarks.y()[0], testing::FloatNear(0.5f, 1e-5));
+  EXPECT_THAT(output_landmarks.x()[1], testing::FloatNear(0.0f, 1e-5));
+  EXPECT_THAT(output_landmarks.y()[1], testing::FloatNear(0.2f, 1e-5));
+  EXPECT_THAT(output_landmarks.x()[2], testing::FloatNear(1.0f, 1e-5));
+  EXPECT_THAT(output_landmarks.y()[2], testing::FloatNear(0.7f, 1e-5));
+}
+
 }  // namespace mediapipe
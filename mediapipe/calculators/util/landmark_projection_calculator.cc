@@ -14,11 +14,13 @@
 
 #include <cmath>
 #include <functional>
+#include <string>
 #include <vector>
 
 #include "mediapipe/calculators/util/landmark_projection_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -27,6 +29,7 @@ namespace mediapipe {
 namespace {
 
 constexpr char kLandmarksTag[] = "NORM_LANDMARKS";
+constexpr char kLandmarkArrayTag[] = "NORM_LANDMARK_ARRAY";
 constexpr char kRectTag[] = "NORM_RECT";
 constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 
@@ -39,6 +42,8 @@ constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 //     or landmarks that should be projected using PROJECTION_MATRIX if
 //     specified. (Prefer using PROJECTION_MATRIX as it eliminates need of
 //     letterbox removal step.)
+//   NORM_LANDMARK_ARRAY - NormalizedLandmarkArray
+//     The same landmarks as flat arrays, used instead of NORM_LANDMARKS.
 //   NORM_RECT - NormalizedRect
 //     Represents a normalized rectangle in image coordinates and results in
 //     landmarks with their locations adjusted to the image.
@@ -48,12 +53,15 @@ constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 //     the normalized region of interest to the coordinate system of the image.
 //
 //   Note: either NORM_RECT or PROJECTION_MATRIX has to be specified.
+//   Note: either NORM_LANDMARKS or NORM_LANDMARK_ARRAY has to be specified.
 //   Note: landmark's Z is projected in a custom way - it's scaled by width of
 //     the normalized region of interest used during landmarks detection.
 //
 // Output:
 //   NORM_LANDMARKS - NormalizedLandmarkList
 //     Landmarks with their locations adjusted according to the inputs.
+//   NORM_LANDMARK_ARRAY - NormalizedLandmarkArray
+//     The same, when the input landmarks are given as NORM_LANDMARK_ARRAY.
 //
 // Usage example:
 // node {
@@ -87,19 +95,35 @@ constexpr char kProjectionMatrix[] = "PROJECTION_MATRIX";
 //   output_stream: "NORM_LANDMARKS:0:projected_landmarks_0"
 //   output_stream: "NORM_LANDMARKS:1:projected_landmarks_1"
 // }
+//
+// node {
+//   calculator: "LandmarkProjectionCalculator"
+//   input_stream: "NORM_LANDMARK_ARRAY:landmark_array"
+//   input_stream: "NORM_RECT:rect"
+//   output_stream: "NORM_LANDMARK_ARRAY:projected_landmark_array"
+// }
 class LandmarkProjectionCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
-    RET_CHECK(cc->Inputs().HasTag(kLandmarksTag))
-        << "Missing NORM_LANDMARKS input.";
+    RET_CHECK(cc->Inputs().HasTag(kLandmarksTag) ^
+              cc->Inputs().HasTag(kLandmarkArrayTag))
+        << "Either NORM_LANDMARKS or NORM_LANDMARK_ARRAY input must be "
+           "specified.";
+    const std::string tag = LandmarksTag(*cc);
 
-    RET_CHECK_EQ(cc->Inputs().NumEntries(kLandmarksTag),
-                 cc->Outputs().NumEntries(kLandmarksTag))
+    RET_CHECK_EQ(cc->Inputs().NumEntries(tag), cc->Outputs().NumEntries(tag))
         << "Same number of input and output landmarks is required.";
 
-    for (CollectionItemId id = cc->Inputs().BeginId(kLandmarksTag);
-         id != cc->Inputs().EndId(kLandmarksTag); ++id) {
-      cc->Inputs().Get(id).Set<NormalizedLandmarkList>();
+    for (CollectionItemId in_id = cc->Inputs().BeginId(tag),
+                          out_id = cc->Outputs().BeginId(tag);
+         in_id != cc->Inputs().EndId(tag); ++in_id, ++out_id) {
+      if (tag == kLandmarkArrayTag) {
+        cc->Inputs().Get(in_id).Set<NormalizedLandmarkArray>();
+        cc->Outputs().Get(out_id).Set<NormalizedLandmarkArray>();
+      } else {
+        cc->Inputs().Get(in_id).Set<NormalizedLandmarkList>();
+        cc->Outputs().Get(out_id).Set<NormalizedLandmarkList>();
+      }
     }
     RET_CHECK(cc->Inputs().HasTag(kRectTag) ^
               cc->Inputs().HasTag(kProjectionMatrix))
@@ -110,20 +134,23 @@ class LandmarkProjectionCalculator : public CalculatorBase {
       cc->Inputs().Tag(kProjectionMatrix).Set<std::array<float, 16>>();
     }
 
-    for (CollectionItemId id = cc->Outputs().BeginId(kLandmarksTag);
-         id != cc->Outputs().EndId(kLandmarksTag); ++id) {
-      cc->Outputs().Get(id).Set<NormalizedLandmarkList>();
-    }
-
     return absl::OkStatus();
   }
 
   absl::Status Open(CalculatorContext* cc) override {
     cc->SetOffset(TimestampDiff(0));
+    landmarks_tag_ = LandmarksTag(*cc);
 
     return absl::OkStatus();
   }
 
+  // Returns the tag of the landmark streams, which determines their type.
+  template <typename CC>
+  static std::string LandmarksTag(const CC& cc) {
+    return cc.Inputs().HasTag(kLandmarkArrayTag) ? kLandmarkArrayTag
+                                                 : kLandmarksTag;
+  }
+
   static void ProjectXY(const NormalizedLandmark& lm,
                         const std::array<float, 16>& matrix,
                         NormalizedLandmark* out) {
@@ -154,9 +181,52 @@ class LandmarkProjectionCalculator : public CalculatorBase {
                      std::pow(b_projected.y() - a_projected.y(), 2));
   }
 
+  // Projects the landmarks of landmarks as project_fn does with a rect.
+  static void ProjectWithRect(const NormalizedRect& input_rect,
+                              bool ignore_rotation,
+                              NormalizedLandmarkArray* landmarks) {
+    const float angle = ignore_rotation ? 0 : input_rect.rotation();
+    const float cos_angle = std::cos(angle);
+    const float sin_angle = std::sin(angle);
+    const float width = input_rect.width();
+    const float height = input_rect.height();
+    const float x_center = input_rect.x_center();
+    const float y_center = input_rect.y_center();
+    float* __restrict xs = landmarks->x();
+    float* __restrict ys = landmarks->y();
+    float* __restrict zs = landmarks->z();
+    for (int i = 0; i < landmarks->size(); ++i) {
+      const float x = xs[i] - 0.5f;
+      const float y = ys[i] - 0.5f;
+      xs[i] = (cos_angle * x - sin_angle * y) * width + x_center;
+      ys[i] = (sin_angle * x + cos_angle * y) * height + y_center;
+      zs[i] = zs[i] * width;  // Scale Z coordinate as X.
+    }
+    landmarks->MarkCoordinatesSet();
+  }
+
+  // Projects the landmarks of landmarks as project_fn does with a matrix.
+  static void ProjectWithMatrix(const std::array<float, 16>& matrix,
+                                float z_scale,
+                                NormalizedLandmarkArray* landmarks) {
+    float* __restrict xs = landmarks->x();
+    float* __restrict ys = landmarks->y();
+    float* __restrict zs = landmarks->z();
+    for (int i = 0; i < landmarks->size(); ++i) {
+      const float x = xs[i];
+      const float y = ys[i];
+      const float z = zs[i];
+      xs[i] = x * matrix[0] + y * matrix[1] + z * matrix[2] + matrix[3];
+      ys[i] = x * matrix[4] + y * matrix[5] + z * matrix[6] + matrix[7];
+      zs[i] = z_scale * z;
+    }
+    landmarks->MarkCoordinatesSet();
+  }
+
   absl::Status Process(CalculatorContext* cc) override {
     std::function<void(const NormalizedLandmark&, NormalizedLandmark*)>
         project_fn;
+    std::function<void(NormalizedLandmarkArray*)> project_array_fn;
     if (cc->Inputs().HasTag(kRectTag)) {
       if (cc->Inputs().Tag(kRectTag).IsEmpty()) {
         return absl::OkStatus();
@@ -164,6 +234,10 @@ class LandmarkProjectionCalculator : public CalculatorBase {
       const auto& input_rect = cc->Inputs().Tag(kRectTag).Get<NormalizedRect>();
       const auto& options =
           cc->Options<mediapipe::LandmarkProjectionCalculatorOptions>();
+      project_array_fn = [&input_rect,
+                          &options](NormalizedLandmarkArray* landmarks) {
+        ProjectWithRect(input_rect, options.ignore_rotation(), landmarks);
+      };
       project_fn = [&input_rect, &options](const NormalizedLandmark& landmark,
                                            NormalizedLandmark* new_landmark) {
         // TODO: fix projection or deprecate (current projection
@@ -192,6 +266,10 @@ class LandmarkProjectionCalculator : public CalculatorBase {
       const auto& project_mat =
           cc->Inputs().Tag(kProjectionMatrix).Get<std::array<float, 16>>();
       const float z_scale = CalculateZScale(project_mat);
+      project_array_fn = [&project_mat,
+                          z_scale](NormalizedLandmarkArray* landmarks) {
+        ProjectWithMatrix(project_mat, z_scale, landmarks);
+      };
       project_fn = [&project_mat, z_scale](const NormalizedLandmark& lm,
                                            NormalizedLandmark* new_landmark) {
         *new_landmark = lm;
@@ -202,16 +280,26 @@ class LandmarkProjectionCalculator : public CalculatorBase {
       return absl::InternalError("Either rect or matrix must be specified.");
     }
 
-    CollectionItemId input_id = cc->Inputs().BeginId(kLandmarksTag);
-    CollectionItemId output_id = cc->Outputs().BeginId(kLandmarksTag);
+    CollectionItemId input_id = cc->Inputs().BeginId(landmarks_tag_);
+    CollectionItemId output_id = cc->Outputs().BeginId(landmarks_tag_);
     // Number of inputs and outpus is the same according to the contract.
-    for (; input_id != cc->Inputs().EndId(kLandmarksTag);
+    for (; input_id != cc->Inputs().EndId(landmarks_tag_);
          ++input_id, ++output_id) {
       const auto& input_packet = cc->Inputs().Get(input_id);
       if (input_packet.IsEmpty()) {
         continue;
       }
 
+      if (landmarks_tag_ == kLandmarkArrayTag) {
+        NormalizedLandmarkArray output_landmarks =
+            input_packet.Get<NormalizedLandmarkArray>();
+        project_array_fn(&output_landmarks);
+        cc->Outputs().Get(output_id).AddPacket(
+            MakePacket<NormalizedLandmarkArray>(std::move(output_landmarks))
+                .At(cc->InputTimestamp()));
+        continue;
+      }
+
       const auto& input_landmarks = input_packet.Get<NormalizedLandmarkList>();
       NormalizedLandmarkList output_landmarks;
       for (int i = 0; i < input_landmarks.landmark_size(); ++i) {
@@ -226,6 +314,9 @@ class LandmarkProjectionCalculator : public CalculatorBase {
     }
     return absl::OkStatus();
   }
+
+ private:
+  std::string landmarks_tag_;
 };
 REGISTER_CALCULATOR(LandmarkProjectionCalculator);
 
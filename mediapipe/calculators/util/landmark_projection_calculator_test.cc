@@ -8,6 +8,7 @@
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/message_matchers.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_array.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -19,6 +20,7 @@ namespace {
 constexpr char kProjectionMatrixTag[] = "PROJECTION_MATRIX";
 constexpr char kNormRectTag[] = "NORM_RECT";
 constexpr char kNormLandmarksTag[] = "NORM_LANDMARKS";
+constexpr char kNormLandmarkArrayTag[] = "NORM_LANDMARK_ARRAY";
 
 absl::StatusOr<mediapipe::NormalizedLandmarkList> RunCalculator(
     mediapipe::NormalizedLandmarkList input, mediapipe::NormalizedRect rect) {
@@ -240,5 +242,54 @@ TEST(LandmarkProjectionCalculatorTest, ProjectingWithRotationMatrix) {
       )pb")));
 }
 
+TEST(LandmarkProjectionCalculatorTest, ProjectingArrayMatchesList) {
+  mediapipe::NormalizedLandmarkList landmarks =
+      ParseTextProtoOrDie<mediapipe::NormalizedLandmarkList>(R"pb(
+        landmark { x: 0.1, y: 0.2, z: -0.5, visibility: 0.9 }
+        landmark { x: 0.7, y: 0.4, z: 0.25 }
+      )pb");
+  mediapipe::NormalizedRect rect =
+      ParseTextProtoOrDie<mediapipe::NormalizedRect>(R"pb(
+        x_center: 0.4, y_center: 0.6, width: 0.5, height: 0.8, rotation: 0.5
+      )pb");
+  auto expected = RunCalculator(landmarks, rect);
+  MP_ASSERT_OK(expected);
+
+  mediapipe::CalculatorRunner runner(
+      ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(R"pb(
+        calculator: "LandmarkProjectionCalculator"
+        input_stream: "NORM_LANDMARK_ARRAY:landmarks"
+        input_stream: "NORM_RECT:rect"
+        output_stream: "NORM_LANDMARK_ARRAY:projected_landmarks"
+      )pb"));
+  runner.MutableInputs()
+      ->Tag(kNormLandmarkArrayTag)
+      .packets.push_back(
+          MakePacket<NormalizedLandmarkArray>(landmarks).At(Timestamp(1)));
+  runner.MutableInputs()
+      ->Tag(kNormRectTag)
+      .packets.push_back(
+          MakePacket<mediapipe::NormalizedRect>(rect).At(Timestamp(1)));
+  MP_ASSERT_OK(runner.Run());
+  const auto& output_packets =
+      runner.Outputs().Tag(kNormLandmarkArrayTag).packets;
+  ASSERT_EQ(output_packets.size(), 1);
+  EXPECT_THAT(output_packets[0].Get<NormalizedLandmarkArray>().ToProto(),
+              EqualsProto(expected.value()));
+}
+
+TEST(LandmarkProjectionCalculatorTest, RejectsListsAndArraysTogether) {
+  mediapipe::CalculatorRunner runner(
+      ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig::Node>(R"pb(
+        calculator: "LandmarkProjectionCalculator"
+        input_stream: "NORM_LANDMARKS:landmarks"
+        input_stream: "NORM_LANDMARK_ARRAY:landmark_array"
+        input_stream: "NORM_RECT:rect"
+        output_stream: "NORM_LANDMARKS:projected_landmarks"
+        output_stream: "NORM_LANDMARK_ARRAY:projected_landmark_array"
+      )pb"));
+  EXPECT_FALSE(runner.Run().ok());
+}
+
 }  // namespace
 }  // namespace mediapipe
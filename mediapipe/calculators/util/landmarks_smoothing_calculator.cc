@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <memory>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "mediapipe/calculators/util/landmarks_smoothing_calculator.pb.h"
@@ -21,8 +22,8 @@
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/timestamp.h"
-#include "mediapipe/util/filtering/one_euro_filter.h"
-#include "mediapipe/util/filtering/relative_velocity_filter.h"
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+#include "mediapipe/util/filtering/relative_velocity_filter_bank.h"
 
 namespace mediapipe {
 
@@ -35,8 +36,8 @@ constexpr char kObjectScaleRoiTag[] = "OBJECT_SCALE_ROI";
 constexpr char kNormalizedFilteredLandmarksTag[] = "NORM_FILTERED_LANDMARKS";
 constexpr char kFilteredLandmarksTag[] = "FILTERED_LANDMARKS";
 
-using mediapipe::OneEuroFilter;
-using mediapipe::RelativeVelocityFilter;
+using mediapipe::OneEuroFilterBank;
+using mediapipe::RelativeVelocityFilterBank;
 
 void NormalizedLandmarksToLandmarks(
     const NormalizedLandmarkList& norm_landmarks, const int image_width,
@@ -108,6 +109,33 @@ float GetObjectScale(const Rect& roi) {
   return (roi.width() + roi.height()) / 2.0f;
 }
 
+// Copies the coordinates of landmarks to values, as x, y and z of the first
+// landmark, then of the second one, and so on.
+void GetCoordinates(const LandmarkList& landmarks, std::vector<float>* values) {
+  values->resize(3 * landmarks.landmark_size());
+  float* value = values->data();
+  for (const auto& landmark : landmarks.landmark()) {
+    *value++ = landmark.x();
+    *value++ = landmark.y();
+    *value++ = landmark.z();
+  }
+}
+
+// Sets out_landmarks to in_landmarks with the coordinates from values, see
+// GetCoordinates.
+void SetCoordinates(const LandmarkList& in_landmarks,
+                    const std::vector<float>& values,
+                    LandmarkList* out_landmarks) {
+  const float* value = values.data();
+  for (const auto& in_landmark : in_landmarks.landmark()) {
+    auto* out_landmark = out_landmarks->add_landmark();
+    *out_landmark = in_landmark;
+    out_landmark->set_x(*value++);
+    out_landmark->set_y(*value++);
+    out_landmark->set_z(*value++);
+  }
+}
+
 // Abstract class for various landmarks filters.
 class LandmarksFilter {
  public:
@@ -144,9 +172,7 @@ class VelocityFilter : public LandmarksFilter {
         disable_value_scaling_(disable_value_scaling) {}
 
   absl::Status Reset() override {
-    x_filters_.clear();
-    y_filters_.clear();
-    z_filters_.clear();
+    filters_.reset();
     return absl::OkStatus();
   }
 
@@ -171,19 +197,11 @@ class VelocityFilter : public LandmarksFilter {
     // Initialize filters once.
     MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.landmark_size()));
 
-    // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
-
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(
-          x_filters_[i].Apply(timestamp, value_scale, in_landmark.x()));
-      out_landmark->set_y(
-          y_filters_[i].Apply(timestamp, value_scale, in_landmark.y()));
-      out_landmark->set_z(
-          z_filters_[i].Apply(timestamp, value_scale, in_landmark.z()));
-    }
+    // Filter landmarks. Every axis of every landmark is filtered separately,
+    // all at once.
+    GetCoordinates(in_landmarks, &values_);
+    filters_->Apply(timestamp, value_scale, values_.data(), values_.data());
+    SetCoordinates(in_landmarks, values_, out_landmarks);
 
     return absl::OkStatus();
   }
@@ -192,19 +210,13 @@ class VelocityFilter : public LandmarksFilter {
   // Initializes filters for the first time or after Reset. If initialized then
   // check the size.
   absl::Status InitializeFiltersIfEmpty(const int n_landmarks) {
-    if (!x_filters_.empty()) {
-      RET_CHECK_EQ(x_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(y_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(z_filters_.size(), n_landmarks);
+    if (filters_) {
+      RET_CHECK_EQ(filters_->size(), 3 * n_landmarks);
       return absl::OkStatus();
     }
 
-    x_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
-    y_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
-    z_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
+    filters_ = absl::make_unique<RelativeVelocityFilterBank>(
+        3 * n_landmarks, window_size_, velocity_scale_);
 
     return absl::OkStatus();
   }
@@ -214,9 +226,9 @@ class VelocityFilter : public LandmarksFilter {
   float min_allowed_object_scale_;
   bool disable_value_scaling_;
 
-  std::vector<RelativeVelocityFilter> x_filters_;
-  std::vector<RelativeVelocityFilter> y_filters_;
-  std::vector<RelativeVelocityFilter> z_filters_;
+  // Filters of the x, y and z coordinates of all landmarks.
+  std::unique_ptr<RelativeVelocityFilterBank> filters_;
+  std::vector<float> values_;
 };
 
 // Please check OneEuroFilter documentation for details.
@@ -233,9 +245,7 @@ class OneEuroFilterImpl : public LandmarksFilter {
         disable_value_scaling_(disable_value_scaling) {}
 
   absl::Status Reset() override {
-    x_filters_.clear();
-    y_filters_.clear();
-    z_filters_.clear();
+    filters_.reset();
     return absl::OkStatus();
   }
 
@@ -260,19 +270,11 @@ class OneEuroFilterImpl : public LandmarksFilter {
       value_scale = 1.0f / object_scale;
     }
 
-    // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
-
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(
-          x_filters_[i].Apply(timestamp, value_scale, in_landmark.x()));
-      out_landmark->set_y(
-          y_filters_[i].Apply(timestamp, value_scale, in_landmark.y()));
-      out_landmark->set_z(
-          z_filters_[i].Apply(timestamp, value_scale, in_landmark.z()));
-    }
+    // Filter landmarks. Every axis of every landmark is filtered separately,
+    // all at once.
+    GetCoordinates(in_landmarks, &values_);
+    filters_->Apply(timestamp, value_scale, values_.data(), values_.data());
+    SetCoordinates(in_landmarks, values_, out_landmarks);
 
     return absl::OkStatus();
   }
@@ -281,21 +283,13 @@ class OneEuroFilterImpl : public LandmarksFilter {
   // Initializes filters for the first time or after Reset. If initialized then
   // check the size.
   absl::Status InitializeFiltersIfEmpty(const int n_landmarks) {
-    if (!x_filters_.empty()) {
-      RET_CHECK_EQ(x_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(y_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(z_filters_.size(), n_landmarks);
+    if (filters_) {
+      RET_CHECK_EQ(filters_->size(), 3 * n_landmarks);
       return absl::OkStatus();
     }
 
-    for (int i = 0; i < n_landmarks; ++i) {
-      x_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      y_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      z_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-    }
+    filters_ = absl::make_unique<OneEuroFilterBank>(
+        3 * n_landmarks, frequency_, min_cutoff_, beta_, derivate_cutoff_);
 
     return absl::OkStatus();
   }
@@ -307,9 +301,9 @@ class OneEuroFilterImpl : public LandmarksFilter {
   double min_allowed_object_scale_;
   bool disable_value_scaling_;
 
-  std::vector<OneEuroFilter> x_filters_;
-  std::vector<OneEuroFilter> y_filters_;
-  std::vector<OneEuroFilter> z_filters_;
+  // Filters of the x, y and z coordinates of all landmarks.
+  std::unique_ptr<OneEuroFilterBank> filters_;
+  std::vector<float> values_;
 };
 
 }  // namespace
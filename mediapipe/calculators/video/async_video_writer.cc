@@ -0,0 +1,176 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "mediapipe/calculators/video/async_video_writer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_builder.h"
+
+namespace mediapipe {
+
+AsyncVideoWriter::AsyncVideoWriter(std::unique_ptr<cv::VideoWriter> writer,
+                                   const Options& options)
+    : options_(options), writer_(std::move(writer)) {
+  if (options_.max_queue_size > 0) {
+    encoder_ = absl::make_unique<ThreadPool>("video_encoder", 1);
+    encoder_->StartWorkers();
+    encoder_->Schedule([this] { EncodeLoop(); });
+  }
+}
+
+AsyncVideoWriter::~AsyncVideoWriter() {
+  absl::Status status = Close();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to encode video: " << status;
+  }
+}
+
+absl::Status AsyncVideoWriter::Write(Packet packet) {
+  MP_RETURN_IF_ERROR(packet.ValidateAsType<ImageFrame>());
+  const ImageFormat::Format format = packet.Get<ImageFrame>().Format();
+  if (format != ImageFormat::GRAY8 && format != ImageFormat::SRGB &&
+      format != ImageFormat::SRGBA) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Unsupported image format: " << format;
+  }
+  if (!encoder_) {
+    RET_CHECK(writer_) << "Write after Close.";
+    EncodeAndRecord(packet);
+    absl::MutexLock lock(&mutex_);
+    return status_;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  RET_CHECK(!closing_) << "Write after Close.";
+  MP_RETURN_IF_ERROR(status_);
+  if (queue_.size() >= options_.max_queue_size) {
+    switch (options_.overflow_policy) {
+      case OverflowPolicy::kBlock:
+        mutex_.Await(
+            absl::Condition(this, &AsyncVideoWriter::HasRoomOrClosing));
+        break;
+      case OverflowPolicy::kDropNewest:
+        ++stats_.frames_dropped;
+        return absl::OkStatus();
+      case OverflowPolicy::kDropOldest:
+        queue_.pop_front();
+        ++stats_.frames_dropped;
+        break;
+    }
+  }
+  queue_.push_back(std::move(packet));
+  stats_.max_queue_size =
+      std::max<int>(stats_.max_queue_size, queue_.size());
+  return absl::OkStatus();
+}
+
+int AsyncVideoWriter::QueueSize() {
+  absl::MutexLock lock(&mutex_);
+  return queue_.size();
+}
+
+absl::Status AsyncVideoWriter::Close() {
+  if (encoder_) {
+    {
+      absl::MutexLock lock(&mutex_);
+      closing_ = true;
+    }
+    // Waits for the encoding thread to drain the queue.
+    encoder_.reset();
+  }
+  if (writer_) {
+    if (writer_->isOpened()) writer_->release();
+    writer_.reset();
+  }
+  absl::MutexLock lock(&mutex_);
+  closing_ = true;
+  return status_;
+}
+
+AsyncVideoWriter::Stats AsyncVideoWriter::GetStats() {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+void AsyncVideoWriter::EncodeLoop() {
+  while (true) {
+    Packet packet;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(
+          absl::Condition(this, &AsyncVideoWriter::HasFrameOrClosing));
+      if (queue_.empty()) return;
+      packet = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    EncodeAndRecord(packet);
+  }
+}
+
+void AsyncVideoWriter::EncodeAndRecord(const Packet& packet) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!status_.ok()) return;
+  }
+  const absl::Time start_time = absl::Now();
+  absl::Status status = Encode(packet);
+  const absl::Time end_time = absl::Now();
+  if (status.ok() && options_.encoded_callback) {
+    options_.encoded_callback(packet.Timestamp(), start_time, end_time);
+  }
+  absl::MutexLock lock(&mutex_);
+  if (status.ok()) {
+    ++stats_.frames_encoded;
+    stats_.encode_time_usec += absl::ToInt64Microseconds(end_time - start_time);
+  } else {
+    status_ = std::move(status);
+  }
+}
+
+absl::Status AsyncVideoWriter::Encode(const Packet& packet) {
+  const ImageFrame& image_frame = packet.Get<ImageFrame>();
+  cv::Mat frame = formats::MatView(&image_frame);
+  if (frame.empty()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Receive empty frame at timestamp " << packet.Timestamp();
+  }
+  // cvtColor only reallocates bgr_frame_ when the frame size changes.
+  switch (image_frame.Format()) {
+    case ImageFormat::GRAY8:
+      writer_->write(frame);
+      break;
+    case ImageFormat::SRGB:
+      cv::cvtColor(frame, bgr_frame_, cv::COLOR_RGB2BGR);
+      writer_->write(bgr_frame_);
+      break;
+    case ImageFormat::SRGBA:
+      cv::cvtColor(frame, bgr_frame_, cv::COLOR_RGBA2BGR);
+      writer_->write(bgr_frame_);
+      break;
+    default:
+      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+             << "Unsupported image format: " << image_frame.Format();
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,122 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MEDIAPIPE_CALCULATORS_VIDEO_ASYNC_VIDEO_WRITER_H_
+#define MEDIAPIPE_CALCULATORS_VIDEO_ASYNC_VIDEO_WRITER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+// Encodes ImageFrames with a cv::VideoWriter on a background thread, so that
+// encoding doesn't add to the latency of the caller. Frames are handed over
+// as packets through a bounded queue, without copying, and converted to BGR
+// on the encoding thread into a buffer reused across frames.
+//
+// Write and Close must be called from one thread at a time.
+class AsyncVideoWriter {
+ public:
+  // What Write does when max_queue_size frames are already queued.
+  enum class OverflowPolicy {
+    kBlock,       // Waits until the oldest queued frame is encoded.
+    kDropNewest,  // Drops the frame being written.
+    kDropOldest,  // Drops the oldest queued frame.
+  };
+
+  struct Options {
+    // Maximum number of frames waiting to be encoded. 0 encodes frames in
+    // Write, on the caller thread.
+    int max_queue_size = 8;
+
+    OverflowPolicy overflow_policy = OverflowPolicy::kBlock;
+
+    // Called on the encoding thread once a frame is encoded, with the
+    // timestamp of its packet and the encoding start and end times.
+    std::function<void(Timestamp, absl::Time, absl::Time)> encoded_callback;
+  };
+
+  struct Stats {
+    int64 frames_encoded = 0;
+    int64 frames_dropped = 0;
+    // Largest number of frames queued at once.
+    int max_queue_size = 0;
+    // Time spent converting and encoding frames, in microseconds.
+    int64 encode_time_usec = 0;
+
+    // Frames encoded per second of encoding time.
+    double EncodeFps() const {
+      return encode_time_usec > 0 ? frames_encoded * 1e6 / encode_time_usec
+                                  : 0.0;
+    }
+  };
+
+  // Takes ownership of an opened writer.
+  AsyncVideoWriter(std::unique_ptr<cv::VideoWriter> writer,
+                   const Options& options);
+  // Encodes the queued frames and closes the writer, see Close.
+  ~AsyncVideoWriter();
+
+  // Queues the ImageFrame of packet for encoding. The frame must be GRAY8,
+  // SRGB or SRGBA. Returns the first encoding error, if any.
+  absl::Status Write(Packet packet);
+
+  // Number of frames waiting to be encoded.
+  int QueueSize() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Encodes the queued frames, stops the encoding thread and releases the
+  // writer. Returns the first encoding error, if any.
+  absl::Status Close();
+
+  Stats GetStats() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  void EncodeLoop();
+  // Encodes the frame unless a previous frame failed, and records the result.
+  void EncodeAndRecord(const Packet& packet) ABSL_LOCKS_EXCLUDED(mutex_);
+  // Converts and writes one frame.
+  absl::Status Encode(const Packet& packet);
+
+  bool HasRoomOrClosing() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return closing_ || queue_.size() < options_.max_queue_size;
+  }
+  bool HasFrameOrClosing() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return closing_ || !queue_.empty();
+  }
+
+  const Options options_;
+  // Only used on the encoding thread while it runs.
+  std::unique_ptr<cv::VideoWriter> writer_;
+  cv::Mat bgr_frame_;
+
+  std::unique_ptr<ThreadPool> encoder_;
+  absl::Mutex mutex_;
+  std::deque<Packet> queue_ ABSL_GUARDED_BY(mutex_);
+  bool closing_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_VIDEO_ASYNC_VIDEO_WRITER_H_
@@ -0,0 +1,152 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "mediapipe/calculators/video/async_video_writer.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/notification.h"
+#include "mediapipe/framework/formats/deleting_file.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 48;
+
+std::unique_ptr<cv::VideoWriter> OpenWriter(const std::string& path) {
+  auto writer = absl::make_unique<cv::VideoWriter>(
+      path, mediapipe::fourcc('M', 'J', 'P', 'G'), 30.0,
+      cv::Size(kWidth, kHeight));
+  EXPECT_TRUE(writer->isOpened());
+  return writer;
+}
+
+Packet MakeFrame(int64 timestamp,
+                 ImageFormat::Format format = ImageFormat::SRGB) {
+  auto frame = absl::make_unique<ImageFrame>(format, kWidth, kHeight);
+  frame->SetToZero();
+  return Adopt(frame.release()).At(Timestamp(timestamp));
+}
+
+int CountFrames(const std::string& path) {
+  cv::VideoCapture capture(path);
+  int count = 0;
+  cv::Mat frame;
+  while (capture.read(frame) && !frame.empty()) ++count;
+  return count;
+}
+
+TEST(AsyncVideoWriterTest, BlockingWriteEncodesAllFrames) {
+  const std::string path = "/tmp/async_video_writer_test.avi";
+  DeletingFile deleting_file(path, true);
+  AsyncVideoWriter::Options options;
+  options.max_queue_size = 2;
+  AsyncVideoWriter writer(OpenWriter(path), options);
+  for (int i = 0; i < 30; ++i) {
+    MP_ASSERT_OK(writer.Write(MakeFrame(i)));
+    EXPECT_LE(writer.QueueSize(), 2);
+  }
+  MP_ASSERT_OK(writer.Close());
+
+  const AsyncVideoWriter::Stats stats = writer.GetStats();
+  EXPECT_EQ(stats.frames_encoded, 30);
+  EXPECT_EQ(stats.frames_dropped, 0);
+  EXPECT_LE(stats.max_queue_size, 2);
+  EXPECT_EQ(CountFrames(path), 30);
+}
+
+TEST(AsyncVideoWriterTest, SynchronousWriteEncodesInWrite) {
+  const std::string path = "/tmp/async_video_writer_test_sync.avi";
+  DeletingFile deleting_file(path, true);
+  AsyncVideoWriter::Options options;
+  options.max_queue_size = 0;
+  AsyncVideoWriter writer(OpenWriter(path), options);
+  MP_ASSERT_OK(writer.Write(MakeFrame(0, ImageFormat::GRAY8)));
+  MP_ASSERT_OK(writer.Write(MakeFrame(1, ImageFormat::SRGBA)));
+  EXPECT_EQ(writer.GetStats().frames_encoded, 2);
+  MP_ASSERT_OK(writer.Close());
+}
+
+TEST(AsyncVideoWriterTest, RejectsUnsupportedFormat) {
+  const std::string path = "/tmp/async_video_writer_test_format.avi";
+  DeletingFile deleting_file(path, true);
+  AsyncVideoWriter writer(OpenWriter(path), AsyncVideoWriter::Options());
+  EXPECT_FALSE(writer.Write(MakeFrame(0, ImageFormat::VEC32F1)).ok());
+  EXPECT_FALSE(writer.Write(MakePacket<int>(0)).ok());
+  MP_ASSERT_OK(writer.Close());
+}
+
+// Writes frames 0 to 4 while the encoding of frame 0 is held, with room for
+// two queued frames, and returns the timestamps of the encoded frames.
+std::vector<int64> WriteWhileEncodingIsHeld(
+    AsyncVideoWriter::OverflowPolicy policy, AsyncVideoWriter::Stats* stats) {
+  const std::string path = "/tmp/async_video_writer_test_drop.avi";
+  DeletingFile deleting_file(path, true);
+  absl::Notification encoding_started;
+  absl::Notification release_encoding;
+  std::vector<int64> encoded;
+  AsyncVideoWriter::Options options;
+  options.max_queue_size = 2;
+  options.overflow_policy = policy;
+  options.encoded_callback = [&](Timestamp timestamp, absl::Time,
+                                 absl::Time) {
+    encoded.push_back(timestamp.Value());
+    if (!encoding_started.HasBeenNotified()) {
+      encoding_started.Notify();
+      release_encoding.WaitForNotification();
+    }
+  };
+  AsyncVideoWriter writer(OpenWriter(path), options);
+  MP_EXPECT_OK(writer.Write(MakeFrame(0)));
+  encoding_started.WaitForNotification();
+  for (int i = 1; i < 5; ++i) {
+    MP_EXPECT_OK(writer.Write(MakeFrame(i)));
+  }
+  EXPECT_EQ(writer.QueueSize(), 2);
+  release_encoding.Notify();
+  MP_EXPECT_OK(writer.Close());
+  *stats = writer.GetStats();
+  return encoded;
+}
+
+TEST(AsyncVideoWriterTest, DropNewest) {
+  AsyncVideoWriter::Stats stats;
+  EXPECT_THAT(WriteWhileEncodingIsHeld(
+                  AsyncVideoWriter::OverflowPolicy::kDropNewest, &stats),
+              ElementsAre(0, 1, 2));
+  EXPECT_EQ(stats.frames_encoded, 3);
+  EXPECT_EQ(stats.frames_dropped, 2);
+  EXPECT_EQ(stats.max_queue_size, 2);
+}
+
+TEST(AsyncVideoWriterTest, DropOldest) {
+  AsyncVideoWriter::Stats stats;
+  EXPECT_THAT(WriteWhileEncodingIsHeld(
+                  AsyncVideoWriter::OverflowPolicy::kDropOldest, &stats),
+              ElementsAre(0, 3, 4));
+  EXPECT_EQ(stats.frames_encoded, 3);
+  EXPECT_EQ(stats.frames_dropped, 2);
+}
+
+}  // namespace
+}  // namespace mediapipe
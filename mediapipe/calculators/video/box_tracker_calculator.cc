@@ -14,6 +14,7 @@
 
 #include <stdio.h>
 
+#include <map>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -108,6 +109,9 @@ const char kOptionsTag[] = "OPTIONS";
 //          (requires VIDEO to be present)
 //   BOXES: Optional output stream of type TimedBoxProtoList for each
 //          initialized result.
+//   TRACK_TIMES: Optional output stream of type std::map<int, int64>, mapping
+//          the id of each box tracked in streaming mode to the time in
+//          microseconds spent tracking it by the current TRACKING frame.
 //   RA_BOXES: Optional output stream of type TimedBoxProtoList for each
 //             request in RA_TRACK. Same timestamp as request is used.
 //
@@ -174,9 +178,11 @@ class BoxTrackerCalculator : public CalculatorBase {
   // Specify destination timestamp and frame duration TrackingData was
   // computed for. Used in streaming mode.
   // Returns list of ids that failed.
+  // If track_times_us is specified, outputs time spent tracking each box.
   void StreamTrack(const TrackingData& data, int data_frame_num,
                    int64 dst_timestamp_ms, int64 duration_ms, bool forward,
-                   MotionBoxMap* box_map, std::vector<int>* failed_ids);
+                   MotionBoxMap* box_map, std::vector<int>* failed_ids,
+                   std::map<int, int64>* track_times_us = nullptr);
 
   // Fast forwards specified boxes from starting position to current play head
   // and outputs successful boxes to box_map.
@@ -241,8 +247,8 @@ class BoxTrackerCalculator : public CalculatorBase {
   std::vector<Timestamp> queued_track_requests_;
 
   // Stores the tracked ids that have been discarded actively, from continuous
-  // tracking data. It may accumulate across multiple frames. Once consumed, it
-  // should be cleared immediately.
+  // tracking data. It may accumulate across multiple frames. Once consumed by
+  // tracking a set of boxes, it is cleared.
   absl::flat_hash_set<int> actively_discarded_tracked_ids_;
 
   // Add smooth transition between re-acquisition and previous tracked boxes.
@@ -297,6 +303,7 @@ constexpr char kCacheDirTag[] = "CACHE_DIR";
 constexpr char kInitialPosTag[] = "INITIAL_POS";
 constexpr char kRaBoxesTag[] = "RA_BOXES";
 constexpr char kBoxesTag[] = "BOXES";
+constexpr char kTrackTimesTag[] = "TRACK_TIMES";
 constexpr char kVizTag[] = "VIZ";
 constexpr char kRaTrackProtoStringTag[] = "RA_TRACK_PROTO_STRING";
 constexpr char kRaTrackTag[] = "RA_TRACK";
@@ -443,6 +450,12 @@ absl::Status BoxTrackerCalculator::GetContract(CalculatorContract* cc) {
     cc->Outputs().Tag(kBoxesTag).Set<TimedBoxProtoList>();
   }
 
+  if (cc->Outputs().HasTag(kTrackTimesTag)) {
+    RET_CHECK(cc->Inputs().HasTag(kTrackingTag))
+        << "TRACK_TIMES is only supported in streaming mode.";
+    cc->Outputs().Tag(kTrackTimesTag).Set<std::map<int, int64>>();
+  }
+
   if (cc->Outputs().HasTag(kRaBoxesTag)) {
     cc->Outputs().Tag(kRaBoxesTag).Set<TimedBoxProtoList>();
   }
@@ -701,9 +714,16 @@ absl::Status BoxTrackerCalculator::Process(CalculatorContext* cc) {
               : 0;
 
       std::vector<int> failed_boxes;
+      std::unique_ptr<std::map<int, int64>> track_times;
+      if (cc->Outputs().HasTag(kTrackTimesTag)) {
+        track_times.reset(new std::map<int, int64>());
+      }
       StreamTrack(track_data, frame_num_, time_ms, duration_ms,
                   true,  // forward.
-                  &streaming_motion_boxes_, &failed_boxes);
+                  &streaming_motion_boxes_, &failed_boxes, track_times.get());
+      if (track_times) {
+        cc->Outputs().Tag(kTrackTimesTag).Add(track_times.release(), timestamp);
+      }
 
       // Add fast forward boxes.
       if (!fast_forward_boxes.empty()) {
@@ -1164,7 +1184,8 @@ void BoxTrackerCalculator::StreamTrack(const TrackingData& data,
                                        int64 dst_timestamp_ms,
                                        int64 duration_ms, bool forward,
                                        MotionBoxMap* box_map,
-                                       std::vector<int>* failed_ids) {
+                                       std::vector<int>* failed_ids,
+                                       std::map<int, int64>* track_times_us) {
   CHECK(box_map);
   CHECK(failed_ids);
 
@@ -1192,9 +1213,32 @@ void BoxTrackerCalculator::StreamTrack(const TrackingData& data,
   const int from_frame = data_frame_num - (forward ? 1 : 0);
   const int to_frame = forward ? from_frame + 1 : from_frame - 1;
 
+  // All boxes share the motion vector frame converted above, boxes themselves
+  // are tracked independently (in parallel if requested).
+  std::vector<MotionBox*> boxes;
+  boxes.reserve(box_map->size());
   for (auto& motion_box : *box_map) {
-    if (!motion_box.second.box.TrackStep(from_frame,  // from frame.
-                                         mvf, forward)) {
+    boxes.push_back(&motion_box.second.box);
+  }
+
+  std::vector<MotionBoxTrackStepResult> results;
+  TrackStepMultiple(from_frame, mvf, forward,
+                    options_.track_boxes_in_parallel(), boxes, &results);
+
+  // Discarded ids have been consumed by all boxes.
+  if (!boxes.empty()) {
+    actively_discarded_tracked_ids_.clear();
+  }
+
+  // Iteration order of box_map is unchanged, results match order of boxes.
+  int k = 0;
+  for (auto& motion_box : *box_map) {
+    const MotionBoxTrackStepResult& result = results[k++];
+    if (track_times_us) {
+      (*track_times_us)[motion_box.first] = result.track_time_us;
+    }
+
+    if (!result.success) {
       failed_ids->push_back(motion_box.first);
       LOG(INFO) << "lost track. pushed failed id: " << motion_box.first;
     } else {
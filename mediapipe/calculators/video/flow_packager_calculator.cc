@@ -25,6 +25,7 @@
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/util/tracking/camera_motion.pb.h"
 #include "mediapipe/util/tracking/flow_packager.h"
+#include "mediapipe/util/tracking/packed_tracking_data.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
 
 namespace mediapipe {
@@ -247,7 +248,11 @@ void FlowPackagerCalculator::WriteChunk(const TrackingDataChunk& chunk) const {
   }
 
   std::string data;
-  chunk.SerializeToString(&data);
+  if (options_.use_packed_cache_format()) {
+    PackTrackingDataChunk(chunk, &data);
+  } else {
+    chunk.SerializeToString(&data);
+  }
 
   const char* temp_filename = tempnam(cache_dir_.c_str(), nullptr);
   std::ofstream out_file(temp_filename);
@@ -19,14 +19,14 @@
 #include <vector>
 
 #include "absl/strings/str_split.h"
+#include "mediapipe/calculators/video/async_video_writer.h"
 #include "mediapipe/calculators/video/opencv_video_encoder_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
-#include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/formats/video_stream_header.h"
+#include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/opencv_highgui_inc.h"
-#include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/opencv_video_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/source_location.h"
@@ -79,6 +79,28 @@ constexpr char kVideoTag[] = "VIDEO";
 //   }
 // }
 //
+// With max_queue_size set in the options, frames are encoded on a background
+// thread and Process only queues them. The queue depth is reported to the
+// profiler as PACKET_QUEUED events on the VIDEO stream, the encoding of each
+// frame as CPU_TASK_USER events, and the number of encoded and dropped frames
+// in the "Frames encoded" and "Frames dropped" counters.
+//
+// Example config:
+// node {
+//   calculator: "OpenCvVideoEncoderCalculator"
+//   input_stream: "VIDEO:video"
+//   input_stream: "VIDEO_PRESTREAM:video_header"
+//   input_side_packet: "OUTPUT_FILE_PATH:output_file_path"
+//   node_options {
+//     [type.googleapis.com/mediapipe.OpenCvVideoEncoderCalculatorOptions]: {
+//        codec: "avc1"
+//        video_format: "mp4"
+//        max_queue_size: 16
+//        overflow_policy: DROP_OLDEST
+//     }
+//   }
+// }
+//
 class OpenCvVideoEncoderCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc);
@@ -89,9 +111,14 @@ class OpenCvVideoEncoderCalculator : public CalculatorBase {
  private:
   absl::Status SetUpVideoWriter(float frame_rate, int width, int height);
 
+  OpenCvVideoEncoderCalculatorOptions options_;
   std::string output_file_path_;
   int four_cc_;
-  std::unique_ptr<cv::VideoWriter> writer_;
+  std::unique_ptr<AsyncVideoWriter> writer_;
+
+  // For the profiler events of the encoding thread.
+  ProfilingContext* profiling_context_ = nullptr;
+  int node_id_ = -1;
 };
 
 absl::Status OpenCvVideoEncoderCalculator::GetContract(CalculatorContract* cc) {
@@ -109,15 +136,15 @@ absl::Status OpenCvVideoEncoderCalculator::GetContract(CalculatorContract* cc) {
 }
 
 absl::Status OpenCvVideoEncoderCalculator::Open(CalculatorContext* cc) {
-  OpenCvVideoEncoderCalculatorOptions options =
-      cc->Options<OpenCvVideoEncoderCalculatorOptions>();
-  RET_CHECK(options.has_codec() && options.codec().length() == 4)
+  options_ = cc->Options<OpenCvVideoEncoderCalculatorOptions>();
+  RET_CHECK_GE(options_.max_queue_size(), 0);
+  RET_CHECK(options_.has_codec() && options_.codec().length() == 4)
       << "A 4-character codec code must be specified in "
          "OpenCvVideoEncoderCalculatorOptions";
-  const char* codec_array = options.codec().c_str();
+  const char* codec_array = options_.codec().c_str();
   four_cc_ = mediapipe::fourcc(codec_array[0], codec_array[1], codec_array[2],
                                codec_array[3]);
-  RET_CHECK(!options.video_format().empty())
+  RET_CHECK(!options_.video_format().empty())
       << "Video format must be specified in "
          "OpenCvVideoEncoderCalculatorOptions";
   output_file_path_ =
@@ -126,15 +153,17 @@ absl::Status OpenCvVideoEncoderCalculator::Open(CalculatorContext* cc) {
       absl::StrSplit(output_file_path_, '.');
   RET_CHECK(splited_file_path.size() >= 2 &&
             splited_file_path[splited_file_path.size() - 1] ==
-                options.video_format())
+                options_.video_format())
       << "The output file path is invalid.";
+  profiling_context_ = cc->GetProfilingContext();
+  node_id_ = cc->NodeId();
   // If the video header will be available, the video metadata will be fetched
   // from the video header directly. The calculator will receive the video
   // header packet at timestamp prestream.
   if (cc->Inputs().HasTag(kVideoPrestreamTag)) {
     return absl::OkStatus();
   }
-  return SetUpVideoWriter(options.fps(), options.width(), options.height());
+  return SetUpVideoWriter(options_.fps(), options_.width(), options_.height());
 }
 
 absl::Status OpenCvVideoEncoderCalculator::Process(CalculatorContext* cc) {
@@ -145,42 +174,33 @@ absl::Status OpenCvVideoEncoderCalculator::Process(CalculatorContext* cc) {
                             video_header.height);
   }
 
-  const ImageFrame& image_frame =
-      cc->Inputs().Tag(kVideoTag).Value().Get<ImageFrame>();
-  ImageFormat::Format format = image_frame.Format();
-  cv::Mat frame;
-  if (format == ImageFormat::GRAY8) {
-    frame = formats::MatView(&image_frame);
-    if (frame.empty()) {
-      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Receive empty frame at timestamp "
-             << cc->Inputs().Tag(kVideoTag).Value().Timestamp()
-             << " in OpenCvVideoEncoderCalculator::Process()";
-    }
-  } else {
-    cv::Mat tmp_frame = formats::MatView(&image_frame);
-    if (tmp_frame.empty()) {
-      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Receive empty frame at timestamp "
-             << cc->Inputs().Tag(kVideoTag).Value().Timestamp()
-             << " in OpenCvVideoEncoderCalculator::Process()";
-    }
-    if (format == ImageFormat::SRGB) {
-      cv::cvtColor(tmp_frame, frame, cv::COLOR_RGB2BGR);
-    } else if (format == ImageFormat::SRGBA) {
-      cv::cvtColor(tmp_frame, frame, cv::COLOR_RGBA2BGR);
-    } else {
-      return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-             << "Unsupported image format: " << format;
-    }
+  RET_CHECK(writer_) << "The video header hasn't been received.";
+  const Packet& packet = cc->Inputs().Tag(kVideoTag).Value();
+  MP_RETURN_IF_ERROR(writer_->Write(packet));
+  if (options_.max_queue_size() > 0) {
+    mediapipe::LogEvent(profiling_context_,
+                        TraceEvent(TraceEvent::PACKET_QUEUED)
+                            .set_node_id(node_id_)
+                            .set_input_ts(packet.Timestamp())
+                            .set_packet_ts(packet.Timestamp())
+                            .set_stream_id(&cc->Inputs().Tag(kVideoTag).Name())
+                            .set_event_data(writer_->QueueSize()));
   }
-  writer_->write(frame);
   return absl::OkStatus();
 }
 
 absl::Status OpenCvVideoEncoderCalculator::Close(CalculatorContext* cc) {
-  if (writer_ && writer_->isOpened()) {
-    writer_->release();
+  if (writer_) {
+    MP_RETURN_IF_ERROR(writer_->Close());
+    const AsyncVideoWriter::Stats stats = writer_->GetStats();
+    cc->GetCounter("Frames encoded")->IncrementBy(stats.frames_encoded);
+    cc->GetCounter("Frames dropped")->IncrementBy(stats.frames_dropped);
+    if (options_.max_queue_size() > 0) {
+      LOG(INFO) << "Encoded " << stats.frames_encoded << " frames at "
+                << stats.EncodeFps() << " fps, dropped "
+                << stats.frames_dropped << " frames, queued at most "
+                << stats.max_queue_size << " frames.";
+    }
   }
   if (cc->InputSidePackets().HasTag(kAudioFilePathTag)) {
 #ifdef HAVE_FFMPEG
@@ -218,12 +238,42 @@ absl::Status OpenCvVideoEncoderCalculator::SetUpVideoWriter(float frame_rate,
   RET_CHECK(frame_rate > 0 && width > 0 && height > 0)
       << "Invalid video metadata: frame_rate=" << frame_rate
       << ", width=" << width << ", height=" << height;
-  writer_ = absl::make_unique<cv::VideoWriter>(
+  auto writer = absl::make_unique<cv::VideoWriter>(
       output_file_path_, four_cc_, frame_rate, cv::Size(width, height));
-  if (!writer_->isOpened()) {
+  if (!writer->isOpened()) {
     return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
            << "Fail to open file at " << output_file_path_;
   }
+  AsyncVideoWriter::Options writer_options;
+  writer_options.max_queue_size = options_.max_queue_size();
+  switch (options_.overflow_policy()) {
+    case OpenCvVideoEncoderCalculatorOptions::BLOCK:
+      writer_options.overflow_policy = AsyncVideoWriter::OverflowPolicy::kBlock;
+      break;
+    case OpenCvVideoEncoderCalculatorOptions::DROP_NEWEST:
+      writer_options.overflow_policy =
+          AsyncVideoWriter::OverflowPolicy::kDropNewest;
+      break;
+    case OpenCvVideoEncoderCalculatorOptions::DROP_OLDEST:
+      writer_options.overflow_policy =
+          AsyncVideoWriter::OverflowPolicy::kDropOldest;
+      break;
+  }
+  if (options_.max_queue_size() > 0) {
+    writer_options.encoded_callback = [this](Timestamp timestamp,
+                                             absl::Time start_time,
+                                             absl::Time end_time) {
+      TraceEvent event = TraceEvent(TraceEvent::CPU_TASK_USER)
+                             .set_node_id(node_id_)
+                             .set_input_ts(timestamp)
+                             .set_event_time(start_time);
+      mediapipe::LogEvent(profiling_context_, event);
+      mediapipe::LogEvent(profiling_context_,
+                          event.set_event_time(end_time).set_is_finish(true));
+    };
+  }
+  writer_ =
+      absl::make_unique<AsyncVideoWriter>(std::move(writer), writer_options);
   return absl::OkStatus();
 }
 
@@ -220,5 +220,68 @@ TEST(OpenCvVideoEncoderCalculatorTest, TestMkvVp8Video) {
                                         cap.get(cv::CAP_PROP_FPS))));
 }
 
+TEST(OpenCvVideoEncoderCalculatorTest, TestMkvVp8VideoOnEncodingThread) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node {
+          calculator: "OpenCvVideoDecoderCalculator"
+          input_side_packet: "INPUT_FILE_PATH:input_file_path"
+          output_stream: "VIDEO:video"
+          output_stream: "VIDEO_PRESTREAM:video_prestream"
+        }
+        node {
+          calculator: "OpenCvVideoEncoderCalculator"
+          input_stream: "VIDEO:video"
+          input_stream: "VIDEO_PRESTREAM:video_prestream"
+          input_side_packet: "OUTPUT_FILE_PATH:output_file_path"
+          node_options {
+            [type.googleapis.com/
+             mediapipe.OpenCvVideoEncoderCalculatorOptions]: {
+              codec: "PIM1"
+              video_format: "mkv"
+              max_queue_size: 4
+            }
+          }
+        }
+      )pb");
+  std::map<std::string, Packet> input_side_packets;
+  input_side_packets["input_file_path"] = MakePacket<std::string>(
+      file::JoinPath("./",
+                     "/mediapipe/calculators/video/"
+                     "testdata/format_MKV_VP8_VORBIS.video"));
+  const std::string output_file_path = "/tmp/tmp_video_async.mkv";
+  DeletingFile deleting_file(output_file_path, true);
+  input_side_packets["output_file_path"] =
+      MakePacket<std::string>(output_file_path);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config, input_side_packets));
+  StatusOrPoller status_or_poller =
+      graph.AddOutputStreamPoller("video_prestream");
+  ASSERT_TRUE(status_or_poller.ok());
+  OutputStreamPoller poller = std::move(status_or_poller.value());
+
+  MP_ASSERT_OK(graph.StartRun({}));
+  Packet packet;
+  while (poller.Next(&packet)) {
+  }
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  const VideoHeader& video_header = packet.Get<VideoHeader>();
+
+  // All frames are encoded with the blocking default overflow policy.
+  EXPECT_EQ(graph.GetCounterFactory()
+                ->GetCounter("OpenCvVideoEncoderCalculator-Frames dropped")
+                ->Get(),
+            0);
+  cv::VideoCapture cap(output_file_path);
+  ASSERT_TRUE(cap.isOpened());
+  EXPECT_EQ(video_header.width,
+            static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH)));
+  EXPECT_EQ(video_header.height,
+            static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT)));
+  EXPECT_EQ(video_header.duration,
+            static_cast<int>(std::round(cap.get(cv::CAP_PROP_FRAME_COUNT) /
+                                        cap.get(cv::CAP_PROP_FPS))));
+}
+
 }  // namespace
 }  // namespace mediapipe
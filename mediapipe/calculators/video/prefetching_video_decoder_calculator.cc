@@ -0,0 +1,378 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/video/prefetching_video_decoder_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
+#include "mediapipe/framework/formats/video_stream_header.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/framework/tool/status_util.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kVideoPrestreamTag[] = "VIDEO_PRESTREAM";
+constexpr char kVideoTag[] = "VIDEO";
+constexpr char kStatsTag[] = "STATS";
+constexpr char kInputFilePathTag[] = "INPUT_FILE_PATH";
+
+// cv::VideoCapture set data type to unsigned char by default. Therefore, the
+// image format is only related to the number of channles the cv::Mat has.
+ImageFormat::Format GetImageFormat(int num_channels) {
+  switch (num_channels) {
+    case 1:
+      return ImageFormat::GRAY8;
+    case 3:
+      return ImageFormat::SRGB;
+    case 4:
+      return ImageFormat::SRGBA;
+    default:
+      return ImageFormat::UNKNOWN;
+  }
+}
+
+// A frame decoded ahead of its output.
+struct DecodedFrame {
+  ImageFrameSharedPtr frame;
+  Timestamp timestamp;
+  VideoDecoderStats stats;
+};
+
+}  // namespace
+
+// Decodes a video file on a dedicated thread, ahead of the graph, and outputs
+// its frames. This is a drop-in replacement for OpenCvVideoDecoderCalculator
+// (without SAVED_AUDIO_PATH) when decoding dominates the graph run time.
+//
+// Up to prefetch_depth frames are decoded ahead of their output. Frames are
+// decoded into a pool of ImageFrame buffers, and converted from BGR to RGB in
+// place, so a buffer is reused once downstream calculators release the
+// previous frame stored in it. Frames can be restricted to a range of frame
+// indices and subsampled with frame_stride for offline analysis, see
+// PrefetchingVideoDecoderCalculatorOptions.
+//
+// Output Streams:
+//   VIDEO: Output video frames (ImageFrame).
+//   VIDEO_PRESTREAM:
+//       Optional video header information output at
+//       Timestamp::PreStream() for the corresponding stream. The frame rate
+//       and duration account for frame_stride and the decoded range.
+//   STATS:
+//       Optional VideoDecoderStats for each output frame, at its timestamp.
+// Input Side Packets:
+//   INPUT_FILE_PATH: The input file path.
+//
+// Example config:
+// node {
+//   calculator: "PrefetchingVideoDecoderCalculator"
+//   input_side_packet: "INPUT_FILE_PATH:input_file_path"
+//   output_stream: "VIDEO:video_frames"
+//   output_stream: "VIDEO_PRESTREAM:video_header"
+//   options {
+//     [mediapipe.PrefetchingVideoDecoderCalculatorOptions.ext] {
+//       prefetch_depth: 8
+//       frame_stride: 5
+//     }
+//   }
+// }
+class PrefetchingVideoDecoderCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->InputSidePackets().Tag(kInputFilePathTag).Set<std::string>();
+    cc->Outputs().Tag(kVideoTag).Set<ImageFrame>();
+    if (cc->Outputs().HasTag(kVideoPrestreamTag)) {
+      cc->Outputs().Tag(kVideoPrestreamTag).Set<VideoHeader>();
+    }
+    if (cc->Outputs().HasTag(kStatsTag)) {
+      cc->Outputs().Tag(kStatsTag).Set<VideoDecoderStats>();
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+  absl::Status Close(CalculatorContext* cc) override;
+
+ private:
+  // Positions cap_ so that the next grabbed frame is frame_index.
+  absl::Status Seek(int64 frame_index);
+
+  // Decodes frames into queue_ until the end of the range, an error, or
+  // Close. Runs on decoder_.
+  void DecodeLoop();
+
+  // Decodes the next output frame. Returns false at the end of the range.
+  absl::StatusOr<bool> DecodeFrame(DecodedFrame* decoded);
+
+  bool HasRoomOrStopping() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return stopping_ || queue_.size() < options_.prefetch_depth();
+  }
+  bool HasFrameOrDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return done_ || !queue_.empty();
+  }
+
+  PrefetchingVideoDecoderCalculatorOptions options_;
+  // Only used by the decoding thread once it is started.
+  std::unique_ptr<cv::VideoCapture> cap_;
+  std::shared_ptr<ImageFramePool> pool_;
+  int width_;
+  int height_;
+  int frame_count_;
+  ImageFormat::Format format_;
+  int64 end_frame_;
+  // Index of the next frame grabbed from cap_.
+  int64 next_frame_ = 0;
+
+  int decoded_frames_ = 0;
+  Timestamp prev_timestamp_ = Timestamp::Unset();
+
+  std::unique_ptr<ThreadPool> decoder_;
+  absl::Mutex mutex_;
+  std::deque<DecodedFrame> queue_ ABSL_GUARDED_BY(mutex_);
+  // Set by the decoding thread when it exits.
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status decode_status_ ABSL_GUARDED_BY(mutex_);
+  // Set by Close to interrupt the decoding thread.
+  bool stopping_ ABSL_GUARDED_BY(mutex_) = false;
+};
+REGISTER_CALCULATOR(PrefetchingVideoDecoderCalculator);
+
+absl::Status PrefetchingVideoDecoderCalculator::Open(CalculatorContext* cc) {
+  options_ = cc->Options<PrefetchingVideoDecoderCalculatorOptions>();
+  RET_CHECK_GT(options_.prefetch_depth(), 0);
+  RET_CHECK_GE(options_.pool_size(), 0);
+  RET_CHECK_GE(options_.start_frame(), 0);
+  RET_CHECK_GT(options_.frame_stride(), 0);
+
+  const std::string& input_file_path =
+      cc->InputSidePackets().Tag(kInputFilePathTag).Get<std::string>();
+  cap_ = absl::make_unique<cv::VideoCapture>(input_file_path);
+  if (!cap_->isOpened()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Fail to open video file at " << input_file_path;
+  }
+  width_ = static_cast<int>(cap_->get(cv::CAP_PROP_FRAME_WIDTH));
+  height_ = static_cast<int>(cap_->get(cv::CAP_PROP_FRAME_HEIGHT));
+  const double fps = static_cast<double>(cap_->get(cv::CAP_PROP_FPS));
+  frame_count_ = static_cast<int>(cap_->get(cv::CAP_PROP_FRAME_COUNT));
+  // cap_->get(cv::CAP_PROP_FORMAT) always returns CV_8UC1, so the image format
+  // is taken from the first frame of the video.
+  cv::Mat frame;
+  cap_->read(frame);
+  if (frame.empty()) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Fail to read any frames from the video file at "
+           << input_file_path;
+  }
+  format_ = GetImageFormat(frame.channels());
+  if (format_ == ImageFormat::UNKNOWN) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Unsupported video format of the video file at "
+           << input_file_path;
+  }
+  if (fps <= 0 || frame_count_ <= 0 || width_ <= 0 || height_ <= 0) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "Fail to make video header due to the incorrect metadata from "
+              "the video file at "
+           << input_file_path;
+  }
+  end_frame_ = options_.end_frame() < 0
+                   ? frame_count_
+                   : std::min<int64>(options_.end_frame(), frame_count_);
+  if (options_.start_frame() >= end_frame_) {
+    return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+           << "No frames to decode in [" << options_.start_frame() << ", "
+           << end_frame_ << ") from the video file at " << input_file_path;
+  }
+
+  if (cc->Outputs().HasTag(kVideoPrestreamTag)) {
+    auto header = absl::make_unique<VideoHeader>();
+    header->format = format_;
+    header->width = width_;
+    header->height = height_;
+    header->frame_rate = fps / options_.frame_stride();
+    header->duration = (end_frame_ - options_.start_frame()) / fps;
+    cc->Outputs()
+        .Tag(kVideoPrestreamTag)
+        .Add(header.release(), Timestamp::PreStream());
+    cc->Outputs().Tag(kVideoPrestreamTag).Close();
+  }
+
+  MP_RETURN_IF_ERROR(Seek(options_.start_frame()));
+  pool_ = ImageFramePool::Create(width_, height_, format_,
+                                 options_.pool_size());
+  decoder_ = absl::make_unique<ThreadPool>("video_decoder", 1);
+  decoder_->StartWorkers();
+  decoder_->Schedule([this] { DecodeLoop(); });
+  return absl::OkStatus();
+}
+
+absl::Status PrefetchingVideoDecoderCalculator::Seek(int64 frame_index) {
+  if (frame_index > 0) {
+    cap_->set(cv::CAP_PROP_POS_FRAMES, frame_index);
+    if (static_cast<int64>(cap_->get(cv::CAP_PROP_POS_FRAMES)) ==
+        frame_index) {
+      next_frame_ = frame_index;
+      return absl::OkStatus();
+    }
+  }
+  // Rewind to the very first frame and skip to frame_index.
+  cap_->set(cv::CAP_PROP_POS_AVI_RATIO, 0);
+  for (next_frame_ = 0; next_frame_ < frame_index; ++next_frame_) {
+    RET_CHECK(cap_->grab()) << "Fail to seek to frame " << frame_index;
+  }
+  return absl::OkStatus();
+}
+
+void PrefetchingVideoDecoderCalculator::DecodeLoop() {
+  while (true) {
+    DecodedFrame decoded;
+    absl::StatusOr<bool> decoded_or = DecodeFrame(&decoded);
+    absl::MutexLock lock(&mutex_);
+    if (!decoded_or.ok() || !decoded_or.value()) {
+      decode_status_ = decoded_or.status();
+      done_ = true;
+      return;
+    }
+    queue_.push_back(std::move(decoded));
+    mutex_.Await(absl::Condition(
+        this, &PrefetchingVideoDecoderCalculator::HasRoomOrStopping));
+    if (stopping_) {
+      done_ = true;
+      return;
+    }
+  }
+}
+
+absl::StatusOr<bool> PrefetchingVideoDecoderCalculator::DecodeFrame(
+    DecodedFrame* decoded) {
+  const absl::Time start_time = absl::Now();
+  // Skipped frames are only grabbed, which spares their retrieval and
+  // conversion.
+  while ((next_frame_ - options_.start_frame()) % options_.frame_stride()) {
+    if (next_frame_ >= end_frame_ || !cap_->grab()) return false;
+    ++next_frame_;
+  }
+  if (next_frame_ >= end_frame_) return false;
+  // Use microsecond as the unit of time. The position is read before grabbing
+  // the frame, as in OpenCvVideoDecoderCalculator.
+  decoded->timestamp = Timestamp(cap_->get(cv::CAP_PROP_POS_MSEC) * 1000);
+  if (!cap_->grab()) return false;
+
+  decoded->frame = pool_->GetBuffer();
+  RET_CHECK(decoded->frame);
+  cv::Mat frame = formats::MatView(decoded->frame.get());
+  const uchar* pixel_data = frame.data;
+  if (!cap_->retrieve(frame) || frame.empty()) return false;
+  // VideoCapture writes into the pooled buffer as long as the frame matches
+  // its dimensions and type, otherwise it would allocate a new one.
+  RET_CHECK(frame.data == pixel_data)
+      << "Decoded frame " << next_frame_ << " is " << frame.cols << "x"
+      << frame.rows << " with " << frame.channels()
+      << " channels, which doesn't match the first frame of the video.";
+  if (format_ == ImageFormat::SRGB) {
+    cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
+  } else if (format_ == ImageFormat::SRGBA) {
+    cv::cvtColor(frame, frame, cv::COLOR_BGRA2RGBA);
+  }
+
+  decoded->stats.set_frame_index(next_frame_);
+  decoded->stats.set_decode_time_usec(
+      absl::ToInt64Microseconds(absl::Now() - start_time));
+  ++next_frame_;
+  return true;
+}
+
+absl::Status PrefetchingVideoDecoderCalculator::Process(
+    CalculatorContext* cc) {
+  const absl::Time start_time = absl::Now();
+  DecodedFrame decoded;
+  {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(
+        this, &PrefetchingVideoDecoderCalculator::HasFrameOrDone));
+    if (queue_.empty()) {
+      MP_RETURN_IF_ERROR(decode_status_);
+      return tool::StatusStop();
+    }
+    decoded = std::move(queue_.front());
+    queue_.pop_front();
+    decoded.stats.set_prefetched_frames(queue_.size());
+  }
+  decoded.stats.set_wait_time_usec(
+      absl::ToInt64Microseconds(absl::Now() - start_time));
+
+  // If the timestamp of the current frame is not greater than the one of the
+  // previous frame, the new frame will be discarded.
+  if (!(prev_timestamp_ < decoded.timestamp)) {
+    return absl::OkStatus();
+  }
+  // The output frame shares the pixels of the pooled buffer, and returns it
+  // to the pool once released.
+  ImageFrame* pooled = decoded.frame.get();
+  auto image_frame = absl::make_unique<ImageFrame>(
+      format_, width_, height_, pooled->WidthStep(),
+      pooled->MutablePixelData(),
+      [buffer = std::move(decoded.frame)](uint8*) {});
+  cc->Outputs().Tag(kVideoTag).Add(image_frame.release(), decoded.timestamp);
+  if (cc->Outputs().HasTag(kStatsTag)) {
+    cc->Outputs().Tag(kStatsTag).AddPacket(
+        MakePacket<VideoDecoderStats>(decoded.stats).At(decoded.timestamp));
+  }
+  prev_timestamp_ = decoded.timestamp;
+  decoded_frames_++;
+  return absl::OkStatus();
+}
+
+absl::Status PrefetchingVideoDecoderCalculator::Close(CalculatorContext* cc) {
+  if (decoder_) {
+    {
+      absl::MutexLock lock(&mutex_);
+      stopping_ = true;
+    }
+    // Waits for the decoding thread to exit.
+    decoder_.reset();
+  }
+  if (cap_ && cap_->isOpened()) {
+    cap_->release();
+  }
+  const int64 expected_frames =
+      (end_frame_ - options_.start_frame() + options_.frame_stride() - 1) /
+      options_.frame_stride();
+  if (decoded_frames_ != expected_frames) {
+    LOG(WARNING) << "Not all the frames are decoded (expected frames: "
+                 << expected_frames
+                 << " vs decoded frames: " << decoded_frames_ << ").";
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,154 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <string>
+#include <vector>
+
+#include "mediapipe/calculators/video/prefetching_video_decoder_calculator.pb.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/video_stream_header.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kVideoTag[] = "VIDEO";
+constexpr char kVideoPrestreamTag[] = "VIDEO_PRESTREAM";
+constexpr char kStatsTag[] = "STATS";
+constexpr char kInputFilePathTag[] = "INPUT_FILE_PATH";
+
+std::string TestVideoPath() {
+  return file::JoinPath("./",
+                        "/mediapipe/calculators/video/"
+                        "testdata/format_FLV_H264_AAC.video");
+}
+
+// Decodes every frame of the test video with OpenCvVideoDecoderCalculator.
+std::vector<Packet> DecodeReferenceFrames() {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "OpenCvVideoDecoderCalculator"
+    input_side_packet: "INPUT_FILE_PATH:input_file_path"
+    output_stream: "VIDEO:video")pb"));
+  runner.MutableSidePackets()->Tag(kInputFilePathTag) =
+      MakePacket<std::string>(TestVideoPath());
+  MP_EXPECT_OK(runner.Run());
+  return runner.Outputs().Tag(kVideoTag).packets;
+}
+
+void ExpectSameFrame(const Packet& expected, const Packet& actual) {
+  cv::Mat expected_mat = formats::MatView(&expected.Get<ImageFrame>());
+  cv::Mat actual_mat = formats::MatView(&actual.Get<ImageFrame>());
+  ASSERT_EQ(expected_mat.size(), actual_mat.size());
+  ASSERT_EQ(expected_mat.type(), actual_mat.type());
+  EXPECT_EQ(cv::norm(expected_mat, actual_mat, cv::NORM_INF), 0);
+}
+
+TEST(PrefetchingVideoDecoderCalculatorTest, MatchesOpenCvVideoDecoder) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "PrefetchingVideoDecoderCalculator"
+    input_side_packet: "INPUT_FILE_PATH:input_file_path"
+    output_stream: "VIDEO:video"
+    output_stream: "VIDEO_PRESTREAM:video_prestream"
+    output_stream: "STATS:stats"
+    options {
+      [mediapipe.PrefetchingVideoDecoderCalculatorOptions.ext] {
+        prefetch_depth: 2
+        pool_size: 2
+      }
+    })pb"));
+  runner.MutableSidePackets()->Tag(kInputFilePathTag) =
+      MakePacket<std::string>(TestVideoPath());
+  MP_ASSERT_OK(runner.Run());
+
+  ASSERT_EQ(runner.Outputs().Tag(kVideoPrestreamTag).packets.size(), 1);
+  const VideoHeader& header =
+      runner.Outputs().Tag(kVideoPrestreamTag).packets[0].Get<VideoHeader>();
+  EXPECT_EQ(ImageFormat::SRGB, header.format);
+  EXPECT_EQ(640, header.width);
+  EXPECT_EQ(320, header.height);
+
+  const std::vector<Packet> expected = DecodeReferenceFrames();
+  const std::vector<Packet>& frames = runner.Outputs().Tag(kVideoTag).packets;
+  const std::vector<Packet>& stats = runner.Outputs().Tag(kStatsTag).packets;
+  ASSERT_EQ(expected.size(), frames.size());
+  ASSERT_EQ(frames.size(), stats.size());
+  for (int i = 0; i < frames.size(); ++i) {
+    EXPECT_EQ(expected[i].Timestamp(), frames[i].Timestamp());
+    ExpectSameFrame(expected[i], frames[i]);
+    EXPECT_EQ(frames[i].Timestamp(), stats[i].Timestamp());
+    EXPECT_EQ(i, stats[i].Get<VideoDecoderStats>().frame_index());
+    EXPECT_LE(stats[i].Get<VideoDecoderStats>().prefetched_frames(), 2);
+  }
+}
+
+TEST(PrefetchingVideoDecoderCalculatorTest, SeeksAndDecodesWithStride) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "PrefetchingVideoDecoderCalculator"
+    input_side_packet: "INPUT_FILE_PATH:input_file_path"
+    output_stream: "VIDEO:video"
+    output_stream: "VIDEO_PRESTREAM:video_prestream"
+    output_stream: "STATS:stats"
+    options {
+      [mediapipe.PrefetchingVideoDecoderCalculatorOptions.ext] {
+        start_frame: 31
+        end_frame: 91
+        frame_stride: 3
+      }
+    })pb"));
+  runner.MutableSidePackets()->Tag(kInputFilePathTag) =
+      MakePacket<std::string>(TestVideoPath());
+  MP_ASSERT_OK(runner.Run());
+
+  const VideoHeader& header =
+      runner.Outputs().Tag(kVideoPrestreamTag).packets[0].Get<VideoHeader>();
+  const std::vector<Packet> expected = DecodeReferenceFrames();
+  ASSERT_EQ(expected.size(), 180);
+  EXPECT_FLOAT_EQ(header.frame_rate * 3 * 6, 180);
+
+  const std::vector<Packet>& frames = runner.Outputs().Tag(kVideoTag).packets;
+  const std::vector<Packet>& stats = runner.Outputs().Tag(kStatsTag).packets;
+  ASSERT_EQ(frames.size(), 20);
+  ASSERT_EQ(stats.size(), 20);
+  for (int i = 0; i < frames.size(); ++i) {
+    const int frame_index = 31 + 3 * i;
+    EXPECT_EQ(frame_index, stats[i].Get<VideoDecoderStats>().frame_index());
+    EXPECT_EQ(expected[frame_index].Timestamp(), frames[i].Timestamp());
+    ExpectSameFrame(expected[frame_index], frames[i]);
+  }
+}
+
+TEST(PrefetchingVideoDecoderCalculatorTest, FailsOnEmptyRange) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "PrefetchingVideoDecoderCalculator"
+    input_side_packet: "INPUT_FILE_PATH:input_file_path"
+    output_stream: "VIDEO:video"
+    options {
+      [mediapipe.PrefetchingVideoDecoderCalculatorOptions.ext] {
+        start_frame: 1000
+      }
+    })pb"));
+  runner.MutableSidePackets()->Tag(kInputFilePathTag) =
+      MakePacket<std::string>(TestVideoPath());
+  EXPECT_FALSE(runner.Run().ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
 #include <fstream>
 #include <map>
 #include <memory>
@@ -26,9 +27,11 @@
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/port/advanced_proto_inc.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/opencv_highgui_inc.h"
 #include "mediapipe/framework/port/proto_ns.h"
 #include "mediapipe/framework/port/status.h"
@@ -80,6 +83,43 @@ bool LoadBinaryTestGraph(const std::string& graph_path,
   return success;
 }
 
+// Crops num_images frames from image, each shifted to the right and bottom by
+// translation_step pixels compared with the previous one.
+void CreateTranslatedFrames(const cv::Mat& image, int num_images,
+                            int translation_step, int frame_interval_us,
+                            std::vector<Packet>* frame_packets) {
+  const int crop_width = image.cols - num_images * translation_step;
+  const int crop_height = image.rows - num_images * translation_step;
+  for (int i = 0; i < num_images; ++i) {
+    cv::Rect roi(i * translation_step, i * translation_step, crop_width,
+                 crop_height);
+    cv::Mat cropped_img = cv::Mat(image, roi);
+    auto cropped_image_frame = absl::make_unique<ImageFrame>(
+        ImageFormat::SRGB, crop_width, crop_height, cropped_img.step[0],
+        cropped_img.data, ImageFrame::PixelDataDeleter::kNone);
+    Timestamp curr_timestamp = Timestamp(i * frame_interval_us);
+    Packet image_packet =
+        Adopt(cropped_image_frame.release()).At(curr_timestamp);
+    frame_packets->push_back(image_packet);
+  }
+}
+
+// Returns side packets for tracker.binarypb with the passed box tracker
+// options.
+std::map<std::string, Packet> TrackerSidePackets(
+    const BoxTrackerCalculatorOptions& box_tracker_options) {
+  CalculatorOptions calculator_options;
+  *calculator_options.MutableExtension(BoxTrackerCalculatorOptions::ext) =
+      box_tracker_options;
+  std::map<std::string, Packet> side_packets;
+  side_packets.insert(std::make_pair("analysis_downsample_factor",
+                                     mediapipe::MakePacket<float>(1.0f)));
+  side_packets.insert(std::make_pair(
+      "calculator_options",
+      mediapipe::MakePacket<CalculatorOptions>(calculator_options)));
+  return side_packets;
+}
+
 class TrackingGraphTest : public Test {
  protected:
   TrackingGraphTest() {}
@@ -282,20 +322,8 @@ std::unique_ptr<TimedBoxProtoList> TrackingGraphTest::MakeBoxList(
 void TrackingGraphTest::CreateInputFramesFromOriginalImage(
     int num_images, int translation_step,
     std::vector<Packet>* input_frames_packets) {
-  const int crop_width = original_image_.cols - num_images * translation_step;
-  const int crop_height = original_image_.rows - num_images * translation_step;
-  for (int i = 0; i < num_images; ++i) {
-    cv::Rect roi(i * translation_step, i * translation_step, crop_width,
-                 crop_height);
-    cv::Mat cropped_img = cv::Mat(original_image_, roi);
-    auto cropped_image_frame = absl::make_unique<ImageFrame>(
-        ImageFormat::SRGB, crop_width, crop_height, cropped_img.step[0],
-        cropped_img.data, ImageFrame::PixelDataDeleter::kNone);
-    Timestamp curr_timestamp = Timestamp(i * kFrameIntervalUs);
-    Packet image_packet =
-        Adopt(cropped_image_frame.release()).At(curr_timestamp);
-    input_frames_packets->push_back(image_packet);
-  }
+  CreateTranslatedFrames(original_image_, num_images, translation_step,
+                         kFrameIntervalUs, input_frames_packets);
 }
 
 void TrackingGraphTest::RunGraphWithSidePacketsAndInputs(
@@ -703,7 +731,140 @@ TEST_F(TrackingGraphTest, TestTransitionFramesForReacquisition) {
   }
 }
 
+TEST_F(TrackingGraphTest, ParallelTrackingOfManyBoxes) {
+  constexpr int kNumBoxes = 32;
+  const std::vector<bool> is_quad_tracking(kNumBoxes, false);
+  const std::vector<bool> is_pnp_tracking(kNumBoxes, false);
+  const std::vector<bool> is_reacquisition(kNumBoxes, false);
+
+  // Boxes output per frame, for sequential and parallel tracking.
+  std::vector<std::vector<Packet>> box_packets(2);
+  for (const bool parallel : {false, true}) {
+    CalculatorGraphConfig config = config_;
+    for (auto& node : *config.mutable_node()) {
+      if (node.calculator() == "BoxTrackerCalculator") {
+        node.add_output_stream("TRACK_TIMES:track_times");
+      }
+    }
+    std::vector<Packet> track_times_packets;
+    tool::AddVectorSink("boxes", &config, &box_packets[parallel]);
+    tool::AddVectorSink("track_times", &config, &track_times_packets);
+    CalculatorGraph graph;
+    MP_ASSERT_OK(graph.Initialize(config));
+
+    BoxTrackerCalculatorOptions options;
+    options.set_track_boxes_in_parallel(parallel);
+    MP_ASSERT_OK(graph.StartRun(TrackerSidePackets(options)));
+
+    const Timestamp start_box_time = input_frames_packets_[0].Timestamp();
+    auto start_box_list = MakeBoxList(start_box_time, is_quad_tracking,
+                                      is_pnp_tracking, is_reacquisition);
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "start_pos", Adopt(start_box_list.release()).At(start_box_time)));
+    for (const auto& frame_packet : input_frames_packets_) {
+      MP_ASSERT_OK(
+          graph.AddPacketToInputStream("image_cpu_frames", frame_packet));
+      MP_ASSERT_OK(graph.WaitUntilIdle());
+    }
+    MP_ASSERT_OK(graph.CloseAllInputStreams());
+    MP_ASSERT_OK(graph.WaitUntilDone());
+
+    ASSERT_EQ(input_frames_packets_.size(), box_packets[parallel].size());
+    for (int i = 0; i < box_packets[parallel].size(); ++i) {
+      const TimedBoxProtoList& boxes =
+          box_packets[parallel][i].Get<TimedBoxProtoList>();
+      ASSERT_EQ(kNumBoxes, boxes.box_size());
+      for (const TimedBoxProto& box : boxes.box()) {
+        ExpectBoxAtFrame(box, i, false);
+      }
+    }
+
+    // Track times are reported for every box tracked by a TRACKING frame,
+    // i.e. all frames after the first one.
+    ASSERT_EQ(input_frames_packets_.size() - 1, track_times_packets.size());
+    for (const Packet& packet : track_times_packets) {
+      const auto& track_times = packet.Get<std::map<int, int64>>();
+      EXPECT_EQ(kNumBoxes, track_times.size());
+      for (const auto& track_time : track_times) {
+        EXPECT_GE(track_time.second, 0);
+      }
+    }
+  }
+
+  // Boxes are tracked independently, parallel tracking yields identical
+  // results.
+  for (int i = 0; i < box_packets[0].size(); ++i) {
+    const TimedBoxProtoList& sequential =
+        box_packets[0][i].Get<TimedBoxProtoList>();
+    const TimedBoxProtoList& parallel =
+        box_packets[1][i].Get<TimedBoxProtoList>();
+    ASSERT_EQ(sequential.box_size(), parallel.box_size());
+    for (int j = 0; j < sequential.box_size(); ++j) {
+      EXPECT_EQ(sequential.box(j).SerializeAsString(),
+                parallel.box(j).SerializeAsString());
+    }
+  }
+}
+
 // TODO: Add test for reacquisition.
 
+// Tracks a grid of state.range(0) boxes through the tracker graph, in parallel
+// if state.range(1) is non-zero.
+void BM_TrackManyBoxes(benchmark::State& state) {
+  const int num_boxes = state.range(0);
+  const std::string test_dir = GetTestDir();
+  CalculatorGraphConfig config;
+  CHECK(LoadBinaryTestGraph(file::JoinPath(test_dir, "tracker.binarypb"),
+                            &config));
+  const cv::Mat image = cv::imread(file::JoinPath(test_dir, "lenna.png"));
+  constexpr int kNumFrames = 8;
+  constexpr int kFrameIntervalUs = 30000;
+  std::vector<Packet> frame_packets;
+  CreateTranslatedFrames(image, kNumFrames, 10, kFrameIntervalUs,
+                         &frame_packets);
+
+  // Small boxes distributed over the frame on a regular grid.
+  const int grid_size = std::ceil(std::sqrt(num_boxes));
+  const float step = 0.8f / grid_size;
+  TimedBoxProtoList box_list;
+  for (int k = 0; k < num_boxes; ++k) {
+    TimedBoxProto* box = box_list.add_box();
+    box->set_left(0.1f + (k % grid_size) * step);
+    box->set_top(0.1f + (k / grid_size) * step);
+    box->set_right(box->left() + 0.75f * step);
+    box->set_bottom(box->top() + 0.75f * step);
+    box->set_id(k);
+    box->set_time_msec(0);
+  }
+
+  BoxTrackerCalculatorOptions options;
+  options.set_track_boxes_in_parallel(state.range(1) != 0);
+  const auto side_packets = TrackerSidePackets(options);
+
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    CHECK(graph.Initialize(config).ok());
+    CHECK(graph.StartRun(side_packets).ok());
+    CHECK(graph
+              .AddPacketToInputStream(
+                  "start_pos", MakePacket<TimedBoxProtoList>(box_list).At(
+                                   frame_packets[0].Timestamp()))
+              .ok());
+    for (const auto& frame_packet : frame_packets) {
+      CHECK(graph.AddPacketToInputStream("image_cpu_frames", frame_packet)
+                .ok());
+    }
+    CHECK(graph.CloseAllInputStreams().ok());
+    CHECK(graph.WaitUntilDone().ok());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumFrames * num_boxes);
+}
+// Args: number of boxes, parallel tracking.
+BENCHMARK(BM_TrackManyBoxes)
+    ->Args({64, 0})
+    ->Args({64, 1})
+    ->Args({256, 0})
+    ->Args({256, 1});
+
 }  // namespace
 }  // namespace mediapipe
@@ -15,11 +15,13 @@
 // This Calculator takes an ImageFrame and scales it appropriately.
 
 #include <algorithm>
+#include <cmath>
 #include <memory>
 #include <vector>
 
 #include "mediapipe/examples/desktop/autoflip/autoflip_messages.pb.h"
 #include "mediapipe/examples/desktop/autoflip/calculators/border_detection_calculator.pb.h"
+#include "mediapipe/examples/desktop/autoflip/quality/frame_analysis.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
@@ -39,6 +41,7 @@ constexpr int kMinBorderDistance = 5;
 constexpr int kKMeansClusterCount = 4;
 constexpr int kMaxPixelsToProcess = 300000;
 constexpr char kVideoInputTag[] = "VIDEO";
+constexpr char kAnalysisInputTag[] = "ANALYSIS";
 
 namespace mediapipe {
 namespace autoflip {
@@ -60,6 +63,9 @@ void SetRect(const cv::Rect& region,
 // This calculator takes a sequence of images (video) and detects solid color
 // borders as well as the dominant color of the non-border area.  This per-frame
 // information is passed to downstream calculators.
+//
+// An optional ANALYSIS input from a FrameAnalysisCalculator run on the same
+// frames lets the dominant color be found on the already downsampled frame.
 class BorderDetectionCalculator : public CalculatorBase {
  public:
   BorderDetectionCalculator() : frame_width_(-1), frame_height_(-1) {}
@@ -153,10 +159,32 @@ absl::Status BorderDetectionCalculator::Process(
   DetectBorder(frame, seed_color_bottom, Border::BOTTOM, features.get());
 
   // Check the non-border area for a dominant color.
-  cv::Mat non_static_frame = frame(
-      cv::Rect(features->non_static_area().x(), features->non_static_area().y(),
-               features->non_static_area().width(),
-               features->non_static_area().height()));
+  cv::Rect non_static_area(
+      features->non_static_area().x(), features->non_static_area().y(),
+      features->non_static_area().width(),
+      features->non_static_area().height());
+  cv::Mat non_static_frame = frame(non_static_area);
+  if (cc->Inputs().HasTag(kAnalysisInputTag) &&
+      !cc->Inputs().Tag(kAnalysisInputTag).IsEmpty()) {
+    const auto& analysis =
+        cc->Inputs().Tag(kAnalysisInputTag).Get<FrameAnalysis>();
+    RET_CHECK(analysis.frame_size == frame.size())
+        << "ANALYSIS must be computed on the VIDEO frames.";
+    if (!analysis.downsampled.empty()) {
+      const double scale_x =
+          analysis.downsampled.cols / static_cast<double>(frame.cols);
+      const double scale_y =
+          analysis.downsampled.rows / static_cast<double>(frame.rows);
+      const int x0 = std::round(non_static_area.x * scale_x);
+      const int y0 = std::round(non_static_area.y * scale_y);
+      const int x1 = std::round(non_static_area.br().x * scale_x);
+      const int y1 = std::round(non_static_area.br().y * scale_y);
+      if (x1 > x0 && y1 > y0) {
+        non_static_frame =
+            analysis.downsampled(cv::Rect(x0, y0, x1 - x0, y1 - y0));
+      }
+    }
+  }
   Color dominant_color_nonborder;
   double dominant_color_percent =
       FindDominantColor(non_static_frame, &dominant_color_nonborder);
@@ -212,18 +240,19 @@ double BorderDetectionCalculator::FindDominantColor(const cv::Mat& image_raw,
 
 double BorderDetectionCalculator::ColorCount(const Color& mask_color,
                                              const cv::Mat& image) const {
+  // Branch-free count over plain ints, so the compiler can vectorize the
+  // inner loop.
+  const int r = mask_color.r();
+  const int g = mask_color.g();
+  const int b = mask_color.b();
+  const int tolerance = options_.color_tolerance();
   int background_count = 0;
   for (int i = 0; i < image.rows; i++) {
     const uint8* row_ptr = image.ptr<uint8>(i);
     for (int j = 0; j < image.cols * 3; j += 3) {
-      if (std::abs(mask_color.r() - static_cast<int>(row_ptr[j + 2])) <=
-              options_.color_tolerance() &&
-          std::abs(mask_color.g() - static_cast<int>(row_ptr[j + 1])) <=
-              options_.color_tolerance() &&
-          std::abs(mask_color.b() - static_cast<int>(row_ptr[j])) <=
-              options_.color_tolerance()) {
-        background_count++;
-      }
+      background_count += (std::abs(r - row_ptr[j + 2]) <= tolerance) &
+                          (std::abs(g - row_ptr[j + 1]) <= tolerance) &
+                          (std::abs(b - row_ptr[j]) <= tolerance);
     }
   }
   return background_count / static_cast<double>(image.rows * image.cols);
@@ -293,6 +322,9 @@ void BorderDetectionCalculator::DetectBorder(
 absl::Status BorderDetectionCalculator::GetContract(
     mediapipe::CalculatorContract* cc) {
   cc->Inputs().Tag(kVideoInputTag).Set<ImageFrame>();
+  if (cc->Inputs().HasTag(kAnalysisInputTag)) {
+    cc->Inputs().Tag(kAnalysisInputTag).Set<FrameAnalysis>();
+  }
   cc->Outputs().Tag(kDetectedBorders).Set<StaticFeatures>();
   return absl::OkStatus();
 }
@@ -0,0 +1,81 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/examples/desktop/autoflip/calculators/frame_analysis_calculator.pb.h"
+#include "mediapipe/examples/desktop/autoflip/quality/frame_analysis.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace autoflip {
+
+constexpr char kVideoInputTag[] = "VIDEO";
+constexpr char kAnalysisOutputTag[] = "ANALYSIS";
+
+// This calculator analyzes every frame of a video once for the AutoFlip
+// calculators that accept an ANALYSIS input, so that they share the
+// downsampled frame and its color histogram instead of each computing their
+// own. Frames larger than max_pixels are downsampled first.
+//
+// Example:
+//  node {
+//    calculator: "FrameAnalysisCalculator"
+//    input_stream: "VIDEO:video_frames"
+//    output_stream: "ANALYSIS:frame_analysis"
+//  }
+//  node {
+//    calculator: "ShotBoundaryCalculator"
+//    input_stream: "ANALYSIS:frame_analysis"
+//    output_stream: "IS_SHOT_CHANGE:is_shot"
+//  }
+class FrameAnalysisCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Tag(kVideoInputTag).Set<ImageFrame>();
+    cc->Outputs().Tag(kAnalysisOutputTag).Set<FrameAnalysis>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    options_ = cc->Options<FrameAnalysisCalculatorOptions>();
+    RET_CHECK_GE(options_.max_pixels(), 0);
+    cc->SetOffset(TimestampDiff(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    const cv::Mat frame = formats::MatView(
+        &cc->Inputs().Tag(kVideoInputTag).Get<ImageFrame>());
+    auto analysis = absl::make_unique<FrameAnalysis>();
+    MP_RETURN_IF_ERROR(
+        AnalyzeFrame(frame, options_.max_pixels(), analysis.get()));
+    cc->Outputs()
+        .Tag(kAnalysisOutputTag)
+        .Add(analysis.release(), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+
+ private:
+  FrameAnalysisCalculatorOptions options_;
+};
+REGISTER_CALCULATOR(FrameAnalysisCalculator);
+
+}  // namespace autoflip
+}  // namespace mediapipe
@@ -14,6 +14,7 @@
 
 #include "mediapipe/examples/desktop/autoflip/calculators/scene_cropping_calculator.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "absl/memory/memory.h"
@@ -145,6 +146,16 @@ absl::Status SceneCroppingCalculator::Open(CalculatorContext* cc) {
       << "Maximum scene size is non-positive.";
   RET_CHECK_GE(options_.prior_frame_buffer_size(), 0)
       << "Prior frame buffer size is negative.";
+  RET_CHECK_GE(options_.streaming_window_size(), 0)
+      << "Streaming window size is negative.";
+  RET_CHECK(options_.streaming_window_size() == 0 ||
+            options_.camera_motion_options().has_kinematic_options())
+      << "Streaming window size requires kinematic camera motion options.";
+  max_buffered_frames_ = options_.max_scene_size();
+  if (options_.streaming_window_size() > 0) {
+    max_buffered_frames_ =
+        std::min(max_buffered_frames_, options_.streaming_window_size());
+  }
 
   RET_CHECK(options_.solid_background_frames_padding_fraction() >= 0.0 &&
             options_.solid_background_frames_padding_fraction() <= 1.0)
@@ -377,13 +388,14 @@ absl::Status SceneCroppingCalculator::Process(
 
   // Saves frame and timestamp and whether it is a key frame.
   if (HasFrameSignal(cc)) {
-    // Only buffer frames if |should_perform_frame_cropping_| is true.
+    // Only buffer frames if |should_perform_frame_cropping_| is true. Frames
+    // are not copied: the packet is kept and the buffered frame is a view of
+    // it. Frames are never drawn on in place.
     if (should_perform_frame_cropping_) {
-      const auto& frame = cc->Inputs().Tag(kInputVideoFrames).Get<ImageFrame>();
-      const cv::Mat frame_mat = formats::MatView(&frame);
-      cv::Mat copy_mat;
-      frame_mat.copyTo(copy_mat);
-      scene_frames_or_empty_.push_back(copy_mat);
+      const Packet& packet = cc->Inputs().Tag(kInputVideoFrames).Value();
+      scene_frames_or_empty_.push_back(
+          formats::MatView(&packet.Get<ImageFrame>()));
+      scene_frame_packets_.push_back(packet);
     }
     scene_frame_timestamps_.push_back(cc->InputTimestamp().Value());
     is_key_frames_.push_back(
@@ -410,7 +422,7 @@ absl::Status SceneCroppingCalculator::Process(
   }
 
   const bool force_buffer_flush =
-      scene_frame_timestamps_.size() >= options_.max_scene_size();
+      scene_frame_timestamps_.size() >= max_buffered_frames_;
   if (!scene_frame_timestamps_.empty() && force_buffer_flush) {
     MP_RETURN_IF_ERROR(ProcessScene(is_end_of_scene, cc));
     continue_last_scene_ = true;
@@ -440,10 +452,19 @@ absl::Status SceneCroppingCalculator::Close(mediapipe::CalculatorContext* cc) {
 // sizes, the other for the actual removal of borders from the frames.
 absl::Status SceneCroppingCalculator::RemoveStaticBorders(
     CalculatorContext* cc, int* top_border_size, int* bottom_border_size) {
-  *top_border_size = 0;
-  *bottom_border_size = 0;
-  MP_RETURN_IF_ERROR(ComputeSceneStaticBordersSize(
-      static_features_, top_border_size, bottom_border_size));
+  if (options_.streaming_window_size() > 0 && continue_last_scene_) {
+    // Keeps the borders of the first window of the scene, so that the crop
+    // does not jump between windows.
+    *top_border_size = scene_top_border_size_;
+    *bottom_border_size = scene_bottom_border_size_;
+  } else {
+    *top_border_size = 0;
+    *bottom_border_size = 0;
+    MP_RETURN_IF_ERROR(ComputeSceneStaticBordersSize(
+        static_features_, top_border_size, bottom_border_size));
+    scene_top_border_size_ = *top_border_size;
+    scene_bottom_border_size_ = *bottom_border_size;
+  }
   const double scale = static_cast<double>(frame_height_) / key_frame_height_;
   top_border_distance_ = std::round(scale * *top_border_size);
   const int bottom_border_distance = std::round(scale * *bottom_border_size);
@@ -565,6 +586,15 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
           effective_frame_height_, scene_frame_timestamps_,
           has_solid_background_, &scene_summary, &focus_point_frames,
           &scene_camera_motion));
+  if (options_.streaming_window_size() > 0) {
+    if (continue_last_scene_) {
+      scene_summary.set_crop_window_width(scene_crop_window_width_);
+      scene_summary.set_crop_window_height(scene_crop_window_height_);
+    } else {
+      scene_crop_window_width_ = scene_summary.crop_window_width();
+      scene_crop_window_height_ = scene_summary.crop_window_height();
+    }
+  }
 
   // Crops scene frames.
   std::vector<cv::Mat> cropped_frames;
@@ -647,6 +677,8 @@ absl::Status SceneCroppingCalculator::ProcessScene(const bool is_end_of_scene,
 
   key_frame_infos_.clear();
   scene_frames_or_empty_.clear();
+  raw_scene_frames_or_empty_.clear();
+  scene_frame_packets_.clear();
   scene_frame_timestamps_.clear();
   is_key_frames_.clear();
   static_features_.clear();
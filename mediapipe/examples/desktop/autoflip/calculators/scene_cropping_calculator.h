@@ -67,6 +67,11 @@ namespace autoflip {
 // the scene using a Retargeter, which solves linear programming problems
 // through a L1 path solver (default) or least squares problems through a L2
 // path solver.
+//
+// By default a scene is buffered in full, up to max_scene_size frames, before
+// it is cropped. With the kinematic camera model, streaming_window_size can be
+// set to crop scenes in windows of a few frames instead, which bounds memory
+// use and latency regardless of the scene length.
 
 // Input streams:
 // - required tag VIDEO_FRAMES (type ImageFrame):
@@ -134,7 +139,8 @@ class SceneCroppingCalculator : public CalculatorBase {
   // Buffers each scene frame and its timestamp. Packs and stores KeyFrameInfo
   // for key frames (a.k.a. frames with detection features). When a shot
   // boundary is encountered or when the buffer is full, calls ProcessScene()
-  // to process the scene at once, and clears buffers.
+  // to process the scene at once, and clears buffers. In streaming mode the
+  // buffer is full after streaming_window_size frames.
   absl::Status Process(CalculatorContext* cc) override;
 
   // Calls ProcessScene() on remaining buffered frames. Optionally outputs a
@@ -226,6 +232,13 @@ class SceneCroppingCalculator : public CalculatorBase {
   std::vector<cv::Mat> raw_scene_frames_or_empty_;
   std::vector<int64> scene_frame_timestamps_;
   std::vector<bool> is_key_frames_;
+  // Input packets backing scene_frames_or_empty_, which are views of their
+  // frames rather than copies.
+  std::vector<Packet> scene_frame_packets_;
+
+  // Number of frames after which the buffers are flushed even if there is no
+  // shot boundary.
+  int max_buffered_frames_ = -1;
 
   // Static border information for the scene.
   int top_border_distance_ = -1;
@@ -238,6 +251,13 @@ class SceneCroppingCalculator : public CalculatorBase {
   // forced flush when buffer is full).
   bool continue_last_scene_ = false;
 
+  // Static border sizes and crop window size found on the first window of the
+  // current scene, kept for its later windows in streaming mode.
+  int scene_top_border_size_ = 0;
+  int scene_bottom_border_size_ = 0;
+  int scene_crop_window_width_ = -1;
+  int scene_crop_window_height_ = -1;
+
   // KeyFrameCropOptions used by the FrameCropRegionComputer.
   KeyFrameCropOptions key_frame_crop_options_;
 
@@ -920,6 +920,66 @@ TEST(SceneCroppingCalculatorTest, OutputsCropMessageKinematicPathNoVideo) {
     EXPECT_EQ(ext_render_message.render_to_location().height(), 1124);
   }
 }
+
+// Checks that streaming requires the kinematic path solver.
+TEST(SceneCroppingCalculatorTest, ChecksStreamingCameraMotion) {
+  CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+          absl::Substitute(kDebugConfig, kTargetWidth, kTargetHeight));
+  config.mutable_options()
+      ->MutableExtension(SceneCroppingCalculatorOptions::ext)
+      ->set_streaming_window_size(4);
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  const auto status = runner->Run();
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.ToString(), HasSubstr("requires kinematic"));
+}
+
+// Checks that in streaming mode a scene is cropped in windows, with the crop
+// window kept across the windows of the scene.
+TEST(SceneCroppingCalculatorTest, StreamsSceneInWindows) {
+  CalculatorGraphConfig::Node config =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+          absl::Substitute(kDebugConfig, kTargetWidth, kTargetHeight));
+  auto* options = config.mutable_options()->MutableExtension(
+      SceneCroppingCalculatorOptions::ext);
+  options->set_streaming_window_size(4);
+  auto* kinematic_options =
+      options->mutable_camera_motion_options()->mutable_kinematic_options();
+  kinematic_options->set_min_motion_to_reframe(1.2);
+  kinematic_options->set_max_velocity(200);
+
+  auto runner = absl::make_unique<CalculatorRunner>(config);
+  const int num_frames = 12;
+  AddScene(0, num_frames, kInputFrameWidth, kInputFrameHeight, kKeyFrameWidth,
+           kKeyFrameHeight, 1, runner->MutableInputs());
+
+  MP_EXPECT_OK(runner->Run());
+  CheckCroppedFrames(*runner, num_frames, kTargetWidth, kTargetHeight);
+  const auto& outputs = runner->Outputs();
+  // Two full windows, the rest of the scene up to the shot boundary, and the
+  // frame of the shot boundary.
+  const auto& summary =
+      outputs.Tag(kCroppingSummaryTag).packets[0].Get<VideoCroppingSummary>();
+  ASSERT_EQ(summary.scene_summaries_size(), 4);
+  EXPECT_FALSE(summary.scene_summaries(0).is_end_of_scene());
+  EXPECT_FALSE(summary.scene_summaries(1).is_end_of_scene());
+  EXPECT_TRUE(summary.scene_summaries(2).is_end_of_scene());
+
+  const auto& ext_render_per_frame =
+      outputs.Tag(kExternalRenderingPerFrameTag).packets;
+  ASSERT_EQ(ext_render_per_frame.size(), num_frames);
+  const auto& first_crop = ext_render_per_frame[0]
+                               .Get<ExternalRenderFrame>()
+                               .crop_from_location();
+  for (int i = 1; i < num_frames - 1; ++i) {
+    const auto& crop = ext_render_per_frame[i]
+                           .Get<ExternalRenderFrame>()
+                           .crop_from_location();
+    EXPECT_EQ(crop.width(), first_crop.width());
+    EXPECT_EQ(crop.height(), first_crop.height());
+  }
+}
 }  // namespace
 }  // namespace autoflip
 }  // namespace mediapipe
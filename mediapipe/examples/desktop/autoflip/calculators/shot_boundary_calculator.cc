@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "mediapipe/examples/desktop/autoflip/calculators/shot_boundary_calculator.pb.h"
+#include "mediapipe/examples/desktop/autoflip/quality/frame_analysis.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
@@ -32,22 +33,19 @@ using mediapipe::PacketTypeSet;
 
 // IO labels.
 constexpr char kVideoInputTag[] = "VIDEO";
+constexpr char kAnalysisInputTag[] = "ANALYSIS";
 constexpr char kShotChangeTag[] = "IS_SHOT_CHANGE";
-// Histogram settings.
-const int kSaturationBins = 8;
-const int kHistogramChannels[] = {0, 1, 2};
-const int kHistogramBinNum[] = {kSaturationBins, kSaturationBins,
-                                kSaturationBins};
-const float kRange[] = {0, 256};
-const float* kHistogramRange[] = {kRange, kRange, kRange};
 
 namespace mediapipe {
 namespace autoflip {
 
 // This calculator computes a shot (or scene) change within a video.  It works
-// by computing a 3d color histogram and comparing this frame-to-frame. Settings
+// by computing a color histogram and comparing this frame-to-frame. Settings
 // to control the shot change logic are presented in the options proto.
 //
+// Instead of VIDEO, the calculator can take the ANALYSIS output of a
+// FrameAnalysisCalculator and reuse its histogram.
+//
 // Example:
 //  node {
 //    calculator: "ShotBoundaryCalculator"
@@ -65,8 +63,10 @@ class ShotBoundaryCalculator : public mediapipe::CalculatorBase {
   absl::Status Process(mediapipe::CalculatorContext* cc) override;
 
  private:
-  // Computes the histogram of an image.
-  void ComputeHistogram(const cv::Mat& image, cv::Mat* image_histogram);
+  // Computes the histogram of the current frame, or takes it from the frame
+  // analysis.
+  absl::Status ComputeHistogram(mediapipe::CalculatorContext* cc,
+                                cv::Mat* image_histogram);
   // Transmits signal to next calculator.
   void Transmit(mediapipe::CalculatorContext* cc, bool is_shot_change);
   // Calculator options.
@@ -82,24 +82,27 @@ class ShotBoundaryCalculator : public mediapipe::CalculatorBase {
 };
 REGISTER_CALCULATOR(ShotBoundaryCalculator);
 
-void ShotBoundaryCalculator::ComputeHistogram(const cv::Mat& image,
-                                              cv::Mat* image_histogram) {
-  cv::Mat equalized_image;
-  cv::cvtColor(image.clone(), equalized_image, cv::COLOR_RGB2GRAY);
-
-  double min, max;
-  cv::minMaxLoc(equalized_image, &min, &max);
-
-  if (options_.equalize_histogram()) {
-    cv::equalizeHist(equalized_image, equalized_image);
+absl::Status ShotBoundaryCalculator::ComputeHistogram(
+    mediapipe::CalculatorContext* cc, cv::Mat* image_histogram) {
+  if (cc->Inputs().HasTag(kAnalysisInputTag)) {
+    *image_histogram = cc->Inputs()
+                           .Tag(kAnalysisInputTag)
+                           .Get<FrameAnalysis>()
+                           .color_histogram;
+    return absl::OkStatus();
   }
-
-  cv::calcHist(&image, 1, kHistogramChannels, cv::Mat(), *image_histogram, 2,
-               kHistogramBinNum, kHistogramRange, true, false);
+  // The histogram is read straight from the input frame, without copying it.
+  const cv::Mat frame = mediapipe::formats::MatView(
+      &cc->Inputs().Tag(kVideoInputTag).Get<ImageFrame>());
+  return ComputeColorHistogram(
+      frame,
+      ColorHistogramStep(frame.size(), options_.max_histogram_pixels()),
+      image_histogram);
 }
 
 absl::Status ShotBoundaryCalculator::Open(mediapipe::CalculatorContext* cc) {
   options_ = cc->Options<ShotBoundaryCalculatorOptions>();
+  RET_CHECK_GE(options_.max_histogram_pixels(), 0);
   last_shot_timestamp_ = Timestamp(0);
   init_ = false;
   return absl::OkStatus();
@@ -127,14 +130,9 @@ void ShotBoundaryCalculator::Transmit(mediapipe::CalculatorContext* cc,
 }
 
 absl::Status ShotBoundaryCalculator::Process(mediapipe::CalculatorContext* cc) {
-  // Connect to input frame and make a mutable copy.
-  cv::Mat frame_org = mediapipe::formats::MatView(
-      &cc->Inputs().Tag(kVideoInputTag).Get<ImageFrame>());
-  cv::Mat frame = frame_org.clone();
-
   // Extract histogram from the current frame.
   cv::Mat current_histogram;
-  ComputeHistogram(frame, &current_histogram);
+  MP_RETURN_IF_ERROR(ComputeHistogram(cc, &current_histogram));
 
   if (!init_) {
     last_histogram_ = current_histogram;
@@ -179,7 +177,14 @@ absl::Status ShotBoundaryCalculator::Process(mediapipe::CalculatorContext* cc) {
 
 absl::Status ShotBoundaryCalculator::GetContract(
     mediapipe::CalculatorContract* cc) {
-  cc->Inputs().Tag(kVideoInputTag).Set<ImageFrame>();
+  RET_CHECK(cc->Inputs().HasTag(kVideoInputTag) !=
+            cc->Inputs().HasTag(kAnalysisInputTag))
+      << "Exactly one of VIDEO and ANALYSIS must be set.";
+  if (cc->Inputs().HasTag(kVideoInputTag)) {
+    cc->Inputs().Tag(kVideoInputTag).Set<ImageFrame>();
+  } else {
+    cc->Inputs().Tag(kAnalysisInputTag).Set<FrameAnalysis>();
+  }
   cc->Outputs().Tag(kShotChangeTag).Set<bool>();
   return absl::OkStatus();
 }
@@ -15,6 +15,7 @@
 #include "absl/flags/flag.h"
 #include "absl/strings/string_view.h"
 #include "mediapipe/examples/desktop/autoflip/calculators/shot_boundary_calculator.pb.h"
+#include "mediapipe/examples/desktop/autoflip/quality/frame_analysis.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
@@ -45,12 +46,23 @@ namespace {
 
 constexpr char kIsShotChangeTag[] = "IS_SHOT_CHANGE";
 constexpr char kVideoTag[] = "VIDEO";
+constexpr char kAnalysisTag[] = "ANALYSIS";
 
 const char kConfig[] = R"(
     calculator: "ShotBoundaryCalculator"
     input_stream: "VIDEO:camera_frames"
     output_stream: "IS_SHOT_CHANGE:is_shot"
     )";
+const char kAnalysisConfig[] = R"(
+    calculator: "ShotBoundaryCalculator"
+    input_stream: "ANALYSIS:frame_analysis"
+    output_stream: "IS_SHOT_CHANGE:is_shot"
+    options {
+      [mediapipe.autoflip.ShotBoundaryCalculatorOptions.ext] {
+        output_only_on_change: false
+      }
+    }
+    )";
 const int kTestFrameWidth = 640;
 const int kTestFrameHeight = 480;
 
@@ -162,6 +174,45 @@ TEST(ShotBoundaryCalculatorTest, ShotChangeSingleOnOnChange) {
   ASSERT_EQ(output_packets[0].Timestamp().Value(), 15000000);
 }
 
+TEST(ShotBoundaryCalculatorTest, ShotChangeFromFrameAnalysis) {
+  CalculatorGraphConfig::Node node =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(kConfig);
+  node.mutable_options()
+      ->MutableExtension(ShotBoundaryCalculatorOptions::ext)
+      ->set_output_only_on_change(false);
+  CalculatorRunner video_runner(node);
+  AddFrames(20, {10}, &video_runner);
+
+  CalculatorRunner analysis_runner(
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(kAnalysisConfig));
+  const auto& frames = video_runner.MutableInputs()->Tag(kVideoTag).packets;
+  for (const Packet& packet : frames) {
+    auto analysis = absl::make_unique<FrameAnalysis>();
+    MP_ASSERT_OK(AnalyzeFrame(
+        mediapipe::formats::MatView(&packet.Get<ImageFrame>()),
+        /*max_pixels=*/0, analysis.get()));
+    analysis_runner.MutableInputs()->Tag(kAnalysisTag).packets.push_back(
+        Adopt(analysis.release()).At(packet.Timestamp()));
+  }
+  MP_ASSERT_OK(analysis_runner.Run());
+  CheckOutput(20, {10},
+              analysis_runner.Outputs().Tag(kIsShotChangeTag).packets);
+}
+
+TEST(ShotBoundaryCalculatorTest, ShotChangeSubsampled) {
+  CalculatorGraphConfig::Node node =
+      ParseTextProtoOrDie<CalculatorGraphConfig::Node>(kConfig);
+  auto* options = node.mutable_options()->MutableExtension(
+      ShotBoundaryCalculatorOptions::ext);
+  options->set_output_only_on_change(false);
+  options->set_max_histogram_pixels(kTestFrameWidth * kTestFrameHeight / 4);
+  auto runner = ::absl::make_unique<CalculatorRunner>(node);
+
+  AddFrames(20, {10}, runner.get());
+  MP_ASSERT_OK(runner->Run());
+  CheckOutput(20, {10}, runner->Outputs().Tag(kIsShotChangeTag).packets);
+}
+
 }  // namespace
 }  // namespace autoflip
 }  // namespace mediapipe
@@ -0,0 +1,114 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/examples/desktop/autoflip/quality/frame_analysis.h"
+
+#include <cmath>
+
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+namespace autoflip {
+
+namespace {
+
+constexpr int kBinBits = 3;
+static_assert(1 << kBinBits == kColorHistogramBins,
+              "kBinBits must match kColorHistogramBins");
+constexpr int kNumBins = kColorHistogramBins * kColorHistogramBins;
+// Number of partial histograms counted in an interleaved way.
+constexpr int kNumPartials = 4;
+
+// Index of the bin of a pixel, the same as cv::calcHist uses for a uniform
+// range [0, 256) on 8-bit data.
+inline int Bin(const uint8* pixel) {
+  return ((pixel[0] >> (8 - kBinBits)) << kBinBits) |
+         (pixel[1] >> (8 - kBinBits));
+}
+
+}  // namespace
+
+absl::Status ComputeColorHistogram(const cv::Mat& image, int step,
+                                   cv::Mat* histogram) {
+  RET_CHECK(histogram);
+  RET_CHECK_EQ(image.depth(), CV_8U);
+  RET_CHECK_GE(image.channels(), 2);
+  RET_CHECK_GE(step, 1);
+
+  // Consecutive pixels often fall into the same bin, which would serialize
+  // the increments on a single counter. Counting them into separate partial
+  // histograms keeps the increments independent.
+  uint32 counts[kNumPartials][kNumBins] = {};
+  const int pixel_stride = image.channels() * step;
+  const int row_size = image.cols * image.channels();
+  const int unrolled_size = row_size - (kNumPartials - 1) * pixel_stride;
+  for (int y = 0; y < image.rows; y += step) {
+    const uint8* row = image.ptr<uint8>(y);
+    int i = 0;
+    for (; i < unrolled_size; i += kNumPartials * pixel_stride) {
+      ++counts[0][Bin(row + i)];
+      ++counts[1][Bin(row + i + pixel_stride)];
+      ++counts[2][Bin(row + i + 2 * pixel_stride)];
+      ++counts[3][Bin(row + i + 3 * pixel_stride)];
+    }
+    for (; i < row_size; i += pixel_stride) {
+      ++counts[0][Bin(row + i)];
+    }
+  }
+
+  histogram->create(kColorHistogramBins, kColorHistogramBins, CV_32F);
+  for (int bin = 0; bin < kNumBins; ++bin) {
+    uint32 count = 0;
+    for (int partial = 0; partial < kNumPartials; ++partial) {
+      count += counts[partial][bin];
+    }
+    histogram->at<float>(bin / kColorHistogramBins,
+                         bin % kColorHistogramBins) = count;
+  }
+  return absl::OkStatus();
+}
+
+int ColorHistogramStep(const cv::Size& size, int max_pixels) {
+  if (max_pixels <= 0) {
+    return 1;
+  }
+  int step = 1;
+  while (static_cast<int64>((size.width + step - 1) / step) *
+             ((size.height + step - 1) / step) >
+         max_pixels) {
+    ++step;
+  }
+  return step;
+}
+
+absl::Status AnalyzeFrame(const cv::Mat& frame, int max_pixels,
+                          FrameAnalysis* analysis) {
+  RET_CHECK(analysis);
+  analysis->frame_size = frame.size();
+  if (max_pixels > 0 && frame.total() > static_cast<size_t>(max_pixels)) {
+    const double scale =
+        std::sqrt(max_pixels / static_cast<double>(frame.total()));
+    cv::resize(frame, analysis->downsampled, cv::Size(), scale, scale,
+               cv::INTER_AREA);
+    return ComputeColorHistogram(analysis->downsampled, 1,
+                                 &analysis->color_histogram);
+  }
+  analysis->downsampled.release();
+  return ComputeColorHistogram(frame, 1, &analysis->color_histogram);
+}
+
+}  // namespace autoflip
+}  // namespace mediapipe
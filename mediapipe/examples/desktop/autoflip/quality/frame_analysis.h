@@ -0,0 +1,60 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_FRAME_ANALYSIS_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_FRAME_ANALYSIS_H_
+
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace autoflip {
+
+// Number of bins per channel of the color histogram. A power of two, so that
+// channel values are quantized with a shift.
+constexpr int kColorHistogramBins = 8;
+
+// Per-frame analysis shared by AutoFlip calculators, so that a frame is
+// downsampled and color quantized once rather than once per calculator. See
+// FrameAnalysisCalculator.
+struct FrameAnalysis {
+  // Size of the analyzed frame.
+  cv::Size frame_size;
+  // The frame downsampled to at most max_pixels pixels. Empty if the frame
+  // already fits, in which case consumers use the frame itself.
+  cv::Mat downsampled;
+  // Color histogram of the downsampled frame, see ComputeColorHistogram.
+  cv::Mat color_histogram;
+};
+
+// Computes the kColorHistogramBins x kColorHistogramBins CV_32F histogram of
+// the first two channels of an 8-bit image with 2 to 4 channels. Only every
+// step-th pixel of every step-th row is counted. With step 1 the result is
+// the same as the one of cv::calcHist over channels {0, 1} and range [0, 256).
+absl::Status ComputeColorHistogram(const cv::Mat& image, int step,
+                                   cv::Mat* histogram);
+
+// Returns the smallest sampling step for which at most max_pixels pixels of an
+// image of the given size are counted. Returns 1 if max_pixels is not positive.
+int ColorHistogramStep(const cv::Size& size, int max_pixels);
+
+// Downsamples frame to about max_pixels pixels, if larger, and computes the
+// color histogram of the result. max_pixels <= 0 disables downsampling.
+absl::Status AnalyzeFrame(const cv::Mat& frame, int max_pixels,
+                          FrameAnalysis* analysis);
+
+}  // namespace autoflip
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_QUALITY_FRAME_ANALYSIS_H_
@@ -0,0 +1,135 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/examples/desktop/autoflip/quality/frame_analysis.h"
+
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace autoflip {
+namespace {
+
+cv::Mat RandomImage(int width, int height, int type) {
+  cv::Mat image(height, width, type);
+  cv::theRNG().state = 1;
+  cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+  return image;
+}
+
+cv::Mat ReferenceHistogram(const cv::Mat& image) {
+  const int channels[] = {0, 1};
+  const int bins[] = {kColorHistogramBins, kColorHistogramBins};
+  const float range[] = {0, 256};
+  const float* ranges[] = {range, range};
+  cv::Mat histogram;
+  cv::calcHist(&image, 1, channels, cv::Mat(), histogram, 2, bins, ranges,
+               true, false);
+  return histogram;
+}
+
+void ExpectSameHistogram(const cv::Mat& actual, const cv::Mat& expected) {
+  ASSERT_EQ(actual.type(), CV_32F);
+  ASSERT_EQ(actual.size(), expected.size());
+  EXPECT_EQ(cv::norm(actual, expected, cv::NORM_INF), 0);
+}
+
+TEST(FrameAnalysisTest, MatchesCalcHist) {
+  for (int type : {CV_8UC3, CV_8UC4}) {
+    // Odd width to exercise the tail of the unrolled loop.
+    const cv::Mat image = RandomImage(101, 37, type);
+    cv::Mat histogram;
+    MP_ASSERT_OK(ComputeColorHistogram(image, 1, &histogram));
+    ExpectSameHistogram(histogram, ReferenceHistogram(image));
+  }
+}
+
+TEST(FrameAnalysisTest, MatchesCalcHistOnRoi) {
+  const cv::Mat image = RandomImage(64, 48, CV_8UC3);
+  const cv::Mat roi = image(cv::Rect(3, 5, 33, 20));
+  cv::Mat histogram;
+  MP_ASSERT_OK(ComputeColorHistogram(roi, 1, &histogram));
+  ExpectSameHistogram(histogram, ReferenceHistogram(roi));
+}
+
+TEST(FrameAnalysisTest, SamplesWithStep) {
+  const cv::Mat image = RandomImage(63, 30, CV_8UC3);
+  cv::Mat sampled(15, 32, CV_8UC3);
+  for (int y = 0; y < sampled.rows; ++y) {
+    for (int x = 0; x < sampled.cols; ++x) {
+      sampled.at<cv::Vec3b>(y, x) = image.at<cv::Vec3b>(2 * y, 2 * x);
+    }
+  }
+  cv::Mat histogram;
+  MP_ASSERT_OK(ComputeColorHistogram(image, 2, &histogram));
+  ExpectSameHistogram(histogram, ReferenceHistogram(sampled));
+}
+
+TEST(FrameAnalysisTest, ColorHistogramStep) {
+  EXPECT_EQ(ColorHistogramStep(cv::Size(1920, 1080), 0), 1);
+  EXPECT_EQ(ColorHistogramStep(cv::Size(640, 480), 640 * 480), 1);
+  EXPECT_EQ(ColorHistogramStep(cv::Size(640, 480), 640 * 480 - 1), 2);
+  EXPECT_EQ(ColorHistogramStep(cv::Size(1920, 1080), 300000), 3);
+}
+
+TEST(FrameAnalysisTest, DownsamplesLargeFrames) {
+  const cv::Mat frame = RandomImage(400, 300, CV_8UC3);
+  FrameAnalysis analysis;
+  MP_ASSERT_OK(AnalyzeFrame(frame, 30000, &analysis));
+  EXPECT_EQ(analysis.frame_size, frame.size());
+  EXPECT_EQ(analysis.downsampled.size(), cv::Size(200, 150));
+  ExpectSameHistogram(analysis.color_histogram,
+                      ReferenceHistogram(analysis.downsampled));
+
+  MP_ASSERT_OK(AnalyzeFrame(frame, 400 * 300, &analysis));
+  EXPECT_TRUE(analysis.downsampled.empty());
+  ExpectSameHistogram(analysis.color_histogram, ReferenceHistogram(frame));
+}
+
+TEST(FrameAnalysisTest, RejectsInvalidInputs) {
+  cv::Mat histogram;
+  EXPECT_FALSE(
+      ComputeColorHistogram(cv::Mat(4, 4, CV_8UC1), 1, &histogram).ok());
+  EXPECT_FALSE(
+      ComputeColorHistogram(cv::Mat(4, 4, CV_32FC3), 1, &histogram).ok());
+  EXPECT_FALSE(
+      ComputeColorHistogram(cv::Mat(4, 4, CV_8UC3), 0, &histogram).ok());
+}
+
+// Histogram of a 1080p frame, with OpenCV as baseline.
+void BM_ComputeColorHistogram(benchmark::State& state) {
+  const cv::Mat image = RandomImage(1920, 1080, CV_8UC3);
+  cv::Mat histogram;
+  for (auto _ : state) {
+    MEDIAPIPE_CHECK_OK(ComputeColorHistogram(image, state.range(0),
+                                             &histogram));
+  }
+}
+BENCHMARK(BM_ComputeColorHistogram)->Arg(1)->Arg(3);
+
+void BM_CalcHist(benchmark::State& state) {
+  const cv::Mat image = RandomImage(1920, 1080, CV_8UC3);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ReferenceHistogram(image));
+  }
+}
+BENCHMARK(BM_CalcHist);
+
+}  // namespace
+}  // namespace autoflip
+}  // namespace mediapipe
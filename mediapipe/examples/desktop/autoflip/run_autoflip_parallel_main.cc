@@ -0,0 +1,363 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Runs AutoFlip on a video with shots cropped in parallel. A first pass
+// detects shot boundaries on the whole video. The video is then split into
+// segments of whole shots, each decoded and cropped by its own graph on a
+// worker pool, and the cropped frames are written in timestamp order. Logs the
+// time spent in each pass, so that the runner doubles as a benchmark.
+//
+// Example:
+// bazel build -c opt --define MEDIAPIPE_DISABLE_GPU=1 \
+//   mediapipe/examples/desktop/autoflip:run_autoflip_parallel
+// GLOG_logtostderr=1 \
+//   bazel-bin/mediapipe/examples/desktop/autoflip/run_autoflip_parallel \
+//   --input_video_path=/absolute/path/to/the/local/video/file \
+//   --output_video_path=/absolute/path/to/save/the/output/video/file \
+//   --aspect_ratio=9:16 --num_workers=32
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/examples/desktop/autoflip/shot_segments.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+ABSL_FLAG(std::string, shot_detection_graph,
+          "mediapipe/examples/desktop/autoflip/"
+          "autoflip_shot_detection_graph.pbtxt",
+          "File containing the text format CalculatorGraphConfig detecting "
+          "shot boundaries.");
+ABSL_FLAG(std::string, segment_graph,
+          "mediapipe/examples/desktop/autoflip/autoflip_segment_graph.pbtxt",
+          "File containing the text format CalculatorGraphConfig cropping a "
+          "segment of shots.");
+ABSL_FLAG(std::string, input_video_path, "", "Full path of the input video.");
+ABSL_FLAG(std::string, output_video_path, "",
+          "Full path of the cropped video to write. Audio is not copied.");
+ABSL_FLAG(std::string, aspect_ratio, "9:16",
+          "Target aspect ratio, in the format 'width:height'.");
+ABSL_FLAG(int, num_workers, 8, "Number of segments cropped concurrently.");
+ABSL_FLAG(int, segments_per_worker, 4,
+          "Number of segments per worker the video is split into, for load "
+          "balancing. Segments only start at shot boundaries, so there may be "
+          "fewer segments.");
+
+namespace mediapipe {
+namespace autoflip {
+namespace {
+
+constexpr char kInputVideo[] = "video_raw";
+constexpr char kShotChange[] = "shot_change";
+constexpr char kCroppedFrames[] = "cropped_frames";
+constexpr char kAspectRatio[] = "aspect_ratio";
+
+// Cropped frames of a segment, filled by a worker.
+struct SegmentResult {
+  absl::Mutex mutex;
+  bool done ABSL_GUARDED_BY(mutex) = false;
+  absl::Status status ABSL_GUARDED_BY(mutex);
+  std::vector<Packet> frames ABSL_GUARDED_BY(mutex);
+};
+
+absl::Status LoadGraphConfig(const std::string& path,
+                             CalculatorGraphConfig* config) {
+  std::string contents;
+  MP_RETURN_IF_ERROR(file::GetContents(path, &contents));
+  *config = ParseTextProtoOrDie<CalculatorGraphConfig>(contents);
+  return absl::OkStatus();
+}
+
+// Reads the next frame as OpenCvVideoDecoderCalculator does. Returns nullptr
+// at the end of the video.
+std::unique_ptr<ImageFrame> ReadFrame(cv::VideoCapture* capture,
+                                      Timestamp* timestamp) {
+  // Use microsecond as the unit of time.
+  *timestamp = Timestamp(capture->get(cv::CAP_PROP_POS_MSEC) * 1000);
+  cv::Mat bgr_frame;
+  if (!capture->read(bgr_frame) || bgr_frame.empty()) {
+    return nullptr;
+  }
+  auto frame = absl::make_unique<ImageFrame>(ImageFormat::SRGB, bgr_frame.cols,
+                                             bgr_frame.rows,
+                                             /*alignment_boundary=*/1);
+  cv::cvtColor(bgr_frame, formats::MatView(frame.get()), cv::COLOR_BGR2RGB);
+  return frame;
+}
+
+// Decodes the whole video and detects its shot boundaries.
+absl::Status DetectShots(const CalculatorGraphConfig& config,
+                         const std::string& video_path, VideoFrames* video) {
+  CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  absl::Mutex mutex;
+  std::set<Timestamp> shot_changes;
+  MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+      kShotChange, [&mutex, &shot_changes](const Packet& packet) {
+        if (packet.Get<bool>()) {
+          absl::MutexLock lock(&mutex);
+          shot_changes.insert(packet.Timestamp());
+        }
+        return absl::OkStatus();
+      }));
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+
+  cv::VideoCapture capture(video_path);
+  RET_CHECK(capture.isOpened()) << "Fail to open video file at " << video_path;
+  video->frame_rate = capture.get(cv::CAP_PROP_FPS);
+  Timestamp timestamp;
+  while (auto frame = ReadFrame(&capture, &timestamp)) {
+    video->timestamps.push_back(timestamp);
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kInputVideo, Adopt(frame.release()).At(timestamp)));
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+
+  absl::MutexLock lock(&mutex);
+  video->is_shot_start.resize(video->timestamps.size());
+  for (int i = 0; i < video->timestamps.size(); ++i) {
+    video->is_shot_start[i] = shot_changes.count(video->timestamps[i]) > 0;
+  }
+  return absl::OkStatus();
+}
+
+// Positions capture at frame index of video and decodes it. Seeking by frame
+// index is inexact for some containers, so the decoded timestamp is checked
+// against the one of the first pass, and frames are decoded forward from
+// further back until they match, as a last resort from the first frame.
+absl::StatusOr<std::unique_ptr<ImageFrame>> SeekAndReadFrame(
+    const std::string& video_path, const VideoFrames& video, int index,
+    cv::VideoCapture* capture) {
+  const Timestamp target = video.timestamps[index];
+  for (int attempt = 0;; ++attempt) {
+    const int start = SeekStartFrame(index, attempt);
+    if (start == 0) {
+      // Decodes as the first pass did.
+      capture->open(video_path);
+      RET_CHECK(capture->isOpened())
+          << "Fail to open video file at " << video_path;
+    } else {
+      capture->set(cv::CAP_PROP_POS_FRAMES, start);
+    }
+    Timestamp timestamp;
+    while (auto frame = ReadFrame(capture, &timestamp)) {
+      if (timestamp == target) {
+        return frame;
+      }
+      if (timestamp > target) {
+        break;
+      }
+    }
+    RET_CHECK_GT(start, 0) << "Fail to decode frame " << index << " at "
+                           << target;
+    VLOG(1) << "Inexact seek to frame " << start << ", retrying.";
+  }
+}
+
+// Decodes and crops the frames of segment with a new instance of the segment
+// graph.
+absl::Status CropSegment(const CalculatorGraphConfig& config,
+                         const std::string& video_path,
+                         const VideoFrames& video, const Segment& segment,
+                         std::vector<Packet>* cropped_frames) {
+  CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(
+      config, {{kAspectRatio, MakePacket<std::string>(
+                                  absl::GetFlag(FLAGS_aspect_ratio))}}));
+  MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+      kCroppedFrames, [cropped_frames](const Packet& packet) {
+        cropped_frames->push_back(packet);
+        return absl::OkStatus();
+      }));
+  MP_RETURN_IF_ERROR(graph.StartRun({}));
+
+  cv::VideoCapture capture(video_path);
+  RET_CHECK(capture.isOpened()) << "Fail to open video file at " << video_path;
+  for (int i = segment.begin; i < segment.end; ++i) {
+    std::unique_ptr<ImageFrame> frame;
+    if (i == segment.begin) {
+      ASSIGN_OR_RETURN(frame,
+                       SeekAndReadFrame(video_path, video, i, &capture));
+    } else {
+      Timestamp decoded_timestamp;
+      frame = ReadFrame(&capture, &decoded_timestamp);
+      RET_CHECK(frame) << "Fail to decode frame " << i;
+      RET_CHECK_EQ(decoded_timestamp, video.timestamps[i])
+          << "Unexpected frame decoded at frame " << i;
+    }
+    const Timestamp timestamp = video.timestamps[i];
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kInputVideo, Adopt(frame.release()).At(timestamp)));
+    // Shot changes are sent for every frame, so that downstream calculators
+    // are not held back waiting for the next shot.
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        kShotChange, MakePacket<bool>(video.is_shot_start[i]).At(timestamp)));
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllInputStreams());
+  return graph.WaitUntilDone();
+}
+
+absl::Status WriteFrames(const std::vector<Packet>& frames, double frame_rate,
+                         cv::VideoWriter* writer) {
+  for (const Packet& packet : frames) {
+    const ImageFrame& frame = packet.Get<ImageFrame>();
+    if (!writer->isOpened()) {
+      RET_CHECK_GT(frame_rate, 0) << "Invalid frame rate.";
+      writer->open(absl::GetFlag(FLAGS_output_video_path),
+                   mediapipe::fourcc('a', 'v', 'c', '1'), frame_rate,
+                   cv::Size(frame.Width(), frame.Height()));
+      RET_CHECK(writer->isOpened()) << "Fail to open file at "
+                                    << absl::GetFlag(FLAGS_output_video_path);
+    }
+    cv::Mat bgr_frame;
+    cv::cvtColor(formats::MatView(&frame), bgr_frame, cv::COLOR_RGB2BGR);
+    writer->write(bgr_frame);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RunAutoFlipParallel() {
+  const std::string video_path = absl::GetFlag(FLAGS_input_video_path);
+  RET_CHECK(!video_path.empty()) << "--input_video_path is required.";
+  RET_CHECK(!absl::GetFlag(FLAGS_output_video_path).empty())
+      << "--output_video_path is required.";
+  const int num_workers = std::max(1, absl::GetFlag(FLAGS_num_workers));
+  CalculatorGraphConfig shot_detection_config;
+  MP_RETURN_IF_ERROR(LoadGraphConfig(absl::GetFlag(FLAGS_shot_detection_graph),
+                                     &shot_detection_config));
+  CalculatorGraphConfig segment_config;
+  MP_RETURN_IF_ERROR(
+      LoadGraphConfig(absl::GetFlag(FLAGS_segment_graph), &segment_config));
+
+  const absl::Time start_time = absl::Now();
+  VideoFrames video;
+  MP_RETURN_IF_ERROR(DetectShots(shot_detection_config, video_path, &video));
+  RET_CHECK(!video.timestamps.empty()) << "No frames decoded.";
+  const absl::Time detection_end_time = absl::Now();
+
+  const int num_segments =
+      num_workers * std::max(1, absl::GetFlag(FLAGS_segments_per_worker));
+  const std::vector<Segment> segments = SplitIntoSegments(video, num_segments);
+  LOG(INFO) << "Cropping " << video.timestamps.size() << " frames in "
+            << segments.size() << " segments on " << num_workers
+            << " workers.";
+
+  // Segments are started in order, and at most this many segments ahead of
+  // the one being written, which bounds the cropped frames held in memory.
+  const int max_pending_segments = 2 * num_workers;
+  absl::Mutex written_mutex;
+  absl::CondVar written_cond;
+  int num_written = 0;
+  bool cancelled = false;
+  std::vector<std::unique_ptr<SegmentResult>> results;
+  for (int i = 0; i < segments.size(); ++i) {
+    results.push_back(absl::make_unique<SegmentResult>());
+  }
+  cv::VideoWriter writer;
+  absl::Status status;
+  {
+    ThreadPool pool("autoflip_segments", num_workers);
+    pool.StartWorkers();
+    for (int i = 0; i < segments.size(); ++i) {
+      pool.Schedule([&, i] {
+        bool skip;
+        {
+          absl::MutexLock lock(&written_mutex);
+          while (!cancelled && i >= num_written + max_pending_segments) {
+            written_cond.Wait(&written_mutex);
+          }
+          skip = cancelled;
+        }
+        std::vector<Packet> frames;
+        absl::Status segment_status =
+            skip ? absl::CancelledError("Cancelled.")
+                 : CropSegment(segment_config, video_path, video, segments[i],
+                               &frames);
+        SegmentResult& result = *results[i];
+        absl::MutexLock lock(&result.mutex);
+        result.frames = std::move(frames);
+        result.status = std::move(segment_status);
+        result.done = true;
+      });
+    }
+
+    // Writes the segments in order as they complete.
+    for (int i = 0; i < segments.size() && status.ok(); ++i) {
+      SegmentResult& result = *results[i];
+      std::vector<Packet> frames;
+      result.mutex.LockWhen(absl::Condition(&result.done));
+      frames = std::move(result.frames);
+      status = result.status;
+      result.mutex.Unlock();
+      if (status.ok()) {
+        status = WriteFrames(frames, video.frame_rate, &writer);
+      }
+      absl::MutexLock lock(&written_mutex);
+      ++num_written;
+      cancelled = !status.ok();
+      written_cond.SignalAll();
+    }
+  }
+  MP_RETURN_IF_ERROR(status);
+  writer.release();
+
+  const absl::Time end_time = absl::Now();
+  const double total_sec = absl::ToDoubleSeconds(end_time - start_time);
+  LOG(INFO) << absl::StrFormat(
+      "Processed %d frames in %.2f s (%.1f fps): shot detection %.2f s, "
+      "cropping and encoding %.2f s.",
+      video.timestamps.size(), total_sec, video.timestamps.size() / total_sec,
+      absl::ToDoubleSeconds(detection_end_time - start_time),
+      absl::ToDoubleSeconds(end_time - detection_end_time));
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace autoflip
+}  // namespace mediapipe
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = mediapipe::autoflip::RunAutoFlipParallel();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run AutoFlip: " << run_status.message();
+    return EXIT_FAILURE;
+  }
+  LOG(INFO) << "Success!";
+  return EXIT_SUCCESS;
+}
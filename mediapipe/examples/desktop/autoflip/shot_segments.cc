@@ -0,0 +1,63 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/examples/desktop/autoflip/shot_segments.h"
+
+#include <algorithm>
+
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+namespace autoflip {
+
+namespace {
+
+// Frames decoded before the requested frame on the second seek attempt,
+// doubled on every further attempt.
+constexpr int kSeekPrerollFrames = 32;
+
+}  // namespace
+
+std::vector<Segment> SplitIntoSegments(const VideoFrames& video,
+                                       int num_segments) {
+  const int num_frames = video.timestamps.size();
+  const int min_length =
+      std::max(1, (num_frames + num_segments - 1) / std::max(1, num_segments));
+  std::vector<Segment> segments;
+  Segment segment;
+  for (int i = 1; i < num_frames; ++i) {
+    if (video.is_shot_start[i] && i - segment.begin >= min_length) {
+      segment.end = i;
+      segments.push_back(segment);
+      segment.begin = i;
+    }
+  }
+  segment.end = num_frames;
+  if (segment.end > segment.begin) {
+    segments.push_back(segment);
+  }
+  return segments;
+}
+
+int SeekStartFrame(int index, int attempt) {
+  if (attempt == 0) {
+    return index;
+  }
+  const int64 preroll = int64{kSeekPrerollFrames}
+                        << std::min(attempt - 1, 32);
+  return std::max<int64>(0, index - preroll);
+}
+
+}  // namespace autoflip
+}  // namespace mediapipe
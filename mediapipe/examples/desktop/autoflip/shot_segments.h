@@ -0,0 +1,53 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_SHOT_SEGMENTS_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_SHOT_SEGMENTS_H_
+
+#include <vector>
+
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace autoflip {
+
+// Frames of a video, as decoded by the shot detection pass of
+// run_autoflip_parallel.
+struct VideoFrames {
+  double frame_rate = 0;
+  std::vector<Timestamp> timestamps;
+  std::vector<bool> is_shot_start;
+};
+
+// A run of whole shots, as frame indices [begin, end).
+struct Segment {
+  int begin = 0;
+  int end = 0;
+};
+
+// Splits the video into about num_segments segments of similar length, each
+// starting at a shot boundary. The segments cover all frames in order.
+std::vector<Segment> SplitIntoSegments(const VideoFrames& video,
+                                       int num_segments);
+
+// Returns the frame to seek to on the given attempt, starting at 0, to decode
+// frame index. Seeking by frame index is inexact for some containers, so
+// every attempt starts further back and decodes forward to index, until the
+// last attempt decodes from the first frame, for which 0 is returned.
+int SeekStartFrame(int index, int attempt);
+
+}  // namespace autoflip
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_AUTOFLIP_SHOT_SEGMENTS_H_
@@ -0,0 +1,110 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/examples/desktop/autoflip/shot_segments.h"
+
+#include <vector>
+
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace autoflip {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+
+// Returns a video with num_frames frames, and shots starting at shot_starts.
+VideoFrames MakeVideo(int num_frames, const std::vector<int>& shot_starts) {
+  VideoFrames video;
+  video.frame_rate = 30;
+  for (int i = 0; i < num_frames; ++i) {
+    video.timestamps.push_back(Timestamp(i * 33333));
+  }
+  video.is_shot_start.resize(num_frames);
+  for (int start : shot_starts) {
+    video.is_shot_start[start] = true;
+  }
+  return video;
+}
+
+auto SegmentIs(int begin, int end) {
+  return ::testing::AllOf(Field(&Segment::begin, begin),
+                          Field(&Segment::end, end));
+}
+
+TEST(ShotSegmentsTest, SingleShotIsSingleSegment) {
+  EXPECT_THAT(SplitIntoSegments(MakeVideo(100, {0}), 8),
+              ElementsAre(SegmentIs(0, 100)));
+}
+
+TEST(ShotSegmentsTest, SplitsAtShotStarts) {
+  EXPECT_THAT(SplitIntoSegments(MakeVideo(90, {0, 30, 60}), 3),
+              ElementsAre(SegmentIs(0, 30), SegmentIs(30, 60),
+                          SegmentIs(60, 90)));
+}
+
+// Shots shorter than a segment are merged into the segment they start in.
+TEST(ShotSegmentsTest, MergesShortShots) {
+  EXPECT_THAT(
+      SplitIntoSegments(MakeVideo(100, {0, 10, 20, 45, 50, 55, 90}), 4),
+      ElementsAre(SegmentIs(0, 45), SegmentIs(45, 90), SegmentIs(90, 100)));
+}
+
+TEST(ShotSegmentsTest, NoMoreSegmentsThanShots) {
+  EXPECT_THAT(SplitIntoSegments(MakeVideo(10, {0, 5}), 100),
+              ElementsAre(SegmentIs(0, 5), SegmentIs(5, 10)));
+}
+
+TEST(ShotSegmentsTest, EmptyVideo) {
+  EXPECT_TRUE(SplitIntoSegments(MakeVideo(0, {}), 4).empty());
+}
+
+// Every frame is in exactly one segment, and segments only start at shots.
+TEST(ShotSegmentsTest, CoversAllFrames) {
+  std::vector<int> shot_starts;
+  for (int i = 0; i < 1000; i += 7 + i % 13) {
+    shot_starts.push_back(i);
+  }
+  const VideoFrames video = MakeVideo(1000, shot_starts);
+  for (int num_segments : {1, 2, 5, 16, 64, 2000}) {
+    const std::vector<Segment> segments =
+        SplitIntoSegments(video, num_segments);
+    ASSERT_FALSE(segments.empty());
+    EXPECT_LE(segments.size(), num_segments);
+    EXPECT_EQ(segments.front().begin, 0);
+    EXPECT_EQ(segments.back().end, 1000);
+    for (int i = 0; i < segments.size(); ++i) {
+      EXPECT_LT(segments[i].begin, segments[i].end);
+      EXPECT_TRUE(video.is_shot_start[segments[i].begin]);
+      if (i > 0) {
+        EXPECT_EQ(segments[i].begin, segments[i - 1].end);
+      }
+    }
+  }
+}
+
+TEST(ShotSegmentsTest, SeekStartFrameBacksOff) {
+  EXPECT_EQ(SeekStartFrame(100, 0), 100);
+  EXPECT_EQ(SeekStartFrame(100, 1), 68);
+  EXPECT_EQ(SeekStartFrame(100, 2), 36);
+  EXPECT_EQ(SeekStartFrame(100, 3), 0);
+  EXPECT_EQ(SeekStartFrame(100, 40), 0);
+  EXPECT_EQ(SeekStartFrame(0, 0), 0);
+}
+
+}  // namespace
+}  // namespace autoflip
+}  // namespace mediapipe
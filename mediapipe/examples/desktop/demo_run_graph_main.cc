@@ -13,11 +13,17 @@
 // limitations under the License.
 //
 // An example of sending OpenCV webcam frames into a MediaPipe graph.
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
+#include <memory>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
+#include "mediapipe/examples/desktop/frame_throttle.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/external_image_frame.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
 #include "mediapipe/framework/port/file_helpers.h"
@@ -26,10 +32,14 @@
 #include "mediapipe/framework/port/opencv_video_inc.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/threadpool.h"
 
 constexpr char kInputStream[] = "input_video";
 constexpr char kOutputStream[] = "output_video";
 constexpr char kWindowName[] = "MediaPipe";
+// Frames of a loaded video decoded ahead of rendering. One frame is decoded
+// while the graph processes the other.
+constexpr int kMaxFramesInFlight = 2;
 
 ABSL_FLAG(std::string, calculator_graph_config_file, "",
           "Name of file containing text format CalculatorGraphConfig proto.");
@@ -39,6 +49,22 @@ ABSL_FLAG(std::string, input_video_path, "",
 ABSL_FLAG(std::string, output_video_path, "",
           "Full path of where to save result (.mp4 only). "
           "If not provided, show result in a window.");
+ABSL_FLAG(bool, pipelined, true,
+          "If true, capture, the graph and rendering run as concurrent "
+          "pipeline stages, and a loaded video is decoded at most a few "
+          "frames ahead of rendering so that none of its frames is dropped. "
+          "Otherwise, each frame is rendered before the next one is "
+          "captured.");
+
+namespace {
+
+// Microseconds on the clock used to timestamp the captured frames.
+int64 NowUs() {
+  return static_cast<double>(cv::getTickCount()) /
+         static_cast<double>(cv::getTickFrequency()) * 1e6;
+}
+
+}  // namespace
 
 absl::Status RunMPPGraph() {
   std::string calculator_graph_config_contents;
@@ -51,13 +77,25 @@ absl::Status RunMPPGraph() {
       mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
           calculator_graph_config_contents);
 
+  const bool load_video = !absl::GetFlag(FLAGS_input_video_path).empty();
+  const bool save_video = !absl::GetFlag(FLAGS_output_video_path).empty();
+  const bool pipelined = absl::GetFlag(FLAGS_pipelined);
+  // The FlowLimiterCalculator of live graphs drops the frames that arrive
+  // while the graph is busy, which is the intent for a webcam. The frames of
+  // a video wait for the FrameThrottle below instead, and are queued when
+  // they arrive before the graph reports the previous frame as finished.
+  const bool throttle_frames = pipelined && load_video;
+  if (throttle_frames) {
+    MP_RETURN_IF_ERROR(mediapipe::QueueFlowLimiterInput(
+        kInputStream, kMaxFramesInFlight, &config));
+  }
+
   LOG(INFO) << "Initialize the calculator graph.";
   mediapipe::CalculatorGraph graph;
   MP_RETURN_IF_ERROR(graph.Initialize(config));
 
   LOG(INFO) << "Initialize the camera or load the video.";
   cv::VideoCapture capture;
-  const bool load_video = !absl::GetFlag(FLAGS_input_video_path).empty();
   if (load_video) {
     capture.open(absl::GetFlag(FLAGS_input_video_path));
   } else {
@@ -66,7 +104,6 @@ absl::Status RunMPPGraph() {
   RET_CHECK(capture.isOpened());
 
   cv::VideoWriter writer;
-  const bool save_video = !absl::GetFlag(FLAGS_output_video_path).empty();
   if (!save_video) {
     cv::namedWindow(kWindowName, /*flags=WINDOW_AUTOSIZE*/ 1);
 #if (CV_MAJOR_VERSION >= 3) && (CV_MINOR_VERSION >= 2)
@@ -77,47 +114,58 @@ absl::Status RunMPPGraph() {
   }
 
   LOG(INFO) << "Start running the calculator graph.";
-  ASSIGN_OR_RETURN(mediapipe::OutputStreamPoller poller,
-                   graph.AddOutputStreamPoller(kOutputStream));
+  // A webcam window only shows the latest result, so older results are
+  // dropped when rendering falls behind. Every frame of a video is rendered.
+  const int max_queue_size = pipelined && !load_video && !save_video ? 1 : -1;
+  ASSIGN_OR_RETURN(std::shared_ptr<mediapipe::OutputPacketQueue> output_queue,
+                   graph.AddOutputPacketQueue(kOutputStream, max_queue_size));
   MP_RETURN_IF_ERROR(graph.StartRun({}));
 
   LOG(INFO) << "Start grabbing and processing frames.";
-  bool grab_frames = true;
-  while (grab_frames) {
+  // Input frames are recycled once the graph releases them, and the capture
+  // reuses its buffer.
+  mediapipe::InputFramePool frame_pool;
+  cv::Mat camera_frame_raw;
+  mediapipe::FrameThrottle throttle(kMaxFramesInFlight);
+  // Captures the next frame and sends it into the graph. Returns false at the
+  // end of the video, or once the throttle is closed.
+  auto send_next_frame = [&]() -> absl::StatusOr<bool> {
     // Capture opencv camera or video frame.
-    cv::Mat camera_frame_raw;
     capture >> camera_frame_raw;
-    if (camera_frame_raw.empty()) {
-      if (!load_video) {
-        LOG(INFO) << "Ignore empty frames from camera.";
-        continue;
+    while (camera_frame_raw.empty()) {
+      if (load_video) {
+        LOG(INFO) << "Empty frame, end of video reached.";
+        return false;
       }
-      LOG(INFO) << "Empty frame, end of video reached.";
-      break;
+      LOG(INFO) << "Ignore empty frames from camera.";
+      capture >> camera_frame_raw;
     }
-    cv::Mat camera_frame;
-    cv::cvtColor(camera_frame_raw, camera_frame, cv::COLOR_BGR2RGB);
+    // Convert straight into a pooled ImageFrame.
+    mediapipe::ImageFrameSharedPtr input_frame = frame_pool.GetFrame(
+        mediapipe::ImageFormat::SRGB, camera_frame_raw.cols,
+        camera_frame_raw.rows);
+    cv::Mat input_frame_mat = mediapipe::formats::MatView(input_frame.get());
+    cv::cvtColor(camera_frame_raw, input_frame_mat, cv::COLOR_BGR2RGB);
     if (!load_video) {
-      cv::flip(camera_frame, camera_frame, /*flipcode=HORIZONTAL*/ 1);
+      cv::flip(input_frame_mat, input_frame_mat, /*flipcode=HORIZONTAL*/ 1);
     }
 
-    // Wrap Mat into an ImageFrame.
-    auto input_frame = absl::make_unique<mediapipe::ImageFrame>(
-        mediapipe::ImageFormat::SRGB, camera_frame.cols, camera_frame.rows,
-        mediapipe::ImageFrame::kDefaultAlignmentBoundary);
-    cv::Mat input_frame_mat = mediapipe::formats::MatView(input_frame.get());
-    camera_frame.copyTo(input_frame_mat);
-
     // Send image packet into the graph.
-    size_t frame_timestamp_us =
-        (double)cv::getTickCount() / (double)cv::getTickFrequency() * 1e6;
+    const mediapipe::Timestamp timestamp(NowUs());
+    if (throttle_frames && !throttle.Acquire(timestamp)) return false;
     MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
-        kInputStream, mediapipe::Adopt(input_frame.release())
-                          .At(mediapipe::Timestamp(frame_timestamp_us))));
+        kInputStream, mediapipe::MakeImageFramePacket(std::move(input_frame))
+                          .At(timestamp)));
+    return true;
+  };
 
-    // Get the graph result packet, or stop if that fails.
-    mediapipe::Packet packet;
-    if (!poller.Next(&packet)) break;
+  const double video_fps = capture.get(cv::CAP_PROP_FPS);
+  bool grab_frames = true;
+  int64 num_rendered = 0;
+  int64 total_latency_us = 0;
+  int64 max_latency_us = 0;
+  // Displays or saves an output packet.
+  auto render = [&](const mediapipe::Packet& packet) -> absl::Status {
     auto& output_frame = packet.Get<mediapipe::ImageFrame>();
 
     // Convert back to opencv for display or saving.
@@ -128,7 +176,7 @@ absl::Status RunMPPGraph() {
         LOG(INFO) << "Prepare video writer.";
         writer.open(absl::GetFlag(FLAGS_output_video_path),
                     mediapipe::fourcc('a', 'v', 'c', '1'),  // .mp4
-                    capture.get(cv::CAP_PROP_FPS), output_frame_mat.size());
+                    video_fps, output_frame_mat.size());
         RET_CHECK(writer.isOpened());
       }
       writer.write(output_frame_mat);
@@ -138,11 +186,81 @@ absl::Status RunMPPGraph() {
       const int pressed_key = cv::waitKey(5);
       if (pressed_key >= 0 && pressed_key != 255) grab_frames = false;
     }
+    // Packets are timestamped with their capture time.
+    const int64 latency_us = NowUs() - packet.Timestamp().Value();
+    total_latency_us += latency_us;
+    max_latency_us = std::max(max_latency_us, latency_us);
+    ++num_rendered;
+    return absl::OkStatus();
+  };
+
+  const int64 start_us = NowUs();
+  if (pipelined) {
+    // Capture runs on its own thread, paced by the webcam or the throttle,
+    // while this thread renders. Display and window events have to stay on
+    // this thread.
+    std::atomic<bool> stop_capture(false);
+    absl::Status capture_status;
+    {
+      mediapipe::ThreadPool capture_thread("capture", 1);
+      capture_thread.StartWorkers();
+      capture_thread.Schedule([&] {
+        while (!stop_capture) {
+          auto sent = send_next_frame();
+          if (!sent.ok()) capture_status = sent.status();
+          if (!sent.ok() || !*sent) break;
+        }
+        // Closing the input lets the graph, and then the output queue, finish.
+        capture_status.Update(graph.CloseInputStream(kInputStream));
+      });
+
+      std::vector<mediapipe::Packet> packets;
+      absl::Status render_status;
+      while (render_status.ok() && output_queue->NextBatch(&packets)) {
+        for (const mediapipe::Packet& packet : packets) {
+          render_status = render(packet);
+          if (!render_status.ok()) break;
+        }
+        if (!packets.empty()) throttle.Release(packets.back().Timestamp());
+        if (!grab_frames) {
+          stop_capture = true;
+          throttle.Close();
+        }
+      }
+      stop_capture = true;
+      throttle.Close();
+      // The thread pool joins the capture thread when going out of scope.
+      if (!render_status.ok()) {
+        graph.Cancel();
+        return render_status;
+      }
+    }
+    MP_RETURN_IF_ERROR(capture_status);
+    if (output_queue->NumDropped() > 0) {
+      LOG(INFO) << "Skipped " << output_queue->NumDropped()
+                << " results to show the latest one.";
+    }
+  } else {
+    while (grab_frames) {
+      ASSIGN_OR_RETURN(bool sent, send_next_frame());
+      if (!sent) break;
+      // Get the graph result packet, or stop if that fails.
+      mediapipe::Packet packet;
+      if (!output_queue->Next(&packet)) break;
+      MP_RETURN_IF_ERROR(render(packet));
+    }
+    MP_RETURN_IF_ERROR(graph.CloseInputStream(kInputStream));
   }
 
+  const double elapsed_s = (NowUs() - start_us) * 1e-6;
+  LOG(INFO) << "Rendered " << num_rendered << " frames in " << elapsed_s
+            << " s: " << num_rendered / std::max(elapsed_s, 1e-6)
+            << " fps, latency mean "
+            << total_latency_us / std::max<int64>(num_rendered, 1) / 1000
+            << " ms, max " << max_latency_us / 1000 << " ms.";
+
   LOG(INFO) << "Shutting down.";
   if (writer.isOpened()) writer.release();
-  MP_RETURN_IF_ERROR(graph.CloseInputStream(kInputStream));
   return graph.WaitUntilDone();
 }
 
@@ -0,0 +1,114 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/examples/desktop/frame_throttle.h"
+
+#include <algorithm>
+
+#include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
+#include "mediapipe/framework/port/any_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/tool/validate_name.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kFlowLimiterCalculator[] = "FlowLimiterCalculator";
+
+// Returns true if the node reads input_stream as an untagged input.
+absl::StatusOr<bool> ReadsFrames(const CalculatorGraphConfig::Node& node,
+                                 const std::string& input_stream) {
+  for (const std::string& tag_index_name : node.input_stream()) {
+    std::string tag;
+    int index;
+    std::string name;
+    MP_RETURN_IF_ERROR(
+        tool::ParseTagIndexName(tag_index_name, &tag, &index, &name));
+    if (tag.empty() && name == input_stream) return true;
+  }
+  return false;
+}
+
+void RaiseMaxInQueue(int max_in_queue, FlowLimiterCalculatorOptions* options) {
+  options->set_max_in_queue(std::max(options->max_in_queue(), max_in_queue));
+}
+
+}  // namespace
+
+FrameThrottle::FrameThrottle(int max_in_flight)
+    : max_in_flight_(max_in_flight) {}
+
+bool FrameThrottle::Acquire(Timestamp timestamp) {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(
+      +[](FrameThrottle* throttle) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+           throttle->mutex_) {
+        return throttle->closed_ ||
+               throttle->in_flight_.size() < throttle->max_in_flight_;
+      },
+      this));
+  if (closed_) return false;
+  in_flight_.push_back(timestamp);
+  return true;
+}
+
+void FrameThrottle::Release(Timestamp timestamp) {
+  absl::MutexLock lock(&mutex_);
+  while (!in_flight_.empty() && in_flight_.front() <= timestamp) {
+    in_flight_.pop_front();
+  }
+}
+
+void FrameThrottle::Close() {
+  absl::MutexLock lock(&mutex_);
+  closed_ = true;
+}
+
+int FrameThrottle::NumInFlight() {
+  absl::MutexLock lock(&mutex_);
+  return in_flight_.size();
+}
+
+absl::Status QueueFlowLimiterInput(const std::string& input_stream,
+                                   int max_in_queue,
+                                   CalculatorGraphConfig* config) {
+  RET_CHECK_GE(max_in_queue, 0);
+  for (auto& node : *config->mutable_node()) {
+    if (node.calculator() != kFlowLimiterCalculator) continue;
+    ASSIGN_OR_RETURN(bool reads_frames, ReadsFrames(node, input_stream));
+    if (!reads_frames) continue;
+    // The calculator reads "options" if present, and "node_options" otherwise.
+    if (node.has_options()) {
+      RaiseMaxInQueue(max_in_queue, node.mutable_options()->MutableExtension(
+                                        FlowLimiterCalculatorOptions::ext));
+      continue;
+    }
+    FlowLimiterCalculatorOptions options;
+    mediapipe::protobuf::Any* packed_options = nullptr;
+    for (auto& any : *node.mutable_node_options()) {
+      if (any.Is<FlowLimiterCalculatorOptions>()) {
+        RET_CHECK(any.UnpackTo(&options));
+        packed_options = &any;
+      }
+    }
+    if (!packed_options) packed_options = node.add_node_options();
+    RaiseMaxInQueue(max_in_queue, &options);
+    packed_options->PackFrom(options);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
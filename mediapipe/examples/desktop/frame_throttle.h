@@ -0,0 +1,77 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_EXAMPLES_DESKTOP_FRAME_THROTTLE_H_
+#define MEDIAPIPE_EXAMPLES_DESKTOP_FRAME_THROTTLE_H_
+
+#include <deque>
+#include <string>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+
+// Limits the number of frames between the capture and the render stage of a
+// pipelined runner. A webcam paces the capture by itself, and the
+// FlowLimiterCalculator drops the frames the graph has no time for. A video
+// file is decoded as fast as possible instead, so its frames have to wait for
+// the render stage to keep up, or they would be dropped.
+//
+// Usage, with capture and render on different threads:
+//   FrameThrottle throttle(2);
+//   // Capture thread.
+//   if (!throttle.Acquire(timestamp)) return;
+//   graph.AddPacketToInputStream(stream, packet.At(timestamp));
+//   // Render thread.
+//   throttle.Release(output_packet.Timestamp());
+class FrameThrottle {
+ public:
+  explicit FrameThrottle(int max_in_flight);
+
+  // Waits until fewer than max_in_flight frames are in flight, then adds the
+  // frame at timestamp. Returns false, without adding the frame, once the
+  // throttle is closed.
+  bool Acquire(Timestamp timestamp);
+
+  // Finishes the frames in flight up to and including timestamp. Frames the
+  // graph dropped are finished by the next frame that comes out.
+  void Release(Timestamp timestamp);
+
+  // Unblocks Acquire, e.g. when the render stage stops.
+  void Close();
+
+  int NumInFlight();
+
+ private:
+  const int max_in_flight_;
+  absl::Mutex mutex_;
+  std::deque<Timestamp> in_flight_ ABSL_GUARDED_BY(mutex_);
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+// Lets the FlowLimiterCalculator nodes reading input_stream queue up to
+// max_in_queue frames rather than dropping them. A FrameThrottle with the same
+// limit then never has a frame dropped: the next frame can be sent while the
+// "FINISHED" packet of the previous one is still on its way back to the
+// FlowLimiterCalculator. Nodes within subgraphs are not affected.
+absl::Status QueueFlowLimiterInput(const std::string& input_stream,
+                                   int max_in_queue,
+                                   CalculatorGraphConfig* config);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_EXAMPLES_DESKTOP_FRAME_THROTTLE_H_
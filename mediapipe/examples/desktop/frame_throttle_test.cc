@@ -0,0 +1,227 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/examples/desktop/frame_throttle.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/core/flow_limiter_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/output_packet_queue.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr int kNumFrames = 30;
+
+// Passes packets through after sleeping, like a busy graph.
+class SlowPassThroughCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).SetAny();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    absl::SleepFor(absl::Milliseconds(5));
+    cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(SlowPassThroughCalculator);
+
+// A live graph as in mediapipe/graphs, with a default FlowLimiterCalculator.
+CalculatorGraphConfig LiveGraphConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "input_video"
+    output_stream: "output_video"
+    node {
+      calculator: "FlowLimiterCalculator"
+      input_stream: "input_video"
+      input_stream: "FINISHED:output_video"
+      input_stream_info: { tag_index: "FINISHED" back_edge: true }
+      output_stream: "throttled_input_video"
+    }
+    node {
+      calculator: "SlowPassThroughCalculator"
+      input_stream: "throttled_input_video"
+      output_stream: "output_video"
+    }
+  )pb");
+}
+
+// Sends kNumFrames frames from a capture thread, throttled if throttle is set,
+// and returns the timestamps of the rendered frames.
+std::vector<int64> RunPipelined(const CalculatorGraphConfig& config,
+                                FrameThrottle* throttle) {
+  CalculatorGraph graph;
+  MP_EXPECT_OK(graph.Initialize(config));
+  auto queue_or = graph.AddOutputPacketQueue("output_video");
+  MP_EXPECT_OK(queue_or.status());
+  std::shared_ptr<OutputPacketQueue> queue = queue_or.value();
+  MP_EXPECT_OK(graph.StartRun({}));
+
+  std::vector<int64> rendered;
+  {
+    ThreadPool capture_thread("capture", 1);
+    capture_thread.StartWorkers();
+    capture_thread.Schedule([&] {
+      for (int i = 0; i < kNumFrames; ++i) {
+        if (throttle && !throttle->Acquire(Timestamp(i))) break;
+        MP_EXPECT_OK(graph.AddPacketToInputStream(
+            "input_video", MakePacket<int>(i).At(Timestamp(i))));
+      }
+      MP_EXPECT_OK(graph.CloseInputStream("input_video"));
+    });
+    std::vector<Packet> packets;
+    while (queue->NextBatch(&packets)) {
+      for (const Packet& packet : packets) {
+        rendered.push_back(packet.Timestamp().Value());
+      }
+      if (throttle && !packets.empty()) {
+        throttle->Release(packets.back().Timestamp());
+      }
+    }
+  }
+  MP_EXPECT_OK(graph.WaitUntilDone());
+  return rendered;
+}
+
+TEST(FrameThrottleTest, LimitsFramesInFlight) {
+  FrameThrottle throttle(2);
+  ASSERT_TRUE(throttle.Acquire(Timestamp(0)));
+  ASSERT_TRUE(throttle.Acquire(Timestamp(1)));
+  EXPECT_EQ(throttle.NumInFlight(), 2);
+
+  absl::Notification acquired;
+  {
+    ThreadPool capture_thread("capture", 1);
+    capture_thread.StartWorkers();
+    capture_thread.Schedule([&] {
+      EXPECT_TRUE(throttle.Acquire(Timestamp(2)));
+      acquired.Notify();
+    });
+    absl::SleepFor(absl::Milliseconds(20));
+    EXPECT_FALSE(acquired.HasBeenNotified());
+    throttle.Release(Timestamp(0));
+  }
+  EXPECT_TRUE(acquired.HasBeenNotified());
+  EXPECT_EQ(throttle.NumInFlight(), 2);
+
+  // Frames dropped before the released timestamp are finished as well.
+  throttle.Release(Timestamp(2));
+  EXPECT_EQ(throttle.NumInFlight(), 0);
+}
+
+TEST(FrameThrottleTest, CloseUnblocksAcquire) {
+  FrameThrottle throttle(1);
+  ASSERT_TRUE(throttle.Acquire(Timestamp(0)));
+  bool acquired = true;
+  {
+    ThreadPool capture_thread("capture", 1);
+    capture_thread.StartWorkers();
+    capture_thread.Schedule([&] { acquired = throttle.Acquire(Timestamp(1)); });
+    throttle.Close();
+  }
+  EXPECT_FALSE(acquired);
+  EXPECT_EQ(throttle.NumInFlight(), 1);
+}
+
+TEST(FrameThrottleTest, QueueFlowLimiterInputSetsOptions) {
+  auto config = ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "input_video"
+    node {
+      calculator: "FlowLimiterCalculator"
+      input_stream: "input_video"
+      input_stream: "FINISHED:output_video"
+      output_stream: "a"
+    }
+    node {
+      calculator: "FlowLimiterCalculator"
+      input_stream: "input_video"
+      input_stream: "FINISHED:output_video"
+      output_stream: "b"
+      node_options: {
+        [type.googleapis.com/mediapipe.FlowLimiterCalculatorOptions] {
+          max_in_queue: 1
+          in_flight_timeout: 0
+        }
+      }
+    }
+    node {
+      calculator: "FlowLimiterCalculator"
+      input_stream: "input_video"
+      input_stream: "FINISHED:output_video"
+      output_stream: "c"
+      options: {
+        [mediapipe.FlowLimiterCalculatorOptions.ext] { max_in_queue: 5 }
+      }
+    }
+    node {
+      calculator: "FlowLimiterCalculator"
+      input_stream: "other_video"
+      input_stream: "FINISHED:input_video"
+      output_stream: "d"
+    }
+  )pb");
+  MP_ASSERT_OK(QueueFlowLimiterInput("input_video", 2, &config));
+
+  FlowLimiterCalculatorOptions options;
+  ASSERT_EQ(config.node(0).node_options_size(), 1);
+  ASSERT_TRUE(config.node(0).node_options(0).UnpackTo(&options));
+  EXPECT_EQ(options.max_in_queue(), 2);
+
+  ASSERT_EQ(config.node(1).node_options_size(), 1);
+  ASSERT_TRUE(config.node(1).node_options(0).UnpackTo(&options));
+  EXPECT_EQ(options.max_in_queue(), 2);
+  EXPECT_EQ(options.in_flight_timeout(), 0);
+
+  options =
+      config.node(2).options().GetExtension(FlowLimiterCalculatorOptions::ext);
+  EXPECT_EQ(options.max_in_queue(), 5);
+
+  // Only the untagged frame input counts.
+  EXPECT_FALSE(config.node(3).has_options());
+  EXPECT_EQ(config.node(3).node_options_size(), 0);
+}
+
+TEST(FrameThrottleTest, UnthrottledVideoLosesFrames) {
+  std::vector<int64> rendered = RunPipelined(LiveGraphConfig(), nullptr);
+  EXPECT_LT(rendered.size(), kNumFrames);
+}
+
+TEST(FrameThrottleTest, ThrottledVideoKeepsAllFrames) {
+  CalculatorGraphConfig config = LiveGraphConfig();
+  MP_ASSERT_OK(QueueFlowLimiterInput("input_video", 2, &config));
+  FrameThrottle throttle(2);
+  std::vector<int64> rendered = RunPipelined(config, &throttle);
+  std::vector<int64> expected;
+  for (int i = 0; i < kNumFrames; ++i) expected.push_back(i);
+  EXPECT_EQ(rendered, expected);
+  EXPECT_EQ(throttle.NumInFlight(), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,203 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// A main function to benchmark a MediaPipe graph on synthetic or recorded
+// video frames. Reports throughput, end-to-end latency percentiles,
+// per-calculator process time, peak RSS and heap allocations as JSON.
+//
+// Example:
+// bazel run -c opt --define MEDIAPIPE_DISABLE_GPU=1 \
+//   mediapipe/examples/desktop:mediapipe_graph_benchmark -- \
+//   --calculator_graph_config_file=\
+//     mediapipe/graphs/holistic_tracking/holistic_tracking_cpu.pbtxt \
+//   --num_frames=300 --frame_rate=30
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_split.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/opencv_video_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/tool/graph_benchmark.h"
+
+ABSL_FLAG(std::string, calculator_graph_config_file, "",
+          "Name of file containing text format CalculatorGraphConfig proto.");
+ABSL_FLAG(std::string, input_stream, "input_video",
+          "The graph input stream receiving ImageFrame packets.");
+ABSL_FLAG(std::string, output_streams, "output_video",
+          "Comma-separated list of graph output streams determining when a "
+          "frame is complete.");
+ABSL_FLAG(std::string, input_side_packets, "",
+          "Comma-separated list of key=value pairs specifying side packets "
+          "for the CalculatorGraph. All values will be treated as the "
+          "string type.");
+ABSL_FLAG(std::string, input_video_path, "",
+          "Full path of video to load frames from. Frames are decoded before "
+          "the benchmark starts and repeated as needed. If not provided, "
+          "synthetic frames of --frame_width x --frame_height are used.");
+ABSL_FLAG(int, frame_width, 640, "Width of synthetic frames.");
+ABSL_FLAG(int, frame_height, 480, "Height of synthetic frames.");
+ABSL_FLAG(int, max_distinct_frames, 300,
+          "Maximum number of distinct frames held in memory.");
+ABSL_FLAG(int, num_warmup_frames, 30, "Number of frames before measuring.");
+ABSL_FLAG(int, num_frames, 300, "Number of measured frames.");
+ABSL_FLAG(double, frame_rate, 0,
+          "Rate at which frames are fed, in frames per second. The value 0 "
+          "feeds frames as fast as the graph accepts them.");
+ABSL_FLAG(std::string, output_json_file, "",
+          "File to write the JSON report to. Printed to stdout if empty.");
+
+namespace {
+
+// Counters of the global allocation functions replaced below.
+std::atomic<int64> allocation_count(0);
+std::atomic<int64> allocation_bytes(0);
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+absl::Status LoadFrames(std::vector<mediapipe::Packet>* frames) {
+  const int max_frames = absl::GetFlag(FLAGS_max_distinct_frames);
+  if (absl::GetFlag(FLAGS_input_video_path).empty()) {
+    // Noise keeps calculators from taking shortcuts on uniform images.
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> noise(0, 255);
+    for (int i = 0; i < std::min(max_frames, 8); ++i) {
+      auto frame = absl::make_unique<mediapipe::ImageFrame>(
+          mediapipe::ImageFormat::SRGB, absl::GetFlag(FLAGS_frame_width),
+          absl::GetFlag(FLAGS_frame_height),
+          mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+      cv::Mat mat = mediapipe::formats::MatView(frame.get());
+      for (int y = 0; y < mat.rows; ++y) {
+        uint8* row = mat.ptr<uint8>(y);
+        for (int x = 0; x < mat.cols * mat.channels(); ++x) {
+          row[x] = noise(rng);
+        }
+      }
+      frames->push_back(mediapipe::Adopt(frame.release()));
+    }
+    return absl::OkStatus();
+  }
+
+  cv::VideoCapture capture(absl::GetFlag(FLAGS_input_video_path));
+  RET_CHECK(capture.isOpened());
+  cv::Mat camera_frame_raw;
+  while (frames->size() < max_frames && capture.read(camera_frame_raw) &&
+         !camera_frame_raw.empty()) {
+    auto frame = absl::make_unique<mediapipe::ImageFrame>(
+        mediapipe::ImageFormat::SRGB, camera_frame_raw.cols,
+        camera_frame_raw.rows,
+        mediapipe::ImageFrame::kDefaultAlignmentBoundary);
+    cv::cvtColor(camera_frame_raw, mediapipe::formats::MatView(frame.get()),
+                 cv::COLOR_BGR2RGB);
+    frames->push_back(mediapipe::Adopt(frame.release()));
+  }
+  RET_CHECK(!frames->empty()) << "No frames decoded.";
+  return absl::OkStatus();
+}
+
+absl::Status RunGraphBenchmark() {
+  std::string calculator_graph_config_contents;
+  MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
+      absl::GetFlag(FLAGS_calculator_graph_config_file),
+      &calculator_graph_config_contents));
+  mediapipe::CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+          calculator_graph_config_contents);
+
+  std::vector<mediapipe::Packet> frames;
+  MP_RETURN_IF_ERROR(LoadFrames(&frames));
+  LOG(INFO) << "Loaded " << frames.size() << " distinct frames.";
+
+  mediapipe::tool::GraphBenchmarkOptions options;
+  options.input_stream = absl::GetFlag(FLAGS_input_stream);
+  options.output_streams =
+      absl::StrSplit(absl::GetFlag(FLAGS_output_streams), ',');
+  options.frame_generator = [&frames](int64 index) {
+    return frames[index % frames.size()];
+  };
+  options.num_warmup_frames = absl::GetFlag(FLAGS_num_warmup_frames);
+  options.num_frames = absl::GetFlag(FLAGS_num_frames);
+  options.frame_rate = absl::GetFlag(FLAGS_frame_rate);
+  if (!absl::GetFlag(FLAGS_input_side_packets).empty()) {
+    std::vector<std::string> kv_pairs =
+        absl::StrSplit(absl::GetFlag(FLAGS_input_side_packets), ',');
+    for (const std::string& kv_pair : kv_pairs) {
+      std::vector<std::string> name_and_value = absl::StrSplit(kv_pair, '=');
+      RET_CHECK(name_and_value.size() == 2);
+      options.input_side_packets[name_and_value[0]] =
+          mediapipe::MakePacket<std::string>(name_and_value[1]);
+    }
+  }
+  options.allocation_counter = []() {
+    mediapipe::tool::AllocationCounts counts;
+    counts.count = allocation_count.load(std::memory_order_relaxed);
+    counts.bytes = allocation_bytes.load(std::memory_order_relaxed);
+    return counts;
+  };
+
+  ASSIGN_OR_RETURN(mediapipe::tool::GraphBenchmarkResult result,
+                   mediapipe::tool::RunGraphBenchmark(config, options));
+  const std::string json = mediapipe::tool::GraphBenchmarkResultToJson(result);
+  if (absl::GetFlag(FLAGS_output_json_file).empty()) {
+    std::cout << json;
+    return absl::OkStatus();
+  }
+  return mediapipe::file::SetContents(absl::GetFlag(FLAGS_output_json_file),
+                                      json);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunGraphBenchmark();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the graph benchmark: "
+               << run_status.message();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
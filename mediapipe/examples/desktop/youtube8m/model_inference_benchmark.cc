@@ -0,0 +1,174 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Measures the throughput of the YouTube-8M model inference graph with
+// TensorFlowInferenceCalculator running one input timestamp per Process() call
+// and with batch_ready_timestamps, where all the ready timestamps are run as
+// one batch. The graph is run --num_runs times in each mode.
+//
+// Example:
+// bazel run -c opt --define MEDIAPIPE_DISABLE_GPU=1 \
+//   mediapipe/examples/desktop/youtube8m:model_inference_benchmark -- \
+//   --calculator_graph_config_file=\
+//     mediapipe/graphs/youtube8m/yt8m_dataset_model_inference.pbtxt \
+//   --input_side_packets=tfrecord_path=/tmp/mediapipe/trainpj.tfrecord,\
+//     record_index=0,desired_segment_size=5
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/calculators/tensorflow/tensorflow_inference_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+ABSL_FLAG(std::string, calculator_graph_config_file,
+          "mediapipe/graphs/youtube8m/yt8m_dataset_model_inference.pbtxt",
+          "Name of file containing text format CalculatorGraphConfig proto.");
+ABSL_FLAG(std::string, input_side_packets, "",
+          "Comma-separated list of key=value pairs specifying side packets "
+          "for the CalculatorGraph. All values will be treated as the "
+          "string type.");
+ABSL_FLAG(std::string, output_stream, "annotation_summary",
+          "The output stream counted for the throughput.");
+ABSL_FLAG(int, num_runs, 5, "Number of graph runs in each mode.");
+ABSL_FLAG(int, max_batch_size, 0,
+          "Maximum number of timestamps per batched Process() call. The value "
+          "0 uses the batch_size of each TensorFlowInferenceCalculator.");
+
+namespace {
+
+struct RunStats {
+  // Output packets after the first one.
+  int64 num_packets = 0;
+  absl::Duration elapsed;
+};
+
+// Sets batch_ready_timestamps in the options of every
+// TensorFlowInferenceCalculator of the graph.
+void EnableReadyBatches(mediapipe::CalculatorGraphConfig* config,
+                        int max_batch_size) {
+  using mediapipe::TensorFlowInferenceCalculatorOptions;
+  for (auto& node : *config->mutable_node()) {
+    if (node.calculator() != "TensorFlowInferenceCalculator") continue;
+    for (auto& any : *node.mutable_node_options()) {
+      if (any.Is<TensorFlowInferenceCalculatorOptions>()) {
+        TensorFlowInferenceCalculatorOptions options;
+        any.UnpackTo(&options);
+        options.set_batch_ready_timestamps(true);
+        any.PackFrom(options);
+      }
+    }
+    auto* options = node.mutable_options();
+    if (options->HasExtension(TensorFlowInferenceCalculatorOptions::ext)) {
+      options->MutableExtension(TensorFlowInferenceCalculatorOptions::ext)
+          ->set_batch_ready_timestamps(true);
+    }
+    if (max_batch_size > 0) {
+      node.set_max_batch_size(max_batch_size);
+    }
+  }
+}
+
+// Runs the graph once. The time is measured from the first to the last output
+// packet, so that the model loading in Open() is not counted.
+absl::StatusOr<RunStats> RunGraph(
+    const mediapipe::CalculatorGraphConfig& config,
+    const std::map<std::string, mediapipe::Packet>& input_side_packets) {
+  mediapipe::CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  RunStats stats;
+  absl::Time first_packet_time = absl::InfinitePast();
+  absl::Time last_packet_time;
+  MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+      absl::GetFlag(FLAGS_output_stream),
+      [&](const mediapipe::Packet& packet) {
+        last_packet_time = absl::Now();
+        if (first_packet_time == absl::InfinitePast()) {
+          first_packet_time = last_packet_time;
+        } else {
+          ++stats.num_packets;
+        }
+        return absl::OkStatus();
+      }));
+  MP_RETURN_IF_ERROR(graph.Run(input_side_packets));
+  RET_CHECK_GT(stats.num_packets, 0) << "Too few output packets to measure.";
+  stats.elapsed = last_packet_time - first_packet_time;
+  return stats;
+}
+
+absl::Status RunBenchmark() {
+  std::string calculator_graph_config_contents;
+  MP_RETURN_IF_ERROR(mediapipe::file::GetContents(
+      absl::GetFlag(FLAGS_calculator_graph_config_file),
+      &calculator_graph_config_contents));
+  mediapipe::CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<mediapipe::CalculatorGraphConfig>(
+          calculator_graph_config_contents);
+  mediapipe::CalculatorGraphConfig batched_config = config;
+  EnableReadyBatches(&batched_config, absl::GetFlag(FLAGS_max_batch_size));
+
+  std::map<std::string, mediapipe::Packet> input_side_packets;
+  if (!absl::GetFlag(FLAGS_input_side_packets).empty()) {
+    std::vector<std::string> kv_pairs =
+        absl::StrSplit(absl::GetFlag(FLAGS_input_side_packets), ',');
+    for (const std::string& kv_pair : kv_pairs) {
+      std::vector<std::string> name_and_value = absl::StrSplit(kv_pair, '=');
+      RET_CHECK(name_and_value.size() == 2);
+      input_side_packets[name_and_value[0]] =
+          mediapipe::MakePacket<std::string>(name_and_value[1]);
+    }
+  }
+
+  // Alternates the modes so that both see the same system load.
+  RunStats totals[2];
+  for (int run = 0; run < absl::GetFlag(FLAGS_num_runs); ++run) {
+    for (int batched = 0; batched < 2; ++batched) {
+      ASSIGN_OR_RETURN(
+          RunStats stats,
+          RunGraph(batched ? batched_config : config, input_side_packets));
+      totals[batched].num_packets += stats.num_packets;
+      totals[batched].elapsed += stats.elapsed;
+    }
+  }
+  for (int batched = 0; batched < 2; ++batched) {
+    const RunStats& stats = totals[batched];
+    LOG(INFO) << (batched ? "batch_ready_timestamps" : "batch_size") << ": "
+              << stats.num_packets << " packets in " << stats.elapsed << ", "
+              << stats.num_packets / absl::ToDoubleSeconds(stats.elapsed)
+              << " packets/s";
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  google::InitGoogleLogging(argv[0]);
+  absl::ParseCommandLine(argc, argv);
+  absl::Status run_status = RunBenchmark();
+  if (!run_status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmark: " << run_status.message();
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -2,6 +2,7 @@
 
 #include <functional>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/api2/packet.h"
@@ -10,6 +11,7 @@
 #include "mediapipe/framework/api2/test_contracts.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/deps/message_matchers.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/parse_text_proto.h"
@@ -298,6 +300,124 @@ TEST(BuilderTest, EmptyTag) {
   EXPECT_THAT(graph.GetConfig(), EqualsProto(expected));
 }
 
+struct Incrementer : public NodeIntf {
+  static constexpr Input<int> kIn{"IN"};
+  static constexpr Input<int>::Optional kStep{"STEP"};
+  static constexpr Output<int> kOut{"OUT"};
+
+  MEDIAPIPE_NODE_INTERFACE(Incrementer, kIn, kStep, kOut);
+};
+
+class IncrementerImpl : public NodeImpl<Incrementer, IncrementerImpl> {
+ public:
+  absl::Status Process(CalculatorContext* cc) override {
+    const int step = kStep(cc).IsEmpty() ? 1 : *kStep(cc);
+    kOut(cc).Send(*kIn(cc) + step);
+    return {};
+  }
+};
+
+// A chain of Incrementers, built with typed nodes.
+CalculatorGraphConfig BuildIncrementerChain(int length) {
+  builder::Graph graph;
+  builder::Source<false, int> last = graph[Input<int>("IN")].SetName("in");
+  for (int i = 0; i < length; ++i) {
+    auto& node = graph.AddNode<Incrementer>();
+    last >> node[Incrementer::kIn];
+    last = node[Incrementer::kOut];
+  }
+  last.SetName("out") >> graph[Output<int>("OUT")];
+  return graph.GetConfig();
+}
+
+// The same chain as a text proto.
+std::string IncrementerChainText(int length) {
+  std::string text = R"pb(input_stream: "IN:in" output_stream: "OUT:out")pb";
+  for (int i = 0; i < length; ++i) {
+    absl::SubstituteAndAppend(
+        &text, R"pb(node {
+                      calculator: "Incrementer"
+                      input_stream: "IN:$0"
+                      output_stream: "OUT:$1"
+                    })pb",
+        i == 0 ? "in" : absl::StrCat("__stream_", i - 1),
+        i == length - 1 ? "out" : absl::StrCat("__stream_", i));
+  }
+  return text;
+}
+
+// Runs num_packets packets through the chain and returns the outputs.
+std::vector<int> RunIncrementerChain(const CalculatorGraphConfig& config,
+                                     int num_packets) {
+  std::vector<int> outputs;
+  CalculatorGraph graph;
+  MEDIAPIPE_CHECK_OK(graph.Initialize(config));
+  MEDIAPIPE_CHECK_OK(
+      graph.ObserveOutputStream("out", [&outputs](const mediapipe::Packet& p) {
+        outputs.push_back(p.Get<int>());
+        return absl::OkStatus();
+      }));
+  MEDIAPIPE_CHECK_OK(graph.StartRun({}));
+  for (int i = 0; i < num_packets; ++i) {
+    MEDIAPIPE_CHECK_OK(graph.AddPacketToInputStream(
+        "in", mediapipe::MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MEDIAPIPE_CHECK_OK(graph.CloseAllPacketSources());
+  MEDIAPIPE_CHECK_OK(graph.WaitUntilDone());
+  return outputs;
+}
+
+TEST(BuilderTest, RunsTypedGraph) {
+  const CalculatorGraphConfig config = BuildIncrementerChain(3);
+  EXPECT_THAT(config, EqualsProto(mediapipe::ParseTextProtoOrDie<
+                                  CalculatorGraphConfig>(
+                          IncrementerChainText(3))));
+  // Ports are resolved on first access and reused by later packets.
+  EXPECT_THAT(RunIncrementerChain(config, 4),
+              testing::ElementsAre(3, 4, 5, 6));
+}
+
+// Both startup paths go through CalculatorGraphConfig: the builder only
+// replaces text proto parsing. These benchmarks time graph initialization,
+// which validates the config and dominates startup, from each source.
+void BM_InitializeGraphFromBuilder(benchmark::State& state) {
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    MEDIAPIPE_CHECK_OK(graph.Initialize(BuildIncrementerChain(state.range(0))));
+  }
+}
+BENCHMARK(BM_InitializeGraphFromBuilder)->Arg(10)->Arg(100);
+
+void BM_InitializeGraphFromProto(benchmark::State& state) {
+  const std::string text = IncrementerChainText(state.range(0));
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    MEDIAPIPE_CHECK_OK(graph.Initialize(
+        mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(text)));
+  }
+}
+BENCHMARK(BM_InitializeGraphFromProto)->Arg(10)->Arg(100);
+
+// Initialization alone, from a config prepared beforehand.
+void BM_InitializeGraph(benchmark::State& state) {
+  const CalculatorGraphConfig config = BuildIncrementerChain(state.range(0));
+  for (auto _ : state) {
+    CalculatorGraph graph;
+    MEDIAPIPE_CHECK_OK(graph.Initialize(config));
+  }
+}
+BENCHMARK(BM_InitializeGraph)->Arg(10)->Arg(100);
+
+// Packets through a chain of 10 typed nodes, each accessing its ports by tag.
+void BM_RunTypedGraph(benchmark::State& state) {
+  const CalculatorGraphConfig config = BuildIncrementerChain(10);
+  for (auto _ : state) {
+    RunIncrementerChain(config, state.range(0));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RunTypedGraph)->Arg(1000);
+
 }  // namespace test
 }  // namespace api2
 }  // namespace mediapipe
@@ -167,7 +167,6 @@ struct IsCompatibleType<V, OneOf<U...>>
 template <typename T>
 inline Packet<T> PacketBase::As() const {
   if (!payload_) return Packet<T>().At(timestamp_);
-  packet_internal::Holder<T>* typed_payload = payload_->As<T>();
   internal::CheckCompatibleType(*payload_, internal::Wrap<T>{});
   return Packet<T>(payload_).At(timestamp_);
 }
@@ -197,6 +196,14 @@ class Packet<internal::Generic> : public PacketBase {
   friend PacketBase;
 };
 
+namespace internal {
+// Returns a Packet<T> sharing the payload of op without checking its type. op
+// must be known to hold a T, e.g. because it was received on an input stream
+// of type T, whose packets the framework validates.
+template <typename T>
+Packet<T> FromValidatedOldPacket(const mediapipe::Packet& op);
+}  // namespace internal
+
 // Having Packet<T> subclass Packet<Generic> will require hiding some methods
 // like As. May be better not to subclass, and allow implicit conversion
 // instead.
@@ -208,11 +215,13 @@ class Packet : public Packet<internal::Generic> {
   Packet<T> At(Timestamp timestamp) const&;
   Packet<T> At(Timestamp timestamp) &&;
 
+  // The type of the payload was checked when this packet was created, so it
+  // is not checked again here.
   const T& Get() const {
     CHECK(payload_);
-    packet_internal::Holder<T>* typed_payload = payload_->As<T>();
-    CHECK(typed_payload);
-    return typed_payload->data();
+    DCHECK(payload_->As<T>());
+    return static_cast<const packet_internal::Holder<T>*>(payload_.get())
+        ->data();
   }
   const T& operator*() const { return Get(); }
 
@@ -239,6 +248,9 @@ class Packet : public Packet<internal::Generic> {
   friend Packet<U> PacketAdopting(const U* ptr);
   template <typename U>
   friend Packet<U> PacketAdopting(std::unique_ptr<U> ptr);
+  template <typename U>
+  friend Packet<U> internal::FromValidatedOldPacket(
+      const mediapipe::Packet& op);
 };
 
 namespace internal {
@@ -445,12 +457,26 @@ inline Packet<internal::Generic> Packet<internal::Generic>::At(
   return std::move(*this);
 }
 
+// Small trivially copyable payloads are stored in the holder itself, which
+// makes creating the packet a single allocation.
 template <typename T, typename... Args>
 Packet<T> MakePacket(Args&&... args) {
-  return Packet<T>(std::make_shared<packet_internal::Holder<T>>(
-      new T(std::forward<Args>(args)...)));
+  if constexpr (packet_internal::IsInlinePayload<T>::value) {
+    return Packet<T>(std::make_shared<packet_internal::InlineHolder<T>>(
+        std::forward<Args>(args)...));
+  } else {
+    return Packet<T>(std::make_shared<packet_internal::Holder<T>>(
+        new T(std::forward<Args>(args)...)));
+  }
 }
 
+namespace internal {
+template <typename T>
+Packet<T> FromValidatedOldPacket(const mediapipe::Packet& op) {
+  return Packet<T>(packet_internal::GetHolderShared(op)).At(op.Timestamp());
+}
+}  // namespace internal
+
 template <typename T>
 Packet<T> PacketAdopting(const T* ptr) {
   return Packet<T>(std::make_shared<packet_internal::Holder<T>>(ptr));
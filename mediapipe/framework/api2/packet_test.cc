@@ -1,6 +1,7 @@
 #include "mediapipe/framework/api2/packet.h"
 
 #include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/status_matchers.h"
@@ -242,6 +243,85 @@ TEST(PacketTest, OneOfConsume) {
   EXPECT_TRUE(p.IsEmpty());
 }
 
+TEST(PacketTest, InlinePayload) {
+  Packet<float> p = MakePacket<float>(2.5f).At(Timestamp(10));
+  const HolderBase* holder = packet_internal::GetHolder(ToOldPacket(p));
+  const char* data = reinterpret_cast<const char*>(&p.Get());
+  EXPECT_GE(data, reinterpret_cast<const char*>(holder));
+  EXPECT_LT(data, reinterpret_cast<const char*>(holder) +
+                      sizeof(packet_internal::InlineHolder<float>));
+
+  mediapipe::Packet op = ToOldPacket(p);
+  EXPECT_EQ(op.Get<float>(), 2.5f);
+  PacketBase pb = FromOldPacket(op);
+  EXPECT_EQ(pb.As<float>().Get(), 2.5f);
+  op = {};
+  pb = {};
+
+  auto maybe_float = p.Consume();
+  MP_ASSERT_OK(maybe_float);
+  EXPECT_EQ(*maybe_float.value(), 2.5f);
+  EXPECT_TRUE(p.IsEmpty());
+}
+
+TEST(PacketTest, FromValidatedOldPacket) {
+  mediapipe::Packet op = mediapipe::MakePacket<int>(4).At(Timestamp(5));
+  Packet<int> p = internal::FromValidatedOldPacket<int>(op);
+  EXPECT_EQ(p.Get(), 4);
+  EXPECT_EQ(p.timestamp(), Timestamp(5));
+  EXPECT_TRUE(internal::FromValidatedOldPacket<int>({}).IsEmpty());
+}
+
+struct Rect {
+  float x_center;
+  float y_center;
+  float width;
+  float height;
+  float rotation;
+};
+
+void BM_MakePacketInline(benchmark::State& state) {
+  for (auto _ : state) {
+    Packet<Rect> p = MakePacket<Rect>(Rect{0.5f, 0.5f, 0.2f, 0.3f, 0.0f});
+    benchmark::DoNotOptimize(p);
+  }
+}
+BENCHMARK(BM_MakePacketInline);
+
+void BM_MakePacketAdopting(benchmark::State& state) {
+  for (auto _ : state) {
+    Packet<Rect> p = PacketAdopting(new Rect{0.5f, 0.5f, 0.2f, 0.3f, 0.0f});
+    benchmark::DoNotOptimize(p);
+  }
+}
+BENCHMARK(BM_MakePacketAdopting);
+
+void BM_GetTyped(benchmark::State& state) {
+  Packet<Rect> p = MakePacket<Rect>(Rect{0.5f, 0.5f, 0.2f, 0.3f, 0.0f});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(p.Get().width);
+  }
+}
+BENCHMARK(BM_GetTyped);
+
+void BM_FromOldPacketAs(benchmark::State& state) {
+  mediapipe::Packet op = ToOldPacket(MakePacket<Rect>());
+  for (auto _ : state) {
+    Packet<Rect> p = FromOldPacket(op).As<Rect>();
+    benchmark::DoNotOptimize(p);
+  }
+}
+BENCHMARK(BM_FromOldPacketAs);
+
+void BM_FromValidatedOldPacket(benchmark::State& state) {
+  mediapipe::Packet op = ToOldPacket(MakePacket<Rect>());
+  for (auto _ : state) {
+    Packet<Rect> p = internal::FromValidatedOldPacket<Rect>(op);
+    benchmark::DoNotOptimize(p);
+  }
+}
+BENCHMARK(BM_FromValidatedOldPacket);
+
 }  // namespace
 }  // namespace api2
 }  // namespace mediapipe
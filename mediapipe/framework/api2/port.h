@@ -142,6 +142,26 @@ auto GetOrNull(Collection& collection, const std::string& tag, int index)
   return id.IsValid() ? &collection.Get(id) : nullptr;
 }
 
+// Returns the first entry for tag in collection, or null if there is none, and
+// the number of entries for tag.
+template <class Collection>
+auto GetEntries(CalculatorContract* cc, Collection& collection, const char* tag)
+    -> std::pair<decltype(&collection.Get(std::declval<CollectionItemId>())),
+                 int> {
+  return {GetOrNull(collection, tag, 0), collection.NumEntries(tag)};
+}
+
+// Within a CalculatorContext the tag is resolved once, so that accessing a
+// port while processing packets does not look up its tag every time.
+template <class Collection>
+auto GetEntries(CalculatorContext* cc, Collection& collection, const char* tag)
+    -> std::pair<decltype(&collection.Get(std::declval<CollectionItemId>())),
+                 int> {
+  const auto resolved = cc->ResolveTag(collection, tag);
+  return {resolved.first.IsValid() ? &collection.Get(resolved.first) : nullptr,
+          resolved.second};
+}
+
 template <class T>
 struct IsOneOf : std::false_type {};
 
@@ -220,7 +240,7 @@ template <typename ValueT, typename PortT, class CC>
 auto AccessPort(std::false_type, const PortT& port, CC* cc) {
   auto& collection = GetCollection(cc, port);
   return SinglePortAccess<ValueT>(
-      cc, internal::GetOrNull(collection, port.Tag(), 0));
+      cc, internal::GetEntries(cc, collection, port.Tag()).first);
 }
 
 template <typename ValueT, typename X, class CC>
@@ -280,10 +300,10 @@ class MultiplePortAccess {
 template <typename ValueT, typename PortT, class CC>
 auto AccessPort(std::true_type, const PortT& port, CC* cc) {
   auto& collection = GetCollection(cc, port);
-  auto* first = internal::GetOrNull(collection, port.Tag(), 0);
-  using EntryT = typename std::remove_pointer<decltype(first)>::type;
-  return MultiplePortAccess<ValueT, EntryT, CC>(
-      cc, first, collection.NumEntries(port.Tag()));
+  auto entries = internal::GetEntries(cc, collection, port.Tag());
+  using EntryT = typename std::remove_pointer<decltype(entries.first)>::type;
+  return MultiplePortAccess<ValueT, EntryT, CC>(cc, entries.first,
+                                                entries.second);
 }
 
 template <class Base>
@@ -405,8 +425,8 @@ class SideFallbackT : public Base {
     auto& stream_collection = internal::GetCollection(cc, stream_port);
     auto& side_collection = internal::GetCollection(cc, side_port);
     return internal::SinglePortAccess<PayloadT>(
-        cc, internal::GetOrNull(stream_collection, Tag(), 0),
-        internal::GetOrNull(side_collection, Tag(), 0));
+        cc, internal::GetEntries(cc, stream_collection, Tag()).first,
+        internal::GetEntries(cc, side_collection, Tag()).first);
   }
 
   template <std::size_t N>
@@ -593,10 +613,21 @@ class InputShardAccess : public Packet<T> {
 
  private:
   InputShardAccess(const CalculatorContext&, InputStreamShard* stream)
-      : Packet<T>(stream ? FromOldPacket(stream->Value()).template As<T>()
-                         : Packet<T>()),
+      : Packet<T>(stream ? FromStreamPacket(stream->Value()) : Packet<T>()),
         stream_(stream) {}
 
+  // The framework validates the packets of an input stream against its type,
+  // which for a concrete T is exactly T. Only packets of streams that may hold
+  // one of several types need checking here.
+  static Packet<T> FromStreamPacket(const mediapipe::Packet& packet) {
+    if constexpr (internal::IsOneOf<T>{} ||
+                  std::is_same<T, internal::Generic>{}) {
+      return FromOldPacket(packet).template As<T>();
+    } else {
+      return internal::FromValidatedOldPacket<T>(packet);
+    }
+  }
+
   template <class F, class... A>
   auto WrapConsumeCall(F f, A&&... args) {
     stream_->Value() = {};
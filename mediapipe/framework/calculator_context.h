@@ -15,12 +15,14 @@
 #ifndef MEDIAPIPE_FRAMEWORK_CALCULATOR_CONTEXT_H_
 #define MEDIAPIPE_FRAMEWORK_CALCULATOR_CONTEXT_H_
 
+#include <deque>
 #include <memory>
-#include <queue>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "mediapipe/framework/calculator_state.h"
+#include "mediapipe/framework/collection_item_id.h"
 #include "mediapipe/framework/counter.h"
 #include "mediapipe/framework/graph_service.h"
 #include "mediapipe/framework/input_stream_shard.h"
@@ -85,6 +87,19 @@ class CalculatorContext {
                                      : input_timestamps_.front();
   }
 
+  // Returns the number of input timestamps delivered to this Process() call.
+  // This is 1 unless the calculator declared batch support with
+  // CalculatorContract::SetMaxBatchSize().
+  int BatchSize() const { return batch_size_; }
+
+  // Returns the i-th input timestamp of a batched Process() call, in
+  // increasing order. BatchInputTimestamp(0) is InputTimestamp(). The
+  // packets of the i-th timestamp are InputStreamShard::BatchValue(i).
+  Timestamp BatchInputTimestamp(int i) const {
+    CHECK_LT(i, NumberOfTimestamps());
+    return input_timestamps_[i];
+  }
+
   // Returns a reference to the input side packet set.
   const PacketSet& InputSidePackets() const;
   // Returns a reference to the output side packet collection.
@@ -118,7 +133,33 @@ class CalculatorContext {
     return ServiceBinding<T>(calculator_state_->GetServiceObject(service));
   }
 
+  // Returns the id of the first entry for tag in collection, which must be
+  // one of the collections of this context, and the number of entries for
+  // tag. The tag is only looked up the first time, later calls return the
+  // cached result, so tag must have static storage: this is meant for api2
+  // ports, whose tags are string literals.
+  template <class Collection>
+  std::pair<CollectionItemId, int> ResolveTag(const Collection& collection,
+                                              const char* tag) {
+    for (const ResolvedTag& resolved : resolved_tags_) {
+      if (resolved.tag == tag && resolved.collection == &collection) {
+        return {resolved.id, resolved.count};
+      }
+    }
+    const CollectionItemId id = collection.GetId(tag, 0);
+    const int count = collection.NumEntries(tag);
+    resolved_tags_.push_back({&collection, tag, id, count});
+    return {id, count};
+  }
+
  private:
+  struct ResolvedTag {
+    const void* collection;
+    const char* tag;
+    CollectionItemId id;
+    int count;
+  };
+
   int NumberOfTimestamps() const {
     return static_cast<int>(input_timestamps_.size());
   }
@@ -127,12 +168,12 @@ class CalculatorContext {
 
   // Adds a new input timestamp by the friend class CalculatorContextManager.
   void PushInputTimestamp(Timestamp input_timestamp) {
-    input_timestamps_.push(input_timestamp);
+    input_timestamps_.push_back(input_timestamp);
   }
 
   void PopInputTimestamp() {
     CHECK(!input_timestamps_.empty());
-    input_timestamps_.pop();
+    input_timestamps_.pop_front();
   }
 
   void SetGraphStatus(const absl::Status& status) { graph_status_ = status; }
@@ -153,11 +194,17 @@ class CalculatorContext {
   mutable std::unique_ptr<InputStreamSet> input_streams_;
   mutable std::unique_ptr<OutputStreamSet> output_streams_;
   // The queue of timestamp values to Process() in this calculator context.
-  std::queue<Timestamp> input_timestamps_;
+  std::deque<Timestamp> input_timestamps_;
+  // The number of input timestamps delivered to the current Process() call.
+  int batch_size_ = 1;
 
   // The status of the graph run. Only used when Close() is called.
   absl::Status graph_status_;
 
+  // Tags resolved by ResolveTag. A node has few ports, so a linear search over
+  // pointers is faster than any lookup by tag.
+  std::vector<ResolvedTag> resolved_tags_;
+
   // Accesses CalculatorContext for setting input timestamp.
   friend class CalculatorContextManager;
 };
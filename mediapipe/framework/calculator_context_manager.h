@@ -106,6 +106,14 @@ class CalculatorContextManager {
     calculator_context->PopInputTimestamp();
   }
 
+  // Sets the number of input timestamps delivered to the next Process() call
+  // with calculator_context.
+  void SetContextBatchSize(CalculatorContext* calculator_context,
+                           int batch_size) {
+    CHECK(calculator_context);
+    calculator_context->batch_size_ = batch_size;
+  }
+
   void SetGraphStatusInContext(CalculatorContext* calculator_context,
                                const absl::Status& status) {
     CHECK(calculator_context);
@@ -131,6 +131,15 @@ class CalculatorContract {
   void SetTimestampOffset(TimestampDiff offset) { timestamp_offset_ = offset; }
   TimestampDiff GetTimestampOffset() const { return timestamp_offset_; }
 
+  // Declares that Process can handle up to max_batch_size input timestamps in
+  // a single call. The framework then delivers all the timestamps that are
+  // ready when the calculator is scheduled, up to this limit, see
+  // CalculatorContext::BatchSize(). It never waits for a batch to fill up.
+  // CalculatorGraphConfig::Node::max_batch_size can lower the limit.
+  // Batching is disabled for nodes with max_in_flight greater than 1.
+  void SetMaxBatchSize(int max_batch_size) { max_batch_size_ = max_batch_size; }
+  int GetMaxBatchSize() const { return max_batch_size_; }
+
   class GraphServiceRequest {
    public:
     // APIs that should be used by calculators.
@@ -183,6 +192,7 @@ class CalculatorContract {
   std::map<std::string, GraphServiceRequest> service_requests_;
   bool process_timestamps_ = false;
   TimestampDiff timestamp_offset_ = TimestampDiff::Unset();
+  int max_batch_size_ = 1;
 
   friend class CalculatorNode;
 };
@@ -135,6 +135,8 @@ CalculatorGraph::~CalculatorGraph() {
   if (!status.ok()) {
     LOG(ERROR) << "During graph destruction: " << status;
   }
+  // The profiler may outlive the graph and its packet memory counters.
+  profiler_->SetPacketMemoryTracker(nullptr);
 }
 
 absl::Status CalculatorGraph::InitializePacketGeneratorGraph(
@@ -179,6 +181,22 @@ absl::Status CalculatorGraph::InitializeStreams() {
         edge_info.name, edge_info.packet_type, edge_info.back_edge));
   }
 
+  // Count the packet bytes queued in the input streams, if requested.
+  const CalculatorGraphConfig& config = validated_graph_->Config();
+  if (config.packet_memory_budget() > 0 ||
+      config.profiler_config().enable_packet_memory_accounting()) {
+    PacketMemoryAccounting::SetEnabled(true);
+    packet_memory_ = absl::make_unique<PacketMemoryTracker>(
+        std::max<int64>(config.packet_memory_budget(), 0));
+    packet_memory_->SetBudgetCallback(
+        std::bind(&CalculatorGraph::UpdateMemoryThrottle, this));
+    for (int index = 0; index < validated_graph_->InputStreamInfos().size();
+         ++index) {
+      input_stream_managers_[index].SetPacketMemoryTracker(
+          packet_memory_.get());
+    }
+  }
+
   // Create and initialize the output streams.
   output_stream_managers_ = absl::make_unique<OutputStreamManager[]>(
       validated_graph_->OutputStreamInfos().size());
@@ -298,6 +316,7 @@ absl::Status CalculatorGraph::InitializePacketGeneratorNodes(
 
 absl::Status CalculatorGraph::InitializeProfiler() {
   profiler_->Initialize(*validated_graph_);
+  profiler_->SetPacketMemoryTracker(packet_memory_.get());
   return absl::OkStatus();
 }
 
@@ -485,6 +504,32 @@ absl::StatusOr<OutputStreamPoller> CalculatorGraph::AddOutputStreamPoller(
   return std::move(poller);
 }
 
+absl::StatusOr<std::shared_ptr<OutputPacketQueue>>
+CalculatorGraph::AddOutputPacketQueue(const std::string& stream_name,
+                                      int max_queue_size) {
+  RET_CHECK(initialized_).SetNoLogging()
+      << "CalculatorGraph is not initialized.";
+  int output_stream_index = validated_graph_->OutputStreamIndex(stream_name);
+  if (output_stream_index < 0) {
+    return mediapipe::NotFoundErrorBuilder(MEDIAPIPE_LOC)
+           << "Unable to attach observer to output stream \"" << stream_name
+           << "\" because it doesn't exist.";
+  }
+  auto queue = std::make_shared<OutputPacketQueue>(max_queue_size);
+  auto observer = absl::make_unique<internal::OutputStreamObserver>();
+  MP_RETURN_IF_ERROR(observer->Initialize(
+      stream_name, &any_packet_type_,
+      [queue](const Packet& packet) {
+        queue->Push(packet);
+        return absl::OkStatus();
+      },
+      &output_stream_managers_[output_stream_index]));
+  observer->SetDoneCallback([queue] { queue->Close(); });
+  graph_output_streams_.push_back(std::move(observer));
+  output_packet_queues_.push_back(queue);
+  return queue;
+}
+
 absl::StatusOr<Packet> CalculatorGraph::GetOutputSidePacket(
     const std::string& packet_name) {
   int side_packet_index = validated_graph_->OutputSidePacketIndex(packet_name);
@@ -697,6 +742,8 @@ absl::Status CalculatorGraph::PrepareForRun(
     full_input_streams_.clear();
     full_input_streams_.resize(validated_graph_->CalculatorInfos().size() +
                                graph_input_streams_.size());
+    // The scheduler has been reset, including its throttled stream count.
+    memory_throttled_ = false;
   }
 
   for (auto& item : graph_input_streams_) {
@@ -731,6 +778,9 @@ absl::Status CalculatorGraph::PrepareForRun(
       RecordError(result);
     }
   }
+  for (auto& queue : output_packet_queues_) {
+    queue->Reset();
+  }
   for (auto& graph_output_stream : graph_output_streams_) {
     graph_output_stream->PrepareForRun(
         [&graph_output_stream, this] {
@@ -858,7 +908,7 @@ absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
         return error_status;
       }
       // Return with StatusUnavailable if this stream is being throttled.
-      if (!full_input_streams_[node_id].empty()) {
+      if (!full_input_streams_[node_id].empty() || memory_throttled_) {
         return mediapipe::UnavailableErrorBuilder(MEDIAPIPE_LOC)
                << "Graph is throttled.";
       }
@@ -868,7 +918,8 @@ absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
       // TODO: instead of checking has_error_, we could just check
       // if the graph is done. That could also be indicated by returning an
       // error from WaitUntilGraphInputStreamUnthrottled.
-      while (!has_error_ && !full_input_streams_[node_id].empty()) {
+      while (!has_error_ &&
+             (!full_input_streams_[node_id].empty() || memory_throttled_)) {
         // TODO: allow waiting for a specific stream?
         scheduler_.WaitUntilGraphInputStreamUnthrottled(
             &full_input_streams_mutex_);
@@ -1131,6 +1182,29 @@ void CalculatorGraph::UpdateThrottledNodes(InputStreamManager* stream,
   }
 }
 
+void CalculatorGraph::UpdateMemoryThrottle() {
+  absl::MutexLock lock(&full_input_streams_mutex_);
+  if (full_input_streams_.empty()) {
+    // The graph has not been started.
+    return;
+  }
+  bool over_budget = packet_memory_->OverBudget();
+  if (over_budget == memory_throttled_) {
+    return;
+  }
+  VLOG(2) << "Queued packet bytes " << packet_memory_->QueuedBytes()
+          << (over_budget ? " exceed" : " are within")
+          << " the packet memory budget " << packet_memory_->Budget();
+  memory_throttled_ = over_budget;
+  // Making these calls while holding full_input_streams_mutex_ ensures they
+  // are correctly serialized, see UpdateThrottledNodes.
+  if (over_budget) {
+    scheduler_.ThrottledGraphInputStream();
+  } else {
+    scheduler_.UnthrottledGraphInputStream();
+  }
+}
+
 bool CalculatorGraph::IsNodeThrottled(int node_id) {
   absl::MutexLock lock(&full_input_streams_mutex_);
   return max_queue_size_ != -1 && !full_input_streams_[node_id].empty();
@@ -1157,8 +1231,17 @@ bool CalculatorGraph::UnthrottleSources() {
   // stream during each call to UnthrottleSources will eventually resolve
   // each deadlock.
   absl::flat_hash_set<InputStreamManager*> full_streams;
+  bool memory_throttled = false;
   {
     absl::MutexLock lock(&full_input_streams_mutex_);
+    // Packets queued in the input streams cannot be released while all
+    // calculators are idle, so the packet memory budget is suspended until
+    // the next packet is added.
+    memory_throttled = memory_throttled_;
+    if (memory_throttled_ && !Config().report_deadlock()) {
+      memory_throttled_ = false;
+      scheduler_.UnthrottledGraphInputStream();
+    }
     for (absl::flat_hash_set<InputStreamManager*>& s : full_input_streams_) {
       for (auto& stream : s) {
         // The queue size of a graph output stream shouldn't change. Throttling
@@ -1170,6 +1253,21 @@ bool CalculatorGraph::UnthrottleSources() {
       }
     }
   }
+  if (memory_throttled) {
+    if (Config().report_deadlock()) {
+      RecordError(absl::UnavailableError(absl::StrCat(
+          "Detected a deadlock due to the packet memory budget: ",
+          packet_memory_->QueuedBytes(),
+          " bytes are queued. All calculators are idle while graph input "
+          "streams remain throttled.  Consider adjusting "
+          "\"packet_memory_budget\".")));
+    } else {
+      LOG_EVERY_N(WARNING, 100)
+          << "Resolved a deadlock by exceeding the packet memory budget: "
+          << packet_memory_->QueuedBytes() << " bytes are queued. Consider "
+          << "increasing packet_memory_budget for better performance.";
+    }
+  }
   for (InputStreamManager* stream : full_streams) {
     if (Config().report_deadlock()) {
       RecordError(absl::UnavailableError(absl::StrCat(
@@ -1186,7 +1284,7 @@ bool CalculatorGraph::UnthrottleSources() {
         << stream->Name() << " to: " << new_size
         << ". Consider increasing max_queue_size for better performance.";
   }
-  return !full_streams.empty();
+  return !full_streams.empty() || memory_throttled;
 }
 
 CalculatorGraph::GraphInputStreamAddMode
@@ -1288,6 +1386,9 @@ void CalculatorGraph::CleanupAfterRun(absl::Status* status) {
   for (auto& graph_output_stream : graph_output_streams_) {
     graph_output_stream->input_stream()->Close();
   }
+  for (auto& queue : output_packet_queues_) {
+    queue->Close();
+  }
 
   scheduler_.CleanupAfterRun();
 
@@ -40,6 +40,7 @@
 #include "mediapipe/framework/graph_service.h"
 #include "mediapipe/framework/graph_service_manager.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
+#include "mediapipe/framework/output_packet_queue.h"
 #include "mediapipe/framework/output_side_packet_impl.h"
 #include "mediapipe/framework/output_stream.h"
 #include "mediapipe/framework/output_stream_manager.h"
@@ -48,6 +49,7 @@
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/packet_generator.pb.h"
 #include "mediapipe/framework/packet_generator_graph.h"
+#include "mediapipe/framework/packet_memory.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
@@ -166,6 +168,15 @@ class CalculatorGraph {
   // also the helpers in tool/sink.h.
   StatusOrPoller AddOutputStreamPoller(const std::string& stream_name);
 
+  // Observes the named output stream and queues its packets in the returned
+  // OutputPacketQueue, which is closed once the stream is done or the run
+  // ends. Unlike an OutputStreamPoller, the queue never throttles the graph:
+  // if max_queue_size is non-negative, the oldest packets are dropped once it
+  // is full. This suits pipelined apps whose display only needs the latest
+  // results. Should only be called before Run() or StartRun().
+  absl::StatusOr<std::shared_ptr<OutputPacketQueue>> AddOutputPacketQueue(
+      const std::string& stream_name, int max_queue_size = -1);
+
   // Gets output side packet by name after the graph is done. However, base
   // packets (generated by PacketGenerators) can be retrieved before
   // graph is done. Returns error if the graph is still running (for non-base
@@ -528,6 +539,14 @@ class CalculatorGraph {
   // status before taking any action.
   void UpdateThrottledNodes(InputStreamManager* stream, bool* stream_was_full);
 
+  // Throttles all graph input streams while the packet bytes queued in the
+  // input streams exceed CalculatorGraphConfig::packet_memory_budget, and
+  // unthrottles them once the queued bytes are back within the budget.
+  //
+  // This method is invoked by the PacketMemoryTracker with no stream locks
+  // held, so it re-reads the tracker before taking any action.
+  void UpdateMemoryThrottle() ABSL_LOCKS_EXCLUDED(full_input_streams_mutex_);
+
 #if !MEDIAPIPE_DISABLE_GPU
   // Owns the legacy GpuSharedData if we need to create one for backwards
   // compatibility.
@@ -565,6 +584,9 @@ class CalculatorGraph {
   std::vector<std::shared_ptr<internal::GraphOutputStream>>
       graph_output_streams_;
 
+  // The queues fed by graph output streams, closed at the end of every run.
+  std::vector<std::shared_ptr<OutputPacketQueue>> output_packet_queues_;
+
   // Maximum queue size for an input stream. This is used by the scheduler to
   // restrict memory usage.
   int max_queue_size_ = -1;
@@ -583,6 +605,14 @@ class CalculatorGraph {
   std::vector<absl::flat_hash_set<InputStreamManager*>> full_input_streams_
       ABSL_GUARDED_BY(full_input_streams_mutex_);
 
+  // Counts the packet bytes queued in the input streams, if packet memory
+  // accounting is enabled.
+  std::unique_ptr<PacketMemoryTracker> packet_memory_;
+
+  // True if the graph input streams are throttled because the queued packet
+  // bytes exceed the packet memory budget.
+  bool memory_throttled_ ABSL_GUARDED_BY(full_input_streams_mutex_) = false;
+
   // Maps stream names to graph input stream objects.
   absl::flat_hash_map<std::string, std::unique_ptr<GraphInputStream>>
       graph_input_streams_;
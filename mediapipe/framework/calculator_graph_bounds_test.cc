@@ -574,6 +574,113 @@ TEST(CalculatorGraph, CheckBatchProcessingBoundPropagation) {
   MP_ASSERT_OK(graph.Run());
 }
 
+// Outputs 10 packets in a single call to Process, so that they are all ready
+// when the next node is scheduled.
+class BurstSourceCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Outputs().Index(0).Set<int>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    for (int i = 0; i < 10; ++i) {
+      cc->Outputs().Index(0).Add(new int(i), Timestamp(i * 10));
+    }
+    return tool::StatusStop();
+  }
+};
+REGISTER_CALCULATOR(BurstSourceCalculator);
+
+// Passes through up to 4 input timestamps per call to Process, and outputs
+// the size of each batch at its first timestamp.
+class BatchPassThroughCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Tag("VALUE").Set<int>();
+    cc->Outputs().Tag("VALUE").SetSameAs(&cc->Inputs().Tag("VALUE"));
+    cc->Outputs().Tag("BATCH_SIZE").Set<int>();
+    cc->SetTimestampOffset(0);
+    cc->SetMaxBatchSize(4);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    for (int i = 0; i < cc->BatchSize(); ++i) {
+      RET_CHECK_EQ(cc->Inputs().Tag("VALUE").BatchValue(i).Timestamp(),
+                   cc->BatchInputTimestamp(i));
+      cc->Outputs().Tag("VALUE").AddPacket(
+          cc->Inputs().Tag("VALUE").BatchValue(i));
+    }
+    cc->Outputs()
+        .Tag("BATCH_SIZE")
+        .Add(new int(cc->BatchSize()), cc->InputTimestamp());
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(BatchPassThroughCalculator);
+
+CalculatorGraphConfig BatchPassThroughGraph(int max_batch_size) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node { calculator: 'BurstSourceCalculator' output_stream: 'in' }
+        node {
+          calculator: 'BatchPassThroughCalculator'
+          input_stream: 'VALUE:in'
+          output_stream: 'VALUE:out'
+          output_stream: 'BATCH_SIZE:batch_size'
+        }
+        node { calculator: 'IntSinkCalculator' input_stream: 'out' }
+      )pb");
+  config.mutable_node(1)->set_max_batch_size(max_batch_size);
+  return config;
+}
+
+// Shows that ready input timestamps are delivered to one call to Process, up
+// to the batch size declared by the calculator.
+TEST(CalculatorGraphBoundsTest, BatchesReadyTimestamps) {
+  CalculatorGraphConfig config = BatchPassThroughGraph(0);
+  std::vector<Packet> out_packets;
+  std::vector<Packet> batch_size_packets;
+  tool::AddVectorSink("out", &config, &out_packets);
+  tool::AddVectorSink("batch_size", &config, &batch_size_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.Run());
+
+  ASSERT_EQ(out_packets.size(), 10);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(out_packets[i].Get<int>(), i);
+    EXPECT_EQ(out_packets[i].Timestamp(), Timestamp(i * 10));
+  }
+  // The last batch is not waited for.
+  EXPECT_THAT(GetContents<int>(batch_size_packets),
+              testing::ElementsAre(4, 4, 2));
+  EXPECT_EQ(batch_size_packets[1].Timestamp(), Timestamp(40));
+}
+
+// Shows that Node::max_batch_size lowers the batch size of the calculator.
+TEST(CalculatorGraphBoundsTest, NodeMaxBatchSize) {
+  for (int max_batch_size : {1, 3}) {
+    CalculatorGraphConfig config = BatchPassThroughGraph(max_batch_size);
+    std::vector<Packet> out_packets;
+    std::vector<Packet> batch_size_packets;
+    tool::AddVectorSink("out", &config, &out_packets);
+    tool::AddVectorSink("batch_size", &config, &batch_size_packets);
+    CalculatorGraph graph;
+    MP_ASSERT_OK(graph.Initialize(config));
+    MP_ASSERT_OK(graph.Run());
+
+    EXPECT_EQ(out_packets.size(), 10);
+    if (max_batch_size == 1) {
+      EXPECT_EQ(batch_size_packets.size(), 10);
+    } else {
+      EXPECT_THAT(GetContents<int>(batch_size_packets),
+                  testing::ElementsAre(3, 3, 3, 1));
+    }
+  }
+}
+
 // Shows that ImmediateInputStreamHandler allows bounds propagation.
 TEST(CalculatorGraphBoundsTest, ImmediateHandlerBounds) {
   // CustomBoundCalculator produces only timestamp bounds.
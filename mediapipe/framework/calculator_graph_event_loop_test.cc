@@ -625,5 +625,95 @@ TEST_F(CalculatorGraphEventLoopTest, UnthrottleSources) {
   EXPECT_LE(loop_count, 2);
 }
 
+CalculatorGraphConfig PassThroughGraphConfig() {
+  CalculatorGraphConfig graph_config;
+  CHECK(proto_ns::TextFormat::ParseFromString(
+      R"(
+          node {
+            calculator: "PassThroughCalculator"
+            input_stream: "input_numbers"
+            output_stream: "output_numbers"
+          }
+          input_stream: "input_numbers"
+          output_stream: "output_numbers"
+      )",
+      &graph_config));
+  return graph_config;
+}
+
+std::vector<int64> Timestamps(const std::vector<Packet>& packets) {
+  std::vector<int64> timestamps;
+  for (const Packet& packet : packets) {
+    timestamps.push_back(packet.Timestamp().Value());
+  }
+  return timestamps;
+}
+
+// Verifies that OutputStreamPoller::TryNext and NextBatch drain the queued
+// packets in order, and that only the blocking calls report the end of the
+// stream.
+TEST(CalculatorGraphPollerTest, TryNextAndNextBatch) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(PassThroughGraphConfig()));
+  auto poller_status = graph.AddOutputStreamPoller("output_numbers");
+  MP_ASSERT_OK(poller_status.status());
+  mediapipe::OutputStreamPoller& poller = poller_status.value();
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  Packet packet;
+  EXPECT_FALSE(poller.TryNext(&packet));
+  for (int i = 0; i < 5; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input_numbers", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+
+  ASSERT_TRUE(poller.TryNext(&packet));
+  EXPECT_EQ(packet.Get<int>(), 0);
+  std::vector<Packet> packets;
+  ASSERT_TRUE(poller.NextBatch(&packets, 2));
+  EXPECT_THAT(Timestamps(packets), testing::ElementsAre(1, 2));
+  ASSERT_TRUE(poller.NextBatch(&packets));
+  EXPECT_THAT(Timestamps(packets), testing::ElementsAre(3, 4));
+  EXPECT_FALSE(poller.TryNext(&packet));
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  EXPECT_FALSE(poller.NextBatch(&packets));
+  EXPECT_TRUE(packets.empty());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+// Verifies that a bounded OutputPacketQueue drops the oldest packets instead
+// of throttling the graph, and is closed once the stream is done.
+TEST(CalculatorGraphPollerTest, OutputPacketQueueDropsOldest) {
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(PassThroughGraphConfig()));
+  auto queue_status = graph.AddOutputPacketQueue("output_numbers", 3);
+  MP_ASSERT_OK(queue_status.status());
+  std::shared_ptr<OutputPacketQueue> queue = queue_status.value();
+
+  for (int run = 0; run < 2; ++run) {
+    MP_ASSERT_OK(graph.StartRun({}));
+    for (int i = 0; i < 5; ++i) {
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          "input_numbers", MakePacket<int>(i).At(Timestamp(i))));
+    }
+    MP_ASSERT_OK(graph.WaitUntilIdle());
+    EXPECT_EQ(queue->QueueSize(), 3);
+    EXPECT_EQ(queue->NumDropped(), 2);
+
+    Packet packet;
+    ASSERT_TRUE(queue->TryNext(&packet));
+    EXPECT_EQ(packet.Timestamp(), Timestamp(2));
+    MP_ASSERT_OK(graph.CloseAllInputStreams());
+    // The remaining packets are still delivered after the stream is done.
+    std::vector<Packet> packets;
+    ASSERT_TRUE(queue->NextBatch(&packets));
+    EXPECT_THAT(Timestamps(packets), testing::ElementsAre(3, 4));
+    EXPECT_FALSE(queue->Next(&packet));
+    MP_ASSERT_OK(graph.WaitUntilDone());
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -3316,6 +3316,79 @@ TEST(CalculatorGraph, SetInputStreamMaxQueueSizeWorksSlowCalculator) {
   MP_ASSERT_OK(graph.WaitUntilDone());
 }
 
+// Verify that the graph input streams are throttled while the packet bytes
+// queued in the input streams exceed the packet memory budget.
+TEST(CalculatorGraph, PacketMemoryBudgetThrottlesGraphInputStreams) {
+  using Semaphore = SemaphoreCalculator::Semaphore;
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        node {
+          calculator: 'SemaphoreCalculator'
+          input_stream: 'in'
+          output_stream: 'out'
+          input_side_packet: 'POST_SEM:post_sem'
+          input_side_packet: 'WAIT_SEM:wait_sem'
+        }
+        node {
+          calculator: 'SemaphoreCalculator'
+          input_stream: 'in_2'
+          output_stream: 'out_2'
+          input_side_packet: 'POST_SEM:post_sem_busy'
+          input_side_packet: 'WAIT_SEM:wait_sem_busy'
+        }
+        input_stream: 'in'
+        input_stream: 'in_2'
+        max_queue_size: -1
+        packet_memory_budget: 2500
+        num_threads: 2
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+
+  Semaphore calc_entered_process(0);
+  Semaphore calc_can_exit_process(0);
+  Semaphore calc_entered_process_busy(0);
+  Semaphore calc_can_exit_process_busy(0);
+  MP_ASSERT_OK(graph.StartRun({
+      {"post_sem", MakePacket<Semaphore*>(&calc_entered_process)},
+      {"wait_sem", MakePacket<Semaphore*>(&calc_can_exit_process)},
+      {"post_sem_busy", MakePacket<Semaphore*>(&calc_entered_process_busy)},
+      {"wait_sem_busy", MakePacket<Semaphore*>(&calc_can_exit_process_busy)},
+  }));
+
+  // Each packet takes more than 1000 bytes, so the budget is exceeded by the
+  // third queued packet.
+  auto make_packet = [](int64 t) {
+    return MakePacket<std::string>(std::string(1000, 'a')).At(Timestamp(t));
+  };
+  // Prevent deadlock resolution by running the "busy" SemaphoreCalculator
+  // for the duration of the test.
+  MP_EXPECT_OK(graph.AddPacketToInputStream("in_2", make_packet(0)));
+  MP_EXPECT_OK(graph.AddPacketToInputStream("in", make_packet(0)));
+  calc_entered_process.Acquire(1);
+  int64 t = 1;
+  for (int i = 0; i < 3; ++i) {
+    MP_EXPECT_OK(graph.AddPacketToInputStream("in", make_packet(t++)));
+  }
+  for (int i = 0; i < 5; ++i) {
+    // The queued packets exceed the budget.
+    absl::Status status = graph.AddPacketToInputStream("in", make_packet(t));
+    EXPECT_EQ(status.code(), absl::StatusCode::kUnavailable);
+    // Once the calculator takes the next packet, the queued packets are back
+    // within the budget.
+    calc_can_exit_process.Release(1);
+    calc_entered_process.Acquire(1);
+    MP_EXPECT_OK(graph.AddPacketToInputStream("in", make_packet(t++)));
+  }
+  calc_can_exit_process.Release(100);
+  calc_can_exit_process_busy.Release(1);
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 // Verify the scheduler unthrottles the graph input stream to avoid a deadlock,
 // and won't enter a busy loop.
 TEST(CalculatorGraph, AddPacketNoBusyLoop) {
@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/calculator_node.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -30,6 +31,7 @@
 #include "mediapipe/framework/calculator_base.h"
 #include "mediapipe/framework/counter_factory.h"
 #include "mediapipe/framework/input_stream_manager.h"
+#include "mediapipe/framework/load_shedder.h"
 #include "mediapipe/framework/mediapipe_profiling.h"
 #include "mediapipe/framework/output_stream_manager.h"
 #include "mediapipe/framework/packet.h"
@@ -215,6 +217,16 @@ absl::Status CalculatorNode::Initialize(
   input_stream_handler_->SetProcessTimestampBounds(
       contract.GetProcessTimestampBounds());
 
+  int max_batch_size = contract.GetMaxBatchSize();
+  if (node_config->max_batch_size() > 0) {
+    max_batch_size = std::min(max_batch_size, node_config->max_batch_size());
+  }
+  if (max_batch_size > 1 && max_in_flight_ == 1 &&
+      input_stream_handler_->NumInputStreams() > 0) {
+    input_stream_handler_->SetMaxBatchSize(max_batch_size);
+    process_batches_ = true;
+  }
+
   return InitializeInputStreams(input_stream_managers, output_stream_managers);
 }
 
@@ -421,6 +433,14 @@ absl::Status CalculatorNode::PrepareForRun(
     }
   }
 
+  // Drops by the input stream handler are reported to the graph's
+  // LoadShedder, if the graph provides one.
+  auto shedder_it = service_packets.find(kLoadShedderService.key);
+  input_stream_handler_->SetLoadShedder(
+      shedder_it == service_packets.end()
+          ? nullptr
+          : shedder_it->second.Get<std::shared_ptr<LoadShedder>>());
+
   MP_RETURN_IF_ERROR(calculator_context_manager_.PrepareForRun(std::bind(
       &CalculatorNode::ConnectShardsToStreams, this, std::placeholders::_1)));
 
@@ -850,6 +870,9 @@ absl::Status CalculatorNode::ProcessNode(
 
     int num_invocations = calculator_context_manager_.NumberOfContextTimestamps(
         *calculator_context);
+    if (process_batches_ && num_invocations > 1) {
+      return ProcessBatch(calculator_context);
+    }
     RET_CHECK(num_invocations <= 1 || max_in_flight_ <= 1)
         << "num_invocations:" << num_invocations
         << ", max_in_flight_:" << max_in_flight_;
@@ -913,6 +936,48 @@ absl::Status CalculatorNode::ProcessNode(
   }
 }
 
+absl::Status CalculatorNode::ProcessBatch(
+    CalculatorContext* calculator_context) {
+  const int batch_size = calculator_context_manager_.NumberOfContextTimestamps(
+      *calculator_context);
+  const Timestamp first_timestamp = calculator_context->InputTimestamp();
+  const Timestamp last_timestamp =
+      calculator_context->BatchInputTimestamp(batch_size - 1);
+  // Only input sets ready for Process() are batched, the input stream handler
+  // schedules Close() on its own.
+  RET_CHECK(last_timestamp.IsAllowedInStream())
+      << "Invalid input timestamp in ProcessBatch(). timestamp: "
+      << last_timestamp;
+  output_stream_handler_->PrepareOutputs(first_timestamp,
+                                         &calculator_context->Outputs());
+
+  VLOG(2) << "Calling Calculator::Process() for node: " << DebugName()
+          << " timestamps: " << first_timestamp << " to " << last_timestamp;
+
+  calculator_context_manager_.SetContextBatchSize(calculator_context,
+                                                  batch_size);
+  absl::Status result;
+  {
+    MEDIAPIPE_PROFILING(PROCESS, calculator_context);
+    LegacyCalculatorSupport::Scoped<CalculatorContext> s(calculator_context);
+    result = calculator_->Process(calculator_context);
+  }
+  calculator_context_manager_.SetContextBatchSize(calculator_context, 1);
+
+  for (int i = 0; i < batch_size; ++i) {
+    input_stream_handler_->ClearCurrentInputs(calculator_context);
+  }
+  if (!result.ok() && result != tool::StatusStop()) {
+    return mediapipe::StatusBuilder(result, MEDIAPIPE_LOC).SetPrepend()
+           << absl::Substitute(
+                  "Calculator::Process() for node \"$0\" failed: ",
+                  DebugName());
+  }
+  // The output timestamp bound follows the last timestamp of the batch.
+  output_stream_handler_->PostProcess(last_timestamp);
+  return result;
+}
+
 void CalculatorNode::SetQueueSizeCallbacks(
     InputStreamManager::QueueSizeCallback becomes_full_callback,
     InputStreamManager::QueueSizeCallback becomes_not_full_callback) {
@@ -284,6 +284,10 @@ class CalculatorNode {
   // Returns true if all outputs will be identical to the previous graph run.
   bool OutputsAreConstant(CalculatorContext* cc);
 
+  // Calls Calculator::Process() once for all the input timestamps of
+  // calculator_context, for calculators that support batches.
+  absl::Status ProcessBatch(CalculatorContext* calculator_context);
+
   // The calculator.
   std::unique_ptr<CalculatorBase> calculator_;
   // Keeps data which a Calculator subclass needs access to.
@@ -308,6 +312,9 @@ class CalculatorNode {
 
   // The max number of invocations that can be scheduled in parallel.
   int max_in_flight_ = 1;
+  // True if Process() receives several input timestamps per call, see
+  // CalculatorContract::SetMaxBatchSize.
+  bool process_batches_ = false;
   // The following two variables are used for the concurrency control of node
   // scheduling.
   //
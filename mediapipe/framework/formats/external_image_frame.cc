@@ -0,0 +1,76 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/external_image_frame.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/formats/image.h"
+
+namespace mediapipe {
+
+std::unique_ptr<ImageFrame> WrapExternalImageFrame(
+    ImageFormat::Format format, int width, int height, int width_step,
+    uint8* pixel_data, std::function<void()> release) {
+  return absl::make_unique<ImageFrame>(
+      format, width, height, width_step, pixel_data,
+      [release = std::move(release)](uint8*) {
+        if (release) release();
+      });
+}
+
+Packet MakeExternalImageFramePacket(ImageFormat::Format format, int width,
+                                    int height, int width_step,
+                                    uint8* pixel_data,
+                                    std::function<void()> release) {
+  return Adopt(WrapExternalImageFrame(format, width, height, width_step,
+                                      pixel_data, std::move(release))
+                   .release());
+}
+
+Packet MakeImageFramePacket(ImageFrameSharedPtr frame) {
+  ImageFrame* shared = frame.get();
+  return Adopt(new ImageFrame(shared->Format(), shared->Width(),
+                              shared->Height(), shared->WidthStep(),
+                              shared->MutablePixelData(),
+                              [frame = std::move(frame)](uint8*) {}));
+}
+
+Packet MakeImagePacket(ImageFrameSharedPtr frame) {
+  return MakePacket<Image>(std::move(frame));
+}
+
+ImageFrameSharedPtr InputFramePool::GetFrame(ImageFormat::Format format,
+                                             int width, int height) {
+  std::shared_ptr<ImageFramePool> pool;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!pool_ || pool_->format() != format || pool_->width() != width ||
+        pool_->height() != height) {
+      // Frames of the previous pool still in use are freed once released.
+      pool_ = ImageFramePool::Create(width, height, format, keep_count_);
+    }
+    pool = pool_;
+  }
+  return pool->GetBuffer();
+}
+
+std::pair<int, int> InputFramePool::GetInUseAndAvailableCounts() {
+  absl::MutexLock lock(&mutex_);
+  if (!pool_) return {0, 0};
+  return pool_->GetInUseAndAvailableCounts();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,104 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Zero-copy input of application-owned pixels into a graph.
+//
+// Apps usually capture a frame, convert it, copy it into a new ImageFrame and
+// Adopt() that, which costs several full-frame copies per frame. Instead:
+//
+//   InputFramePool frame_pool;
+//   cv::Mat capture_frame;
+//   while (capture.read(capture_frame)) {
+//     ImageFrameSharedPtr frame = frame_pool.GetFrame(
+//         ImageFormat::SRGB, capture_frame.cols, capture_frame.rows);
+//     cv::Mat frame_mat = formats::MatView(frame.get());
+//     cv::cvtColor(capture_frame, frame_mat, cv::COLOR_BGR2RGB);
+//     MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+//         "input_video", MakeImageFramePacket(std::move(frame)).At(ts)));
+//   }
+//
+// The conversion writes straight into a pooled frame, and the frame returns
+// to the pool once the graph has released every packet sharing it. Buffers
+// owned by something else, e.g. a camera driver, can be wrapped with
+// MakeExternalImageFramePacket() and are handed back through a callback.
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_EXTERNAL_IMAGE_FRAME_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_EXTERNAL_IMAGE_FRAME_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Wraps width x height pixels of the given format owned by the caller in an
+// ImageFrame, without copying them. width_step is the distance between rows
+// in bytes. release is called once the frame is destroyed, from the thread
+// destroying it, after which the caller may reuse or free the pixels. They
+// must not be modified before.
+std::unique_ptr<ImageFrame> WrapExternalImageFrame(
+    ImageFormat::Format format, int width, int height, int width_step,
+    uint8* pixel_data, std::function<void()> release);
+
+// Returns an ImageFrame packet over pixels owned by the caller, see
+// WrapExternalImageFrame(). release is called once the graph and the caller
+// have released every copy of the packet.
+Packet MakeExternalImageFramePacket(ImageFormat::Format format, int width,
+                                    int height, int width_step,
+                                    uint8* pixel_data,
+                                    std::function<void()> release);
+
+// Returns an ImageFrame packet sharing the pixels of frame, which is released
+// along with the last copy of the packet. Use with frames from an
+// InputFramePool to recycle them.
+Packet MakeImageFramePacket(ImageFrameSharedPtr frame);
+
+// Returns an Image packet holding frame.
+Packet MakeImagePacket(ImageFrameSharedPtr frame);
+
+// Recycles frames for graph input. Frames of the most recently requested size
+// and format are kept for reuse once released, up to keep_count of them. A
+// capture loop should hold on to the pool for the lifetime of the graph.
+// Thread-safe.
+class InputFramePool {
+ public:
+  explicit InputFramePool(int keep_count = kDefaultKeepCount)
+      : keep_count_(keep_count) {}
+
+  // Returns a frame of the given format and size, reusing a frame released
+  // by the graph where possible. The contents of the frame are undefined.
+  ImageFrameSharedPtr GetFrame(ImageFormat::Format format, int width,
+                               int height);
+
+  // Number of frames of the current size and format in use and available
+  // for reuse.
+  std::pair<int, int> GetInUseAndAvailableCounts();
+
+  static constexpr int kDefaultKeepCount = 4;
+
+ private:
+  const int keep_count_;
+  absl::Mutex mutex_;
+  std::shared_ptr<ImageFramePool> pool_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_EXTERNAL_IMAGE_FRAME_H_
@@ -0,0 +1,132 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/external_image_frame.h"
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/formats/image.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+
+namespace mediapipe {
+namespace {
+
+using Pair = std::pair<int, int>;
+
+TEST(ExternalImageFrameTest, ReleasesAfterLastPacket) {
+  std::vector<uint8> pixels(3 * 8 * 4);
+  int num_released = 0;
+  Packet packet = MakeExternalImageFramePacket(
+      ImageFormat::SRGB, 8, 4, 3 * 8, pixels.data(),
+      [&num_released] { ++num_released; });
+  EXPECT_EQ(packet.Get<ImageFrame>().PixelData(), pixels.data());
+  Packet copy = packet.At(Timestamp(1));
+  packet = Packet();
+  EXPECT_EQ(num_released, 0);
+  copy = Packet();
+  EXPECT_EQ(num_released, 1);
+}
+
+TEST(ExternalImageFrameTest, PacketsReturnFramesToPool) {
+  InputFramePool pool(/*keep_count=*/2);
+  ImageFrameSharedPtr frame = pool.GetFrame(ImageFormat::SRGB, 64, 48);
+  const uint8* pixels = frame->PixelData();
+  Packet packet = MakeImageFramePacket(std::move(frame));
+  EXPECT_EQ(packet.Get<ImageFrame>().PixelData(), pixels);
+  EXPECT_EQ(packet.Get<ImageFrame>().Width(), 64);
+  Packet image_packet =
+      MakeImagePacket(pool.GetFrame(ImageFormat::SRGB, 64, 48));
+  EXPECT_EQ(image_packet.Get<Image>().width(), 64);
+  EXPECT_EQ(pool.GetInUseAndAvailableCounts(), Pair(2, 0));
+
+  packet = Packet();
+  image_packet = Packet();
+  EXPECT_EQ(pool.GetInUseAndAvailableCounts(), Pair(0, 2));
+  // Released frames are reused.
+  frame = pool.GetFrame(ImageFormat::SRGB, 64, 48);
+  EXPECT_EQ(pool.GetInUseAndAvailableCounts(), Pair(1, 1));
+
+  // A new size starts a new pool, frames of the old one are still valid.
+  ImageFrameSharedPtr other = pool.GetFrame(ImageFormat::SRGBA, 32, 24);
+  EXPECT_EQ(other->Format(), ImageFormat::SRGBA);
+  EXPECT_EQ(other->Width(), 32);
+  EXPECT_EQ(pool.GetInUseAndAvailableCounts(), Pair(1, 0));
+  EXPECT_EQ(frame->Width(), 64);
+}
+
+constexpr int kWidth = 1920;
+constexpr int kHeight = 1080;
+
+cv::Mat MakeCaptureFrame() {
+  cv::Mat capture_frame(kHeight, kWidth, CV_8UC3);
+  capture_frame.setTo(cv::Scalar(10, 20, 30));
+  return capture_frame;
+}
+
+// Ingest of a 1080p BGR capture as apps used to do it: convert, copy into a
+// new ImageFrame and adopt it.
+void BM_IngestCopy(benchmark::State& state) {
+  const cv::Mat capture_frame = MakeCaptureFrame();
+  for (auto _ : state) {
+    cv::Mat converted;
+    cv::cvtColor(capture_frame, converted, cv::COLOR_BGR2RGB);
+    auto input_frame = absl::make_unique<ImageFrame>(
+        ImageFormat::SRGB, converted.cols, converted.rows,
+        ImageFrame::kDefaultAlignmentBoundary);
+    cv::Mat input_frame_mat = formats::MatView(input_frame.get());
+    converted.copyTo(input_frame_mat);
+    Packet packet = Adopt(input_frame.release()).At(Timestamp(0));
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_IngestCopy);
+
+// Same ingest converting straight into recycled frames.
+void BM_IngestPooled(benchmark::State& state) {
+  const cv::Mat capture_frame = MakeCaptureFrame();
+  InputFramePool pool;
+  for (auto _ : state) {
+    ImageFrameSharedPtr frame = pool.GetFrame(ImageFormat::SRGB, kWidth,
+                                              kHeight);
+    cv::Mat frame_mat = formats::MatView(frame.get());
+    cv::cvtColor(capture_frame, frame_mat, cv::COLOR_BGR2RGB);
+    Packet packet = MakeImageFramePacket(std::move(frame)).At(Timestamp(0));
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_IngestPooled);
+
+// Ingest of pixels already in the graph format, e.g. from an RGB camera
+// driver, which leaves only the wrapping overhead.
+void BM_IngestExternal(benchmark::State& state) {
+  cv::Mat capture_frame = MakeCaptureFrame();
+  for (auto _ : state) {
+    Packet packet =
+        MakeExternalImageFramePacket(ImageFormat::SRGB, kWidth, kHeight,
+                                     capture_frame.step, capture_frame.data,
+                                     [] {})
+            .At(Timestamp(0));
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_IngestExternal);
+
+}  // namespace
+}  // namespace mediapipe
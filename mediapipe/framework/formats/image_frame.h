@@ -40,6 +40,7 @@
 #include <string>
 
 #include "mediapipe/framework/formats/image_format.pb.h"
+#include "mediapipe/framework/packet_memory.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/tool/type_util.h"
@@ -252,6 +253,13 @@ class ImageFrame {
   std::unique_ptr<uint8[], Deleter> pixel_data_;
 };
 
+template <>
+struct PacketMemorySize<ImageFrame> {
+  static size_t Of(const ImageFrame& value) {
+    return sizeof(value) + value.PixelDataSize();
+  }
+};
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_FORMATS_IMAGE_FRAME_H_
@@ -0,0 +1,178 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_LANDMARK_ARRAY_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_LANDMARK_ARRAY_H_
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+// A list of landmarks stored as one contiguous array per field, as an
+// alternative to the LandmarkList and NormalizedLandmarkList protos for
+// calculators that process all landmarks of a list at once. Stages that
+// accept it work on the arrays directly, so landmarks only go through protos
+// at the edges of a graph, where they are converted with CopyFrom and CopyTo.
+//
+// Like the protos, every field of every landmark may be unset. Unset fields
+// read as 0 in the arrays, and are left unset when converting back to protos,
+// so a list round-trips unchanged.
+//
+// Use through LandmarkArray and NormalizedLandmarkArray.
+template <typename LandmarkListT>
+class BasicLandmarkArray {
+ public:
+  using LandmarkList = LandmarkListT;
+  using Landmark =
+      std::decay_t<decltype(std::declval<LandmarkListT>().landmark(0))>;
+
+  // Bits of fields(), telling which fields of a landmark are set.
+  enum Field : uint8_t {
+    kX = 1 << 0,
+    kY = 1 << 1,
+    kZ = 1 << 2,
+    kVisibility = 1 << 3,
+    kPresence = 1 << 4,
+    kCoordinates = kX | kY | kZ,
+  };
+
+  BasicLandmarkArray() = default;
+  explicit BasicLandmarkArray(const LandmarkListT& list) { CopyFrom(list); }
+
+  int size() const { return fields_.size(); }
+  bool empty() const { return fields_.empty(); }
+
+  // Resizes the array. Added landmarks have no field set.
+  void resize(int size) {
+    x_.resize(size);
+    y_.resize(size);
+    z_.resize(size);
+    visibility_.resize(size);
+    presence_.resize(size);
+    fields_.resize(size);
+  }
+
+  void clear() { resize(0); }
+
+  float* x() { return x_.data(); }
+  const float* x() const { return x_.data(); }
+  float* y() { return y_.data(); }
+  const float* y() const { return y_.data(); }
+  float* z() { return z_.data(); }
+  const float* z() const { return z_.data(); }
+  float* visibility() { return visibility_.data(); }
+  const float* visibility() const { return visibility_.data(); }
+  float* presence() { return presence_.data(); }
+  const float* presence() const { return presence_.data(); }
+  uint8_t* fields() { return fields_.data(); }
+  const uint8_t* fields() const { return fields_.data(); }
+
+  // Marks the coordinates of all landmarks as set, as after writing all of
+  // x(), y() and z().
+  void MarkCoordinatesSet() {
+    for (uint8_t& fields : fields_) fields |= kCoordinates;
+  }
+
+  // Appends landmarks [begin, end) of other.
+  void Append(const BasicLandmarkArray& other, int begin, int end) {
+    CHECK_LE(0, begin);
+    CHECK_LE(begin, end);
+    CHECK_LE(end, other.size());
+    AppendRange(other.x_, begin, end, &x_);
+    AppendRange(other.y_, begin, end, &y_);
+    AppendRange(other.z_, begin, end, &z_);
+    AppendRange(other.visibility_, begin, end, &visibility_);
+    AppendRange(other.presence_, begin, end, &presence_);
+    AppendRange(other.fields_, begin, end, &fields_);
+  }
+
+  void Append(const BasicLandmarkArray& other) {
+    Append(other, 0, other.size());
+  }
+
+  // Returns landmark i as a proto.
+  Landmark landmark(int i) const {
+    Landmark landmark;
+    SetLandmark(i, &landmark);
+    return landmark;
+  }
+
+  // Replaces the contents of this array with the landmarks of list.
+  void CopyFrom(const LandmarkListT& list) {
+    resize(list.landmark_size());
+    for (int i = 0; i < list.landmark_size(); ++i) {
+      const Landmark& landmark = list.landmark(i);
+      x_[i] = landmark.x();
+      y_[i] = landmark.y();
+      z_[i] = landmark.z();
+      visibility_[i] = landmark.visibility();
+      presence_[i] = landmark.presence();
+      fields_[i] = (landmark.has_x() ? kX : 0) | (landmark.has_y() ? kY : 0) |
+                   (landmark.has_z() ? kZ : 0) |
+                   (landmark.has_visibility() ? kVisibility : 0) |
+                   (landmark.has_presence() ? kPresence : 0);
+    }
+  }
+
+  // Replaces the landmarks of list with the landmarks of this array.
+  void CopyTo(LandmarkListT* list) const {
+    list->clear_landmark();
+    list->mutable_landmark()->Reserve(size());
+    for (int i = 0; i < size(); ++i) {
+      SetLandmark(i, list->add_landmark());
+    }
+  }
+
+  LandmarkListT ToProto() const {
+    LandmarkListT list;
+    CopyTo(&list);
+    return list;
+  }
+
+ private:
+  template <typename T>
+  static void AppendRange(const std::vector<T>& from, int begin, int end,
+                          std::vector<T>* to) {
+    to->insert(to->end(), from.begin() + begin, from.begin() + end);
+  }
+
+  void SetLandmark(int i, Landmark* landmark) const {
+    const uint8_t fields = fields_[i];
+    if (fields & kX) landmark->set_x(x_[i]);
+    if (fields & kY) landmark->set_y(y_[i]);
+    if (fields & kZ) landmark->set_z(z_[i]);
+    if (fields & kVisibility) landmark->set_visibility(visibility_[i]);
+    if (fields & kPresence) landmark->set_presence(presence_[i]);
+  }
+
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<float> z_;
+  std::vector<float> visibility_;
+  std::vector<float> presence_;
+  std::vector<uint8_t> fields_;
+};
+
+using LandmarkArray = BasicLandmarkArray<LandmarkList>;
+using NormalizedLandmarkArray = BasicLandmarkArray<NormalizedLandmarkList>;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_LANDMARK_ARRAY_H_
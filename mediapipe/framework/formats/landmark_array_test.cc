@@ -0,0 +1,86 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/landmark_array.h"
+
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+NormalizedLandmarkList TestLandmarks() {
+  return ParseTextProtoOrDie<NormalizedLandmarkList>(R"pb(
+    landmark { x: 0.1 y: 0.2 z: 0.3 visibility: 0.9 presence: 0.8 }
+    landmark { x: 0.4 y: 0.5 }
+    landmark { x: 0.7 y: 0.8 z: 0.9 visibility: 0.5 }
+  )pb");
+}
+
+TEST(LandmarkArrayTest, RoundTripsProto) {
+  const NormalizedLandmarkList list = TestLandmarks();
+  NormalizedLandmarkArray array(list);
+  ASSERT_EQ(array.size(), 3);
+  EXPECT_EQ(array.x()[1], 0.4f);
+  EXPECT_EQ(array.z()[1], 0.0f);
+  EXPECT_EQ(array.visibility()[2], 0.5f);
+  EXPECT_EQ(array.fields()[1], NormalizedLandmarkArray::kX |
+                                   NormalizedLandmarkArray::kY);
+  EXPECT_EQ(array.ToProto().SerializeAsString(), list.SerializeAsString());
+  EXPECT_EQ(array.landmark(2).SerializeAsString(),
+            list.landmark(2).SerializeAsString());
+}
+
+TEST(LandmarkArrayTest, MarkCoordinatesSet) {
+  NormalizedLandmarkArray array(TestLandmarks());
+  array.z()[1] = 0.6f;
+  array.MarkCoordinatesSet();
+  const NormalizedLandmark landmark = array.landmark(1);
+  EXPECT_TRUE(landmark.has_z());
+  EXPECT_EQ(landmark.z(), 0.6f);
+  EXPECT_FALSE(landmark.has_visibility());
+}
+
+TEST(LandmarkArrayTest, Append) {
+  const NormalizedLandmarkList list = TestLandmarks();
+  NormalizedLandmarkArray array(list);
+  NormalizedLandmarkArray appended;
+  appended.Append(array, 1, 3);
+  appended.Append(array);
+  NormalizedLandmarkList expected;
+  *expected.add_landmark() = list.landmark(1);
+  *expected.add_landmark() = list.landmark(2);
+  expected.MergeFrom(list);
+  EXPECT_EQ(appended.ToProto().SerializeAsString(),
+            expected.SerializeAsString());
+}
+
+TEST(LandmarkArrayTest, Resize) {
+  LandmarkArray array;
+  EXPECT_TRUE(array.empty());
+  array.resize(2);
+  EXPECT_EQ(array.size(), 2);
+  LandmarkList list;
+  array.CopyTo(&list);
+  ASSERT_EQ(list.landmark_size(), 2);
+  EXPECT_FALSE(list.landmark(0).has_x());
+  array.clear();
+  array.CopyTo(&list);
+  EXPECT_EQ(list.landmark_size(), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -25,12 +25,20 @@
 
 #include "Eigen/Core"
 #include "mediapipe/framework/formats/matrix_data.pb.h"
+#include "mediapipe/framework/packet_memory.h"
 #include "mediapipe/framework/port.h"
 
 namespace mediapipe {
 
 typedef Eigen::MatrixXf Matrix;
 
+template <>
+struct PacketMemorySize<Matrix> {
+  static size_t Of(const Matrix& value) {
+    return sizeof(value) + value.size() * sizeof(float);
+  }
+};
+
 // Produce a MatrixData proto from an Eigen Matrix. Useful when wanting to
 // copy a repeated float field.
 void MatrixDataProtoFromMatrix(const Matrix& matrix, MatrixData* matrix_data);
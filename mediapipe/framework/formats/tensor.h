@@ -24,6 +24,7 @@
 
 #include "absl/memory/memory.h"
 #include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/packet_memory.h"
 #include "mediapipe/framework/port.h"
 
 #if MEDIAPIPE_METAL_ENABLED
@@ -278,6 +279,14 @@ class Tensor {
 #endif  // MEDIAPIPE_OPENGL_ES_VERSION >= MEDIAPIPE_OPENGL_ES_30
 };
 
+// Counts the CPU buffer size. GPU views of a Tensor are not accounted.
+template <>
+struct PacketMemorySize<Tensor> {
+  static size_t Of(const Tensor& value) {
+    return sizeof(value) + value.bytes();
+  }
+};
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_H_
@@ -92,6 +92,9 @@ absl::Status OutputStreamObserver::Notify() {
           last_processed_ts_ = settled;
         }
       }
+      if (min_timestamp == Timestamp::Done() && done_callback_) {
+        done_callback_();
+      }
       // Last check to make sure that the min timestamp or bound doesn't change.
       // If so, flips notifying_ to false to allow any other threads to perform
       // notification when new packets/timestamp bounds arrive. Otherwise, in
@@ -195,14 +198,48 @@ bool OutputStreamPollerImpl::Next(Packet* packet) {
   if (min_timestamp == Timestamp::Done()) {
     return false;
   }
+  *packet = PopPacket(min_timestamp);
+  return true;
+}
+
+bool OutputStreamPollerImpl::TryNext(Packet* packet) {
+  CHECK(packet);
+  bool empty_queue = true;
+  const Timestamp min_timestamp =
+      input_stream_->MinTimestampOrBound(&empty_queue);
+  if (empty_queue) {
+    return false;
+  }
+  *packet = PopPacket(min_timestamp);
+  return true;
+}
+
+bool OutputStreamPollerImpl::NextBatch(std::vector<Packet>* packets,
+                                       int max_packets) {
+  CHECK(packets);
+  CHECK_NE(max_packets, 0);
+  packets->clear();
+  Packet packet;
+  if (!Next(&packet)) {
+    return false;
+  }
+  packets->push_back(std::move(packet));
+  while ((max_packets < 0 || packets->size() < max_packets) &&
+         TryNext(&packet)) {
+    packets->push_back(std::move(packet));
+  }
+  return true;
+}
+
+Packet OutputStreamPollerImpl::PopPacket(Timestamp min_timestamp) {
   int num_packets_dropped = 0;
   bool stream_is_done = false;
-  *packet = input_stream_->PopPacketAtTimestamp(
+  Packet packet = input_stream_->PopPacketAtTimestamp(
       min_timestamp, &num_packets_dropped, &stream_is_done);
   CHECK_EQ(num_packets_dropped, 0)
       << absl::Substitute("Dropped $0 packet(s) on input stream \"$1\".",
                           num_packets_dropped, input_stream_->Name());
-  return true;
+  return packet;
 }
 
 }  // namespace internal
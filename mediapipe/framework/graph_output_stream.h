@@ -127,9 +127,17 @@ class OutputStreamObserver : public GraphOutputStream {
   // Notifies the observer of the errors in the calculator graph.
   void NotifyError() override {}
 
+  // Sets a callback invoked once the observed output stream is done, after
+  // all its packets were passed to packet_callback. May be invoked more than
+  // once.
+  void SetDoneCallback(std::function<void()> done_callback) {
+    done_callback_ = std::move(done_callback);
+  }
+
  private:
   // Invoked on every packet emitted by the observed output stream.
   std::function<absl::Status(const Packet&)> packet_callback_;
+  std::function<void()> done_callback_;
 };
 
 // OutputStreamPollerImpl that returns packets to the caller via
@@ -166,7 +174,20 @@ class OutputStreamPollerImpl : public GraphOutputStream {
   // done).  Returns true if successful.
   ABSL_MUST_USE_RESULT bool Next(Packet* packet);
 
+  // Gets the next packet if one is available, without blocking. Returns false
+  // if no packet is queued.
+  ABSL_MUST_USE_RESULT bool TryNext(Packet* packet);
+
+  // Gets the queued packets, at most max_packets of them if non-negative,
+  // blocking until at least one is available or the stream is done. Returns
+  // false if the stream is done and no packet is left.
+  ABSL_MUST_USE_RESULT bool NextBatch(std::vector<Packet>* packets,
+                                      int max_packets);
+
  private:
+  // Pops the packet at min_timestamp, the minimum timestamp of the queue.
+  Packet PopPacket(Timestamp min_timestamp);
+
   absl::Mutex mutex_;
   absl::CondVar handler_condvar_ ABSL_GUARDED_BY(mutex_);
   bool graph_has_error_ ABSL_GUARDED_BY(mutex_);
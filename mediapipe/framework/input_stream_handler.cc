@@ -80,6 +80,10 @@ void InputStreamHandler::PrepareForRun(
     }
     stream->PrepareForRun();
   }
+  for (CollectionItemId id = input_stream_managers_.BeginId();
+       id < input_stream_managers_.EndId(); ++id) {
+    MarkStreamChanged(id);
+  }
   unset_header_count_.store(unset_header_count, std::memory_order_relaxed);
   prepared_context_for_close_ = false;
 }
@@ -156,6 +160,18 @@ bool InputStreamHandler::ScheduleInvocations(int max_allowance,
   int invocations_scheduled = 0;
   while (invocations_scheduled < max_allowance) {
     NodeReadiness node_readiness = GetNodeReadiness(&min_stream_timestamp);
+    if (node_readiness != NodeReadiness::kReadyForProcess &&
+        schedule_partial_batches_ &&
+        calculator_context_manager_->ContextHasInputTimestamp(
+            *calculator_context_manager_->GetDefaultCalculatorContext())) {
+      // Schedules the partial batch. input_bound stays unset: the timestamp
+      // bound is propagated once the batch has been processed and the node is
+      // scheduled again.
+      schedule_callback_(
+          calculator_context_manager_->GetDefaultCalculatorContext());
+      ++invocations_scheduled;
+      break;
+    }
     // Sets *input_bound iff the latest node readiness is kNotReady before the
     // function returns regardless of how many invocations have been scheduled.
     if (node_readiness == NodeReadiness::kNotReady) {
@@ -266,6 +282,7 @@ void InputStreamHandler::AddPackets(CollectionItemId id,
     error_callback_(result);
   }
   if (notify) {
+    MarkStreamChanged(id);
     notification_();
   }
 }
@@ -281,6 +298,7 @@ void InputStreamHandler::MovePackets(CollectionItemId id,
     error_callback_(result);
   }
   if (notify) {
+    MarkStreamChanged(id);
     notification_();
   }
 }
@@ -294,6 +312,7 @@ void InputStreamHandler::SetNextTimestampBound(CollectionItemId id,
     error_callback_(result);
   }
   if (notify) {
+    MarkStreamChanged(id);
     notification_();
   }
 }
@@ -309,8 +328,23 @@ void InputStreamHandler::ClearCurrentInputs(
 }
 
 void InputStreamHandler::Close() {
-  for (auto& stream : input_stream_managers_) {
-    stream->Close();
+  for (CollectionItemId id = input_stream_managers_.BeginId();
+       id < input_stream_managers_.EndId(); ++id) {
+    input_stream_managers_.Get(id)->Close();
+    MarkStreamChanged(id);
+  }
+}
+
+void InputStreamHandler::TrackStream(
+    CollectionItemId id, std::shared_ptr<StreamReadinessTracker> tracker,
+    int index) {
+  stream_trackers_[id.value()] = {std::move(tracker), index};
+}
+
+void InputStreamHandler::MarkStreamChanged(CollectionItemId id) {
+  const auto& tracker = stream_trackers_[id.value()];
+  if (tracker.first) {
+    tracker.first->MarkChanged(tracker.second);
   }
 }
 
@@ -325,6 +359,11 @@ void InputStreamHandler::SetBatchSize(int batch_size) {
   batch_size_ = batch_size;
 }
 
+void InputStreamHandler::SetMaxBatchSize(int max_batch_size) {
+  SetBatchSize(max_batch_size);
+  schedule_partial_batches_ = max_batch_size > 1;
+}
+
 void InputStreamHandler::SetLatePreparation(bool late_preparation) {
   CHECK(batch_size_ == 1 || !late_preparation_)
       << "Batching cannot be combined with late preparation.";
@@ -334,23 +373,24 @@ void InputStreamHandler::SetLatePreparation(bool late_preparation) {
 SyncSet::SyncSet(InputStreamHandler* input_stream_handler,
                  std::vector<CollectionItemId> stream_ids)
     : input_stream_handler_(input_stream_handler),
-      stream_ids_(std::move(stream_ids)) {}
+      stream_ids_(std::move(stream_ids)) {
+  tracker_ = std::make_shared<StreamReadinessTracker>(
+      stream_ids_.size(), [input_stream_handler, ids = stream_ids_](
+                              int index, bool* empty) {
+        return input_stream_handler->input_stream_managers_.Get(ids[index])
+            ->MinTimestampOrBound(empty);
+      });
+  for (int i = 0; i < stream_ids_.size(); ++i) {
+    input_stream_handler_->TrackStream(stream_ids_[i], tracker_, i);
+  }
+}
 
 void SyncSet::PrepareForRun() { last_processed_ts_ = Timestamp::Unset(); }
 
 NodeReadiness SyncSet::GetReadiness(Timestamp* min_stream_timestamp) {
-  Timestamp min_bound = Timestamp::Done();
-  Timestamp min_packet = Timestamp::Done();
-  for (CollectionItemId id : stream_ids_) {
-    const auto& stream = input_stream_handler_->input_stream_managers_.Get(id);
-    bool empty;
-    Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
-    if (empty) {
-      min_bound = std::min(min_bound, stream_timestamp);
-    } else {
-      min_packet = std::min(min_packet, stream_timestamp);
-    }
-  }
+  tracker_->Refresh();
+  const Timestamp min_bound = tracker_->MinBound();
+  const Timestamp min_packet = tracker_->MinPacket();
   *min_stream_timestamp = std::min(min_packet, min_bound);
   if (*min_stream_timestamp == Timestamp::Done()) {
     last_processed_ts_ = Timestamp::Done().PreviousAllowedInStream();
@@ -402,12 +442,25 @@ void SyncSet::FillInputSet(Timestamp input_timestamp,
                            InputStreamShardSet* input_set) {
   CHECK(input_timestamp.IsAllowedInStream());
   CHECK(input_set);
-  for (CollectionItemId id : stream_ids_) {
+  for (int i = 0; i < stream_ids_.size(); ++i) {
+    const CollectionItemId id = stream_ids_[i];
+    Timestamp stream_timestamp;
+    bool empty;
+    if (tracker_->GetUnchanged(i, &stream_timestamp, &empty) &&
+        stream_timestamp > input_timestamp) {
+      // Nothing to pop, report the bound as PopPacketAtTimestamp would.
+      input_stream_handler_->AddPacketToShard(
+          &input_set->Get(id),
+          Packet().At(stream_timestamp.PreviousAllowedInStream()),
+          empty && stream_timestamp == Timestamp::Done());
+      continue;
+    }
     const auto& stream = input_stream_handler_->input_stream_managers_.Get(id);
     int num_packets_dropped = 0;
     bool stream_is_done = false;
     Packet current_packet = stream->PopPacketAtTimestamp(
         input_timestamp, &num_packets_dropped, &stream_is_done);
+    tracker_->MarkChanged(i);
     CHECK_EQ(num_packets_dropped, 0)
         << absl::Substitute("Dropped $0 packet(s) on input stream \"$1\".",
                             num_packets_dropped, stream->Name());
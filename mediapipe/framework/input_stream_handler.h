@@ -31,11 +31,13 @@
 #include "mediapipe/framework/deps/registration.h"
 #include "mediapipe/framework/input_stream_manager.h"
 #include "mediapipe/framework/input_stream_shard.h"
+#include "mediapipe/framework/load_shedder.h"
 #include "mediapipe/framework/mediapipe_options.pb.h"
 #include "mediapipe/framework/packet.h"
 #include "mediapipe/framework/packet_set.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/stream_readiness_tracker.h"
 #include "mediapipe/framework/tool/tag_map.h"
 
 namespace mediapipe {
@@ -74,7 +76,8 @@ class InputStreamHandler {
       : input_stream_managers_(std::move(tag_map)),
         calculator_context_manager_(calculator_context_manager),
         options_(options),
-        calculator_run_in_parallel_(calculator_run_in_parallel) {}
+        calculator_run_in_parallel_(calculator_run_in_parallel),
+        stream_trackers_(input_stream_managers_.NumEntries()) {}
 
   virtual ~InputStreamHandler() = default;
 
@@ -131,6 +134,12 @@ class InputStreamHandler {
       InputStreamManager::QueueSizeCallback becomes_full_callback,
       InputStreamManager::QueueSizeCallback becomes_not_full_callback);
 
+  // Sets the graph's LoadShedder, which is informed of the timestamps this
+  // handler drops. nullptr disables the reporting.
+  void SetLoadShedder(std::shared_ptr<LoadShedder> load_shedder) {
+    load_shedder_ = std::move(load_shedder);
+  }
+
   // Add packets into a particular stream.
   virtual void AddPackets(CollectionItemId id,
                           const std::list<Packet>& packets);
@@ -185,6 +194,12 @@ class InputStreamHandler {
   // When true, Calculator::Process is called for every input timestamp bound.
   bool ProcessTimestampBounds() { return process_timestamps_; }
 
+  // Collects up to max_batch_size ready input sets into one calculator
+  // context for a calculator that processes them in a single call. Unlike
+  // SetBatchSize, a partial batch is scheduled as soon as the node is not
+  // ready for another input set, so batching never adds latency.
+  void SetMaxBatchSize(int max_batch_size);
+
   // Returns the number of sync-sets populated by this input stream handler.
   virtual int SyncSetCount() { return 1; }
 
@@ -198,6 +213,10 @@ class InputStreamHandler {
   //
   // If ProcessTimestampBounds() is set, then a fully determined input timestamp
   // with only empty input packets will qualify as ReadyForProcess.
+  //
+  // Readiness is tracked incrementally as packets and bounds arrive, and
+  // FillInputSet only pops the streams that may hold a packet at the input
+  // timestamp.
   class SyncSet {
    public:
     // Creates a SyncSet for a certain set of streams, |stream_ids|.
@@ -227,6 +246,9 @@ class InputStreamHandler {
     InputStreamHandler* input_stream_handler_;
     std::vector<CollectionItemId> stream_ids_;
     Timestamp last_processed_ts_ = Timestamp::Unset();
+    // Tracks stream_ids_[i] at index i. Shared with the InputStreamHandler,
+    // which marks the streams as changed.
+    std::shared_ptr<StreamReadinessTracker> tracker_;
   };
 
  protected:
@@ -251,6 +273,25 @@ class InputStreamHandler {
     shard->AddPacket(std::move(value), is_done);
   }
 
+  // Makes tracker track stream id at index. The streams are then marked as
+  // changed in tracker whenever their earliest packet or bound changes through
+  // this InputStreamHandler. Must not be called while the graph is running.
+  void TrackStream(CollectionItemId id,
+                   std::shared_ptr<StreamReadinessTracker> tracker, int index);
+
+  // Marks stream id as changed in its tracker, if any. Subclasses that modify
+  // input streams directly must call this afterwards.
+  void MarkStreamChanged(CollectionItemId id);
+
+  // Reports timestamps discarded by the subclass to the graph's LoadShedder,
+  // so that the source-side gates can shed frames before work is spent on
+  // them.
+  void RecordDroppedTimestamps(int64 count) {
+    if (load_shedder_ && count > 0) {
+      load_shedder_->RecordDropped(count);
+    }
+  }
+
   // Returns the operation the calculator node is ready for.
   // Specifically:
   // - NodeReadiness::kNotReady if the node's Process() or Close() cannot be
@@ -287,6 +328,7 @@ class InputStreamHandler {
   // A callback to schedule the node with the prepared calculator context.
   std::function<void(CalculatorContext*)> schedule_callback_;
   std::function<void(absl::Status)> error_callback_;
+  std::shared_ptr<LoadShedder> load_shedder_;
 
  private:
   // Indicates when to fill the input set. If true, every input set will be
@@ -301,6 +343,10 @@ class InputStreamHandler {
   // CalculatorNode is scheduled.
   int batch_size_ = 1;
 
+  // When true, a partial batch is scheduled instead of waiting for batch_size_
+  // input sets, see SetMaxBatchSize.
+  bool schedule_partial_batches_ = false;
+
   // When true, any increase in timestamp bound invokes Calculator::Process.
   bool process_timestamps_ = false;
 
@@ -309,6 +355,10 @@ class InputStreamHandler {
   std::function<void()> headers_ready_callback_;
 
   std::atomic<int> unset_header_count_{0};
+
+  // The tracker and index of each stream, indexed by CollectionItemId.
+  std::vector<std::pair<std::shared_ptr<StreamReadinessTracker>, int>>
+      stream_trackers_;
 };
 
 using InputStreamHandlerRegistry = GlobalFactoryRegistry<
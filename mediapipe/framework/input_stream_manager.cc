@@ -46,15 +46,31 @@ void InputStreamManager::SetQueueSizeCallbacks(
   becomes_not_full_callback_ = becomes_not_full_callback;
 }
 
-void InputStreamManager::PrepareForRun() {
+void InputStreamManager::SetPacketMemoryTracker(PacketMemoryTracker* tracker) {
+  packet_memory_tracker_ = tracker;
+  stream_memory_ = tracker ? tracker->AddStream(name_) : nullptr;
+}
+
+int64 InputStreamManager::QueuedBytes() const {
   absl::MutexLock stream_lock(&stream_mutex_);
-  queue_.clear();
-  last_reported_stream_full_ = false;
-  num_packets_added_ = 0;
-  next_timestamp_bound_ = Timestamp::PreStream();
-  last_select_timestamp_ = Timestamp::Unstarted();
-  closed_ = false;
-  header_ = Packet();
+  return queued_bytes_;
+}
+
+void InputStreamManager::PrepareForRun() {
+  {
+    absl::MutexLock stream_lock(&stream_mutex_);
+    queue_.clear();
+    queued_bytes_ = 0;
+    last_reported_stream_full_ = false;
+    num_packets_added_ = 0;
+    next_timestamp_bound_ = Timestamp::PreStream();
+    last_select_timestamp_ = Timestamp::Unstarted();
+    closed_ = false;
+    header_ = Packet();
+  }
+  if (stream_memory_) {
+    UpdatePacketMemory(-stream_memory_->queued_bytes.load());
+  }
 }
 
 bool InputStreamManager::IsEmpty() const {
@@ -96,6 +112,7 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
   *notify = false;
   bool queue_became_non_empty = false;
   bool queue_became_full = false;
+  int64 added_bytes = 0;
   {
     // Scope to prevent locking the stream when notification is called.
     absl::MutexLock stream_lock(&stream_mutex_);
@@ -153,6 +170,7 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
       // If the caller is MovePackets(), packet's underlying holder should be
       // transferred into queue_. Otherwise, queue_ keeps a copy of the packet.
       ++num_packets_added_;
+      added_bytes += PacketBytes(packet);
       VLOG(3) << "Input stream:" << name_
               << " has added packet at time: " << packet.Timestamp();
       if (std::is_const<
@@ -164,6 +182,7 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
     }
     queue_became_full = (!was_queue_full && max_queue_size_ != -1 &&
                          queue_.size() >= max_queue_size_);
+    queued_bytes_ += added_bytes;
     if (queue_.size() > 1) {
       VLOG(3) << "Queue size greater than 1: stream name: " << name_
               << " queue_size: " << queue_.size();
@@ -172,6 +191,7 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
             << " becomes non-empty status:" << queue_became_non_empty
             << " Size: " << queue_.size();
   }
+  UpdatePacketMemory(added_bytes);
   if (queue_became_full) {
     VLOG(3) << "Queue became full: " << Name();
     becomes_full_callback_(this, &last_reported_stream_full_);
@@ -246,6 +266,7 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
   *num_packets_dropped = -1;
   *stream_is_done = false;
   bool queue_became_non_full = false;
+  int64 removed_bytes = 0;
   Packet packet;
   {
     absl::MutexLock stream_lock(&stream_mutex_);
@@ -273,9 +294,11 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
     while (!queue_.empty() && queue_.front().Timestamp() <= timestamp) {
       packet = std::move(queue_.front());
       queue_.pop_front();
+      removed_bytes += PacketBytes(packet);
       current_timestamp = packet.Timestamp();
       ++(*num_packets_dropped);
     }
+    queued_bytes_ -= removed_bytes;
     // Clear value_ if it doesn't have exactly the right timestamp.
     if (current_timestamp != timestamp) {
       // The timestamp bound reported when no packet is sent.
@@ -289,6 +312,7 @@ Packet InputStreamManager::PopPacketAtTimestamp(Timestamp timestamp,
     queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
     *stream_is_done = IsDone();
   }
+  UpdatePacketMemory(-removed_bytes);
   if (queue_became_non_full) {
     VLOG(3) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
@@ -300,6 +324,7 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
   CHECK(!enable_timestamps_);
   *stream_is_done = false;
   bool queue_became_non_full = false;
+  int64 removed_bytes = 0;
   Packet packet;
   {
     absl::MutexLock stream_lock(&stream_mutex_);
@@ -313,6 +338,8 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
     if (!queue_.empty()) {
       packet = std::move(queue_.front());
       queue_.pop_front();
+      removed_bytes = PacketBytes(packet);
+      queued_bytes_ -= removed_bytes;
     } else {
       packet = Packet();
     }
@@ -322,6 +349,7 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
     queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
     *stream_is_done = IsDone();
   }
+  UpdatePacketMemory(-removed_bytes);
   if (queue_became_non_full) {
     VLOG(3) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
@@ -374,6 +402,7 @@ Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
 
 void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
   bool queue_became_non_full = false;
+  int64 removed_bytes = 0;
   {
     absl::MutexLock lock(&stream_mutex_);
     // Checks if queue is full.
@@ -381,13 +410,16 @@ void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
         (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
 
     while (!queue_.empty() && queue_.front().Timestamp() < timestamp) {
+      removed_bytes += PacketBytes(queue_.front());
       queue_.pop_front();
     }
+    queued_bytes_ -= removed_bytes;
 
     VLOG(3) << "Input stream removed packets:" << name_
             << " Size:" << queue_.size();
     queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
   }
+  UpdatePacketMemory(-removed_bytes);
   if (queue_became_non_full) {
     VLOG(3) << "Queue became non-full: " << Name();
     becomes_not_full_callback_(this, &last_reported_stream_full_);
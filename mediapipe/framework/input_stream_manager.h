@@ -23,6 +23,7 @@
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_memory.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -173,6 +174,13 @@ class InputStreamManager {
   void SetQueueSizeCallbacks(QueueSizeCallback becomes_full_callback,
                              QueueSizeCallback becomes_not_full_callback);
 
+  // Counts the packet bytes queued in this stream in tracker. Must be called
+  // after Initialize() and not while the graph is running.
+  void SetPacketMemoryTracker(PacketMemoryTracker* tracker);
+
+  // Returns the packet bytes queued in this stream, if counted.
+  int64 QueuedBytes() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
+
  private:
   // Adds or moves a list of timestamped packets. Sets "notify" to true if the
   // queue becomes non-empty. Returns an error if the packets have errors. Does
@@ -190,6 +198,24 @@ class InputStreamManager {
   // Returns the smallest timestamp at which this stream might see an input.
   Timestamp MinTimestampOrBoundHelper() const;
 
+  // Returns the bytes of packet counted in queued_bytes_.
+  int64 PacketBytes(const Packet& packet) const {
+    if (!stream_memory_) {
+      return 0;
+    }
+    const packet_internal::HolderBase* holder =
+        packet_internal::GetHolder(packet);
+    return holder ? holder->AccountedBytes() : 0;
+  }
+
+  // Reports a change of queued_bytes_ to the PacketMemoryTracker. Must be
+  // called with no locks held.
+  void UpdatePacketMemory(int64 delta) {
+    if (stream_memory_ && delta != 0) {
+      packet_memory_tracker_->Update(stream_memory_, delta);
+    }
+  }
+
   mutable absl::Mutex stream_mutex_;
   std::deque<Packet> queue_ ABSL_GUARDED_BY(stream_mutex_);
   // The number of packets added to queue_.  Used to verify a packet at
@@ -208,6 +234,11 @@ class InputStreamManager {
   // The header packet of the input stream.
   Packet header_;
 
+  // The accounted bytes of the packets in queue_.
+  int64 queued_bytes_ ABSL_GUARDED_BY(stream_mutex_) = 0;
+  PacketMemoryTracker* packet_memory_tracker_ = nullptr;
+  PacketMemoryTracker::StreamMemory* stream_memory_ = nullptr;
+
   // The maximum queue size for this stream if set.
   int max_queue_size_ ABSL_GUARDED_BY(stream_mutex_) = -1;
 
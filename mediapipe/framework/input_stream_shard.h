@@ -15,7 +15,7 @@
 #ifndef MEDIAPIPE_FRAMEWORK_INPUT_STREAM_SHARD_H_
 #define MEDIAPIPE_FRAMEWORK_INPUT_STREAM_SHARD_H_
 
-#include <queue>
+#include <deque>
 #include <string>
 #include <utility>
 
@@ -51,6 +51,16 @@ class InputStreamShard : public InputStream {
     return !packet_queue_.empty() ? packet_queue_.front() : empty_packet_;
   }
 
+  // Returns the packet of the i-th input timestamp of a batched Process()
+  // call, see CalculatorContext::BatchSize(). BatchValue(0) is Value().
+  const Packet& BatchValue(int i) const {
+    return i < NumberOfPackets() ? packet_queue_[i] : empty_packet_;
+  }
+
+  Packet& BatchValue(int i) {
+    return i < NumberOfPackets() ? packet_queue_[i] : empty_packet_;
+  }
+
   // Returns a reference to the name std::string of the InputStreamManager.
   const std::string& Name() const { return *name_; }
 
@@ -63,7 +73,7 @@ class InputStreamShard : public InputStream {
 
   void ClearCurrentPacket() {
     if (!packet_queue_.empty()) {
-      packet_queue_.pop();
+      packet_queue_.pop_front();
     }
   }
 
@@ -72,7 +82,7 @@ class InputStreamShard : public InputStream {
   void AddPacket(Packet&& value, bool is_done);
 
   // Packet storage for batch processing.
-  std::queue<Packet> packet_queue_;
+  std::deque<Packet> packet_queue_;
   Packet empty_packet_;
 
   // Pointer to the name std::string of the InputStreamManager.
@@ -0,0 +1,72 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/load_shedder.h"
+
+#include <algorithm>
+
+namespace mediapipe {
+
+const GraphService<LoadShedder> kLoadShedderService("load_shedder");
+
+void LoadShedder::RecordDropped(int64 count) {
+  absl::MutexLock lock(&mutex_);
+  stats_.dropped_frames += count;
+  interval_dropped_ += count;
+}
+
+bool LoadShedder::ShouldShed() {
+  absl::MutexLock lock(&mutex_);
+  bool shed = false;
+  shed_credit_ += shed_fraction_;
+  if (shed_credit_ >= 1) {
+    shed_credit_ -= 1;
+    shed = true;
+    ++stats_.shed_frames;
+    ++interval_shed_;
+  } else {
+    ++stats_.admitted_frames;
+  }
+  if (++interval_frames_ >= options_.update_interval) {
+    UpdateShedFraction();
+  }
+  return shed;
+}
+
+void LoadShedder::UpdateShedFraction() {
+  if (interval_dropped_ > 0) {
+    // Frames shed plus frames dropped is the excess over what the graph
+    // processed, which is the fraction to shed at the gates.
+    double discarded = static_cast<double>(interval_shed_ + interval_dropped_) /
+                       interval_frames_;
+    shed_fraction_ = std::min(discarded, options_.max_shed_fraction);
+  } else {
+    shed_fraction_ *= options_.decay;
+  }
+  interval_frames_ = 0;
+  interval_shed_ = 0;
+  interval_dropped_ = 0;
+}
+
+double LoadShedder::ShedFraction() const {
+  absl::MutexLock lock(&mutex_);
+  return shed_fraction_;
+}
+
+LoadShedder::Stats LoadShedder::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+}  // namespace mediapipe
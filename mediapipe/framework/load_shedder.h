@@ -0,0 +1,110 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_LOAD_SHEDDER_H_
+#define MEDIAPIPE_FRAMEWORK_LOAD_SHEDDER_H_
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/graph_service.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Graph-wide load-shedding policy.
+//
+// When a graph is overloaded, input stream handlers such as
+// FixedSizeInputStreamHandler drop packets at the queue of a slow node, after
+// all the upstream work on those timestamps has already been done. A
+// LoadShedder moves these drops upstream: the drop points report each dropped
+// timestamp, and the source-side gates, such as FlowLimiterCalculator with
+// the load_shedding option, ask the shedder whether to discard each new frame
+// before any work is spent on it.
+//
+// The shedder estimates the fraction of the source frames that the graph
+// ends up discarding. Every update_interval frames offered at the gates, the
+// shed fraction is raised to the fraction of frames that were shed or dropped
+// during that interval, if any frames were still dropped downstream.
+// Otherwise the shed fraction decays, so that the gates probe for spare
+// capacity once the overload ends.
+//
+// Example:
+//   auto shedder = std::make_shared<LoadShedder>();
+//   MP_RETURN_IF_ERROR(graph.SetServiceObject(kLoadShedderService, shedder));
+//   ...
+//   LOG(INFO) << "saved: " << shedder->GetStats().shed_frames
+//             << " wasted: " << shedder->GetStats().dropped_frames;
+class LoadShedder {
+ public:
+  struct Options {
+    // The number of frames offered at the gates between shed fraction
+    // updates.
+    int update_interval = 8;
+    // The factor applied to the shed fraction after an interval without
+    // downstream drops.
+    double decay = 0.75;
+    // The upper bound of the shed fraction.
+    double max_shed_fraction = 0.95;
+  };
+
+  // Counts of frames, since the shedder was created.
+  struct Stats {
+    // Frames admitted by the gates.
+    int64 admitted_frames = 0;
+    // Frames discarded by the gates, i.e. work saved.
+    int64 shed_frames = 0;
+    // Timestamps dropped downstream of the gates, i.e. work wasted.
+    int64 dropped_frames = 0;
+  };
+
+  LoadShedder() : LoadShedder(Options()) {}
+  explicit LoadShedder(const Options& options) : options_(options) {}
+
+  // Reports that a drop point discarded `count` timestamps.
+  void RecordDropped(int64 count) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Called by a gate for each new frame. Returns true if the frame should be
+  // discarded, in which case it is counted as shed, and otherwise counts it
+  // as admitted.
+  bool ShouldShed() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the current fraction of frames shed by the gates.
+  double ShedFraction() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  Stats GetStats() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  // Updates the shed fraction from the counts of the last interval.
+  void UpdateShedFraction() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Options options_;
+  mutable absl::Mutex mutex_;
+  double shed_fraction_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Accumulates the shed fraction for each frame, and sheds a frame whenever
+  // it reaches 1.
+  double shed_credit_ ABSL_GUARDED_BY(mutex_) = 0;
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
+  // Counts within the current update interval.
+  int64 interval_frames_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64 interval_shed_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64 interval_dropped_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// The service through which drop points and gates share a LoadShedder.
+// Load shedding is disabled unless the graph provides this service.
+extern const GraphService<LoadShedder> kLoadShedderService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_LOAD_SHEDDER_H_
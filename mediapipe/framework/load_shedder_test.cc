@@ -0,0 +1,94 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/load_shedder.h"
+
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+// Offers num_frames frames to the shedder, and returns the number shed.
+int OfferFrames(LoadShedder* shedder, int num_frames) {
+  int num_shed = 0;
+  for (int i = 0; i < num_frames; ++i) {
+    if (shedder->ShouldShed()) {
+      ++num_shed;
+    }
+  }
+  return num_shed;
+}
+
+TEST(LoadShedderTest, AdmitsAllFramesWithoutDrops) {
+  LoadShedder shedder;
+  EXPECT_EQ(OfferFrames(&shedder, 32), 0);
+  EXPECT_EQ(shedder.ShedFraction(), 0);
+  LoadShedder::Stats stats = shedder.GetStats();
+  EXPECT_EQ(stats.admitted_frames, 32);
+  EXPECT_EQ(stats.shed_frames, 0);
+  EXPECT_EQ(stats.dropped_frames, 0);
+}
+
+TEST(LoadShedderTest, ShedsTheFractionDroppedDownstream) {
+  LoadShedder::Options options;
+  options.update_interval = 8;
+  LoadShedder shedder(options);
+
+  // Half of the frames of the first interval are dropped downstream.
+  EXPECT_EQ(OfferFrames(&shedder, 7), 0);
+  shedder.RecordDropped(4);
+  EXPECT_EQ(OfferFrames(&shedder, 1), 0);
+  EXPECT_EQ(shedder.ShedFraction(), 0.5);
+
+  // The gate sheds every other frame, and the downstream drops persist at
+  // the new rate of admitted frames, keeping the shed fraction.
+  EXPECT_EQ(OfferFrames(&shedder, 7), 3);
+  shedder.RecordDropped(1);
+  EXPECT_EQ(OfferFrames(&shedder, 1), 1);
+  EXPECT_EQ(shedder.ShedFraction(), 5.0 / 8);
+
+  LoadShedder::Stats stats = shedder.GetStats();
+  EXPECT_EQ(stats.shed_frames, 4);
+  EXPECT_EQ(stats.admitted_frames, 12);
+  EXPECT_EQ(stats.dropped_frames, 5);
+}
+
+TEST(LoadShedderTest, DecaysWithoutDrops) {
+  LoadShedder::Options options;
+  options.update_interval = 4;
+  options.decay = 0.5;
+  LoadShedder shedder(options);
+  shedder.RecordDropped(2);
+  OfferFrames(&shedder, 4);
+  EXPECT_EQ(shedder.ShedFraction(), 0.5);
+  OfferFrames(&shedder, 4);
+  EXPECT_EQ(shedder.ShedFraction(), 0.25);
+  OfferFrames(&shedder, 4);
+  EXPECT_EQ(shedder.ShedFraction(), 0.125);
+}
+
+TEST(LoadShedderTest, LimitsShedFraction) {
+  LoadShedder::Options options;
+  options.update_interval = 4;
+  options.max_shed_fraction = 0.75;
+  LoadShedder shedder(options);
+  shedder.RecordDropped(10);
+  OfferFrames(&shedder, 4);
+  EXPECT_EQ(shedder.ShedFraction(), 0.75);
+  shedder.RecordDropped(1);
+  EXPECT_EQ(OfferFrames(&shedder, 4), 3);
+}
+
+}  // namespace
+}  // namespace mediapipe
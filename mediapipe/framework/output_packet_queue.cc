@@ -0,0 +1,89 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/output_packet_queue.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+void OutputPacketQueue::Push(Packet packet) {
+  absl::MutexLock lock(&mutex_);
+  if (closed_ || max_queue_size_ == 0) return;
+  if (max_queue_size_ > 0 && packets_.size() >= max_queue_size_) {
+    packets_.pop_front();
+    ++num_dropped_;
+  }
+  packets_.push_back(std::move(packet));
+}
+
+void OutputPacketQueue::Close() {
+  absl::MutexLock lock(&mutex_);
+  closed_ = true;
+}
+
+void OutputPacketQueue::Reset() {
+  absl::MutexLock lock(&mutex_);
+  packets_.clear();
+  closed_ = false;
+  num_dropped_ = 0;
+}
+
+bool OutputPacketQueue::Next(Packet* packet) {
+  CHECK(packet);
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &OutputPacketQueue::HasPacketOrClosed));
+  if (packets_.empty()) return false;
+  *packet = std::move(packets_.front());
+  packets_.pop_front();
+  return true;
+}
+
+bool OutputPacketQueue::TryNext(Packet* packet) {
+  CHECK(packet);
+  absl::MutexLock lock(&mutex_);
+  if (packets_.empty()) return false;
+  *packet = std::move(packets_.front());
+  packets_.pop_front();
+  return true;
+}
+
+bool OutputPacketQueue::NextBatch(std::vector<Packet>* packets,
+                                  int max_packets) {
+  CHECK(packets);
+  CHECK_NE(max_packets, 0);
+  packets->clear();
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &OutputPacketQueue::HasPacketOrClosed));
+  while (!packets_.empty() &&
+         (max_packets < 0 || packets->size() < max_packets)) {
+    packets->push_back(std::move(packets_.front()));
+    packets_.pop_front();
+  }
+  return !packets->empty();
+}
+
+int OutputPacketQueue::QueueSize() {
+  absl::MutexLock lock(&mutex_);
+  return packets_.size();
+}
+
+int64 OutputPacketQueue::NumDropped() {
+  absl::MutexLock lock(&mutex_);
+  return num_dropped_;
+}
+
+}  // namespace mediapipe
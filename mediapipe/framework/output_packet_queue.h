@@ -0,0 +1,91 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_OUTPUT_PACKET_QUEUE_H_
+#define MEDIAPIPE_FRAMEWORK_OUTPUT_PACKET_QUEUE_H_
+
+#include <deque>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// A thread-safe queue of the packets of an observed graph output stream, see
+// CalculatorGraph::AddOutputPacketQueue(). The graph pushes packets as they
+// are emitted and closes the queue once the stream is done, while the
+// application consumes them from its own thread.
+//
+// Unlike an OutputStreamPoller, a bounded queue never throttles the graph.
+// Once it is full, the oldest packet is dropped, so that a slow consumer such
+// as a display always gets the most recent results.
+class OutputPacketQueue {
+ public:
+  // The queue keeps at most max_queue_size packets, or any number of packets
+  // if max_queue_size is negative.
+  explicit OutputPacketQueue(int max_queue_size = -1)
+      : max_queue_size_(max_queue_size) {}
+
+  OutputPacketQueue(const OutputPacketQueue&) = delete;
+  OutputPacketQueue& operator=(const OutputPacketQueue&) = delete;
+
+  // Appends packet, dropping the oldest packet if the queue is full. Packets
+  // pushed after Close() are ignored.
+  void Push(Packet packet);
+
+  // Marks the end of the stream. Packets already queued can still be read.
+  void Close();
+
+  // Clears and reopens the queue.
+  void Reset();
+
+  // Gets the next packet, blocking until one is available or the queue is
+  // closed. Returns false once the queue is closed and empty.
+  ABSL_MUST_USE_RESULT bool Next(Packet* packet);
+
+  // Gets the next packet if one is available, without blocking. Returns false
+  // if the queue is empty.
+  ABSL_MUST_USE_RESULT bool TryNext(Packet* packet);
+
+  // Moves the queued packets, at most max_packets of them if non-negative,
+  // to packets, blocking until at least one is available or the queue is
+  // closed. Returns false once the queue is closed and empty.
+  ABSL_MUST_USE_RESULT bool NextBatch(std::vector<Packet>* packets,
+                                      int max_packets = -1);
+
+  // Returns the number of packets in the queue.
+  int QueueSize();
+
+  // Returns the number of packets dropped because the queue was full.
+  int64 NumDropped();
+
+ private:
+  bool HasPacketOrClosed() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !packets_.empty() || closed_;
+  }
+
+  const int max_queue_size_;
+  absl::Mutex mutex_;
+  std::deque<Packet> packets_ ABSL_GUARDED_BY(mutex_);
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+  int64 num_dropped_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_OUTPUT_PACKET_QUEUE_H_
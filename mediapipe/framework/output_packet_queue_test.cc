@@ -0,0 +1,95 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/output_packet_queue.h"
+
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+Packet IntPacket(int value) {
+  return MakePacket<int>(value).At(Timestamp(value));
+}
+
+TEST(OutputPacketQueueTest, UnboundedKeepsAllPackets) {
+  OutputPacketQueue queue;
+  for (int i = 0; i < 10; ++i) queue.Push(IntPacket(i));
+  EXPECT_EQ(queue.QueueSize(), 10);
+  EXPECT_EQ(queue.NumDropped(), 0);
+  std::vector<Packet> packets;
+  ASSERT_TRUE(queue.NextBatch(&packets, 4));
+  ASSERT_EQ(packets.size(), 4);
+  EXPECT_EQ(packets[3].Get<int>(), 3);
+  EXPECT_EQ(queue.QueueSize(), 6);
+}
+
+TEST(OutputPacketQueueTest, BoundedDropsOldest) {
+  OutputPacketQueue queue(2);
+  for (int i = 0; i < 5; ++i) queue.Push(IntPacket(i));
+  EXPECT_EQ(queue.NumDropped(), 3);
+  Packet packet;
+  ASSERT_TRUE(queue.TryNext(&packet));
+  EXPECT_EQ(packet.Get<int>(), 3);
+  ASSERT_TRUE(queue.TryNext(&packet));
+  EXPECT_EQ(packet.Get<int>(), 4);
+  EXPECT_FALSE(queue.TryNext(&packet));
+}
+
+TEST(OutputPacketQueueTest, CloseAndReset) {
+  OutputPacketQueue queue;
+  queue.Push(IntPacket(1));
+  queue.Close();
+  queue.Push(IntPacket(2));
+  Packet packet;
+  ASSERT_TRUE(queue.Next(&packet));
+  EXPECT_EQ(packet.Get<int>(), 1);
+  EXPECT_FALSE(queue.Next(&packet));
+  std::vector<Packet> packets;
+  EXPECT_FALSE(queue.NextBatch(&packets));
+
+  queue.Reset();
+  queue.Push(IntPacket(3));
+  ASSERT_TRUE(queue.Next(&packet));
+  EXPECT_EQ(packet.Get<int>(), 3);
+}
+
+// Next blocks until a packet is pushed or the queue is closed from another
+// thread.
+TEST(OutputPacketQueueTest, NextWaitsForProducer) {
+  OutputPacketQueue queue;
+  absl::Notification consumed;
+  {
+    ThreadPool pool("producer", 1);
+    pool.StartWorkers();
+    pool.Schedule([&queue, &consumed] {
+      queue.Push(IntPacket(7));
+      consumed.WaitForNotification();
+      queue.Close();
+    });
+    Packet packet;
+    ASSERT_TRUE(queue.Next(&packet));
+    EXPECT_EQ(packet.Get<int>(), 7);
+    consumed.Notify();
+    EXPECT_FALSE(queue.Next(&packet));
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -16,6 +16,7 @@
 #define MEDIAPIPE_FRAMEWORK_OUTPUT_STREAM_POLLER_H_
 
 #include <memory>
+#include <vector>
 
 #include "mediapipe/framework/graph_output_stream.h"
 
@@ -48,6 +49,30 @@ class OutputStreamPoller {
     return poller->Next(packet);
   }
 
+  // Gets the next packet if one is available, without blocking. Returns false
+  // if no packet is queued, use Next() or NextBatch() to detect the end of the
+  // stream.
+  ABSL_MUST_USE_RESULT bool TryNext(Packet* packet) {
+    auto poller = internal_poller_impl_.lock();
+    if (!poller) {
+      return false;
+    }
+    return poller->TryNext(packet);
+  }
+
+  // Gets all queued packets, or at most max_packets of them if non-negative,
+  // blocking until at least one is available or the stream is done. Returns
+  // true if successful. Draining in batches lets a consumer that fell behind
+  // catch up, e.g. by rendering only the most recent packet.
+  ABSL_MUST_USE_RESULT bool NextBatch(std::vector<Packet>* packets,
+                                      int max_packets = -1) {
+    auto poller = internal_poller_impl_.lock();
+    if (!poller) {
+      return false;
+    }
+    return poller->NextBatch(packets, max_packets);
+  }
+
   void SetMaxQueueSize(int queue_size) {
     auto poller = internal_poller_impl_.lock();
     CHECK(poller) << "OutputStreamPollerImpl is already destroyed.";
@@ -25,7 +25,7 @@
 namespace mediapipe {
 namespace packet_internal {
 
-HolderBase::~HolderBase() {}
+HolderBase::~HolderBase() { UnaccountPayload(); }
 
 Packet Create(HolderBase* holder) {
   Packet result;
@@ -29,6 +29,7 @@
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/deps/no_destructor.h"
 #include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/packet_memory.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
@@ -47,6 +48,17 @@ class Packet;
 
 namespace packet_internal {
 class HolderBase;
+template <typename T>
+class InlineHolder;
+
+// Payloads small and trivially copyable enough to be stored in their holder,
+// see InlineHolder.
+template <typename T>
+struct IsInlinePayload
+    : std::integral_constant<
+          bool, std::is_trivially_copyable<T>::value &&
+                    !std::is_array<T>::value && sizeof(T) <= 64 &&
+                    alignof(T) <= alignof(std::max_align_t)> {};
 
 Packet Create(HolderBase* holder);
 Packet Create(HolderBase* holder, Timestamp timestamp);
@@ -301,12 +313,28 @@ Packet AdoptAsSyncedPacket(const T* ptr) {
 //
 // Version for scalars.
 template <typename T,
-          typename std::enable_if<!std::is_array<T>::value>::type* = nullptr,
+          typename std::enable_if<
+              !std::is_array<T>::value &&
+              !packet_internal::IsInlinePayload<T>::value>::type* = nullptr,
           typename... Args>
 Packet MakePacket(Args&&... args) {  // NOLINT(build/c++11)
   return Adopt(new T(std::forward<Args>(args)...));
 }
 
+// Version for small trivially copyable scalars, such as floats or small
+// structs, which are stored in the holder itself: the packet then takes a
+// single allocation instead of three.
+template <typename T,
+          typename std::enable_if<
+              packet_internal::IsInlinePayload<T>::value>::type* = nullptr,
+          typename... Args>
+Packet MakePacket(Args&&... args) {  // NOLINT(build/c++11)
+  return packet_internal::Create(
+      std::make_shared<packet_internal::InlineHolder<T>>(
+          std::forward<Args>(args)...),
+      Timestamp::Unset());
+}
+
 // Version for arrays. We have to use reinterpret_cast because new T[N]
 // returns a T* instead of a T(*)[N] (i.e. a pointer to the first element
 // instead of a pointer to the array itself - they have the same value, but
@@ -393,8 +421,32 @@ class HolderBase {
   virtual StatusOr<std::vector<const proto_ns::MessageLite*>>
   GetVectorOfProtoMessageLite() const = 0;
 
+  // Returns the payload size recorded by packet memory accounting, or 0 if
+  // the payload is not accounted.
+  int64 AccountedBytes() const { return accounted_bytes_; }
+
+ protected:
+  // Records the payload in packet memory accounting.
+  void AccountPayload(PacketTypeMemory* type_memory, int64 bytes) {
+    type_memory_ = type_memory;
+    accounted_bytes_ = bytes;
+    PacketMemoryAccounting::AddPayload(type_memory_, accounted_bytes_);
+  }
+
+  // Removes the payload from packet memory accounting, when it is destroyed
+  // or no longer owned by the holder.
+  void UnaccountPayload() {
+    if (type_memory_) {
+      PacketMemoryAccounting::RemovePayload(type_memory_, accounted_bytes_);
+      type_memory_ = nullptr;
+      accounted_bytes_ = 0;
+    }
+  }
+
  private:
   size_t type_id_;
+  PacketTypeMemory* type_memory_ = nullptr;
+  int64 accounted_bytes_ = 0;
 };
 
 // Two helper functions to get the proto base pointers.
@@ -502,6 +554,12 @@ class Holder : public HolderBase {
   explicit Holder(const T* ptr) : ptr_(ptr) {
     HolderSupport<T>::EnsureStaticInit();
     SetHolderTypeId<Holder>();
+    if (ptr_ && PacketMemoryAccounting::IsEnabled()) {
+      static PacketTypeMemory* type_memory =
+          PacketMemoryAccounting::RegisterType(
+              MediaPipeTypeStringOrDemangled<T>());
+      AccountPayload(type_memory, PayloadBytes());
+    }
   }
   ~Holder() override { delete_helper(); }
   const T& data() const {
@@ -523,9 +581,13 @@ class Holder : public HolderBase {
       return InternalError(
           "Foreign holder can't release data ptr without ownership.");
     }
-    // Casts away constness to make the data mutable after the release.
-    std::unique_ptr<T> data_ptr(const_cast<T*>(ptr_));
+    std::unique_ptr<T> data_ptr = ReleaseInline();
+    if (!data_ptr) {
+      // Casts away constness to make the data mutable after the release.
+      data_ptr.reset(const_cast<T*>(ptr_));
+    }
     ptr_ = nullptr;
+    this->UnaccountPayload();
     return std::move(data_ptr);
   }
   // TODO: support unbounded array after fixing the bug in holder's
@@ -552,6 +614,10 @@ class Holder : public HolderBase {
   // Holder itself may be shared by several Packets.
   const T* ptr_;
 
+  // Returns a copy of the data if it is stored in the holder rather than
+  // owned through ptr_, see InlineHolder. Returns nullptr otherwise.
+  virtual std::unique_ptr<T> ReleaseInline() { return nullptr; }
+
   // Returns the MessageLite pointer to the data, if the underlying object type
   // is protocol buffer, otherwise, nullptr is returned.
   const proto_ns::MessageLite* GetProtoMessageLite() override {
@@ -568,6 +634,19 @@ class Holder : public HolderBase {
   }
 
  private:
+  // Returns the payload size for packet memory accounting. InlineHolder
+  // passes its payload before constructing it, but inline payloads are
+  // trivially copyable and own no memory beyond their own size.
+  size_t PayloadBytes() const {
+    if constexpr (std::is_array<T>::value && std::extent<T>::value == 0) {
+      return 0;
+    } else if constexpr (IsInlinePayload<T>::value) {
+      return sizeof(T);
+    } else {
+      return PacketMemorySize<T>::Of(*ptr_);
+    }
+  }
+
   // Call delete[] if T is an array, delete otherwise.
   template <typename U = T>
   inline void delete_helper(
@@ -592,6 +671,8 @@ class ForeignHolder : public Holder<T> {
     // Distinguishes between Holder and ForeignHolder since Consume() treats
     // them differently.
     this->template SetHolderTypeId<ForeignHolder>();
+    // The packet does not own foreign data.
+    this->UnaccountPayload();
   }
   ~ForeignHolder() override {
     // Null out ptr_ so it doesn't get deleted by ~Holder.
@@ -604,6 +685,33 @@ class ForeignHolder : public Holder<T> {
   }
 };
 
+// Like Holder, but stores its data as a member, so that creating it with
+// std::make_shared allocates the data, the holder and the reference count
+// together. It keeps the type id of Holder<T>, so packets holding it behave
+// exactly like packets holding a Holder<T>. Consuming the packet copies the
+// data out, which is cheap since T is a small trivially copyable type.
+template <typename T>
+class InlineHolder : public Holder<T> {
+ public:
+  static_assert(IsInlinePayload<T>::value, "T must be an inline payload.");
+
+  template <typename... Args>
+  explicit InlineHolder(Args&&... args)
+      : Holder<T>(&data_), data_(std::forward<Args>(args)...) {}
+  ~InlineHolder() override {
+    // Null out ptr_ so it doesn't get deleted by ~Holder.
+    this->ptr_ = nullptr;
+  }
+
+ protected:
+  std::unique_ptr<T> ReleaseInline() override {
+    return absl::make_unique<T>(data_);
+  }
+
+ private:
+  T data_;
+};
+
 template <typename T>
 Holder<T>* HolderBase::As() {
   if (HolderIsOfType<Holder<T>>() || HolderIsOfType<ForeignHolder<T>>()) {
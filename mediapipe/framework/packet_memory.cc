@@ -0,0 +1,100 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_memory.h"
+
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+
+namespace mediapipe {
+namespace {
+
+// Raises peak to value, if value is greater.
+void UpdatePeak(std::atomic<int64>* peak, int64 value) {
+  int64 previous = peak->load(std::memory_order_relaxed);
+  while (value > previous &&
+         !peak->compare_exchange_weak(previous, value,
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+absl::Mutex* TypeRegistryMutex() {
+  static absl::Mutex* mutex = new absl::Mutex();
+  return mutex;
+}
+
+std::vector<std::unique_ptr<PacketTypeMemory>>* TypeRegistry() {
+  static auto* registry = new std::vector<std::unique_ptr<PacketTypeMemory>>();
+  return registry;
+}
+
+}  // namespace
+
+std::atomic<bool> PacketMemoryAccounting::enabled_{false};
+
+PacketTypeMemory* PacketMemoryAccounting::RegisterType(
+    const std::string& type_name) {
+  absl::MutexLock lock(TypeRegistryMutex());
+  TypeRegistry()->push_back(absl::make_unique<PacketTypeMemory>(type_name));
+  return TypeRegistry()->back().get();
+}
+
+std::vector<const PacketTypeMemory*> PacketMemoryAccounting::GetTypeMemory() {
+  absl::MutexLock lock(TypeRegistryMutex());
+  std::vector<const PacketTypeMemory*> result;
+  for (const auto& type_memory : *TypeRegistry()) {
+    result.push_back(type_memory.get());
+  }
+  return result;
+}
+
+void PacketMemoryAccounting::AddPayload(PacketTypeMemory* type_memory,
+                                        int64 bytes) {
+  type_memory->live_packets.fetch_add(1, std::memory_order_relaxed);
+  int64 live_bytes =
+      type_memory->live_bytes.fetch_add(bytes, std::memory_order_relaxed) +
+      bytes;
+  UpdatePeak(&type_memory->peak_bytes, live_bytes);
+}
+
+void PacketMemoryAccounting::RemovePayload(PacketTypeMemory* type_memory,
+                                           int64 bytes) {
+  type_memory->live_packets.fetch_sub(1, std::memory_order_relaxed);
+  type_memory->live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+PacketMemoryTracker::StreamMemory* PacketMemoryTracker::AddStream(
+    const std::string& stream_name) {
+  streams_.push_back(absl::make_unique<StreamMemory>(stream_name));
+  return streams_.back().get();
+}
+
+void PacketMemoryTracker::Update(StreamMemory* stream, int64 delta) {
+  if (delta == 0) {
+    return;
+  }
+  UpdatePeak(&stream->peak_bytes,
+             stream->queued_bytes.fetch_add(delta, std::memory_order_relaxed) +
+                 delta);
+  int64 queued_bytes =
+      queued_bytes_.fetch_add(delta, std::memory_order_relaxed) + delta;
+  // The callback is invoked after each increase above the budget, and after
+  // each decrease from above the budget.
+  if (budget_ > 0 && budget_callback_ &&
+      (delta > 0 ? queued_bytes : queued_bytes - delta) > budget_) {
+    budget_callback_();
+  }
+}
+
+}  // namespace mediapipe
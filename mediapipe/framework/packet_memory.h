@@ -0,0 +1,150 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PACKET_MEMORY_H_
+#define MEDIAPIPE_FRAMEWORK_PACKET_MEMORY_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Packet memory accounting.
+//
+// When enabled, each packet holder records the size of its payload when it
+// is created, and the live packets and bytes are counted per payload type,
+// across stream queues, side packets and calculator state. In addition, each
+// graph counts the bytes queued in each of its input streams, and can
+// throttle its graph input streams when these exceed a budget, see
+// CalculatorGraphConfig::packet_memory_budget.
+//
+// Accounting is enabled by ProfilerConfig::enable_packet_memory_accounting or
+// by a packet memory budget, and then stays enabled for the process. The
+// counters are reported in GraphProfile::packet_memory.
+
+// Returns the number of bytes owned by a packet payload. The default is the
+// size of the object itself. Payload types owning heap buffers, such as
+// ImageFrame, specialize this template next to their definition.
+template <typename T, typename Enable = void>
+struct PacketMemorySize {
+  static size_t Of(const T& value) { return sizeof(T); }
+};
+
+template <>
+struct PacketMemorySize<std::string> {
+  static size_t Of(const std::string& value) {
+    return sizeof(value) + value.capacity();
+  }
+};
+
+template <typename T, typename A>
+struct PacketMemorySize<
+    std::vector<T, A>,
+    typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+  static size_t Of(const std::vector<T, A>& value) {
+    return sizeof(value) + value.capacity() * sizeof(T);
+  }
+};
+
+// The live packet payloads of one type.
+struct PacketTypeMemory {
+  explicit PacketTypeMemory(const std::string& type_name)
+      : type_name(type_name) {}
+  const std::string type_name;
+  std::atomic<int64> live_packets{0};
+  std::atomic<int64> live_bytes{0};
+  std::atomic<int64> peak_bytes{0};
+};
+
+// The process-wide packet memory accounting state.
+class PacketMemoryAccounting {
+ public:
+  // Enables or disables accounting for packets created from now on.
+  static void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+  static bool IsEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Returns the counters for a payload type, registering them on first use.
+  // The counters live for the lifetime of the process.
+  static PacketTypeMemory* RegisterType(const std::string& type_name);
+
+  // Returns the counters of all registered payload types.
+  static std::vector<const PacketTypeMemory*> GetTypeMemory();
+
+  // Updates the counters for a payload created or destroyed.
+  static void AddPayload(PacketTypeMemory* type_memory, int64 bytes);
+  static void RemovePayload(PacketTypeMemory* type_memory, int64 bytes);
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+// Counts the packet bytes queued in the input streams of a graph, and
+// reports when they exceed the graph's packet memory budget.
+class PacketMemoryTracker {
+ public:
+  // The packet bytes queued in one input stream.
+  struct StreamMemory {
+    explicit StreamMemory(const std::string& stream_name)
+        : stream_name(stream_name) {}
+    const std::string stream_name;
+    std::atomic<int64> queued_bytes{0};
+    std::atomic<int64> peak_bytes{0};
+  };
+
+  // A budget of 0 disables the budget.
+  explicit PacketMemoryTracker(int64 budget) : budget_(budget) {}
+
+  // Adds counters for an input stream. Must not be called while the graph is
+  // running.
+  StreamMemory* AddStream(const std::string& stream_name);
+
+  // Sets the callback invoked when the tracker may have gone over or back
+  // under the budget. It is invoked with no locks held, and should re-read
+  // OverBudget().
+  void SetBudgetCallback(std::function<void()> callback) {
+    budget_callback_ = std::move(callback);
+  }
+
+  // Updates the bytes queued in a stream.
+  void Update(StreamMemory* stream, int64 delta);
+
+  int64 Budget() const { return budget_; }
+  int64 QueuedBytes() const {
+    return queued_bytes_.load(std::memory_order_relaxed);
+  }
+  bool OverBudget() const { return budget_ > 0 && QueuedBytes() > budget_; }
+
+  // Returns the counters of all streams.
+  const std::vector<std::unique_ptr<StreamMemory>>& streams() const {
+    return streams_;
+  }
+
+ private:
+  const int64 budget_;
+  std::atomic<int64> queued_bytes_{0};
+  std::vector<std::unique_ptr<StreamMemory>> streams_;
+  std::function<void()> budget_callback_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PACKET_MEMORY_H_
@@ -0,0 +1,167 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_memory.h"
+
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/type_map.h"
+
+namespace mediapipe {
+namespace {
+
+// Payload types used only by these tests, so that the process-wide counters
+// start at zero.
+struct SmallPayload {
+  char data[24];
+};
+struct LargePayload {
+  std::vector<float> values;
+};
+struct ForeignPayload {
+  int64 value;
+};
+
+}  // namespace
+
+template <>
+struct PacketMemorySize<LargePayload> {
+  static size_t Of(const LargePayload& value) {
+    return sizeof(value) + value.values.capacity() * sizeof(float);
+  }
+};
+
+namespace {
+
+template <typename T>
+const PacketTypeMemory* FindTypeMemory() {
+  for (const PacketTypeMemory* type_memory :
+       PacketMemoryAccounting::GetTypeMemory()) {
+    if (type_memory->type_name == MediaPipeTypeStringOrDemangled<T>()) {
+      return type_memory;
+    }
+  }
+  return nullptr;
+}
+
+class PacketMemoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override { PacketMemoryAccounting::SetEnabled(true); }
+  void TearDown() override { PacketMemoryAccounting::SetEnabled(false); }
+};
+
+TEST_F(PacketMemoryTest, CountsLivePackets) {
+  Packet p1 = MakePacket<SmallPayload>();
+  Packet p2 = MakePacket<SmallPayload>();
+  Packet p3 = p2;
+  const PacketTypeMemory* type_memory = FindTypeMemory<SmallPayload>();
+  ASSERT_NE(type_memory, nullptr);
+  EXPECT_EQ(type_memory->live_packets, 2);
+  EXPECT_EQ(type_memory->live_bytes, 2 * sizeof(SmallPayload));
+  EXPECT_EQ(packet_internal::GetHolder(p1)->AccountedBytes(),
+            sizeof(SmallPayload));
+
+  p1 = Packet();
+  p2 = Packet();
+  EXPECT_EQ(type_memory->live_packets, 1);
+  p3 = Packet();
+  EXPECT_EQ(type_memory->live_packets, 0);
+  EXPECT_EQ(type_memory->live_bytes, 0);
+  EXPECT_EQ(type_memory->peak_bytes, 2 * sizeof(SmallPayload));
+}
+
+TEST_F(PacketMemoryTest, CountsOwnedBuffers) {
+  Packet packet = MakePacket<LargePayload>(
+      LargePayload{std::vector<float>(1000, 1.0f)});
+  EXPECT_EQ(packet_internal::GetHolder(packet)->AccountedBytes(),
+            sizeof(LargePayload) + 1000 * sizeof(float));
+
+  std::string text(500, 'a');
+  EXPECT_GE(PacketMemorySize<std::string>::Of(text), 500);
+  std::vector<int32> ints(100);
+  EXPECT_EQ(PacketMemorySize<std::vector<int32>>::Of(ints),
+            sizeof(ints) + 100 * sizeof(int32));
+}
+
+TEST_F(PacketMemoryTest, ConsumeRemovesPayload) {
+  Packet packet = MakePacket<LargePayload>(
+      LargePayload{std::vector<float>(10, 1.0f)});
+  const PacketTypeMemory* type_memory = FindTypeMemory<LargePayload>();
+  ASSERT_NE(type_memory, nullptr);
+  EXPECT_EQ(type_memory->live_packets, 1);
+  MP_ASSERT_OK(packet.Consume<LargePayload>());
+  EXPECT_EQ(type_memory->live_packets, 0);
+  EXPECT_EQ(type_memory->live_bytes, 0);
+}
+
+TEST_F(PacketMemoryTest, IgnoresForeignPayloads) {
+  ForeignPayload payload{1};
+  Packet packet = PointToForeign(&payload);
+  EXPECT_EQ(packet_internal::GetHolder(packet)->AccountedBytes(), 0);
+  const PacketTypeMemory* type_memory = FindTypeMemory<ForeignPayload>();
+  ASSERT_NE(type_memory, nullptr);
+  EXPECT_EQ(type_memory->live_packets, 0);
+}
+
+TEST_F(PacketMemoryTest, IgnoresPacketsWhenDisabled) {
+  PacketMemoryAccounting::SetEnabled(false);
+  Packet packet = MakePacket<int64>(1);
+  EXPECT_EQ(packet_internal::GetHolder(packet)->AccountedBytes(), 0);
+}
+
+TEST(PacketMemoryTrackerTest, ReportsBudget) {
+  PacketMemoryTracker tracker(100);
+  PacketMemoryTracker::StreamMemory* a = tracker.AddStream("a");
+  PacketMemoryTracker::StreamMemory* b = tracker.AddStream("b");
+  int callbacks = 0;
+  tracker.SetBudgetCallback([&callbacks] { ++callbacks; });
+
+  tracker.Update(a, 60);
+  tracker.Update(b, 40);
+  EXPECT_FALSE(tracker.OverBudget());
+  EXPECT_EQ(callbacks, 0);
+
+  tracker.Update(b, 20);
+  EXPECT_TRUE(tracker.OverBudget());
+  EXPECT_EQ(callbacks, 1);
+  EXPECT_EQ(tracker.QueuedBytes(), 120);
+
+  tracker.Update(a, -60);
+  EXPECT_FALSE(tracker.OverBudget());
+  EXPECT_EQ(callbacks, 2);
+  tracker.Update(b, -60);
+  EXPECT_EQ(callbacks, 2);
+
+  EXPECT_EQ(a->queued_bytes, 0);
+  EXPECT_EQ(a->peak_bytes, 60);
+  EXPECT_EQ(b->peak_bytes, 60);
+  ASSERT_EQ(tracker.streams().size(), 2);
+  EXPECT_EQ(tracker.streams()[1]->stream_name, "b");
+}
+
+TEST(PacketMemoryTrackerTest, ZeroBudgetIsUnlimited) {
+  PacketMemoryTracker tracker(0);
+  PacketMemoryTracker::StreamMemory* a = tracker.AddStream("a");
+  tracker.SetBudgetCallback([] { FAIL() << "Unexpected budget callback"; });
+  tracker.Update(a, 1 << 30);
+  EXPECT_FALSE(tracker.OverBudget());
+}
+
+}  // namespace
+}  // namespace mediapipe
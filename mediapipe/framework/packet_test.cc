@@ -369,6 +369,40 @@ TEST(PacketTest, TestPacketConsumeOrCopy) {
   EXPECT_TRUE(packet3.IsEmpty());
 }
 
+struct SmallStruct {
+  float x;
+  float y;
+  int id;
+};
+
+TEST(PacketTest, StoresSmallTrivialPayloadInHolder) {
+  Packet packet = MakePacket<SmallStruct>(SmallStruct{1.5f, 2.5f, 3});
+  const packet_internal::HolderBase* holder =
+      packet_internal::GetHolder(packet);
+  const char* data = reinterpret_cast<const char*>(&packet.Get<SmallStruct>());
+  EXPECT_GE(data, reinterpret_cast<const char*>(holder));
+  EXPECT_LT(data, reinterpret_cast<const char*>(holder) +
+                      sizeof(packet_internal::InlineHolder<SmallStruct>));
+  EXPECT_EQ(packet.Get<SmallStruct>().id, 3);
+  MP_EXPECT_OK(packet.ValidateAsType<SmallStruct>());
+  EXPECT_FALSE(packet.ValidateAsType<int>().ok());
+
+  Packet copy = packet;
+  bool was_copied = false;
+  absl::StatusOr<std::unique_ptr<SmallStruct>> copied =
+      copy.ConsumeOrCopy<SmallStruct>(&was_copied);
+  MP_ASSERT_OK(copied);
+  EXPECT_TRUE(was_copied);
+  EXPECT_EQ(copied.value()->x, 1.5f);
+
+  absl::StatusOr<std::unique_ptr<SmallStruct>> consumed =
+      packet.Consume<SmallStruct>();
+  MP_ASSERT_OK(consumed);
+  EXPECT_TRUE(packet.IsEmpty());
+  EXPECT_EQ(consumed.value()->y, 2.5f);
+  EXPECT_EQ(consumed.value()->id, 3);
+}
+
 TEST(PacketTest, TestConsumeForeignHolder) {
   std::unique_ptr<int> data(new int(33));
   Packet packet = PointToForeign(data.get());
@@ -646,6 +646,36 @@ absl::StatusOr<std::string> GraphProfiler::GetTraceLogPath() {
   }
 }
 
+void GraphProfiler::SetPacketMemoryTracker(const PacketMemoryTracker* tracker) {
+  absl::WriterMutexLock lock(&profiler_mutex_);
+  packet_memory_tracker_ = tracker;
+}
+
+void GraphProfiler::GetPacketMemoryProfile(PacketMemoryProfile* result) const {
+  if (!PacketMemoryAccounting::IsEnabled()) {
+    return;
+  }
+  for (const PacketTypeMemory* type_memory :
+       PacketMemoryAccounting::GetTypeMemory()) {
+    auto* type_profile = result->add_type_memory();
+    type_profile->set_type_name(type_memory->type_name);
+    type_profile->set_live_packets(type_memory->live_packets.load());
+    type_profile->set_live_bytes(type_memory->live_bytes.load());
+    type_profile->set_peak_bytes(type_memory->peak_bytes.load());
+  }
+  absl::ReaderMutexLock lock(&profiler_mutex_);
+  if (packet_memory_tracker_) {
+    for (const auto& stream : packet_memory_tracker_->streams()) {
+      auto* stream_profile = result->add_stream_memory();
+      stream_profile->set_stream_name(stream->stream_name);
+      stream_profile->set_queued_bytes(stream->queued_bytes.load());
+      stream_profile->set_peak_bytes(stream->peak_bytes.load());
+    }
+    result->set_queued_bytes(packet_memory_tracker_->QueuedBytes());
+    result->set_budget_bytes(packet_memory_tracker_->Budget());
+  }
+}
+
 absl::Status GraphProfiler::CaptureProfile(GraphProfile* result) {
   // Record the GraphTrace events since the previous WriteProfile.
   // The end_time is chosen to be trace_log_margin_usec in the past,
@@ -674,6 +704,11 @@ absl::Status GraphProfiler::CaptureProfile(GraphProfile* result) {
   }
   this->Reset();
   CleanCalculatorProfiles(result);
+
+  // Record the current packet memory.
+  if (PacketMemoryAccounting::IsEnabled()) {
+    GetPacketMemoryProfile(result->mutable_packet_memory());
+  }
   return status;
 }
 
@@ -29,6 +29,7 @@
 #include "mediapipe/framework/deps/clock.h"
 #include "mediapipe/framework/deps/monotonic_clock.h"
 #include "mediapipe/framework/executor.h"
+#include "mediapipe/framework/packet_memory.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/profiler/graph_tracer.h"
 #include "mediapipe/framework/profiler/sharded_map.h"
@@ -143,6 +144,16 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   absl::Status GetCalculatorProfiles(std::vector<CalculatorProfile>*) const
       ABSL_LOCKS_EXCLUDED(profiler_mutex_);
 
+  // Sets the packet bytes queued in the input streams of the graph, or null.
+  // The tracker must remain valid until it is replaced.
+  void SetPacketMemoryTracker(const PacketMemoryTracker* tracker)
+      ABSL_LOCKS_EXCLUDED(profiler_mutex_);
+
+  // Collects the live packet bytes per payload type and the queued packet
+  // bytes per input stream.  Empty unless packet memory accounting is enabled.
+  void GetPacketMemoryProfile(PacketMemoryProfile* result) const
+      ABSL_LOCKS_EXCLUDED(profiler_mutex_);
+
   // Records recent profiling and tracing data.  Includes events since the
   // previous call to CaptureProfile.
   absl::Status CaptureProfile(GraphProfile* result);
@@ -338,6 +349,10 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // The configuration for the graph being profiled.
   const ValidatedGraphConfig* validated_graph_;
 
+  // The packet bytes queued in the input streams of the graph.
+  const PacketMemoryTracker* packet_memory_tracker_
+      ABSL_GUARDED_BY(profiler_mutex_) = nullptr;
+
   // A private resource for creating GraphProfiles.
   class GraphProfileBuilder;
   std::unique_ptr<GraphProfileBuilder> profile_builder_;
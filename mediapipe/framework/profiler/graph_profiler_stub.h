@@ -22,12 +22,14 @@ namespace mediapipe {
 class CalculatorProfile;
 class GraphTrace;
 class GraphProfile;
+class PacketMemoryProfile;
 }  // namespace mediapipe
 
 namespace mediapipe {
 using mediapipe::CalculatorProfile;
 using mediapipe::GraphProfile;
 using mediapipe::GraphTrace;
+using mediapipe::PacketMemoryProfile;
 
 class ValidatedGraphConfig;
 class Executor;
@@ -35,6 +37,7 @@ class Packet;
 class Clock;
 class GraphTracer;
 class GlProfilingHelper;
+class PacketMemoryTracker;
 
 class TraceEvent {
  public:
@@ -85,6 +88,8 @@ class GraphProfilerStub {
       std::vector<CalculatorProfile>*) const {
     return absl::OkStatus();
   }
+  inline void SetPacketMemoryTracker(const PacketMemoryTracker* tracker) {}
+  inline void GetPacketMemoryProfile(PacketMemoryProfile* result) const {}
   inline void Pause() {}
   inline void Resume() {}
   inline void Reset() {}
@@ -1268,5 +1268,47 @@ TEST(GraphProfilerTest, CalculatorProfileFilter) {
   EXPECT_EQ(GetCalculatorNames(config), expected_names);
 }
 
+TEST(GraphProfilerTest, PacketMemoryProfile) {
+  CalculatorGraphConfig config;
+  QCHECK(proto2::TextFormat::ParseFromString(R"(
+    input_stream: "in"
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "in"
+      output_stream: "out"
+    }
+    packet_memory_budget: 100000
+    )",
+                                             &config));
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  Packet packet = MakePacket<std::string>(std::string(1000, 'a'));
+  int64 packet_bytes = packet_internal::GetHolder(packet)->AccountedBytes();
+  EXPECT_GT(packet_bytes, 1000);
+  MP_ASSERT_OK(graph.AddPacketToInputStream("in", packet.At(Timestamp(0))));
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  GraphProfile profile;
+  MP_EXPECT_OK(graph.profiler()->CaptureProfile(&profile));
+  const PacketMemoryProfile& memory = profile.packet_memory();
+  EXPECT_EQ(memory.budget_bytes(), 100000);
+  EXPECT_EQ(memory.queued_bytes(), 0);
+  ASSERT_EQ(memory.stream_memory_size(), 1);
+  EXPECT_EQ(memory.stream_memory(0).stream_name(), "in");
+  EXPECT_EQ(memory.stream_memory(0).peak_bytes(), packet_bytes);
+  bool found_type = false;
+  for (const auto& type_memory : memory.type_memory()) {
+    if (type_memory.type_name() ==
+        MediaPipeTypeStringOrDemangled<std::string>()) {
+      found_type = true;
+      EXPECT_GE(type_memory.live_packets(), 1);
+      EXPECT_GE(type_memory.peak_bytes(), packet_bytes);
+    }
+  }
+  EXPECT_TRUE(found_type);
+}
+
 }  // namespace
 }  // namespace mediapipe
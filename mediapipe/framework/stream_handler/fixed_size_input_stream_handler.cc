@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -44,6 +45,10 @@ namespace mediapipe {
 // timestamp, so that each included timestamp delivers the same packets as
 // DefaultInputStreamHandler includes.
 //
+// If the graph provides a LoadShedder service, the dropped timestamps are
+// reported to it, so that source-side gates can discard the frames before
+// any upstream work is spent on them. See load_shedder.h.
+//
 class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
  public:
   FixedSizeInputStreamHandler() = delete;
@@ -82,9 +87,23 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
       min_timestamp_all_streams =
           std::min(min_timestamp_all_streams, min_timestamp);
     }
-    for (auto& stream : input_stream_managers_) {
-      stream->ErasePacketsEarlierThan(min_timestamp_all_streams);
+    ErasePacketsEarlierThan(min_timestamp_all_streams);
+  }
+
+  // Discards the packets earlier than timestamp from every input stream, and
+  // reports the discarded timestamps to the graph's LoadShedder.
+  void ErasePacketsEarlierThan(Timestamp timestamp) {
+    int64 num_dropped = 0;
+    for (CollectionItemId id = input_stream_managers_.BeginId();
+         id < input_stream_managers_.EndId(); ++id) {
+      InputStreamManager* stream = input_stream_managers_.Get(id);
+      int queue_size = stream->QueueSize();
+      stream->ErasePacketsEarlierThan(timestamp);
+      num_dropped = std::max<int64>(num_dropped,
+                                    queue_size - stream->QueueSize());
+      MarkStreamChanged(id);
     }
+    RecordDroppedTimestamps(num_dropped);
   }
 
   // Returns the latest timestamp allowed before a bound.
@@ -146,9 +165,7 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
       kept_timestamp_ =
           std::min(kept_timestamp_, PreviousAllowedInStream(MinStreamBound()));
     }
-    for (auto& stream : input_stream_managers_) {
-      stream->ErasePacketsEarlierThan(kept_timestamp_);
-    }
+    ErasePacketsEarlierThan(kept_timestamp_);
   }
 
   void EraseSurplusPackets(bool keep_one)
@@ -22,6 +22,7 @@
 #include "mediapipe/framework/collection_item_id.h"
 #include "mediapipe/framework/input_stream_handler.h"
 #include "mediapipe/framework/stream_handler/timestamp_align_input_stream_handler.pb.h"
+#include "mediapipe/framework/stream_readiness_tracker.h"
 #include "mediapipe/framework/timestamp.h"
 #include "mediapipe/framework/tool/validate_name.h"
 
@@ -80,6 +81,9 @@ class TimestampAlignInputStreamHandler : public InputStreamHandler {
   absl::Mutex mutex_;
   bool offsets_initialized_ ABSL_GUARDED_BY(mutex_) = false;
   std::vector<TimestampDiff> timestamp_offsets_;
+  // Tracks every stream at its id, aligned with the timestamp base. Only
+  // used once the offsets are initialized.
+  std::shared_ptr<StreamReadinessTracker> tracker_;
 };
 REGISTER_INPUT_STREAM_HANDLER(TimestampAlignInputStreamHandler);
 
@@ -100,6 +104,20 @@ TimestampAlignInputStreamHandler::TimestampAlignInputStreamHandler(
       << "stream \"" << handler_options.timestamp_base_tag_index()
       << "\" is not found.";
   timestamp_offsets_[timestamp_base_stream_id_.value()] = 0;
+  tracker_ = std::make_shared<StreamReadinessTracker>(
+      input_stream_managers_.NumEntries(), [this](int index, bool* empty) {
+        CollectionItemId id = input_stream_managers_.BeginId() + index;
+        Timestamp stream_timestamp =
+            input_stream_managers_.Get(id)->MinTimestampOrBound(empty);
+        if (stream_timestamp.IsRangeValue()) {
+          stream_timestamp += timestamp_offsets_[index];
+        }
+        return stream_timestamp;
+      });
+  for (CollectionItemId id = input_stream_managers_.BeginId();
+       id < input_stream_managers_.EndId(); ++id) {
+    TrackStream(id, tracker_, id.value());
+  }
 }
 
 void TimestampAlignInputStreamHandler::PrepareForRun(
@@ -151,24 +169,16 @@ NodeReadiness TimestampAlignInputStreamHandler::GetNodeReadiness(
       }
       if (unknown_non_base_stream_count == 0) {
         offsets_initialized_ = true;
+        // The tracked timestamps depend on the offsets.
+        tracker_->MarkAllChanged();
       }
       return NodeReadiness::kReadyForProcess;
     }
   }
 
-  for (CollectionItemId id = input_stream_managers_.BeginId();
-       id < input_stream_managers_.EndId(); ++id) {
-    const auto& stream = input_stream_managers_.Get(id);
-    bool empty;
-    Timestamp stream_timestamp = stream->MinTimestampOrBound(&empty);
-    if (stream_timestamp.IsRangeValue()) {
-      stream_timestamp += timestamp_offsets_[id.value()];
-    }
-    if (empty) {
-      min_bound = std::min(min_bound, stream_timestamp);
-    }
-    *min_stream_timestamp = std::min(*min_stream_timestamp, stream_timestamp);
-  }
+  tracker_->Refresh();
+  min_bound = tracker_->MinBound();
+  *min_stream_timestamp = std::min(tracker_->MinPacket(), min_bound);
 
   if (*min_stream_timestamp == Timestamp::Done()) {
     return NodeReadiness::kReadyForClose;
@@ -198,6 +208,7 @@ void TimestampAlignInputStreamHandler::FillInputSet(
         if (id == timestamp_base_stream_id_) {
           current_packet = stream->PopPacketAtTimestamp(
               input_timestamp, &num_packets_dropped, &stream_is_done);
+          tracker_->MarkChanged(id.value());
           CHECK_EQ(num_packets_dropped, 0) << absl::Substitute(
               "Dropped $0 packet(s) on input stream \"$1\".",
               num_packets_dropped, stream->Name());
@@ -217,6 +228,7 @@ void TimestampAlignInputStreamHandler::FillInputSet(
         input_timestamp - timestamp_offsets_[id.value()];
     Packet current_packet = stream->PopPacketAtTimestamp(
         stream_timestamp, &num_packets_dropped, &stream_is_done);
+    tracker_->MarkChanged(id.value());
     if (!current_packet.IsEmpty()) {
       CHECK_EQ(current_packet.Timestamp(), stream_timestamp);
       current_packet = current_packet.At(input_timestamp);
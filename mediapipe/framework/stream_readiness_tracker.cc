@@ -0,0 +1,80 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "mediapipe/framework/stream_readiness_tracker.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+StreamReadinessTracker::StreamReadinessTracker(int num_streams,
+                                               ReadStreamFn read_stream)
+    : num_streams_(num_streams),
+      read_stream_(std::move(read_stream)),
+      changed_(new std::atomic<bool>[num_streams]) {
+  CHECK_GE(num_streams, 0);
+  while (num_leaves_ < num_streams) num_leaves_ *= 2;
+  tree_.resize(2 * num_leaves_);
+  for (int i = 0; i < num_streams_; ++i) changed_[i] = false;
+  MarkAllChanged();
+}
+
+void StreamReadinessTracker::MarkChanged(int index) {
+  DCHECK_LT(index, num_streams_);
+  if (changed_[index].exchange(true)) return;
+  absl::MutexLock lock(&mutex_);
+  changed_list_.push_back(index);
+}
+
+void StreamReadinessTracker::MarkAllChanged() {
+  for (int i = 0; i < num_streams_; ++i) MarkChanged(i);
+}
+
+void StreamReadinessTracker::Refresh() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (changed_list_.empty()) return;
+    std::swap(changed_list_, refresh_list_);
+  }
+  for (int index : refresh_list_) {
+    // Cleared first, so that an update racing with the read below is marked
+    // again and read on the next refresh.
+    changed_[index] = false;
+    bool empty;
+    const Timestamp timestamp = read_stream_(index, &empty);
+    int node = num_leaves_ + index;
+    tree_[node] = empty ? Entry{timestamp, Timestamp::Done()}
+                        : Entry{Timestamp::Done(), timestamp};
+    for (node /= 2; node >= 1; node /= 2) {
+      const Entry& left = tree_[2 * node];
+      const Entry& right = tree_[2 * node + 1];
+      tree_[node] = Entry{std::min(left.bound, right.bound),
+                          std::min(left.packet, right.packet)};
+    }
+  }
+  refresh_list_.clear();
+}
+
+bool StreamReadinessTracker::GetUnchanged(int index, Timestamp* timestamp,
+                                          bool* empty) const {
+  if (changed_[index]) return false;
+  const Entry& leaf = tree_[num_leaves_ + index];
+  *empty = leaf.packet == Timestamp::Done();
+  *timestamp = *empty ? leaf.bound : leaf.packet;
+  return true;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,92 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef MEDIAPIPE_FRAMEWORK_STREAM_READINESS_TRACKER_H_
+#define MEDIAPIPE_FRAMEWORK_STREAM_READINESS_TRACKER_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+
+// Maintains the earliest packet timestamp and the earliest timestamp bound
+// over a set of input streams, for input stream handlers that synchronize
+// their inputs by timestamp.
+//
+// Producers only mark a stream as changed. The consumer re-reads the changed
+// streams in Refresh() and updates a tournament tree of per-stream minima, so
+// that MinBound() and MinPacket() are O(1) and a refresh costs O(log n) per
+// changed stream rather than a lock on every stream.
+//
+// A stream must be marked as changed after each update of its earliest packet
+// or timestamp bound, and before the node is notified of the update. Between
+// the update and the mark, the tracker reports the state before the update.
+//
+// MarkChanged() and MarkAllChanged() are thread-safe. The other methods must
+// only be called by the consumer, and not concurrently with each other.
+class StreamReadinessTracker {
+ public:
+  // Returns the earliest packet timestamp of stream index, or its timestamp
+  // bound when it has no packets. Sets *empty accordingly.
+  using ReadStreamFn = std::function<Timestamp(int index, bool* empty)>;
+
+  StreamReadinessTracker(int num_streams, ReadStreamFn read_stream);
+
+  // Notes that the earliest packet or the bound of stream index may have
+  // changed.
+  void MarkChanged(int index);
+  void MarkAllChanged();
+
+  // Re-reads the streams marked as changed.
+  void Refresh();
+
+  // The earliest bound over streams without packets, or Timestamp::Done().
+  Timestamp MinBound() const { return tree_[1].bound; }
+
+  // The earliest packet timestamp over all streams, or Timestamp::Done().
+  Timestamp MinPacket() const { return tree_[1].packet; }
+
+  // Returns true if stream index has not been marked as changed since the
+  // last Refresh(), and its state from that Refresh().
+  bool GetUnchanged(int index, Timestamp* timestamp, bool* empty) const;
+
+ private:
+  struct Entry {
+    Timestamp bound = Timestamp::Done();
+    Timestamp packet = Timestamp::Done();
+  };
+
+  const int num_streams_;
+  const ReadStreamFn read_stream_;
+  // First leaf of the tree. Leaf i holds the state of stream i, every inner
+  // node the minima of its two children, and tree_[1] the overall minima.
+  int num_leaves_ = 1;
+  std::vector<Entry> tree_;
+
+  // Set by MarkChanged() and cleared by Refresh() before reading the stream.
+  std::unique_ptr<std::atomic<bool>[]> changed_;
+  absl::Mutex mutex_;
+  std::vector<int> changed_list_ ABSL_GUARDED_BY(mutex_);
+  // Swapped with changed_list_ on Refresh() to avoid allocations.
+  std::vector<int> refresh_list_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_STREAM_READINESS_TRACKER_H_
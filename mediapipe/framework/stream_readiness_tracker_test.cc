@@ -0,0 +1,121 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "mediapipe/framework/stream_readiness_tracker.h"
+
+#include <vector>
+
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+namespace {
+
+// The state of a fake input stream.
+struct StreamState {
+  Timestamp timestamp = Timestamp::PreStream();
+  bool empty = true;
+};
+
+StreamReadinessTracker::ReadStreamFn Reader(std::vector<StreamState>* states,
+                                            int* num_reads) {
+  return [states, num_reads](int index, bool* empty) {
+    ++*num_reads;
+    *empty = (*states)[index].empty;
+    return (*states)[index].timestamp;
+  };
+}
+
+TEST(StreamReadinessTrackerTest, TracksMinima) {
+  std::vector<StreamState> states(5);
+  int num_reads = 0;
+  StreamReadinessTracker tracker(5, Reader(&states, &num_reads));
+  tracker.Refresh();
+  EXPECT_EQ(num_reads, 5);
+  EXPECT_EQ(tracker.MinBound(), Timestamp::PreStream());
+  EXPECT_EQ(tracker.MinPacket(), Timestamp::Done());
+
+  for (int i = 0; i < 5; ++i) {
+    states[i] = {Timestamp(10 + i), false};
+    tracker.MarkChanged(i);
+  }
+  tracker.Refresh();
+  EXPECT_EQ(num_reads, 10);
+  EXPECT_EQ(tracker.MinBound(), Timestamp::Done());
+  EXPECT_EQ(tracker.MinPacket(), Timestamp(10));
+
+  states[0] = {Timestamp(11), true};
+  tracker.MarkChanged(0);
+  tracker.MarkChanged(0);
+  tracker.Refresh();
+  EXPECT_EQ(num_reads, 11);
+  EXPECT_EQ(tracker.MinBound(), Timestamp(11));
+  EXPECT_EQ(tracker.MinPacket(), Timestamp(11));
+
+  // Nothing changed, nothing is read.
+  tracker.Refresh();
+  EXPECT_EQ(num_reads, 11);
+}
+
+TEST(StreamReadinessTrackerTest, GetUnchanged) {
+  std::vector<StreamState> states(3);
+  int num_reads = 0;
+  StreamReadinessTracker tracker(3, Reader(&states, &num_reads));
+  Timestamp timestamp;
+  bool empty;
+  EXPECT_FALSE(tracker.GetUnchanged(1, &timestamp, &empty));
+  tracker.Refresh();
+  ASSERT_TRUE(tracker.GetUnchanged(1, &timestamp, &empty));
+  EXPECT_EQ(timestamp, Timestamp::PreStream());
+  EXPECT_TRUE(empty);
+
+  states[1] = {Timestamp(7), false};
+  tracker.MarkChanged(1);
+  EXPECT_FALSE(tracker.GetUnchanged(1, &timestamp, &empty));
+  EXPECT_TRUE(tracker.GetUnchanged(2, &timestamp, &empty));
+  tracker.Refresh();
+  ASSERT_TRUE(tracker.GetUnchanged(1, &timestamp, &empty));
+  EXPECT_EQ(timestamp, Timestamp(7));
+  EXPECT_FALSE(empty);
+
+  tracker.MarkAllChanged();
+  EXPECT_FALSE(tracker.GetUnchanged(0, &timestamp, &empty));
+}
+
+TEST(StreamReadinessTrackerTest, NoStreams) {
+  StreamReadinessTracker tracker(0, [](int, bool*) { return Timestamp(); });
+  tracker.Refresh();
+  EXPECT_EQ(tracker.MinBound(), Timestamp::Done());
+  EXPECT_EQ(tracker.MinPacket(), Timestamp::Done());
+}
+
+// A node with many inputs where one stream changes between readiness checks.
+void BM_RefreshOneChange(benchmark::State& state) {
+  const int num_streams = state.range(0);
+  std::vector<StreamState> states(num_streams);
+  int num_reads = 0;
+  StreamReadinessTracker tracker(num_streams, Reader(&states, &num_reads));
+  int64 t = 0;
+  for (auto _ : state) {
+    const int index = t % num_streams;
+    states[index] = {Timestamp(++t), false};
+    tracker.MarkChanged(index);
+    tracker.Refresh();
+    benchmark::DoNotOptimize(tracker.MinPacket());
+  }
+}
+BENCHMARK(BM_RefreshOneChange)->Arg(4)->Arg(64);
+
+}  // namespace
+}  // namespace mediapipe
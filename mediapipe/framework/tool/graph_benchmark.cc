@@ -0,0 +1,306 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_benchmark.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <deque>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+namespace tool {
+
+namespace {
+
+// Tracks frames in flight and settles them as the output streams advance.
+class FrameTracker {
+ public:
+  explicit FrameTracker(int num_output_streams)
+      : settled_(num_output_streams, Timestamp::Unstarted()) {}
+
+  void AddFrame(Timestamp timestamp, bool measured) {
+    absl::MutexLock lock(&mutex_);
+    frames_.push_back({timestamp, absl::Now(), absl::InfinitePast(), measured});
+  }
+
+  // Called for every packet and timestamp bound on output stream index.
+  void Observe(int index, const Packet& packet) {
+    absl::MutexLock lock(&mutex_);
+    const Timestamp timestamp = packet.Timestamp();
+    const absl::Time now = absl::Now();
+    if (!packet.IsEmpty()) {
+      for (Frame& frame : frames_) {
+        if (frame.timestamp == timestamp) {
+          frame.output_time = now;
+          break;
+        }
+      }
+    }
+    settled_[index] = std::max(settled_[index], timestamp);
+    const Timestamp settled =
+        *std::min_element(settled_.begin(), settled_.end());
+    while (!frames_.empty() && frames_.front().timestamp <= settled) {
+      SettleFront(now);
+    }
+  }
+
+  // Settles the frames remaining after the graph is done. Their latency is
+  // determined by their last output packet, as output streams may not settle
+  // the last timestamps before they are closed.
+  void SettleRemaining() {
+    absl::MutexLock lock(&mutex_);
+    while (!frames_.empty()) {
+      SettleFront(frames_.front().output_time);
+    }
+  }
+
+  // Waits until all frames are settled or timeout expires.
+  bool WaitUntilSettled(absl::Duration timeout) {
+    absl::MutexLock lock(&mutex_);
+    auto settled = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+      return frames_.empty();
+    };
+    return mutex_.AwaitWithTimeout(absl::Condition(&settled), timeout);
+  }
+
+  std::vector<int64> latencies_usec() {
+    absl::MutexLock lock(&mutex_);
+    return latencies_usec_;
+  }
+
+  int64 num_dropped() {
+    absl::MutexLock lock(&mutex_);
+    return num_dropped_;
+  }
+
+  absl::Time last_settled_time() {
+    absl::MutexLock lock(&mutex_);
+    return last_settled_time_;
+  }
+
+ private:
+  struct Frame {
+    Timestamp timestamp;
+    absl::Time add_time;
+    // Time of the last output packet, or InfinitePast() if none.
+    absl::Time output_time;
+    bool measured;
+  };
+
+  void SettleFront(absl::Time settle_time)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    const Frame& frame = frames_.front();
+    if (frame.measured) {
+      if (frame.output_time != absl::InfinitePast()) {
+        latencies_usec_.push_back(
+            absl::ToInt64Microseconds(settle_time - frame.add_time));
+        last_settled_time_ = std::max(last_settled_time_, settle_time);
+      } else {
+        ++num_dropped_;
+      }
+    }
+    frames_.pop_front();
+  }
+
+  absl::Mutex mutex_;
+  std::deque<Frame> frames_ ABSL_GUARDED_BY(mutex_);
+  std::vector<Timestamp> settled_ ABSL_GUARDED_BY(mutex_);
+  std::vector<int64> latencies_usec_ ABSL_GUARDED_BY(mutex_);
+  int64 num_dropped_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::Time last_settled_time_ ABSL_GUARDED_BY(mutex_) = absl::InfinitePast();
+};
+
+// Returns the value at quantile q of the sorted values.
+int64 Percentile(const std::vector<int64>& sorted_values, double q) {
+  if (sorted_values.empty()) {
+    return 0;
+  }
+  const int index = std::min<int>(q * sorted_values.size(),
+                                  sorted_values.size() - 1);
+  return sorted_values[index];
+}
+
+int64 PeakRssKb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  // Reported in bytes on macOS.
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+std::string JsonString(const std::string& value) {
+  std::string result = "\"";
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    }
+    result += c;
+  }
+  result += '"';
+  return result;
+}
+
+}  // namespace
+
+absl::StatusOr<GraphBenchmarkResult> RunGraphBenchmark(
+    CalculatorGraphConfig config, const GraphBenchmarkOptions& options) {
+  RET_CHECK(!options.input_stream.empty());
+  RET_CHECK(!options.output_streams.empty());
+  RET_CHECK(options.frame_generator);
+  RET_CHECK_GT(options.num_frames, 0);
+  RET_CHECK_GT(options.timestamp_frame_rate, 0);
+  config.mutable_profiler_config()->set_enable_profiler(true);
+
+  CalculatorGraph graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  FrameTracker tracker(options.output_streams.size());
+  for (int i = 0; i < options.output_streams.size(); ++i) {
+    MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+        options.output_streams[i],
+        [&tracker, i](const Packet& packet) {
+          tracker.Observe(i, packet);
+          return absl::OkStatus();
+        },
+        /*observe_timestamp_bounds=*/true));
+  }
+  MP_RETURN_IF_ERROR(graph.StartRun(options.input_side_packets));
+
+  const double frame_rate = options.frame_rate > 0
+                                ? options.frame_rate
+                                : options.timestamp_frame_rate;
+  const int64 total_frames = options.num_warmup_frames + options.num_frames;
+  GraphBenchmarkResult result;
+  result.num_frames = options.num_frames;
+  AllocationCounts allocations_start;
+  absl::Time start_time;
+  absl::Time next_frame_time = absl::Now();
+  for (int64 i = 0; i < total_frames; ++i) {
+    const bool measured = i >= options.num_warmup_frames;
+    if (i == options.num_warmup_frames) {
+      // Let the warmup frames drain so they don't affect measurements.
+      tracker.WaitUntilSettled(options.settle_timeout);
+      if (options.allocation_counter) {
+        allocations_start = options.allocation_counter();
+      }
+      start_time = absl::Now();
+      next_frame_time = start_time;
+    }
+    if (options.frame_rate > 0) {
+      absl::SleepFor(next_frame_time - absl::Now());
+      next_frame_time += absl::Seconds(1.0 / options.frame_rate);
+    }
+    const Timestamp timestamp(static_cast<int64>(
+        i * Timestamp::kTimestampUnitsPerSecond / frame_rate));
+    tracker.AddFrame(timestamp, measured);
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        options.input_stream, options.frame_generator(i).At(timestamp)));
+  }
+  tracker.WaitUntilSettled(options.settle_timeout);
+  MP_RETURN_IF_ERROR(graph.CloseAllPacketSources());
+  MP_RETURN_IF_ERROR(graph.WaitUntilDone());
+  tracker.SettleRemaining();
+
+  if (options.allocation_counter) {
+    const AllocationCounts allocations_end = options.allocation_counter();
+    result.has_allocations = true;
+    result.allocations.count = allocations_end.count - allocations_start.count;
+    result.allocations.bytes = allocations_end.bytes - allocations_start.bytes;
+  }
+
+  std::vector<int64> latencies = tracker.latencies_usec();
+  std::sort(latencies.begin(), latencies.end());
+  result.num_completed = latencies.size();
+  result.num_dropped = tracker.num_dropped();
+  if (tracker.last_settled_time() > start_time) {
+    result.elapsed_usec =
+        absl::ToInt64Microseconds(tracker.last_settled_time() - start_time);
+  }
+  if (result.elapsed_usec > 0) {
+    result.throughput = result.num_completed * 1e6 / result.elapsed_usec;
+  }
+  result.latency_p50_usec = Percentile(latencies, 0.5);
+  result.latency_p95_usec = Percentile(latencies, 0.95);
+  result.latency_p99_usec = Percentile(latencies, 0.99);
+  result.latency_max_usec = latencies.empty() ? 0 : latencies.back();
+
+  std::vector<CalculatorProfile> profiles;
+  MP_RETURN_IF_ERROR(graph.profiler()->GetCalculatorProfiles(&profiles));
+  for (const CalculatorProfile& profile : profiles) {
+    GraphBenchmarkResult::CalculatorTime time;
+    time.name = profile.name();
+    time.process_time_usec = profile.process_runtime().total();
+    for (const int64 count : profile.process_runtime().count()) {
+      time.process_count += count;
+    }
+    result.calculator_times.push_back(time);
+  }
+  std::sort(result.calculator_times.begin(), result.calculator_times.end(),
+            [](const GraphBenchmarkResult::CalculatorTime& lhs,
+               const GraphBenchmarkResult::CalculatorTime& rhs) {
+              return lhs.process_time_usec > rhs.process_time_usec;
+            });
+
+  result.peak_rss_kb = PeakRssKb();
+  return result;
+}
+
+std::string GraphBenchmarkResultToJson(const GraphBenchmarkResult& result) {
+  std::vector<std::string> calculators;
+  for (const auto& time : result.calculator_times) {
+    calculators.push_back(absl::StrCat(
+        "    {\"name\": ", JsonString(time.name),
+        ", \"process_count\": ", time.process_count,
+        ", \"process_time_usec\": ", time.process_time_usec, "}"));
+  }
+  std::string json = absl::StrCat(
+      "{\n",                                                           //
+      "  \"num_frames\": ", result.num_frames, ",\n",                  //
+      "  \"num_completed\": ", result.num_completed, ",\n",            //
+      "  \"num_dropped\": ", result.num_dropped, ",\n",                //
+      "  \"elapsed_usec\": ", result.elapsed_usec, ",\n",              //
+      "  \"throughput_fps\": ", result.throughput, ",\n",              //
+      "  \"latency_p50_usec\": ", result.latency_p50_usec, ",\n",      //
+      "  \"latency_p95_usec\": ", result.latency_p95_usec, ",\n",      //
+      "  \"latency_p99_usec\": ", result.latency_p99_usec, ",\n",      //
+      "  \"latency_max_usec\": ", result.latency_max_usec, ",\n",      //
+      "  \"peak_rss_kb\": ", result.peak_rss_kb, ",\n");
+  if (result.has_allocations) {
+    absl::StrAppend(&json, "  \"allocation_count\": ",
+                    result.allocations.count, ",\n",
+                    "  \"allocation_bytes\": ", result.allocations.bytes,
+                    ",\n");
+  }
+  absl::StrAppend(&json, "  \"calculators\": [\n",
+                  absl::StrJoin(calculators, ",\n"), "\n  ]\n}\n");
+  return json;
+}
+
+}  // namespace tool
+}  // namespace mediapipe
@@ -0,0 +1,141 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Measures the end-to-end performance of a CalculatorGraph.
+//
+// Frames are fed to a single graph input stream, either at a fixed frame rate
+// or as fast as the graph accepts them. A frame is complete once all observed
+// output streams have settled its timestamp, either with a packet or with a
+// timestamp bound. Frames that are settled without any output packet, e.g.
+// because a FlowLimiterCalculator dropped them, are counted as dropped.
+// Frames still unsettled when the graph is done are completed at the time of
+// their last output packet.
+//
+// Usage example:
+// GraphBenchmarkOptions options;
+// options.input_stream = "input_video";
+// options.output_streams = {"output_video"};
+// options.frame_generator = [](int64 index) { return MakeFrame(index); };
+// ASSIGN_OR_RETURN(GraphBenchmarkResult result,
+//                  RunGraphBenchmark(config, options));
+// std::cout << GraphBenchmarkResultToJson(result);
+
+#ifndef MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_BENCHMARK_H_
+#define MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_BENCHMARK_H_
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+namespace tool {
+
+// Number and total size of heap allocations.
+struct AllocationCounts {
+  int64 count = 0;
+  int64 bytes = 0;
+};
+
+struct GraphBenchmarkOptions {
+  // The graph input stream receiving the frames.
+  std::string input_stream;
+
+  // The graph output streams determining when a frame is complete.
+  std::vector<std::string> output_streams;
+
+  // Returns the packet content for the frame with the given index. The
+  // timestamp of the returned packet is ignored.
+  std::function<Packet(int64 index)> frame_generator;
+
+  // Number of frames fed before measuring, and number of measured frames.
+  int64 num_warmup_frames = 10;
+  int64 num_frames = 100;
+
+  // Rate at which frames are fed, in frames per second. The value 0 feeds
+  // frames as fast as the graph accepts them.
+  double frame_rate = 0;
+
+  // Timestamps of consecutive frames are spaced as for this frame rate if
+  // frame_rate is 0.
+  double timestamp_frame_rate = 30;
+
+  // Maximum time to wait for the output streams to settle all frames after
+  // warmup and after the last frame.
+  absl::Duration settle_timeout = absl::Seconds(30);
+
+  std::map<std::string, Packet> input_side_packets;
+
+  // Returns the allocations made by the process so far. Optional, as
+  // counting allocations requires replacing the global allocation functions
+  // (see examples/desktop/graph_benchmark_main.cc).
+  std::function<AllocationCounts()> allocation_counter;
+};
+
+struct GraphBenchmarkResult {
+  // Time spent in Process() by a single calculator node.
+  struct CalculatorTime {
+    std::string name;
+    int64 process_count = 0;
+    int64 process_time_usec = 0;
+  };
+
+  // Frames measured, and how many of them were completed with an output
+  // packet or dropped.
+  int64 num_frames = 0;
+  int64 num_completed = 0;
+  int64 num_dropped = 0;
+
+  // Time from feeding the first measured frame to settling the last one.
+  int64 elapsed_usec = 0;
+  // Completed frames per second.
+  double throughput = 0;
+
+  // End-to-end latency percentiles of completed frames.
+  int64 latency_p50_usec = 0;
+  int64 latency_p95_usec = 0;
+  int64 latency_p99_usec = 0;
+  int64 latency_max_usec = 0;
+
+  // Calculator nodes ordered by decreasing process time, including warmup.
+  // Empty unless the graph profiler is available, see mediapipe_profiling.h.
+  std::vector<CalculatorTime> calculator_times;
+
+  // Peak resident set size of the process.
+  int64 peak_rss_kb = 0;
+
+  // Heap allocations made while feeding the measured frames, if
+  // allocation_counter is set.
+  bool has_allocations = false;
+  AllocationCounts allocations;
+};
+
+// Runs the graph described by config over the frames specified in options.
+// The graph profiler is enabled to collect the calculator times.
+absl::StatusOr<GraphBenchmarkResult> RunGraphBenchmark(
+    CalculatorGraphConfig config, const GraphBenchmarkOptions& options);
+
+// Returns the result as JSON object.
+std::string GraphBenchmarkResultToJson(const GraphBenchmarkResult& result);
+
+}  // namespace tool
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_TOOL_GRAPH_BENCHMARK_H_
@@ -0,0 +1,146 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/tool/graph_benchmark.h"
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace tool {
+namespace {
+
+using ::testing::HasSubstr;
+
+// Passes packets with even values and drops the others, propagating the
+// timestamp bound in either case.
+class DropOddCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int64>();
+    cc->Outputs().Index(0).SetSameAs(&cc->Inputs().Index(0));
+    cc->SetTimestampOffset(0);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) final {
+    if (cc->Inputs().Index(0).Get<int64>() % 2 == 0) {
+      cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    }
+    return absl::OkStatus();
+  }
+};
+REGISTER_CALCULATOR(DropOddCalculator);
+
+CalculatorGraphConfig PassThroughGraph() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    input_stream: "in"
+    node {
+      calculator: "PassThroughCalculator"
+      input_stream: "in"
+      output_stream: "out"
+    }
+    node {
+      calculator: "DropOddCalculator"
+      input_stream: "in"
+      output_stream: "even"
+    }
+  )pb");
+}
+
+GraphBenchmarkOptions CountingOptions() {
+  GraphBenchmarkOptions options;
+  options.input_stream = "in";
+  options.frame_generator = [](int64 index) {
+    return MakePacket<int64>(index);
+  };
+  options.num_warmup_frames = 5;
+  options.num_frames = 20;
+  return options;
+}
+
+TEST(GraphBenchmarkTest, CompletesAllFrames) {
+  GraphBenchmarkOptions options = CountingOptions();
+  options.output_streams = {"out"};
+  int64 num_calls = 0;
+  options.allocation_counter = [&num_calls]() {
+    ++num_calls;
+    return AllocationCounts{num_calls * 10, num_calls * 100};
+  };
+  auto result = RunGraphBenchmark(PassThroughGraph(), options);
+  MP_ASSERT_OK(result);
+
+  EXPECT_EQ(result->num_frames, 20);
+  EXPECT_EQ(result->num_completed, 20);
+  EXPECT_EQ(result->num_dropped, 0);
+  EXPECT_GT(result->throughput, 0);
+  EXPECT_LE(result->latency_p50_usec, result->latency_p95_usec);
+  EXPECT_LE(result->latency_p95_usec, result->latency_p99_usec);
+  EXPECT_LE(result->latency_p99_usec, result->latency_max_usec);
+  EXPECT_GT(result->peak_rss_kb, 0);
+  // Counted once before and once after the measured frames.
+  EXPECT_TRUE(result->has_allocations);
+  EXPECT_EQ(result->allocations.count, 10);
+  EXPECT_EQ(result->allocations.bytes, 100);
+}
+
+// Frames settled by timestamp bounds only are counted as dropped. A frame is
+// only complete once all output streams settled it.
+TEST(GraphBenchmarkTest, CountsDroppedFrames) {
+  GraphBenchmarkOptions options = CountingOptions();
+  options.output_streams = {"even"};
+  auto result = RunGraphBenchmark(PassThroughGraph(), options);
+  MP_ASSERT_OK(result);
+  EXPECT_EQ(result->num_completed, 10);
+  EXPECT_EQ(result->num_dropped, 10);
+  EXPECT_FALSE(result->has_allocations);
+
+  options.output_streams = {"even", "out"};
+  result = RunGraphBenchmark(PassThroughGraph(), options);
+  MP_ASSERT_OK(result);
+  EXPECT_EQ(result->num_completed, 20);
+  EXPECT_EQ(result->num_dropped, 0);
+}
+
+TEST(GraphBenchmarkTest, FixedFrameRate) {
+  GraphBenchmarkOptions options = CountingOptions();
+  options.output_streams = {"out"};
+  options.frame_rate = 200;
+  auto result = RunGraphBenchmark(PassThroughGraph(), options);
+  MP_ASSERT_OK(result);
+  EXPECT_EQ(result->num_completed, 20);
+  // 20 frames spaced by 5 ms.
+  EXPECT_GE(result->elapsed_usec, 19 * 5000);
+  EXPECT_LE(result->throughput, 20 * 1e6 / (19 * 5000));
+}
+
+TEST(GraphBenchmarkTest, ResultToJson) {
+  GraphBenchmarkResult result;
+  result.num_frames = 3;
+  result.latency_p99_usec = 1234;
+  result.calculator_times.push_back({"Node\"1", 3, 42});
+  const std::string json = GraphBenchmarkResultToJson(result);
+  EXPECT_THAT(json, HasSubstr("\"num_frames\": 3,"));
+  EXPECT_THAT(json, HasSubstr("\"latency_p99_usec\": 1234,"));
+  EXPECT_THAT(json, HasSubstr("{\"name\": \"Node\\\"1\", \"process_count\": 3, "
+                              "\"process_time_usec\": 42}"));
+  EXPECT_THAT(json, ::testing::Not(HasSubstr("allocation_count")));
+}
+
+}  // namespace
+}  // namespace tool
+}  // namespace mediapipe
@@ -17,8 +17,11 @@
 #include <math.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
+#include "absl/memory/memory.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/vector.h"
 #include "mediapipe/util/color.pb.h"
@@ -73,21 +76,46 @@ cv::RotatedRect RectangleToOpenCVRotatedRect(int left, int top, int right,
       cv::Size2f(right - left, bottom - top), rotation / M_PI * 180.f);
 }
 
-void cv_line2(cv::Mat& img, const cv::Point& start, const cv::Point& end,
+// Draws a line from start to end on img onto target, a region of img with
+// top-left corner offset. The line is iterated over all of img, so that the
+// gradient doesn't depend on the region.
+void cv_line2(const cv::Mat& img, cv::Mat& target, const cv::Point& offset,
+              const cv::Point& start, const cv::Point& end,
               const cv::Scalar& color1, const cv::Scalar& color2,
               int thickness) {
   cv::LineIterator iter(img, start, end, /*cv::LINE_4=*/4);
   for (int i = 0; i < iter.count; i++, iter++) {
+    const cv::Rect rect(iter.pos() - offset, cv::Size(thickness, thickness));
+    if ((rect & cv::Rect(0, 0, target.cols, target.rows)).empty()) continue;
     const double alpha = static_cast<double>(i) / iter.count;
     const cv::Scalar new_color(color1 * (1.0 - alpha) + color2 * alpha);
-    const cv::Rect rect(iter.pos(), cv::Size(thickness, thickness));
-    cv::rectangle(img, rect, new_color, /*cv::FILLED=*/-1, /*cv::LINE_4=*/4);
+    cv::rectangle(target, rect, new_color, /*cv::FILLED=*/-1,
+                  /*cv::LINE_4=*/4);
   }
 }
 
+// Returns the bounding box of points, grown by margin on all sides.
+cv::Rect BoundingBox(const cv::Point* points, int num_points, int margin) {
+  int left = points[0].x, right = points[0].x;
+  int top = points[0].y, bottom = points[0].y;
+  for (int i = 1; i < num_points; ++i) {
+    left = std::min(left, points[i].x);
+    right = std::max(right, points[i].x);
+    top = std::min(top, points[i].y);
+    bottom = std::max(bottom, points[i].y);
+  }
+  return cv::Rect(left - margin, top - margin, right - left + 2 * margin + 1,
+                  bottom - top + 2 * margin + 1);
+}
+
 }  // namespace
 
 void AnnotationRenderer::RenderDataOnImage(const RenderData& render_data) {
+  AddRenderData(render_data);
+  Render();
+}
+
+void AnnotationRenderer::AddRenderData(const RenderData& render_data) {
   for (const auto& annotation : render_data.render_annotations()) {
     if (annotation.data_case() == RenderAnnotation::kRectangle) {
       DrawRectangle(annotation);
@@ -118,6 +146,155 @@ void AnnotationRenderer::RenderDataOnImage(const RenderData& render_data) {
   }
 }
 
+void AnnotationRenderer::Render() {
+  if (primitives_.empty()) {
+    return;
+  }
+  if (!thread_pool_) {
+    for (const Primitive& primitive : primitives_) {
+      DrawPrimitive(primitive, mat_image_, cv::Point(0, 0));
+    }
+    primitives_.clear();
+    return;
+  }
+
+  // Bin the primitives into the tiles they overlap.
+  const cv::Rect image_rect(0, 0, mat_image_.cols, mat_image_.rows);
+  const int num_tiles_x = (mat_image_.cols + tile_size_ - 1) / tile_size_;
+  const int num_tiles_y = (mat_image_.rows + tile_size_ - 1) / tile_size_;
+  tile_primitives_.resize(num_tiles_x * num_tiles_y);
+  for (auto& indices : tile_primitives_) {
+    indices.clear();
+  }
+  // Primitives crossing tile borders, other than gradient lines, which are
+  // rasterized over the whole image anyway.
+  std::vector<int> crossing;
+  bool crossing_antialiased = false;
+  for (int i = 0; i < primitives_.size(); ++i) {
+    const cv::Rect bounds = primitives_[i].bounds & image_rect;
+    if (bounds.empty()) {
+      continue;
+    }
+    const int first_x = bounds.x / tile_size_;
+    const int first_y = bounds.y / tile_size_;
+    const int last_x = (bounds.x + bounds.width - 1) / tile_size_;
+    const int last_y = (bounds.y + bounds.height - 1) / tile_size_;
+    for (int y = first_y; y <= last_y; ++y) {
+      for (int x = first_x; x <= last_x; ++x) {
+        tile_primitives_[y * num_tiles_x + x].push_back(i);
+      }
+    }
+    if ((first_x != last_x || first_y != last_y) &&
+        primitives_[i].type != Primitive::kGradientLine) {
+      crossing.push_back(i);
+      crossing_antialiased |= primitives_[i].line_type == cv::LINE_AA;
+    }
+  }
+
+  // Anti-aliased shapes blend with the image, so they can't be drawn through
+  // a mask. They are rare enough to draw everything in one piece instead.
+  if (crossing_antialiased) {
+    for (const Primitive& primitive : primitives_) {
+      DrawPrimitive(primitive, mat_image_, cv::Point(0, 0));
+    }
+    primitives_.clear();
+    return;
+  }
+
+  // OpenCV rasterizes a shape clipped to a tile slightly differently than in
+  // one piece, so shapes crossing tile borders are rasterized once into a mask
+  // of their bounds, which each tile then fills with the shape color. Shapes
+  // within a single tile are drawn into it directly, which is exact.
+  std::vector<int> mask_index(primitives_.size(), -1);
+  crossing_masks_.resize(crossing.size());
+  for (int m = 0; m < crossing.size(); ++m) {
+    mask_index[crossing[m]] = m;
+  }
+  ParallelFor(crossing.size(), [this, &crossing, &image_rect](int m) {
+    Primitive mask_primitive = primitives_[crossing[m]];
+    mask_primitive.color = cv::Scalar(255);
+    const cv::Rect bounds = mask_primitive.bounds & image_rect;
+    cv::Mat& mask = crossing_masks_[m];
+    mask.create(bounds.size(), CV_8UC1);
+    mask.setTo(cv::Scalar(0));
+    DrawPrimitive(mask_primitive, mask, bounds.tl());
+  });
+
+  std::vector<int> dirty_tiles;
+  for (int i = 0; i < tile_primitives_.size(); ++i) {
+    if (!tile_primitives_[i].empty()) {
+      dirty_tiles.push_back(i);
+    }
+  }
+
+  // Draw the dirty tiles, each worker taking the next undrawn tile.
+  ParallelFor(dirty_tiles.size(), [this, &dirty_tiles, &mask_index,
+                                   num_tiles_x, &image_rect](int t) {
+    const int tile = dirty_tiles[t];
+    const cv::Rect tile_rect =
+        cv::Rect((tile % num_tiles_x) * tile_size_,
+                 (tile / num_tiles_x) * tile_size_, tile_size_, tile_size_) &
+        image_rect;
+    cv::Mat target = mat_image_(tile_rect);
+    for (const int index : tile_primitives_[tile]) {
+      const Primitive& primitive = primitives_[index];
+      if (mask_index[index] < 0) {
+        DrawPrimitive(primitive, target, tile_rect.tl());
+        continue;
+      }
+      const cv::Rect bounds = primitive.bounds & image_rect;
+      const cv::Rect overlap = bounds & tile_rect;
+      target(overlap - tile_rect.tl())
+          .setTo(primitive.color,
+                 crossing_masks_[mask_index[index]](overlap - bounds.tl()));
+    }
+  });
+  primitives_.clear();
+}
+
+void AnnotationRenderer::ParallelFor(int count,
+                                     const std::function<void(int)>& fn) {
+  std::atomic<int> next(0);
+  const int num_workers = std::min(thread_pool_->num_threads(), count);
+  absl::BlockingCounter counter(num_workers);
+  for (int w = 0; w < num_workers; ++w) {
+    thread_pool_->Schedule([&next, &counter, count, &fn] {
+      for (int i = next++; i < count; i = next++) {
+        fn(i);
+      }
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+}
+
+cv::Rect AnnotationRenderer::GetDirtyRegion() const {
+  const cv::Rect image_rect(0, 0, mat_image_.cols, mat_image_.rows);
+  cv::Rect region;
+  for (const Primitive& primitive : primitives_) {
+    const cv::Rect bounds = primitive.bounds & image_rect;
+    if (bounds.empty()) {
+      continue;
+    }
+    region = region.empty() ? bounds : (region | bounds);
+  }
+  return region;
+}
+
+void AnnotationRenderer::SetNumThreads(int num_threads, int tile_size) {
+  tile_size_ = std::max(tile_size, 1);
+  if (num_threads <= 1) {
+    thread_pool_.reset();
+    return;
+  }
+  if (thread_pool_ && thread_pool_->num_threads() == num_threads) {
+    return;
+  }
+  thread_pool_ =
+      absl::make_unique<ThreadPool>("AnnotationRenderer", num_threads);
+  thread_pool_->StartWorkers();
+}
+
 void AnnotationRenderer::AdoptImage(cv::Mat* input_image) {
   image_width_ = input_image->cols;
   image_height_ = input_image->rows;
@@ -167,12 +344,12 @@ void AnnotationRenderer::DrawRectangle(const RenderAnnotation& annotation) {
     cv::Point2f vertices[kNumVertices];
     rect.points(vertices);
     for (int i = 0; i < kNumVertices; i++) {
-      cv::line(mat_image_, vertices[i], vertices[(i + 1) % kNumVertices], color,
-               thickness);
+      AddLine(vertices[i], vertices[(i + 1) % kNumVertices], color,
+              thickness);
     }
   } else {
     cv::Rect rect(left, top, right - left, bottom - top);
-    cv::rectangle(mat_image_, rect, color, thickness);
+    AddRectangle(rect, color, thickness);
   }
 }
 
@@ -209,10 +386,10 @@ void AnnotationRenderer::DrawFilledRectangle(
     for (int i = 0; i < kNumVertices; ++i) {
       vertices[i] = vertices2f[i];
     }
-    cv::fillConvexPoly(mat_image_, vertices, kNumVertices, color);
+    AddConvexPoly(vertices, kNumVertices, color);
   } else {
     cv::Rect rect(left, top, right - left, bottom - top);
-    cv::rectangle(mat_image_, rect, color, -1);
+    AddRectangle(rect, color, -1);
   }
 }
 
@@ -243,9 +420,8 @@ void AnnotationRenderer::DrawRoundedRectangle(
   const int corner_radius =
       round(annotation.rounded_rectangle().corner_radius() * scale_factor_);
   const int line_type = annotation.rounded_rectangle().line_type();
-  DrawRoundedRectangle(mat_image_, cv::Point(left, top),
-                       cv::Point(right, bottom), color, thickness, line_type,
-                       corner_radius);
+  DrawRoundedRectangle(cv::Point(left, top), cv::Point(right, bottom), color,
+                       thickness, line_type, corner_radius);
 }
 
 void AnnotationRenderer::DrawFilledRoundedRectangle(
@@ -274,12 +450,11 @@ void AnnotationRenderer::DrawFilledRoundedRectangle(
   const int corner_radius =
       annotation.rounded_rectangle().corner_radius() * scale_factor_;
   const int line_type = annotation.rounded_rectangle().line_type();
-  DrawRoundedRectangle(mat_image_, cv::Point(left, top),
-                       cv::Point(right, bottom), color, -1, line_type,
-                       corner_radius);
+  DrawRoundedRectangle(cv::Point(left, top), cv::Point(right, bottom), color,
+                       -1, line_type, corner_radius);
 }
 
-void AnnotationRenderer::DrawRoundedRectangle(cv::Mat src, cv::Point top_left,
+void AnnotationRenderer::DrawRoundedRectangle(cv::Point top_left,
                                               cv::Point bottom_right,
                                               const cv::Scalar& line_color,
                                               int thickness, int line_type,
@@ -294,32 +469,32 @@ void AnnotationRenderer::DrawRoundedRectangle(cv::Mat src, cv::Point top_left,
   cv::Point p4 = cv::Point(top_left.x, bottom_right.y);
 
   // Draw edges of the rectangle
-  cv::line(src, cv::Point(p1.x + corner_radius, p1.y),
-           cv::Point(p2.x - corner_radius, p2.y), line_color, thickness,
-           line_type);
-  cv::line(src, cv::Point(p2.x, p2.y + corner_radius),
-           cv::Point(p3.x, p3.y - corner_radius), line_color, thickness,
-           line_type);
-  cv::line(src, cv::Point(p4.x + corner_radius, p4.y),
-           cv::Point(p3.x - corner_radius, p3.y), line_color, thickness,
-           line_type);
-  cv::line(src, cv::Point(p1.x, p1.y + corner_radius),
-           cv::Point(p4.x, p4.y - corner_radius), line_color, thickness,
-           line_type);
+  AddLine(cv::Point(p1.x + corner_radius, p1.y),
+          cv::Point(p2.x - corner_radius, p2.y), line_color, thickness,
+          line_type);
+  AddLine(cv::Point(p2.x, p2.y + corner_radius),
+          cv::Point(p3.x, p3.y - corner_radius), line_color, thickness,
+          line_type);
+  AddLine(cv::Point(p4.x + corner_radius, p4.y),
+          cv::Point(p3.x - corner_radius, p3.y), line_color, thickness,
+          line_type);
+  AddLine(cv::Point(p1.x, p1.y + corner_radius),
+          cv::Point(p4.x, p4.y - corner_radius), line_color, thickness,
+          line_type);
 
   // Draw arcs at corners.
-  cv::ellipse(src, p1 + cv::Point(corner_radius, corner_radius),
-              cv::Size(corner_radius, corner_radius), 180.0, 0, 90, line_color,
-              thickness, line_type);
-  cv::ellipse(src, p2 + cv::Point(-corner_radius, corner_radius),
-              cv::Size(corner_radius, corner_radius), 270.0, 0, 90, line_color,
-              thickness, line_type);
-  cv::ellipse(src, p3 + cv::Point(-corner_radius, -corner_radius),
-              cv::Size(corner_radius, corner_radius), 0.0, 0, 90, line_color,
-              thickness, line_type);
-  cv::ellipse(src, p4 + cv::Point(corner_radius, -corner_radius),
-              cv::Size(corner_radius, corner_radius), 90.0, 0, 90, line_color,
-              thickness, line_type);
+  AddEllipse(p1 + cv::Point(corner_radius, corner_radius),
+             cv::Size(corner_radius, corner_radius), 180.0, 0, 90, line_color,
+             thickness, line_type);
+  AddEllipse(p2 + cv::Point(-corner_radius, corner_radius),
+             cv::Size(corner_radius, corner_radius), 270.0, 0, 90, line_color,
+             thickness, line_type);
+  AddEllipse(p3 + cv::Point(-corner_radius, -corner_radius),
+             cv::Size(corner_radius, corner_radius), 0.0, 0, 90, line_color,
+             thickness, line_type);
+  AddEllipse(p4 + cv::Point(corner_radius, -corner_radius),
+             cv::Size(corner_radius, corner_radius), 90.0, 0, 90, line_color,
+             thickness, line_type);
 }
 
 void AnnotationRenderer::DrawOval(const RenderAnnotation& annotation) {
@@ -348,7 +523,7 @@ void AnnotationRenderer::DrawOval(const RenderAnnotation& annotation) {
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
-  cv::ellipse(mat_image_, center, size, rotation, 0, 360, color, thickness);
+  AddEllipse(center, size, rotation, 0, 360, color, thickness);
 }
 
 void AnnotationRenderer::DrawFilledOval(const RenderAnnotation& annotation) {
@@ -376,7 +551,7 @@ void AnnotationRenderer::DrawFilledOval(const RenderAnnotation& annotation) {
                 std::max(0, (bottom - top) / 2));
   const double rotation = enclosing_rectangle.rotation() / M_PI * 180.f;
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
-  cv::ellipse(mat_image_, center, size, rotation, 0, 360, color, -1);
+  AddEllipse(center, size, rotation, 0, 360, color, -1);
 }
 
 void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation) {
@@ -407,7 +582,7 @@ void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation) {
       ClampThickness(round(annotation.thickness() * scale_factor_));
 
   // Draw the main arrow line.
-  cv::line(mat_image_, arrow_start, arrow_end, color, thickness);
+  AddLine(arrow_start, arrow_end, color, thickness);
 
   // Compute the arrowtip left and right vectors.
   Vector2_d L_start(static_cast<double>(x_start), static_cast<double>(y_start));
@@ -425,8 +600,8 @@ void AnnotationRenderer::DrawArrow(const RenderAnnotation& annotation) {
                                 static_cast<int>(round(arrowtip_left[1])));
   cv::Point arrowtip_right_start(static_cast<int>(round(arrowtip_right[0])),
                                  static_cast<int>(round(arrowtip_right[1])));
-  cv::line(mat_image_, arrowtip_left_start, arrow_end, color, thickness);
-  cv::line(mat_image_, arrowtip_right_start, arrow_end, color, thickness);
+  AddLine(arrowtip_left_start, arrow_end, color, thickness);
+  AddLine(arrowtip_right_start, arrow_end, color, thickness);
 }
 
 void AnnotationRenderer::DrawPoint(const RenderAnnotation& annotation) {
@@ -445,7 +620,7 @@ void AnnotationRenderer::DrawPoint(const RenderAnnotation& annotation) {
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
-  cv::circle(mat_image_, point_to_draw, thickness, color, -1);
+  AddCircle(point_to_draw, thickness, color, -1);
 }
 
 void AnnotationRenderer::DrawLine(const RenderAnnotation& annotation) {
@@ -473,7 +648,7 @@ void AnnotationRenderer::DrawLine(const RenderAnnotation& annotation) {
   const cv::Scalar color = MediapipeColorToOpenCVColor(annotation.color());
   const int thickness =
       ClampThickness(round(annotation.thickness() * scale_factor_));
-  cv::line(mat_image_, start, end, color, thickness);
+  AddLine(start, end, color, thickness);
 }
 
 void AnnotationRenderer::DrawGradientLine(const RenderAnnotation& annotation) {
@@ -502,7 +677,7 @@ void AnnotationRenderer::DrawGradientLine(const RenderAnnotation& annotation) {
       ClampThickness(round(annotation.thickness() * scale_factor_));
   const cv::Scalar color1 = MediapipeColorToOpenCVColor(line.color1());
   const cv::Scalar color2 = MediapipeColorToOpenCVColor(line.color2());
-  cv_line2(mat_image_, start, end, color1, color2, thickness);
+  AddGradientLine(start, end, color1, color2, thickness);
 }
 
 void AnnotationRenderer::DrawText(const RenderAnnotation& annotation) {
@@ -540,9 +715,8 @@ void AnnotationRenderer::DrawText(const RenderAnnotation& annotation) {
     origin.y += text_size.height / 2;
   }
 
-  cv::putText(mat_image_, text.display_text(), origin, font_face, font_scale,
-              color, thickness, /*lineType=*/8,
-              /*bottomLeftOrigin=*/flip_text_vertically_);
+  AddText(text.display_text(), origin, font_face, font_scale, color,
+          thickness);
 }
 
 double AnnotationRenderer::ComputeFontScale(int font_face, int font_size,
@@ -579,4 +753,170 @@ double AnnotationRenderer::ComputeFontScale(int font_face, int font_size,
          (cap_line + base_line);
 }
 
+void AnnotationRenderer::AddLine(const cv::Point& start, const cv::Point& end,
+                                 const cv::Scalar& color, int thickness,
+                                 int line_type) {
+  Primitive& primitive = primitives_.emplace_back();
+  primitive.type = Primitive::kLine;
+  primitive.points[0] = start;
+  primitive.points[1] = end;
+  primitive.num_points = 2;
+  primitive.color = color;
+  primitive.thickness = thickness;
+  primitive.line_type = line_type;
+  primitive.bounds = BoundingBox(primitive.points, 2, thickness / 2 + 2);
+}
+
+void AnnotationRenderer::AddGradientLine(const cv::Point& start,
+                                         const cv::Point& end,
+                                         const cv::Scalar& color1,
+                                         const cv::Scalar& color2,
+                                         int thickness) {
+  Primitive& primitive = primitives_.emplace_back();
+  primitive.type = Primitive::kGradientLine;
+  primitive.points[0] = start;
+  primitive.points[1] = end;
+  primitive.num_points = 2;
+  primitive.color = color1;
+  primitive.color2 = color2;
+  primitive.thickness = thickness;
+  // Squares of thickness pixels are drawn right and below each line pixel.
+  primitive.bounds = BoundingBox(primitive.points, 2, 1);
+  primitive.bounds.width += thickness;
+  primitive.bounds.height += thickness;
+}
+
+void AnnotationRenderer::AddRectangle(const cv::Rect& rect,
+                                      const cv::Scalar& color,
+                                      int thickness) {
+  Primitive& primitive = primitives_.emplace_back();
+  primitive.type = Primitive::kRectangle;
+  primitive.points[0] = rect.tl();
+  primitive.num_points = 1;
+  primitive.size = rect.size();
+  primitive.color = color;
+  primitive.thickness = thickness;
+  const cv::Point corners[2] = {rect.tl(), rect.br()};
+  primitive.bounds = BoundingBox(corners, 2, std::max(thickness, 0) / 2 + 2);
+}
+
+void AnnotationRenderer::AddConvexPoly(const cv::Point* vertices,
+                                       int num_vertices,
+                                       const cv::Scalar& color) {
+  CHECK_LE(num_vertices, 4);
+  Primitive& primitive = primitives_.emplace_back();
+  primitive.type = Primitive::kConvexPoly;
+  std::copy(vertices, vertices + num_vertices, primitive.points);
+  primitive.num_points = num_vertices;
+  primitive.color = color;
+  primitive.bounds = BoundingBox(primitive.points, num_vertices, 2);
+}
+
+void AnnotationRenderer::AddEllipse(const cv::Point& center,
+                                    const cv::Size& axes, double angle,
+                                    double start_angle, double end_angle,
+                                    const cv::Scalar& color, int thickness,
+                                    int line_type) {
+  Primitive& primitive = primitives_.emplace_back();
+  primitive.type = Primitive::kEllipse;
+  primitive.points[0] = center;
+  primitive.num_points = 1;
+  primitive.size = axes;
+  primitive.angle = angle;
+  primitive.start_angle = start_angle;
+  primitive.end_angle = end_angle;
+  primitive.color = color;
+  primitive.thickness = thickness;
+  primitive.line_type = line_type;
+  // Any rotation of the ellipse fits into the circle of its major axis.
+  primitive.bounds = BoundingBox(
+      primitive.points, 1,
+      std::max(std::abs(axes.width), std::abs(axes.height)) +
+          std::max(thickness, 0) / 2 + 2);
+}
+
+void AnnotationRenderer::AddCircle(const cv::Point& center, int radius,
+                                   const cv::Scalar& color, int thickness) {
+  Primitive& primitive = primitives_.emplace_back();
+  primitive.type = Primitive::kCircle;
+  primitive.points[0] = center;
+  primitive.num_points = 1;
+  primitive.size = cv::Size(radius, radius);
+  primitive.color = color;
+  primitive.thickness = thickness;
+  primitive.bounds = BoundingBox(primitive.points, 1,
+                                 radius + std::max(thickness, 0) / 2 + 2);
+}
+
+void AnnotationRenderer::AddText(const std::string& text,
+                                 const cv::Point& origin, int font_face,
+                                 double font_scale, const cv::Scalar& color,
+                                 int thickness) {
+  Primitive& primitive = primitives_.emplace_back();
+  primitive.type = Primitive::kText;
+  primitive.points[0] = origin;
+  primitive.num_points = 1;
+  primitive.text = text;
+  primitive.font_face = font_face;
+  primitive.font_scale = font_scale;
+  primitive.color = color;
+  primitive.thickness = thickness;
+  primitive.bottom_left_origin = flip_text_vertically_;
+  // Glyphs may extend beyond the text size, e.g. in italic or script fonts,
+  // so the box is grown by the text height on all sides and mirrored around
+  // the baseline for flipped text.
+  int baseline = 0;
+  const cv::Size text_size =
+      cv::getTextSize(text, font_face, font_scale, thickness, &baseline);
+  const int margin = text_size.height + thickness;
+  const int above = text_size.height + margin;
+  const int below = baseline + margin;
+  primitive.bounds = cv::Rect(
+      origin.x - margin, origin.y - (flip_text_vertically_ ? below : above),
+      text_size.width + 2 * margin, above + below);
+}
+
+void AnnotationRenderer::DrawPrimitive(const Primitive& primitive,
+                                       cv::Mat& target,
+                                       const cv::Point& offset) const {
+  cv::Point points[4];
+  for (int i = 0; i < primitive.num_points; ++i) {
+    points[i] = primitive.points[i] - offset;
+  }
+  switch (primitive.type) {
+    case Primitive::kLine:
+      cv::line(target, points[0], points[1], primitive.color,
+               primitive.thickness, primitive.line_type);
+      break;
+    case Primitive::kGradientLine:
+      cv_line2(mat_image_, target, offset, primitive.points[0],
+               primitive.points[1], primitive.color, primitive.color2,
+               primitive.thickness);
+      break;
+    case Primitive::kRectangle:
+      cv::rectangle(target, cv::Rect(points[0], primitive.size),
+                    primitive.color, primitive.thickness);
+      break;
+    case Primitive::kConvexPoly:
+      cv::fillConvexPoly(target, points, primitive.num_points,
+                         primitive.color);
+      break;
+    case Primitive::kEllipse:
+      cv::ellipse(target, points[0], primitive.size, primitive.angle,
+                  primitive.start_angle, primitive.end_angle, primitive.color,
+                  primitive.thickness, primitive.line_type);
+      break;
+    case Primitive::kCircle:
+      cv::circle(target, points[0], primitive.size.width, primitive.color,
+                 primitive.thickness);
+      break;
+    case Primitive::kText:
+      cv::putText(target, primitive.text, points[0], primitive.font_face,
+                  primitive.font_scale, primitive.color, primitive.thickness,
+                  /*lineType=*/8,
+                  /*bottomLeftOrigin=*/primitive.bottom_left_origin);
+      break;
+  }
+}
+
 }  // namespace mediapipe
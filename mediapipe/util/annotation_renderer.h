@@ -15,10 +15,14 @@
 #ifndef MEDIAPIPE_UTIL_ANNOTATION_RENDERER_H_
 #define MEDIAPIPE_UTIL_ANNOTATION_RENDERER_H_
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/util/render_data.pb.h"
 
 namespace mediapipe {
@@ -45,6 +49,17 @@ namespace mediapipe {
 // renderer.RenderDataOnImage(render_data_1);
 //
 // UseRenderedImage(mat_image.get());
+//
+// Annotations are first converted into drawing primitives with pixel
+// coordinates and bounding boxes, then drawn. To draw the render data of
+// several sources at once, e.g. in parallel, use AddRenderData() for each of
+// them followed by a single Render():
+//
+// renderer.SetNumThreads(4);
+// renderer.AdoptImage(mat_image.get());
+// renderer.AddRenderData(render_data_0);
+// renderer.AddRenderData(render_data_1);
+// renderer.Render();
 class AnnotationRenderer {
  public:
   explicit AnnotationRenderer() {}
@@ -57,6 +72,25 @@ class AnnotationRenderer {
   // Renders the image with the input render data.
   void RenderDataOnImage(const RenderData& render_data);
 
+  // Adds the annotations of render_data to those drawn by the next Render().
+  // Coordinates are resolved against the currently adopted image.
+  void AddRenderData(const RenderData& render_data);
+
+  // Draws the annotations added since the last call onto the adopted image,
+  // in the order they were added.
+  void Render();
+
+  // Returns the bounding box of the pixels that the annotations added since
+  // the last Render() may touch, clipped to the image.
+  cv::Rect GetDirtyRegion() const;
+
+  // Sets the number of threads used by Render(). With more than one thread,
+  // the image is split into tiles of tile_size x tile_size pixels, and each
+  // tile touched by any annotation is drawn by a single thread. Annotations
+  // crossing tile borders are rasterized once and then copied into the tiles
+  // they overlap, so the result is identical to drawing with a single thread.
+  void SetNumThreads(int num_threads, int tile_size = 256);
+
   // Resets the renderer with a new image. Does not own input_image. input_image
   // must not be modified by caller during rendering.
   void AdoptImage(cv::Mat* input_image);
@@ -106,6 +140,70 @@ class AnnotationRenderer {
   // Draws a text on the image as described in the annotation.
   void DrawText(const RenderAnnotation& annotation);
 
+  // A single OpenCV drawing call with pixel coordinates on the adopted image.
+  struct Primitive {
+    enum Type {
+      kLine,
+      kGradientLine,
+      kRectangle,
+      kConvexPoly,
+      kEllipse,
+      kCircle,
+      kText,
+    };
+    Type type;
+    // Line end points, polygon vertices, or the top-left corner of
+    // rectangles, the center of ellipses and circles, or the text origin.
+    cv::Point points[4];
+    int num_points = 0;
+    cv::Scalar color;
+    // End color of gradient lines.
+    cv::Scalar color2;
+    // Negative values denote filled shapes.
+    int thickness = 1;
+    int line_type = 8;
+    // Rectangle size, ellipse axes, or circle radius in width.
+    cv::Size size;
+    // Ellipse rotation and arc, in degrees.
+    double angle = 0.0;
+    double start_angle = 0.0;
+    double end_angle = 0.0;
+    std::string text;
+    int font_face = 0;
+    double font_scale = 1.0;
+    bool bottom_left_origin = false;
+    // Bounding box of the touched pixels, not clipped to the image.
+    cv::Rect bounds;
+  };
+
+  // Adds primitives. Margin is added to bounds to cover the thickness and
+  // rounding of the rasterized shape.
+  void AddLine(const cv::Point& start, const cv::Point& end,
+               const cv::Scalar& color, int thickness, int line_type = 8);
+  void AddGradientLine(const cv::Point& start, const cv::Point& end,
+                       const cv::Scalar& color1, const cv::Scalar& color2,
+                       int thickness);
+  void AddRectangle(const cv::Rect& rect, const cv::Scalar& color,
+                    int thickness);
+  void AddConvexPoly(const cv::Point* vertices, int num_vertices,
+                     const cv::Scalar& color);
+  void AddEllipse(const cv::Point& center, const cv::Size& axes, double angle,
+                  double start_angle, double end_angle,
+                  const cv::Scalar& color, int thickness, int line_type = 8);
+  void AddCircle(const cv::Point& center, int radius, const cv::Scalar& color,
+                 int thickness);
+  void AddText(const std::string& text, const cv::Point& origin,
+               int font_face, double font_scale, const cv::Scalar& color,
+               int thickness);
+
+  // Draws primitive onto target, a region of the adopted image with top-left
+  // corner offset.
+  void DrawPrimitive(const Primitive& primitive, cv::Mat& target,
+                     const cv::Point& offset) const;
+
+  // Runs fn(0), ..., fn(count - 1) on thread_pool_ and waits for them.
+  void ParallelFor(int count, const std::function<void(int)>& fn);
+
   // Draws a rounded rectangle on the image as described in the annotation.
   void DrawRoundedRectangle(const RenderAnnotation& annotation);
 
@@ -117,8 +215,7 @@ class AnnotationRenderer {
   // parameters are the same as in the OpenCV function rectangle().
   // corner_radius: A positive int value defining the radius of the round
   // corners.
-  void DrawRoundedRectangle(cv::Mat src, cv::Point top_left,
-                            cv::Point bottom_right,
+  void DrawRoundedRectangle(cv::Point top_left, cv::Point bottom_right,
                             const cv::Scalar& line_color, int thickness = 1,
                             int line_type = 8, int corner_radius = 0);
 
@@ -137,6 +234,20 @@ class AnnotationRenderer {
 
   // See SetScaleFactor(float)
   float scale_factor_ = 1.0;
+
+  // Primitives added since the last Render().
+  std::vector<Primitive> primitives_;
+
+  // See SetNumThreads(int, int).
+  int tile_size_ = 256;
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // Indices into primitives_ of the primitives overlapping each tile, in row
+  // major tile order. Kept to reuse allocations.
+  std::vector<std::vector<int>> tile_primitives_;
+
+  // Masks of the primitives crossing tile borders. Kept to reuse allocations.
+  std::vector<cv::Mat> crossing_masks_;
 };
 }  // namespace mediapipe
 
@@ -0,0 +1,175 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/annotation_renderer.h"
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/util/color.pb.h"
+#include "mediapipe/util/render_data.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kWidth = 200;
+constexpr int kHeight = 150;
+constexpr int kTileSize = 64;
+
+RenderAnnotation* AddAnnotation(int r, int g, int b, double thickness,
+                                RenderData* render_data) {
+  RenderAnnotation* annotation = render_data->add_render_annotations();
+  annotation->mutable_color()->set_r(r);
+  annotation->mutable_color()->set_g(g);
+  annotation->mutable_color()->set_b(b);
+  annotation->set_thickness(thickness);
+  return annotation;
+}
+
+void SetRectangle(double left, double top, double right, double bottom,
+                  RenderAnnotation::Rectangle* rectangle) {
+  rectangle->set_left(left);
+  rectangle->set_top(top);
+  rectangle->set_right(right);
+  rectangle->set_bottom(bottom);
+}
+
+// Overlapping annotations of every kind, most of them crossing the borders of
+// kTileSize tiles, some of them leaving the image.
+RenderData CrossingAnnotations() {
+  RenderData render_data;
+
+  auto* filled_oval =
+      AddAnnotation(200, 40, 40, 1, &render_data)->mutable_filled_oval();
+  SetRectangle(30, 25, 101, 110,
+               filled_oval->mutable_oval()->mutable_rectangle());
+
+  auto* filled_rectangle =
+      AddAnnotation(30, 60, 200, 1, &render_data)->mutable_filled_rectangle();
+  SetRectangle(110, 50, 170, 90, filled_rectangle->mutable_rectangle());
+  filled_rectangle->mutable_rectangle()->set_rotation(0.3);
+
+  // Thin and thick lines at shallow and steep slopes.
+  const double lines[][5] = {{1, 3, 7, 197, 141},
+                             {1, 190, 2, 61, 149},
+                             {7, 10, 130, 250, 20},
+                             {12, 120, -20, 70, 170},
+                             {4, 63, 0, 66, 150}};
+  for (const auto& l : lines) {
+    auto* line = AddAnnotation(20, 220, 90, l[0], &render_data)->mutable_line();
+    line->set_x_start(l[1]);
+    line->set_y_start(l[2]);
+    line->set_x_end(l[3]);
+    line->set_y_end(l[4]);
+  }
+
+  auto* gradient_line =
+      AddAnnotation(0, 0, 0, 5, &render_data)->mutable_gradient_line();
+  gradient_line->set_x_start(5);
+  gradient_line->set_y_start(140);
+  gradient_line->set_x_end(190);
+  gradient_line->set_y_end(100);
+  gradient_line->mutable_color1()->set_r(255);
+  gradient_line->mutable_color2()->set_b(255);
+
+  auto* oval = AddAnnotation(240, 240, 0, 3, &render_data)->mutable_oval();
+  SetRectangle(90, 40, 180, 140, oval->mutable_rectangle());
+
+  auto* rectangle =
+      AddAnnotation(0, 250, 250, 4, &render_data)->mutable_rectangle();
+  SetRectangle(50, 60, 140, 130, rectangle);
+
+  auto* rounded_rectangle =
+      AddAnnotation(90, 0, 90, 2, &render_data)->mutable_rounded_rectangle();
+  SetRectangle(20, 5, 120, 70, rounded_rectangle->mutable_rectangle());
+  rounded_rectangle->set_corner_radius(12);
+
+  auto* arrow = AddAnnotation(255, 128, 0, 3, &render_data)->mutable_arrow();
+  arrow->set_x_start(180);
+  arrow->set_y_start(10);
+  arrow->set_x_end(70);
+  arrow->set_y_end(70);
+
+  auto* point = AddAnnotation(255, 255, 255, 6, &render_data)->mutable_point();
+  point->set_x(128);
+  point->set_y(64);
+
+  auto* text = AddAnnotation(250, 250, 250, 2, &render_data)->mutable_text();
+  text->set_display_text("Tiles");
+  text->set_left(20);
+  text->set_baseline(75);
+  text->set_font_height(40);
+
+  auto* thin_text = AddAnnotation(10, 10, 10, 1, &render_data)->mutable_text();
+  thin_text->set_display_text("abc");
+  thin_text->set_left(100);
+  thin_text->set_baseline(132);
+  thin_text->set_font_height(24);
+  thin_text->set_font_face(3);
+
+  return render_data;
+}
+
+cv::Mat Render(const RenderData& render_data, int num_threads, int type,
+               bool flip_text) {
+  cv::Mat image(kHeight, kWidth, type, cv::Scalar(10, 20, 30, 255));
+  AnnotationRenderer renderer;
+  renderer.SetNumThreads(num_threads, kTileSize);
+  renderer.SetFlipTextVertically(flip_text);
+  renderer.AdoptImage(&image);
+  renderer.RenderDataOnImage(render_data);
+  return image;
+}
+
+int CountDifferentValues(const cv::Mat& lhs, const cv::Mat& rhs) {
+  cv::Mat diff;
+  cv::absdiff(lhs, rhs, diff);
+  return cv::countNonZero(diff.reshape(1));
+}
+
+void ExpectTiledMatchesUntiled(const RenderData& render_data, int type,
+                               bool flip_text) {
+  const cv::Mat untiled = Render(render_data, 1, type, flip_text);
+  const cv::Mat background(kHeight, kWidth, type, cv::Scalar(10, 20, 30, 255));
+  ASSERT_GT(CountDifferentValues(untiled, background), 0);
+  for (int num_threads : {2, 3}) {
+    EXPECT_EQ(CountDifferentValues(
+                  Render(render_data, num_threads, type, flip_text), untiled),
+              0)
+        << "with " << num_threads << " threads";
+  }
+}
+
+TEST(AnnotationRendererTest, TiledMatchesUntiled) {
+  ExpectTiledMatchesUntiled(CrossingAnnotations(), CV_8UC3, false);
+}
+
+TEST(AnnotationRendererTest, TiledMatchesUntiledRgbaFlippedText) {
+  ExpectTiledMatchesUntiled(CrossingAnnotations(), CV_8UC4, true);
+}
+
+// Anti-aliased annotations crossing tile borders fall back to drawing in one
+// piece.
+TEST(AnnotationRendererTest, TiledMatchesUntiledAntiAliased) {
+  RenderData render_data = CrossingAnnotations();
+  auto* rounded_rectangle =
+      AddAnnotation(0, 90, 0, 3, &render_data)->mutable_rounded_rectangle();
+  SetRectangle(40, 30, 160, 120, rounded_rectangle->mutable_rectangle());
+  rounded_rectangle->set_corner_radius(20);
+  rounded_rectangle->set_line_type(cv::LINE_AA);
+  ExpectTiledMatchesUntiled(render_data, CV_8UC3, false);
+}
+
+}  // namespace
+}  // namespace mediapipe
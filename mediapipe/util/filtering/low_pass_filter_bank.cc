@@ -0,0 +1,62 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/low_pass_filter_bank.h"
+
+#include "Eigen/Core"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+LowPassFilterBank::LowPassFilterBank(int size, float alpha)
+    : raw_values_(size), alphas_(size, alpha), stored_values_(size) {
+  if (alpha < 0.0f || alpha > 1.0f) {
+    LOG(ERROR) << "alpha: " << alpha << " should be in [0.0, 1.0] range";
+  }
+}
+
+void LowPassFilterBank::ApplyWithAlpha(const float* values,
+                                       const float* alphas, float* filtered) {
+  SetAlphas(alphas);
+  const int n = size();
+  Eigen::Map<Eigen::ArrayXf> raw(raw_values_.data(), n);
+  Eigen::Map<Eigen::ArrayXf> stored(stored_values_.data(), n);
+  raw = Eigen::Map<const Eigen::ArrayXf>(values, n);
+  if (initialized_) {
+    const Eigen::Map<const Eigen::ArrayXf> alpha(alphas_.data(), n);
+    // Same precision as LowPassFilter: the product in float, the rest in
+    // double.
+    stored = ((alpha * raw).cast<double>() +
+              (1.0 - alpha.cast<double>()) * stored.cast<double>())
+                 .cast<float>();
+  } else {
+    stored = raw;
+    initialized_ = true;
+  }
+  Eigen::Map<Eigen::ArrayXf>(filtered, n) = stored;
+}
+
+void LowPassFilterBank::SetAlphas(const float* alphas) {
+  const int n = size();
+  const Eigen::Map<const Eigen::ArrayXf> alpha(alphas, n);
+  Eigen::Map<Eigen::ArrayXf> current(alphas_.data(), n);
+  // Out of range alphas are ignored, as by LowPassFilter.
+  const auto invalid = alpha < 0.0f || alpha > 1.0f;
+  if (invalid.any()) {
+    LOG(ERROR) << invalid.count() << " alphas should be in [0.0, 1.0] range";
+  }
+  current = invalid.select(current, alpha);
+}
+
+}  // namespace mediapipe
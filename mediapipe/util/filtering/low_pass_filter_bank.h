@@ -0,0 +1,53 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_FILTERING_LOW_PASS_FILTER_BANK_H_
+#define MEDIAPIPE_UTIL_FILTERING_LOW_PASS_FILTER_BANK_H_
+
+#include <vector>
+
+namespace mediapipe {
+
+// A bank of LowPassFilters over a fixed number of channels, stored as arrays
+// and updated together. All channels are initialized by the same first call,
+// and each channel gives exactly the results of its own LowPassFilter.
+class LowPassFilterBank {
+ public:
+  LowPassFilterBank(int size, float alpha);
+
+  // Filters values with per-channel alphas. values, alphas and filtered have
+  // size() elements, and filtered may be values.
+  void ApplyWithAlpha(const float* values, const float* alphas,
+                      float* filtered);
+
+  bool HasLastRawValues() const { return initialized_; }
+
+  const std::vector<float>& LastRawValues() const { return raw_values_; }
+
+  const std::vector<float>& LastValues() const { return stored_values_; }
+
+  int size() const { return raw_values_.size(); }
+
+ private:
+  void SetAlphas(const float* alphas);
+
+  std::vector<float> raw_values_;
+  std::vector<float> alphas_;
+  std::vector<float> stored_values_;
+  bool initialized_ = false;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_FILTERING_LOW_PASS_FILTER_BANK_H_
@@ -0,0 +1,117 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Eigen/Core"
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+static const double kEpsilon = 0.000001;
+
+OneEuroFilterBank::OneEuroFilterBank(int size, double frequency,
+                                     double min_cutoff, double beta,
+                                     double derivate_cutoff)
+    : dvalues_(size), alphas_(size) {
+  SetFrequency(frequency);
+  SetMinCutoff(min_cutoff);
+  SetBeta(beta);
+  SetDerivateCutoff(derivate_cutoff);
+  x_ = absl::make_unique<LowPassFilterBank>(size, GetAlpha(min_cutoff));
+  dx_ = absl::make_unique<LowPassFilterBank>(size, GetAlpha(derivate_cutoff));
+}
+
+void OneEuroFilterBank::Apply(absl::Duration timestamp, double value_scale,
+                              const float* values, float* filtered) {
+  const int n = size();
+  int64_t new_timestamp = absl::ToInt64Nanoseconds(timestamp);
+  if (last_time_ >= new_timestamp) {
+    // Results are unpredictable in this case, so nothing to do but
+    // return same values
+    LOG(WARNING) << "New timestamp is equal or less than the last one.";
+    std::copy(values, values + n, filtered);
+    return;
+  }
+
+  // update the sampling frequency based on timestamps
+  if (last_time_ != 0 && new_timestamp != 0) {
+    static constexpr double kNanoSecondsToSecond = 1e-9;
+    frequency_ = 1.0 / ((new_timestamp - last_time_) * kNanoSecondsToSecond);
+  }
+  last_time_ = new_timestamp;
+
+  // estimate the current variation per second
+  const Eigen::Map<const Eigen::ArrayXf> value(values, n);
+  Eigen::Map<Eigen::ArrayXf> dvalue(dvalues_.data(), n);
+  if (x_->HasLastRawValues()) {
+    const Eigen::Map<const Eigen::ArrayXf> last_raw_value(
+        x_->LastRawValues().data(), n);
+    dvalue = (((value.cast<double>() - last_raw_value.cast<double>()) *
+               value_scale) *
+              frequency_)
+                 .cast<float>();
+  } else {
+    dvalue.setZero();
+  }
+  Eigen::Map<Eigen::ArrayXf> alpha(alphas_.data(), n);
+  alpha.setConstant(GetAlpha(derivate_cutoff_));
+  dx_->ApplyWithAlpha(dvalues_.data(), alphas_.data(), dvalues_.data());
+
+  // use it to update the cutoff frequency, and filter the given values with
+  // the alpha of that cutoff, see GetAlpha.
+  const double te = 1.0 / frequency_;
+  const auto cutoff = min_cutoff_ + beta_ * dvalue.cast<double>().abs();
+  const auto tau = 1.0 / (2 * M_PI * cutoff);
+  alpha = (1.0 / (1.0 + tau / te)).cast<float>();
+  x_->ApplyWithAlpha(values, alphas_.data(), filtered);
+}
+
+double OneEuroFilterBank::GetAlpha(double cutoff) const {
+  double te = 1.0 / frequency_;
+  double tau = 1.0 / (2 * M_PI * cutoff);
+  return 1.0 / (1.0 + tau / te);
+}
+
+void OneEuroFilterBank::SetFrequency(double frequency) {
+  if (frequency <= kEpsilon) {
+    LOG(ERROR) << "frequency should be > 0";
+    return;
+  }
+  frequency_ = frequency;
+}
+
+void OneEuroFilterBank::SetMinCutoff(double min_cutoff) {
+  if (min_cutoff <= kEpsilon) {
+    LOG(ERROR) << "min_cutoff should be > 0";
+    return;
+  }
+  min_cutoff_ = min_cutoff;
+}
+
+void OneEuroFilterBank::SetBeta(double beta) { beta_ = beta; }
+
+void OneEuroFilterBank::SetDerivateCutoff(double derivate_cutoff) {
+  if (derivate_cutoff <= kEpsilon) {
+    LOG(ERROR) << "derivate_cutoff should be > 0";
+    return;
+  }
+  derivate_cutoff_ = derivate_cutoff;
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,70 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
+#define MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/util/filtering/low_pass_filter_bank.h"
+
+namespace mediapipe {
+
+// A bank of OneEuroFilters over a fixed number of channels, such as the
+// coordinates of all landmarks of an object, which are filtered with the same
+// timestamps and value scales. Each channel gives exactly the results of its
+// own OneEuroFilter, with all channels updated together with array
+// operations.
+class OneEuroFilterBank {
+ public:
+  OneEuroFilterBank(int size, double frequency, double min_cutoff, double beta,
+                    double derivate_cutoff);
+
+  // Applies the filters to values, see OneEuroFilter::Apply. values and
+  // filtered have size() elements, and filtered may be values.
+  void Apply(absl::Duration timestamp, double value_scale, const float* values,
+             float* filtered);
+
+  int size() const { return dvalues_.size(); }
+
+ private:
+  double GetAlpha(double cutoff) const;
+
+  void SetFrequency(double frequency);
+
+  void SetMinCutoff(double min_cutoff);
+
+  void SetBeta(double beta);
+
+  void SetDerivateCutoff(double derivate_cutoff);
+
+  double frequency_;
+  double min_cutoff_;
+  double beta_;
+  double derivate_cutoff_;
+  std::unique_ptr<LowPassFilterBank> x_;
+  std::unique_ptr<LowPassFilterBank> dx_;
+  int64_t last_time_ = 0;
+
+  // Scratch space for derivatives and alphas.
+  std::vector<float> dvalues_;
+  std::vector<float> alphas_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
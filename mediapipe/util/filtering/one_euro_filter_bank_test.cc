@@ -0,0 +1,104 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+
+#include <random>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/filtering/one_euro_filter.h"
+
+namespace mediapipe {
+namespace {
+
+// Frame intervals in milliseconds, with jitter, a long pause and a repeated
+// timestamp.
+constexpr int kFrameIntervals[] = {33, 30, 40, 33, 0, 33, 500, 16, 33, 33,
+                                   35, 28, 33, 0,  33, 33, 66, 33, 33};
+
+void ExpectMatchesFilters(int size, double min_cutoff, double beta) {
+  const double frequency = 30.0;
+  const double derivate_cutoff = 1.0;
+  std::vector<OneEuroFilter> filters;
+  for (int i = 0; i < size; ++i) {
+    filters.emplace_back(frequency, min_cutoff, beta, derivate_cutoff);
+  }
+  OneEuroFilterBank bank(size, frequency, min_cutoff, beta, derivate_cutoff);
+  std::mt19937 rng(size);
+  std::uniform_real_distribution<float> dist(0.0f, 500.0f);
+  std::vector<float> values(size);
+  for (float& value : values) value = dist(rng);
+  std::vector<float> filtered(size);
+
+  int64_t millis = 0;
+  for (int frame = 0; frame < 3; ++frame) {
+    for (int interval : kFrameIntervals) {
+      millis += interval;
+      const absl::Duration timestamp = absl::Milliseconds(millis);
+      const float value_scale = 1.0f / (100.0f + millis % 7);
+      for (float& value : values) value += dist(rng) / 50.0f - 5.0f;
+      bank.Apply(timestamp, value_scale, values.data(), filtered.data());
+      for (int i = 0; i < size; ++i) {
+        ASSERT_EQ(filtered[i], static_cast<float>(filters[i].Apply(
+                                   timestamp, value_scale, values[i])))
+            << "channel " << i << " at " << millis << " ms";
+      }
+    }
+  }
+}
+
+TEST(OneEuroFilterBankTest, MatchesOneEuroFilters) {
+  ExpectMatchesFilters(/*size=*/99, /*min_cutoff=*/0.05, /*beta=*/80.0);
+  ExpectMatchesFilters(/*size=*/7, /*min_cutoff=*/1.0, /*beta=*/0.0);
+  // Cutoffs can get negative, which LowPassFilter ignores.
+  ExpectMatchesFilters(/*size=*/7, /*min_cutoff=*/0.5, /*beta=*/-10.0);
+}
+
+// Coordinates of face mesh, hands and pose landmarks.
+constexpr int kNumChannels = 3 * (478 + 2 * 21 + 33);
+
+void BM_OneEuroFilters(benchmark::State& state) {
+  std::vector<OneEuroFilter> filters;
+  for (int i = 0; i < kNumChannels; ++i) {
+    filters.emplace_back(30.0, 0.05, 80.0, 1.0);
+  }
+  std::vector<float> values(kNumChannels, 0.5f);
+  int64_t millis = 0;
+  for (auto _ : state) {
+    millis += 33;
+    for (int i = 0; i < kNumChannels; ++i) {
+      values[i] = filters[i].Apply(absl::Milliseconds(millis), 1.0,
+                                   values[i] + 0.01f);
+    }
+  }
+}
+BENCHMARK(BM_OneEuroFilters);
+
+void BM_OneEuroFilterBank(benchmark::State& state) {
+  OneEuroFilterBank bank(kNumChannels, 30.0, 0.05, 80.0, 1.0);
+  std::vector<float> values(kNumChannels, 0.5f);
+  int64_t millis = 0;
+  for (auto _ : state) {
+    millis += 33;
+    for (float& value : values) value += 0.01f;
+    bank.Apply(absl::Milliseconds(millis), 1.0, values.data(), values.data());
+  }
+}
+BENCHMARK(BM_OneEuroFilterBank);
+
+}  // namespace
+}  // namespace mediapipe
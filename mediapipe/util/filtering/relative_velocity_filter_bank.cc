@@ -0,0 +1,116 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/relative_velocity_filter_bank.h"
+
+#include <algorithm>
+
+#include "Eigen/Core"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+RelativeVelocityFilterBank::RelativeVelocityFilterBank(
+    int size, int window_size, float velocity_scale,
+    DistanceEstimationMode distance_mode)
+    : last_values_(size),
+      window_size_(window_size),
+      window_distances_(static_cast<size_t>(window_size) * size),
+      window_durations_(window_size),
+      low_pass_filter_(size, 1.0f),
+      velocity_scale_(velocity_scale),
+      distance_mode_(distance_mode),
+      distances_(size),
+      alphas_(size) {}
+
+float* RelativeVelocityFilterBank::WindowDistances(int index) {
+  const int row = (window_newest_ - index + window_size_) % window_size_;
+  return window_distances_.data() + static_cast<size_t>(row) * size();
+}
+
+void RelativeVelocityFilterBank::Apply(absl::Duration timestamp,
+                                       float value_scale, const float* values,
+                                       float* filtered) {
+  const int n = size();
+  const int64_t new_timestamp = absl::ToInt64Nanoseconds(timestamp);
+  if (last_timestamp_ >= new_timestamp) {
+    // Results are unpredictable in this case, so nothing to do but
+    // return same values
+    LOG(WARNING) << "New timestamp is equal or less than the last one.";
+    std::copy(values, values + n, filtered);
+    return;
+  }
+
+  const Eigen::Map<const Eigen::ArrayXf> value(values, n);
+  Eigen::Map<Eigen::ArrayXf> last_value(last_values_.data(), n);
+  Eigen::Map<Eigen::ArrayXf> alpha(alphas_.data(), n);
+  if (last_timestamp_ == -1) {
+    alpha.setConstant(1.0f);
+  } else {
+    DCHECK(distance_mode_ == DistanceEstimationMode::kLegacyTransition ||
+           distance_mode_ == DistanceEstimationMode::kForceCurrentScale);
+    Eigen::Map<Eigen::ArrayXf> distance(distances_.data(), n);
+    if (distance_mode_ == DistanceEstimationMode::kLegacyTransition) {
+      distance = value * value_scale - last_value * last_value_scale_;
+    } else {
+      distance = value_scale * (value - last_value);
+    }
+
+    const int64_t duration = new_timestamp - last_timestamp_;
+
+    // Durations are shared, so all channels sum the same window elements.
+    // See RelativeVelocityFilter::Apply for the heuristic.
+    constexpr int64_t kAssumedMaxDuration = 1000000000 / 30;
+    const int64_t max_cumulative_duration =
+        (1 + window_size_) * kAssumedMaxDuration;
+    int64_t cumulative_duration = duration;
+    int num_elements = 0;
+    for (; num_elements < window_size_; ++num_elements) {
+      const int row =
+          (window_newest_ - num_elements + window_size_) % window_size_;
+      const int64_t element_duration = window_durations_[row];
+      if (cumulative_duration + element_duration > max_cumulative_duration) {
+        break;
+      }
+      cumulative_duration += element_duration;
+    }
+
+    // The cumulative distances are accumulated in alphas_ in the order
+    // RelativeVelocityFilter sums them.
+    alpha = distance;
+    for (int i = 0; i < num_elements; ++i) {
+      alpha += Eigen::Map<const Eigen::ArrayXf>(WindowDistances(i), n);
+    }
+
+    constexpr double kNanoSecondsToSecond = 1e-9;
+    const double cumulative_seconds =
+        cumulative_duration * kNanoSecondsToSecond;
+    alpha = (alpha.cast<double>() / cumulative_seconds).cast<float>();
+    alpha = 1.0f - 1.0f / (1.0f + velocity_scale_ * alpha.abs());
+
+    if (window_size_ > 0) {
+      window_newest_ = (window_newest_ + 1) % window_size_;
+      Eigen::Map<Eigen::ArrayXf>(WindowDistances(0), n) = distance;
+      window_durations_[window_newest_] = duration;
+    }
+  }
+
+  last_value = value;
+  last_value_scale_ = value_scale;
+  last_timestamp_ = new_timestamp;
+
+  low_pass_filter_.ApplyWithAlpha(values, alphas_.data(), filtered);
+}
+
+}  // namespace mediapipe
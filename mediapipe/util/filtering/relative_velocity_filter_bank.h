@@ -0,0 +1,81 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_FILTERING_RELATIVE_VELOCITY_FILTER_BANK_H_
+#define MEDIAPIPE_UTIL_FILTERING_RELATIVE_VELOCITY_FILTER_BANK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/util/filtering/low_pass_filter_bank.h"
+#include "mediapipe/util/filtering/relative_velocity_filter.h"
+
+namespace mediapipe {
+
+// A bank of RelativeVelocityFilters over a fixed number of channels, such as
+// the coordinates of all landmarks of an object, which are filtered with the
+// same timestamps and value scales. Each channel gives exactly the results of
+// its own RelativeVelocityFilter.
+//
+// Since the channels share timestamps, they share the durations of their
+// windows, and only the distances are kept per channel, in a ring buffer of
+// window_size rows of size() values. All channels are updated together with
+// array operations.
+class RelativeVelocityFilterBank {
+ public:
+  using DistanceEstimationMode = RelativeVelocityFilter::DistanceEstimationMode;
+
+  RelativeVelocityFilterBank(int size, int window_size, float velocity_scale,
+                             DistanceEstimationMode distance_mode);
+
+  RelativeVelocityFilterBank(int size, int window_size, float velocity_scale)
+      : RelativeVelocityFilterBank{size, window_size, velocity_scale,
+                                   DistanceEstimationMode::kDefault} {}
+
+  // Applies the filters to values, see RelativeVelocityFilter::Apply. values
+  // and filtered have size() elements, and filtered may be values.
+  void Apply(absl::Duration timestamp, float value_scale, const float* values,
+             float* filtered);
+
+  int size() const { return last_values_.size(); }
+
+ private:
+  // Returns the distances of the window element that is index elements older
+  // than the newest one.
+  float* WindowDistances(int index);
+
+  float last_value_scale_ = 1.0f;
+  int64_t last_timestamp_ = -1;
+  std::vector<float> last_values_;
+
+  // Like RelativeVelocityFilter's window, which starts with window_size zero
+  // elements.
+  const int window_size_;
+  int window_newest_ = 0;
+  std::vector<float> window_distances_;
+  std::vector<int64_t> window_durations_;
+
+  LowPassFilterBank low_pass_filter_;
+  const float velocity_scale_;
+  const DistanceEstimationMode distance_mode_;
+
+  // Scratch space for distances and alphas.
+  std::vector<float> distances_;
+  std::vector<float> alphas_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_FILTERING_RELATIVE_VELOCITY_FILTER_BANK_H_
@@ -0,0 +1,123 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/relative_velocity_filter_bank.h"
+
+#include <random>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/filtering/relative_velocity_filter.h"
+
+namespace mediapipe {
+namespace {
+
+using DistanceEstimationMode =
+    RelativeVelocityFilterBank::DistanceEstimationMode;
+
+// Frame intervals in milliseconds, with jitter, a long pause and a repeated
+// timestamp.
+constexpr int kFrameIntervals[] = {33, 30, 40, 33, 0, 33, 500, 16, 33, 33,
+                                   35, 28, 33, 0,  33, 33, 66, 33, 33};
+
+void ExpectMatchesFilters(int size, int window_size, float velocity_scale,
+                          DistanceEstimationMode distance_mode) {
+  std::vector<RelativeVelocityFilter> filters(
+      size,
+      RelativeVelocityFilter(window_size, velocity_scale, distance_mode));
+  RelativeVelocityFilterBank bank(size, window_size, velocity_scale,
+                                  distance_mode);
+  std::mt19937 rng(window_size);
+  std::uniform_real_distribution<float> dist(0.0f, 500.0f);
+  std::vector<float> values(size);
+  for (float& value : values) value = dist(rng);
+  std::vector<float> filtered(size);
+
+  int64_t millis = 0;
+  for (int frame = 0; frame < 3; ++frame) {
+    for (int interval : kFrameIntervals) {
+      millis += interval;
+      const absl::Duration timestamp = absl::Milliseconds(millis);
+      const float value_scale = 1.0f / (100.0f + millis % 7);
+      for (float& value : values) value += dist(rng) / 50.0f - 5.0f;
+      bank.Apply(timestamp, value_scale, values.data(), filtered.data());
+      for (int i = 0; i < size; ++i) {
+        ASSERT_EQ(filtered[i],
+                  filters[i].Apply(timestamp, value_scale, values[i]))
+            << "channel " << i << " at " << millis << " ms";
+      }
+    }
+  }
+}
+
+TEST(RelativeVelocityFilterBankTest, MatchesRelativeVelocityFilters) {
+  ExpectMatchesFilters(/*size=*/99, /*window_size=*/5, /*velocity_scale=*/10,
+                       DistanceEstimationMode::kLegacyTransition);
+  ExpectMatchesFilters(/*size=*/99, /*window_size=*/5, /*velocity_scale=*/10,
+                       DistanceEstimationMode::kForceCurrentScale);
+  ExpectMatchesFilters(/*size=*/7, /*window_size=*/1, /*velocity_scale=*/45,
+                       DistanceEstimationMode::kLegacyTransition);
+  ExpectMatchesFilters(/*size=*/7, /*window_size=*/0, /*velocity_scale=*/45,
+                       DistanceEstimationMode::kLegacyTransition);
+}
+
+TEST(RelativeVelocityFilterBankTest, FiltersInPlace) {
+  RelativeVelocityFilterBank bank(2, 5, 10.0f);
+  RelativeVelocityFilter filter(5, 10.0f);
+  float values[] = {1.0f, 1.0f};
+  bank.Apply(absl::Milliseconds(33), 1.0f, values, values);
+  EXPECT_EQ(values[0], filter.Apply(absl::Milliseconds(33), 1.0f, 1.0f));
+  values[0] = values[1] = 5.0f;
+  bank.Apply(absl::Milliseconds(66), 1.0f, values, values);
+  const float expected = filter.Apply(absl::Milliseconds(66), 1.0f, 5.0f);
+  EXPECT_EQ(values[0], expected);
+  EXPECT_EQ(values[1], expected);
+}
+
+// Coordinates of face mesh, hands and pose landmarks.
+constexpr int kNumChannels = 3 * (478 + 2 * 21 + 33);
+
+void BM_RelativeVelocityFilters(benchmark::State& state) {
+  std::vector<RelativeVelocityFilter> filters(
+      kNumChannels, RelativeVelocityFilter(/*window_size=*/5,
+                                           /*velocity_scale=*/10.0f));
+  std::vector<float> values(kNumChannels, 0.5f);
+  int64_t millis = 0;
+  for (auto _ : state) {
+    millis += 33;
+    for (int i = 0; i < kNumChannels; ++i) {
+      values[i] = filters[i].Apply(absl::Milliseconds(millis), 1.0f,
+                                   values[i] + 0.01f);
+    }
+  }
+}
+BENCHMARK(BM_RelativeVelocityFilters);
+
+void BM_RelativeVelocityFilterBank(benchmark::State& state) {
+  RelativeVelocityFilterBank bank(kNumChannels, /*window_size=*/5,
+                                  /*velocity_scale=*/10.0f);
+  std::vector<float> values(kNumChannels, 0.5f);
+  int64_t millis = 0;
+  for (auto _ : state) {
+    millis += 33;
+    for (float& value : values) value += 0.01f;
+    bank.Apply(absl::Milliseconds(millis), 1.0f, values.data(), values.data());
+  }
+}
+BENCHMARK(BM_RelativeVelocityFilterBank);
+
+}  // namespace
+}  // namespace mediapipe
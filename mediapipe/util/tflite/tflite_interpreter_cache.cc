@@ -0,0 +1,90 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tflite/tflite_interpreter_cache.h"
+
+#include <utility>
+
+#include "mediapipe/framework/port/status_macros.h"
+
+namespace mediapipe {
+
+TfLiteInterpreterCache& TfLiteInterpreterCache::GetInstance() {
+  static TfLiteInterpreterCache* cache = new TfLiteInterpreterCache();
+  return *cache;
+}
+
+absl::StatusOr<api2::Packet<TfLiteModelPtr>> TfLiteInterpreterCache::GetModel(
+    const std::string& path) {
+  // The model is loaded while holding the lock, so that calculators opening
+  // concurrently do not load the same model twice.
+  absl::MutexLock lock(&mutex_);
+  auto it = models_.find(path);
+  if (it != models_.end()) {
+    return it->second;
+  }
+  ASSIGN_OR_RETURN(auto model, TfLiteModelLoader::LoadFromPath(path));
+  models_.emplace(path, model);
+  return model;
+}
+
+absl::optional<TfLiteInterpreterCache::Entry> TfLiteInterpreterCache::Acquire(
+    const std::string& key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = idle_interpreters_.find(key);
+  if (it == idle_interpreters_.end()) {
+    return absl::nullopt;
+  }
+  Entry entry = std::move(it->second.back());
+  it->second.pop_back();
+  if (it->second.empty()) {
+    idle_interpreters_.erase(it);
+  }
+  return entry;
+}
+
+void TfLiteInterpreterCache::Release(const std::string& key, Entry entry) {
+  {
+    absl::MutexLock lock(&mutex_);
+    std::vector<Entry>& entries = idle_interpreters_[key];
+    if (entries.size() < kMaxIdleInterpretersPerKey) {
+      entries.push_back(std::move(entry));
+      return;
+    }
+  }
+  // The extra interpreter is destroyed outside the lock, as in Clear.
+}
+
+int TfLiteInterpreterCache::NumIdleInterpreters() const {
+  absl::MutexLock lock(&mutex_);
+  int result = 0;
+  for (const auto& key_entries : idle_interpreters_) {
+    result += key_entries.second.size();
+  }
+  return result;
+}
+
+void TfLiteInterpreterCache::Clear() {
+  std::map<std::string, api2::Packet<TfLiteModelPtr>> models;
+  std::map<std::string, std::vector<Entry>> idle_interpreters;
+  {
+    absl::MutexLock lock(&mutex_);
+    models.swap(models_);
+    idle_interpreters.swap(idle_interpreters_);
+  }
+  // The interpreters are destroyed outside the lock, before their models.
+  idle_interpreters.clear();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,95 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_TFLITE_TFLITE_INTERPRETER_CACHE_H_
+#define MEDIAPIPE_UTIL_TFLITE_TFLITE_INTERPRETER_CACHE_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "mediapipe/framework/api2/packet.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/util/tflite/tflite_model_loader.h"
+#include "tensorflow/lite/interpreter.h"
+
+namespace mediapipe {
+
+// A process-wide cache of TfLite models and prepared interpreters, which lets
+// inference calculators skip loading the model and applying the delegate when
+// a graph is started again, or when another graph runs the same model.
+//
+// Models are cached by path, so that all the interpreters running a model
+// share a single copy of it. An interpreter, with its delegate applied, is
+// returned to the cache when the calculator using it is closed, and handed to
+// the next calculator that opens the same model with the same options. In
+// particular, an XNNPACK delegate keeps the weights it has packed, so they are
+// not packed again. Interpreters are never shared: each calculator running
+// concurrently still owns an interpreter and its packed weights. At most
+// kMaxIdleInterpretersPerKey idle interpreters are kept for each key.
+class TfLiteInterpreterCache {
+ public:
+  static constexpr int kMaxIdleInterpretersPerKey = 4;
+
+  using TfLiteDelegatePtr =
+      std::unique_ptr<TfLiteDelegate, std::function<void(TfLiteDelegate*)>>;
+
+  // An interpreter with its delegate, and the model they run. The members are
+  // declared so that the interpreter is destroyed first, and the model last.
+  struct Entry {
+    api2::Packet<TfLiteModelPtr> model;
+    TfLiteDelegatePtr delegate;
+    std::unique_ptr<tflite::Interpreter> interpreter;
+  };
+
+  // Returns the process-wide cache.
+  static TfLiteInterpreterCache& GetInstance();
+
+  // Returns the model loaded from the specified path, loading it on first use.
+  absl::StatusOr<api2::Packet<TfLiteModelPtr>> GetModel(const std::string& path)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Removes and returns an idle interpreter released under the specified key,
+  // if any. The key must identify the model and every option used to prepare
+  // the interpreter.
+  absl::optional<Entry> Acquire(const std::string& key)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns an interpreter prepared under the specified key to the cache. The
+  // interpreter is destroyed instead if the key already has
+  // kMaxIdleInterpretersPerKey idle interpreters.
+  void Release(const std::string& key, Entry entry) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of idle interpreters in the cache.
+  int NumIdleInterpreters() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Releases the cached models and the idle interpreters. Interpreters in use
+  // are not affected.
+  void Clear() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  mutable absl::Mutex mutex_;
+  std::map<std::string, api2::Packet<TfLiteModelPtr>> models_
+      ABSL_GUARDED_BY(mutex_);
+  std::map<std::string, std::vector<Entry>> idle_interpreters_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TFLITE_TFLITE_INTERPRETER_CACHE_H_
@@ -16,7 +16,6 @@
 
 #include <sys/stat.h>
 
-#include <fstream>
 #include <limits>
 
 #include "absl/strings/str_cat.h"
@@ -26,6 +25,7 @@
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/util/tracking/measure_time.h"
+#include "mediapipe/util/tracking/packed_tracking_data.h"
 #include "mediapipe/util/tracking/tracking.pb.h"
 
 namespace mediapipe {
@@ -119,6 +119,34 @@ TimedBox BlendTimedBoxes(const TimedBox& lhs, const TimedBox& rhs,
   return TimedBox::Blend(lhs, rhs, alpha);
 }
 
+// Returns index of the frame closest to msec, given the lower bound pos of
+// msec within num_frames frames with timestamps timestamp_usec(index).
+template <class TimestampFn>
+int ClosestFrameIndexFromLowerBound(int64 msec, int pos, int num_frames,
+                                    const TimestampFn& timestamp_usec) {
+  // Skip end.
+  if (pos == num_frames) {
+    return pos - 1;
+  } else if (pos == 0) {
+    // Nothing smaller exists.
+    return 0;
+  }
+
+  // Determine closest timestamp.
+  const int64 lhs_diff = msec - timestamp_usec(pos - 1) / 1000;
+  const int64 rhs_diff = timestamp_usec(pos) / 1000 - msec;
+
+  if (std::min(lhs_diff, rhs_diff) >= 67) {
+    LOG(ERROR) << "No frame found within 67ms, probably using wrong chunk.";
+  }
+
+  if (lhs_diff < rhs_diff) {
+    return pos - 1;
+  } else {
+    return pos;
+  }
+}
+
 }  // namespace.
 
 TimedBox TimedBox::Blend(const TimedBox& lhs, const TimedBox& rhs, double alpha,
@@ -314,9 +342,9 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
 
   VLOG(1) << "Starting at chunk " << chunk_idx;
 
-  AugmentedChunkPtr tracking_chunk(ReadChunk(id, kInitCheckpoint, chunk_idx));
+  ChunkDataPtr tracking_chunk = ReadChunk(id, kInitCheckpoint, chunk_idx);
 
-  if (!tracking_chunk.first) {
+  if (!tracking_chunk) {
     absl::MutexLock lock(&status_mutex_);
     --track_status_[id][kInitCheckpoint].tracks_ongoing;
     LOG(ERROR) << "Could not read tracking chunk from file: " << chunk_idx
@@ -324,21 +352,14 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
     return;
   }
 
-  // Grab ownership here, to avoid any memory leaks due to early return.
-  std::unique_ptr<const TrackingDataChunk> chunk_owned;
-  if (tracking_chunk.second) {
-    chunk_owned.reset(tracking_chunk.first);
-  }
-
   const int start_frame =
-      ClosestFrameIndex(initial_pos.time_msec, *tracking_chunk.first);
+      tracking_chunk->ClosestFrameIndex(initial_pos.time_msec);
 
   VLOG(1) << "Local start frame: " << start_frame;
 
   // Update starting position to coincide with a frame.
   TimedBox start_pos = initial_pos;
-  start_pos.time_msec =
-      tracking_chunk.first->item(start_frame).timestamp_usec() / 1000;
+  start_pos.time_msec = tracking_chunk->timestamp_usec(start_frame) / 1000;
 
   VLOG(1) << "Request at " << initial_pos.time_msec << " revised to "
           << start_pos.time_msec;
@@ -375,27 +396,20 @@ void BoxTracker::NewBoxTrackAsync(const TimedBox& initial_pos, int id,
 
   VLOG(1) << "Starting tracking workers ... ";
 
-  AugmentedChunkPtr forward_chunk = tracking_chunk;
-  AugmentedChunkPtr backward_chunk = tracking_chunk;
-
-  if (tracking_chunk.second) {  // We have ownership, need a copy here.
-    forward_chunk = std::make_pair(new TrackingDataChunk(*chunk_owned), true);
-    backward_chunk = std::make_pair(chunk_owned.release(), true);
-  }
-
-  auto forward_operation = [this, forward_chunk, start_state, start_frame,
+  // Both directions share the read-only chunk.
+  auto forward_operation = [this, tracking_chunk, start_state, start_frame,
                             chunk_idx, id, checkpoint, min_msec, max_msec]() {
-    this->TrackingImpl(TrackingImplArgs(forward_chunk, start_state, start_frame,
-                                        chunk_idx, id, checkpoint, true, true,
-                                        min_msec, max_msec));
+    this->TrackingImpl(TrackingImplArgs(tracking_chunk, start_state,
+                                        start_frame, chunk_idx, id, checkpoint,
+                                        true, true, min_msec, max_msec));
   };
 
   tracking_workers_->Schedule(forward_operation);
 
   // Track backward.
-  auto backward_operation = [this, backward_chunk, start_state, start_frame,
+  auto backward_operation = [this, tracking_chunk, start_state, start_frame,
                              chunk_idx, id, checkpoint, min_msec, max_msec]() {
-    this->TrackingImpl(TrackingImplArgs(backward_chunk, start_state,
+    this->TrackingImpl(TrackingImplArgs(tracking_chunk, start_state,
                                         start_frame, chunk_idx, id, checkpoint,
                                         false, true, min_msec, max_msec));
   };
@@ -579,40 +593,116 @@ bool BoxTracker::IsTrackingOngoingMutexHeld() {
   return false;
 }
 
-BoxTracker::AugmentedChunkPtr BoxTracker::ReadChunk(int id, int checkpoint,
-                                                    int chunk_idx) {
+BoxTracker::ChunkData::ChunkData(const TrackingDataChunk* chunk, bool owned)
+    : chunk_(chunk) {
+  if (owned) {
+    owned_chunk_.reset(chunk);
+  }
+}
+
+BoxTracker::ChunkData::ChunkData(std::unique_ptr<MappedFile> mapped_file,
+                                 const PackedTrackingDataChunk& packed_chunk)
+    : mapped_file_(std::move(mapped_file)), packed_chunk_(packed_chunk) {}
+
+int BoxTracker::ChunkData::num_frames() const {
+  return chunk_ ? chunk_->item_size() : packed_chunk_.num_frames();
+}
+
+bool BoxTracker::ChunkData::first_chunk() const {
+  return chunk_ ? chunk_->first_chunk() : packed_chunk_.first_chunk();
+}
+
+bool BoxTracker::ChunkData::last_chunk() const {
+  return chunk_ ? chunk_->last_chunk() : packed_chunk_.last_chunk();
+}
+
+int64 BoxTracker::ChunkData::timestamp_usec(int f) const {
+  return chunk_ ? chunk_->item(f).timestamp_usec()
+                : packed_chunk_.timestamp_usec(f);
+}
+
+int64 BoxTracker::ChunkData::prev_timestamp_usec(int f) const {
+  return chunk_ ? chunk_->item(f).prev_timestamp_usec()
+                : packed_chunk_.prev_timestamp_usec(f);
+}
+
+int BoxTracker::ChunkData::frame_flags(int f) const {
+  return chunk_ ? chunk_->item(f).tracking_data().frame_flags()
+                : packed_chunk_.frame(f).frame_flags();
+}
+
+int BoxTracker::ChunkData::ClosestFrameIndex(int64 msec) const {
+  CHECK_GT(num_frames(), 0);
+  int pos;
+  if (chunk_) {
+    typedef TrackingDataChunk::Item Item;
+    Item item_to_find;
+    item_to_find.set_timestamp_usec(msec * 1000);
+    pos = std::lower_bound(chunk_->item().begin(), chunk_->item().end(),
+                           item_to_find,
+                           [](const Item& lhs, const Item& rhs) -> bool {
+                             return lhs.timestamp_usec() < rhs.timestamp_usec();
+                           }) -
+          chunk_->item().begin();
+  } else {
+    pos = packed_chunk_.LowerBoundFrame(msec * 1000);
+  }
+
+  return ClosestFrameIndexFromLowerBound(
+      msec, pos, num_frames(), [this](int f) { return timestamp_usec(f); });
+}
+
+void BoxTracker::ChunkData::GetMotionVectorFrame(
+    int f, MotionVectorFrame* mvf) const {
+  if (chunk_) {
+    MotionVectorFrameFromTrackingData(chunk_->item(f).tracking_data(), mvf);
+  } else {
+    MotionVectorFrameFromPackedTrackingData(packed_chunk_.frame(f), mvf);
+  }
+}
+
+void BoxTracker::ChunkData::GetTrackingData(
+    int f, TrackingData* tracking_data) const {
+  if (chunk_) {
+    *tracking_data = chunk_->item(f).tracking_data();
+  } else {
+    packed_chunk_.frame(f).ToTrackingData(tracking_data);
+  }
+}
+
+BoxTracker::ChunkDataPtr BoxTracker::ReadChunk(int id, int checkpoint,
+                                               int chunk_idx) {
   VLOG(1) << __FUNCTION__ << " id=" << id << " chunk_idx=" << chunk_idx;
   if (cache_dir_.empty() && !tracking_data_.empty()) {
     if (chunk_idx < tracking_data_.size()) {
-      return std::make_pair(tracking_data_[chunk_idx], false);
+      return std::make_shared<ChunkData>(tracking_data_[chunk_idx], false);
     } else {
       LOG(ERROR) << "chunk_idx >= tracking_data_.size()";
-      return std::make_pair(nullptr, false);
+      return nullptr;
     }
   } else {
-    std::unique_ptr<TrackingDataChunk> chunk_data(
-        ReadChunkFromCache(id, checkpoint, chunk_idx));
-    return std::make_pair(chunk_data.release(), true);
+    return ReadChunkFromCache(id, checkpoint, chunk_idx);
   }
 }
 
-std::unique_ptr<TrackingDataChunk> BoxTracker::ReadChunkFromCache(
-    int id, int checkpoint, int chunk_idx) {
-  VLOG(1) << __FUNCTION__ << " id=" << id << " chunk_idx=" << chunk_idx;
-
+std::string BoxTracker::ChunkFile(int chunk_idx) const {
   auto format_runtime =
       absl::ParsedFormat<'d'>::New(options_.cache_file_format());
 
-  std::string chunk_file;
   if (format_runtime) {
-    chunk_file = cache_dir_ + "/" + absl::StrFormat(*format_runtime, chunk_idx);
+    return cache_dir_ + "/" + absl::StrFormat(*format_runtime, chunk_idx);
   } else {
     LOG(ERROR) << "chache_file_format wrong. fall back to chunk_%04d.";
-    chunk_file = cache_dir_ + "/" + absl::StrFormat("chunk_%04d", chunk_idx);
+    return cache_dir_ + "/" + absl::StrFormat("chunk_%04d", chunk_idx);
   }
+}
+
+BoxTracker::ChunkDataPtr BoxTracker::ReadChunkFromCache(int id, int checkpoint,
+                                                        int chunk_idx) {
+  VLOG(1) << __FUNCTION__ << " id=" << id << " chunk_idx=" << chunk_idx;
 
+  const std::string chunk_file = ChunkFile(chunk_idx);
   VLOG(1) << "Reading chunk from cache: " << chunk_file;
-  std::unique_ptr<TrackingDataChunk> chunk_data(new TrackingDataChunk());
 
   struct stat tmp;
   if (stat(chunk_file.c_str(), &tmp)) {
@@ -623,23 +713,29 @@ std::unique_ptr<TrackingDataChunk> BoxTracker::ReadChunkFromCache(
 
   VLOG(1) << "File exists, reading ...";
 
-  std::ifstream in(chunk_file, std::ios::in | std::ios::binary);
-  if (!in) {
+  // Packed tracking data (see packed_tracking_data.h) is tracked straight
+  // from the mapped file, serialized protos are parsed from it.
+  std::unique_ptr<MappedFile> mapped_file = MappedFile::Open(chunk_file);
+  if (!mapped_file) {
     LOG(ERROR) << "Could not read chunk file: " << chunk_file;
     return nullptr;
   }
 
-  std::string data;
-  in.seekg(0, std::ios::end);
-  data.resize(in.tellg());
-  in.seekg(0, std::ios::beg);
-  in.read(&data[0], data.size());
-  in.close();
-
-  chunk_data->ParseFromString(data);
+  const absl::string_view data = mapped_file->data();
+  if (IsPackedTrackingData(data)) {
+    PackedTrackingDataChunk packed_chunk;
+    if (!packed_chunk.Init(data)) {
+      LOG(ERROR) << "Could not read packed chunk file: " << chunk_file;
+      return nullptr;
+    }
+    VLOG(1) << "Read success";
+    return std::make_shared<ChunkData>(std::move(mapped_file), packed_chunk);
+  }
 
+  std::unique_ptr<TrackingDataChunk> chunk_data(new TrackingDataChunk());
+  chunk_data->ParseFromArray(data.data(), data.size());
   VLOG(1) << "Read success";
-  return chunk_data;
+  return std::make_shared<ChunkData>(chunk_data.release(), true);
 }
 
 bool BoxTracker::WaitForChunkFile(int id, int checkpoint,
@@ -686,42 +782,6 @@ bool BoxTracker::WaitForChunkFile(int id, int checkpoint,
   return file_exists;
 }
 
-int BoxTracker::ClosestFrameIndex(int64 msec,
-                                  const TrackingDataChunk& chunk) const {
-  CHECK_GT(chunk.item_size(), 0);
-  typedef TrackingDataChunk::Item Item;
-  Item item_to_find;
-  item_to_find.set_timestamp_usec(msec * 1000);
-  int pos =
-      std::lower_bound(chunk.item().begin(), chunk.item().end(), item_to_find,
-                       [](const Item& lhs, const Item& rhs) -> bool {
-                         return lhs.timestamp_usec() < rhs.timestamp_usec();
-                       }) -
-      chunk.item().begin();
-
-  // Skip end.
-  if (pos == chunk.item_size()) {
-    return pos - 1;
-  } else if (pos == 0) {
-    // Nothing smaller exists.
-    return 0;
-  }
-
-  // Determine closest timestamp.
-  const int64 lhs_diff = msec - chunk.item(pos - 1).timestamp_usec() / 1000;
-  const int64 rhs_diff = chunk.item(pos).timestamp_usec() / 1000 - msec;
-
-  if (std::min(lhs_diff, rhs_diff) >= 67) {
-    LOG(ERROR) << "No frame found within 67ms, probably using wrong chunk.";
-  }
-
-  if (lhs_diff < rhs_diff) {
-    return pos - 1;
-  } else {
-    return pos;
-  }
-}
-
 void BoxTracker::AddBoxResult(const TimedBox& box, int id, int checkpoint,
                               const MotionBoxState& state) {
   absl::MutexLock lock(&path_mutex_);
@@ -747,13 +807,13 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
   TrackStepOptions track_step_options = options_.track_step_options();
   ChangeTrackingDegreesBasedOnStartPos(a.start_state, &track_step_options);
   MotionBox motion_box(track_step_options);
-  const int chunk_data_size = a.chunk_data->item_size();
+  const int chunk_data_size = a.chunk_data->num_frames();
 
   CHECK_GE(a.start_frame, 0);
   CHECK_LT(a.start_frame, chunk_data_size);
 
   VLOG(1) << " a.start_frame = " << a.start_frame << " @"
-          << a.chunk_data->item(a.start_frame).timestamp_usec() << " with "
+          << a.chunk_data->timestamp_usec(a.start_frame) << " with "
           << chunk_data_size << " items";
   motion_box.ResetAtFrame(a.start_frame, a.start_state);
 
@@ -772,24 +832,22 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
     // Tracking from f to f + 1.
     for (int f = a.start_frame; f + 1 < chunk_data_size; ++f) {
       // Note: we use / 1000 instead of * 1000 to avoid overflow.
-      if (a.chunk_data->item(f + 1).timestamp_usec() / 1000 > a.max_msec) {
+      if (a.chunk_data->timestamp_usec(f + 1) / 1000 > a.max_msec) {
         VLOG(2) << "Reached maximum tracking timestamp @" << a.max_msec;
         break;
       }
       VLOG(1) << "Track forward from " << f;
       MotionVectorFrame mvf;
-      MotionVectorFrameFromTrackingData(
-          a.chunk_data->item(f + 1).tracking_data(), &mvf);
-      const int track_duration_ms =
-          TrackingDataDurationMs(a.chunk_data->item(f + 1));
+      a.chunk_data->GetMotionVectorFrame(f + 1, &mvf);
+      const int track_duration_ms = a.chunk_data->DurationMs(f + 1);
       if (track_duration_ms > 0) {
         mvf.duration_ms = track_duration_ms;
       }
 
       // If this is the first frame in a chunk, there might be an unobserved
       // chunk boundary at the first frame.
-      if (f == 0 && a.chunk_data->item(0).tracking_data().frame_flags() &
-                        TrackingData::FLAG_CHUNK_BOUNDARY) {
+      if (f == 0 &&
+          a.chunk_data->frame_flags(0) & TrackingData::FLAG_CHUNK_BOUNDARY) {
         mvf.is_chunk_boundary = true;
       }
 
@@ -814,16 +872,16 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
         TimedBox result;
         const MotionBoxState& result_state = motion_box.StateAtFrame(f + 1);
         TimedBoxFromMotionBoxState(result_state, &result);
-        result.time_msec = a.chunk_data->item(f + 1).timestamp_usec() / 1000;
+        result.time_msec = a.chunk_data->timestamp_usec(f + 1) / 1000;
         AddBoxResult(result, a.id, a.checkpoint, result_state);
       }
 
       if (f + 2 == chunk_data_size && !a.chunk_data->last_chunk()) {
         // Last frame, successful track, continue;
-        AugmentedChunkPtr next_chunk(
-            ReadChunk(a.id, a.checkpoint, a.chunk_idx + 1));
+        ChunkDataPtr next_chunk =
+            ReadChunk(a.id, a.checkpoint, a.chunk_idx + 1);
 
-        if (next_chunk.first != nullptr) {
+        if (next_chunk != nullptr) {
           TrackingImplArgs next_args(next_chunk, motion_box.StateAtFrame(f + 1),
                                      0, a.chunk_idx + 1, a.id, a.checkpoint,
                                      a.forward, false, a.min_msec, a.max_msec);
@@ -841,16 +899,14 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
     const int first_frame = a.chunk_data->first_chunk() ? 1 : 0;
 
     for (int f = a.start_frame; f >= first_frame; --f) {
-      if (a.chunk_data->item(f).timestamp_usec() / 1000 < a.min_msec) {
+      if (a.chunk_data->timestamp_usec(f) / 1000 < a.min_msec) {
         VLOG(2) << "Reached minimum tracking timestamp @" << a.min_msec;
         break;
       }
       VLOG(1) << "Track backward from " << f;
       MotionVectorFrame mvf;
-      MotionVectorFrameFromTrackingData(a.chunk_data->item(f).tracking_data(),
-                                        &mvf);
-      const int64 track_duration_ms =
-          TrackingDataDurationMs(a.chunk_data->item(f));
+      a.chunk_data->GetMotionVectorFrame(f, &mvf);
+      const int64 track_duration_ms = a.chunk_data->DurationMs(f);
       if (track_duration_ms > 0) {
         mvf.duration_ms = track_duration_ms;
       }
@@ -872,7 +928,7 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
         TimedBox result;
         const MotionBoxState& result_state = motion_box.StateAtFrame(f - 1);
         TimedBoxFromMotionBoxState(result_state, &result);
-        result.time_msec = a.chunk_data->item(f).prev_timestamp_usec() / 1000;
+        result.time_msec = a.chunk_data->prev_timestamp_usec(f) / 1000;
         AddBoxResult(result, a.id, a.checkpoint, result_state);
       }
 
@@ -880,10 +936,10 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
         VLOG(1) << "Read next chunk: " << f << "==" << first_frame << " in "
                 << a.chunk_idx;
         // First frame, successful track, continue.
-        AugmentedChunkPtr prev_chunk(
-            ReadChunk(a.id, a.checkpoint, a.chunk_idx - 1));
-        if (prev_chunk.first != nullptr) {
-          const int last_frame = prev_chunk.first->item_size() - 1;
+        ChunkDataPtr prev_chunk =
+            ReadChunk(a.id, a.checkpoint, a.chunk_idx - 1);
+        if (prev_chunk != nullptr) {
+          const int last_frame = prev_chunk->num_frames() - 1;
           TrackingImplArgs prev_args(prev_chunk, motion_box.StateAtFrame(f - 1),
                                      last_frame, a.chunk_idx - 1, a.id,
                                      a.checkpoint, a.forward, false, a.min_msec,
@@ -894,7 +950,7 @@ void BoxTracker::TrackingImpl(const TrackingImplArgs& a) {
           cleanup_func();
           LOG(ERROR) << "Can't read expected chunk file! " << a.chunk_idx - 1
                      << " while tracking @"
-                     << a.chunk_data->item(f).timestamp_usec() / 1000
+                     << a.chunk_data->timestamp_usec(f) / 1000
                      << " with cutoff " << a.min_msec;
           return;
         }
@@ -1035,26 +1091,21 @@ bool BoxTracker::GetTrackingData(int id, int64 request_time_msec,
 
   int chunk_idx = ChunkIdxFromTime(request_time_msec);
 
-  AugmentedChunkPtr tracking_chunk(ReadChunk(id, kInitCheckpoint, chunk_idx));
-  if (!tracking_chunk.first) {
+  // Packed chunks are only mapped, which decodes just the requested frame.
+  ChunkDataPtr tracking_chunk = ReadChunk(id, kInitCheckpoint, chunk_idx);
+  if (!tracking_chunk) {
     absl::MutexLock lock(&status_mutex_);
     --track_status_[id][kInitCheckpoint].tracks_ongoing;
     LOG(ERROR) << "Could not read tracking chunk from file.";
     return false;
   }
 
-  std::unique_ptr<const TrackingDataChunk> owned_chunk;
-  if (tracking_chunk.second) {
-    owned_chunk.reset(tracking_chunk.first);
-  }
-
   const int closest_frame =
-      ClosestFrameIndex(request_time_msec, *tracking_chunk.first);
+      tracking_chunk->ClosestFrameIndex(request_time_msec);
 
-  *tracking_data = tracking_chunk.first->item(closest_frame).tracking_data();
+  tracking_chunk->GetTrackingData(closest_frame, tracking_data);
   if (tracking_data_msec) {
-    *tracking_data_msec =
-        tracking_chunk.first->item(closest_frame).timestamp_usec() / 1000;
+    *tracking_data_msec = tracking_chunk->timestamp_usec(closest_frame) / 1000;
   }
   return true;
 }
@@ -18,6 +18,7 @@
 #include <inttypes.h>
 
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -26,6 +27,7 @@
 #include "mediapipe/framework/port/threadpool.h"
 #include "mediapipe/util/tracking/box_tracker.pb.h"
 #include "mediapipe/util/tracking/flow_packager.pb.h"
+#include "mediapipe/util/tracking/packed_tracking_data.h"
 #include "mediapipe/util/tracking/tracking.h"
 #include "mediapipe/util/tracking/tracking.pb.h"
 
@@ -216,7 +218,8 @@ class BoxTracker {
 
   // Debug function to obtain raw TrackingData closest to the specified
   // timestamp. This call will read from disk on every invocation so it is
-  // expensive.
+  // expensive, unless the caching directory holds packed tracking data, in
+  // which case only the requested frame is decoded.
   // To not interfere with other tracking requests it is recommended that you
   // use a unique id here.
   // Returns true on success.
@@ -230,40 +233,78 @@ class BoxTracker {
   void NewBoxTrackAsync(const TimedBox& initial_pos, int id, int64 min_msec,
                         int64 max_msec);
 
-  typedef std::pair<const TrackingDataChunk*, bool> AugmentedChunkPtr;
+  // Read-only tracking data of a single chunk. Backed either by a
+  // TrackingDataChunk, or by packed tracking data mapped from the caching
+  // directory, in which case frames are read straight from the mapping and
+  // never decoded to TrackingData.
+  class ChunkData {
+   public:
+    // Wraps chunk, taking ownership if owned is set.
+    ChunkData(const TrackingDataChunk* chunk, bool owned);
+    // Wraps packed_chunk, which views data of mapped_file.
+    ChunkData(std::unique_ptr<MappedFile> mapped_file,
+              const PackedTrackingDataChunk& packed_chunk);
+
+    int num_frames() const;
+    bool first_chunk() const;
+    bool last_chunk() const;
+
+    int64 timestamp_usec(int f) const;
+    int64 prev_timestamp_usec(int f) const;
+    int frame_flags(int f) const;
+
+    // Returns duration covered by the tracking data of frame f.
+    float DurationMs(int f) const {
+      return (timestamp_usec(f) - prev_timestamp_usec(f)) * 1e-3f;
+    }
+
+    // Returns index of the frame closest to msec.
+    int ClosestFrameIndex(int64 msec) const;
+
+    void GetMotionVectorFrame(int f, MotionVectorFrame* mvf) const;
+    void GetTrackingData(int f, TrackingData* tracking_data) const;
+
+   private:
+    std::unique_ptr<const TrackingDataChunk> owned_chunk_;
+    const TrackingDataChunk* chunk_ = nullptr;
+    std::unique_ptr<MappedFile> mapped_file_;
+    PackedTrackingDataChunk packed_chunk_;
+  };
+
+  // Chunks are read-only and shared by forward and backward tracking.
+  typedef std::shared_ptr<const ChunkData> ChunkDataPtr;
+
   // Attempts to read chunk at chunk_idx if it exists. Reads from cache
-  // directory or from in memory cache.
-  // Important: 2nd part of return value indicates if returned tracking data
-  // will be owned by the caller (if true). In that case caller is responsible
-  // for releasing the returned chunk.
-  AugmentedChunkPtr ReadChunk(int id, int checkpoint, int chunk_idx);
-
-  // Attempts to read specified chunk from caching directory. Blocks and waits
-  // until chunk is available or internal time out is reached.
+  // directory or from in memory cache. Returns nullptr on failure.
+  ChunkDataPtr ReadChunk(int id, int checkpoint, int chunk_idx);
+
+  // Returns path of the chunk file at chunk_idx within the caching directory.
+  std::string ChunkFile(int chunk_idx) const;
+
+  // Attempts to read specified chunk from caching directory, either stored as
+  // serialized TrackingDataChunk or as packed tracking data, which is only
+  // mapped. Blocks and waits until chunk is available or internal time out is
+  // reached.
   // Returns nullptr if data could not be read.
-  std::unique_ptr<TrackingDataChunk> ReadChunkFromCache(int id, int checkpoint,
-                                                        int chunk_idx);
+  ChunkDataPtr ReadChunkFromCache(int id, int checkpoint, int chunk_idx);
 
   // Waits with timeout for chunkfile to become available. Returns true on
   // success, false if waited till timeout or when canceled.
   bool WaitForChunkFile(int id, int checkpoint, const std::string& chunk_file)
       ABSL_LOCKS_EXCLUDED(status_mutex_);
 
-  // Determines closest index in passed TrackingDataChunk
-  int ClosestFrameIndex(int64 msec, const TrackingDataChunk& chunk) const;
-
   // Adds new TimedBox to specified checkpoint with state.
   void AddBoxResult(const TimedBox& box, int id, int checkpoint,
                     const MotionBoxState& state);
 
   // Callback can only handle 5 args max.
-  // Set own_data to true for args to assume ownership.
   struct TrackingImplArgs {
-    TrackingImplArgs(AugmentedChunkPtr chunk_ptr,
+    TrackingImplArgs(ChunkDataPtr chunk_data_,
                      const MotionBoxState& start_state_, int start_frame_,
                      int chunk_idx_, int id_, int checkpoint_, bool forward_,
                      bool first_call_, int64 min_msec_, int64 max_msec_)
-        : start_state(start_state_),
+        : chunk_data(std::move(chunk_data_)),
+          start_state(start_state_),
           start_frame(start_frame_),
           chunk_idx(chunk_idx_),
           id(id_),
@@ -271,22 +312,12 @@ class BoxTracker {
           forward(forward_),
           first_call(first_call_),
           min_msec(min_msec_),
-          max_msec(max_msec_) {
-      if (chunk_ptr.second) {
-        chunk_data_buffer.reset(chunk_ptr.first);
-      }
-
-      chunk_data = chunk_ptr.first;
-    }
+          max_msec(max_msec_) {}
 
     TrackingImplArgs(const TrackingImplArgs&) = default;
 
-    // Storage for tracking data.
-    std::shared_ptr<const TrackingDataChunk> chunk_data_buffer;
-
-    // Pointer to the actual tracking data. Usually points to the buffer
-    // but can also point to external data for performance reasons.
-    const TrackingDataChunk* chunk_data;
+    // Tracking data of the current chunk.
+    ChunkDataPtr chunk_data;
 
     MotionBoxState start_state;
     int start_frame;
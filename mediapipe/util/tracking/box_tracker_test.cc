@@ -14,8 +14,15 @@
 
 #include "mediapipe/util/tracking/box_tracker.h"
 
+#include <cstdlib>
+
+#include "absl/strings/str_cat.h"
 #include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/util/tracking/flow_packager.pb.h"
+#include "mediapipe/util/tracking/packed_tracking_data.h"
 
 namespace mediapipe {
 namespace {
@@ -23,11 +30,13 @@ namespace {
 constexpr double kWidth = 1280.0;
 constexpr double kHeight = 720.0;
 
-// Ground truth test; testing tracking accuracy and multi-thread load testing.
-TEST(BoxTrackerTest, MovingBoxTest) {
-  const std::string cache_dir =
-      file::JoinPath("./", "/mediapipe/util/tracking/testdata/box_tracker");
-  BoxTracker box_tracker(cache_dir, BoxTrackerOptions());
+constexpr char kCacheDir[] = "/mediapipe/util/tracking/testdata/box_tracker";
+constexpr int kNumChunks = 7;
+
+// Tracks the overlay in the test video and compares against ground truth;
+// also exercises multi-thread load testing.
+void ExpectTracksMovingBox(BoxTracker* box_tracker_ptr) {
+  BoxTracker& box_tracker = *box_tracker_ptr;
 
   // Ground truth positions of the overlay (linear in between).
   // @ 0:     (50, 100)
@@ -112,6 +121,34 @@ TEST(BoxTrackerTest, MovingBoxTest) {
   }
 }
 
+// Ground truth test; testing tracking accuracy and multi-thread load testing.
+TEST(BoxTrackerTest, MovingBoxTest) {
+  BoxTracker box_tracker(file::JoinPath("./", kCacheDir), BoxTrackerOptions());
+  ExpectTracksMovingBox(&box_tracker);
+}
+
+// Same as above with the cache converted to the packed format, which is
+// memory mapped instead of parsed.
+TEST(BoxTrackerTest, MovingBoxTestPackedCache) {
+  const std::string packed_dir =
+      file::JoinPath(std::getenv("TEST_TMPDIR"), "packed_box_tracker");
+  MP_ASSERT_OK(file::RecursivelyCreateDir(packed_dir));
+  for (int k = 0; k < kNumChunks; ++k) {
+    const std::string chunk_file = absl::StrCat("chunk_000", k);
+    std::string data;
+    MP_ASSERT_OK(file::GetContents(
+        file::JoinPath("./", kCacheDir, chunk_file), &data));
+    TrackingDataChunk chunk;
+    ASSERT_TRUE(chunk.ParseFromString(data));
+    PackTrackingDataChunk(chunk, &data);
+    MP_ASSERT_OK(
+        file::SetContents(file::JoinPath(packed_dir, chunk_file), data));
+  }
+
+  BoxTracker box_tracker(packed_dir, BoxTrackerOptions());
+  ExpectTracksMovingBox(&box_tracker);
+}
+
 }  // namespace
 
 }  // namespace mediapipe
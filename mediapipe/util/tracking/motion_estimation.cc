@@ -37,6 +37,7 @@
 #include "mediapipe/util/tracking/measure_time.h"
 #include "mediapipe/util/tracking/motion_models.h"
 #include "mediapipe/util/tracking/motion_models.pb.h"
+#include "mediapipe/util/tracking/packed_region_flow.h"
 #include "mediapipe/util/tracking/parallel_invoker.h"
 #include "mediapipe/util/tracking/region_flow.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
@@ -3346,6 +3347,119 @@ LinearSimilarityModel LinearSimilarityL2SolveSystem(
   return LinearSimilarityModel();
 }
 
+// Packed counterparts of the IRLS loops in EstimateLinearSimilarityModelIRLS,
+// EstimateAffineModelIRLS and EstimateHomographyIRLS, used if
+// MotionEstimationOptions::irls_use_packed_features is set. Features are
+// packed once, each round reduces to a product of the precomputed monomials
+// with the current weights. Updated irls weights are written back to
+// feature_list, also in case of failure. Returns false if a system could not
+// be solved for.
+template <class T>
+bool LinearSimilarityPackedIRLS(int irls_rounds,
+                                const LinearSimilarityModel& irls_transform,
+                                float irls_residual_scale,
+                                bool irls_use_l0_norm,
+                                const std::vector<float>* irls_priors,
+                                const std::vector<float>* irls_alphas,
+                                RegionFlowFeatureList* feature_list,
+                                LinearSimilarityModel* solved_model) {
+  PackedRegionFlowFeatures packed(*feature_list);
+  const FeatureMonomials<T> monomials(packed);
+  Eigen::ArrayXf residuals;
+  bool success = true;
+  for (int i = 0; i < irls_rounds && success; ++i) {
+    success = SolveLinearSimilarity<T>(
+        monomials.WeightedMoments(packed.irls_weights()), solved_model);
+    if (success) {
+      LinearSimilarityResiduals(packed, *solved_model, irls_transform,
+                                &residuals);
+      UpdateIRLSWeights(residuals, irls_residual_scale, irls_use_l0_norm,
+                        kIrlsEps,
+                        irls_alphas != nullptr ? (*irls_alphas)[i] : 0.0f,
+                        irls_priors, packed.mutable_irls_weights());
+    }
+  }
+  packed.CopyIRLSWeightsTo(feature_list);
+  return success;
+}
+
+bool AffinePackedIRLS(int irls_rounds,
+                      const LinearSimilarityModel& irls_transform,
+                      RegionFlowFeatureList* feature_list,
+                      AffineModel* solved_model) {
+  PackedRegionFlowFeatures packed(*feature_list);
+  const FeatureMonomials<double> monomials(packed);
+  Eigen::ArrayXf& weights = *packed.mutable_irls_weights();
+  Eigen::ArrayXf residuals;
+  // Same as EstimateAffineModelIRLS, the normal equations are accumulated
+  // across rounds.
+  FeatureMonomials<double>::Moments moments =
+      FeatureMonomials<double>::Moments::Zero();
+  bool success = true;
+  for (int i = 0; i < irls_rounds && success; ++i) {
+    // Rows of the affine system are scaled by the weights.
+    moments += monomials.WeightedMoments(weights.square());
+    success = SolveAffine<double>(moments, solved_model);
+    if (success) {
+      AffineResiduals(packed, *solved_model, irls_transform, &residuals);
+      weights = (weights == 0.0f)
+                    .select(0.0f, (residuals + kIrlsEps).inverse().sqrt());
+    }
+  }
+  packed.CopyIRLSWeightsTo(feature_list);
+  return success;
+}
+
+// Template class T specifies the accuracy of the normal equations and is
+// ignored if use_exact_estimation is set.
+template <class T>
+bool HomographyPackedIRLS(int irls_rounds, bool use_exact_estimation,
+                          bool exact_denominator_scaling,
+                          float perspective_regularizer,
+                          const LinearSimilarityModel& irls_transform,
+                          float irls_residual_scale, bool irls_use_l0_norm,
+                          const std::vector<float>* irls_priors,
+                          const std::vector<float>* irls_alphas,
+                          RegionFlowFeatureList* feature_list,
+                          Homography* norm_model) {
+  PackedRegionFlowFeatures packed(*feature_list);
+  std::unique_ptr<FeatureMonomials<T>> monomials;
+  if (!use_exact_estimation) {
+    monomials.reset(new FeatureMonomials<T>(packed));
+  }
+
+  Eigen::ArrayXf scale;
+  Eigen::ArrayXf residuals;
+  bool success = true;
+  for (int r = 0; r < irls_rounds && success; ++r) {
+    const Eigen::ArrayXf* weights = &packed.irls_weights();
+    Eigen::ArrayXf scaled_weights;
+    if (exact_denominator_scaling) {
+      HomographyDenominatorScale(packed, *norm_model, &scale);
+      scaled_weights = packed.irls_weights() * scale;
+      weights = &scaled_weights;
+    }
+
+    if (use_exact_estimation) {
+      success = SolveHomographyExact(packed, *weights, perspective_regularizer,
+                                     norm_model);
+    } else {
+      success = SolveHomography<T>(monomials->WeightedMoments(*weights),
+                                   perspective_regularizer, norm_model);
+    }
+
+    if (success) {
+      HomographyResiduals(packed, *norm_model, irls_transform, &residuals);
+      UpdateIRLSWeights(residuals, irls_residual_scale, irls_use_l0_norm,
+                        kIrlsEps,
+                        irls_alphas != nullptr ? (*irls_alphas)[r] : 0.0f,
+                        irls_priors, packed.mutable_irls_weights());
+    }
+  }
+  packed.CopyIRLSWeightsTo(feature_list);
+  return success;
+}
+
 }  // namespace.
 
 bool MotionEstimation::GetSimilarityIrlsInitialization(
@@ -3562,6 +3676,28 @@ bool MotionEstimation::EstimateLinearSimilarityModelIRLS(
     irls_alphas = &prior_weights->alphas;
   }
 
+  if (options_.irls_use_packed_features()) {
+    bool success;
+    if (options_.use_highest_accuracy_for_normal_equations()) {
+      success = LinearSimilarityPackedIRLS<double>(
+          irls_rounds, irls_transform_, irls_residual_scale, irls_use_l0_norm,
+          irls_priors, irls_alphas, flow_feature_list, solved_model);
+    } else {
+      success = LinearSimilarityPackedIRLS<float>(
+          irls_rounds, irls_transform_, irls_residual_scale, irls_use_l0_norm,
+          irls_priors, irls_alphas, flow_feature_list, solved_model);
+    }
+
+    if (!success) {
+      VLOG(1) << "Linear similarity estimation failed.";
+      *camera_motion->mutable_linear_similarity() = LinearSimilarityModel();
+      camera_motion->set_flags(camera_motion->flags() |
+                               CameraMotion::FLAG_SINGULAR_ESTIMATION);
+      return false;
+    }
+    irls_rounds = 0;  // All rounds performed above.
+  }
+
   for (int i = 0; i < irls_rounds; ++i) {
     bool success;
     if (options_.use_highest_accuracy_for_normal_equations()) {
@@ -3648,6 +3784,16 @@ bool MotionEstimation::EstimateAffineModelIRLS(
 
   AffineModel* solved_model = camera_motion->mutable_affine();
 
+  if (options_.irls_use_packed_features()) {
+    if (!AffinePackedIRLS(irls_rounds, irls_transform_, feature_list,
+                          solved_model)) {
+      camera_motion->set_flags(camera_motion->flags() |
+                               CameraMotion::FLAG_SINGULAR_ESTIMATION);
+      return false;
+    }
+    irls_rounds = 0;  // All rounds performed above.
+  }
+
   // Multiple rounds of weighting based L2 optimization.
   for (int i = 0; i < irls_rounds; ++i) {
     // Build Jacobians.
@@ -4941,6 +5087,34 @@ bool MotionEstimation::EstimateHomographyIRLS(
     prev_solution = &norm_model;
   }
 
+  if (options_.irls_use_packed_features()) {
+    bool success;
+    if (options_.use_exact_homography_estimation() ||
+        options_.use_highest_accuracy_for_normal_equations()) {
+      success = HomographyPackedIRLS<double>(
+          irls_rounds, options_.use_exact_homography_estimation(),
+          options_.homography_exact_denominator_scaling(),
+          options_.homography_perspective_regularizer(), irls_transform_,
+          irls_residual_scale, irls_use_l0_norm, irls_priors, irls_alphas,
+          feature_list, &norm_model);
+    } else {
+      success = HomographyPackedIRLS<float>(
+          irls_rounds, false, options_.homography_exact_denominator_scaling(),
+          options_.homography_perspective_regularizer(), irls_transform_,
+          irls_residual_scale, irls_use_l0_norm, irls_priors, irls_alphas,
+          feature_list, &norm_model);
+    }
+
+    if (!success) {
+      VLOG(1) << "Could not solve for homography.";
+      *camera_motion->mutable_homography() = Homography();
+      camera_motion->set_flags(camera_motion->flags() |
+                               CameraMotion::FLAG_SINGULAR_ESTIMATION);
+      return false;
+    }
+    irls_rounds = 0;  // All rounds performed above.
+  }
+
   for (int r = 0; r < irls_rounds; ++r) {
     if (options_.use_exact_homography_estimation()) {
       bool success = false;
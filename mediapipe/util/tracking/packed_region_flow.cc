@@ -0,0 +1,489 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/packed_region_flow.h"
+
+#include <cmath>
+
+#include "Eigen/Dense"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/util/tracking/motion_models.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Same tolerances as used by the proto based solvers in motion_estimation.cc.
+constexpr float kMaxCondition = 1e30f;
+constexpr float kPrecision = 0.1f;
+
+// View on every second element of a column, starting at data.
+typedef Eigen::Map<Eigen::ArrayXf, 0, Eigen::InnerStride<2>> InterleavedRows;
+
+// Applies the linear similarity transform to the points (x, y) component-wise.
+template <class X, class Y>
+void TransformPoints(const LinearSimilarityModel& model, const X& x,
+                     const Y& y, Eigen::ArrayXf* out_x,
+                     Eigen::ArrayXf* out_y) {
+  *out_x = model.a() * x - model.b() * y + model.dx();
+  *out_y = model.b() * x + model.a() * y + model.dy();
+}
+
+}  // namespace.
+
+PackedRegionFlowFeatures::PackedRegionFlowFeatures(
+    const RegionFlowFeatureList& feature_list) {
+  const int num_features = feature_list.feature_size();
+  x_.resize(num_features);
+  y_.resize(num_features);
+  dx_.resize(num_features);
+  dy_.resize(num_features);
+  irls_weights_.resize(num_features);
+
+  for (int i = 0; i < num_features; ++i) {
+    const RegionFlowFeature& feature = feature_list.feature(i);
+    x_[i] = feature.x();
+    y_[i] = feature.y();
+    dx_[i] = feature.dx();
+    dy_[i] = feature.dy();
+    irls_weights_[i] = feature.irls_weight();
+  }
+
+  match_x_ = x_ + dx_;
+  match_y_ = y_ + dy_;
+}
+
+void PackedRegionFlowFeatures::CopyIRLSWeightsTo(
+    RegionFlowFeatureList* feature_list) const {
+  CHECK(feature_list != nullptr);
+  CHECK_EQ(feature_list->feature_size(), size());
+  for (int i = 0; i < size(); ++i) {
+    feature_list->mutable_feature(i)->set_irls_weight(irls_weights_[i]);
+  }
+}
+
+template <class T>
+FeatureMonomials<T>::FeatureMonomials(
+    const PackedRegionFlowFeatures& features) {
+  typedef Eigen::Array<T, Eigen::Dynamic, 1> ArrayT;
+  const ArrayT x = features.x().template cast<T>();
+  const ArrayT y = features.y().template cast<T>();
+  const ArrayT dx = features.dx().template cast<T>();
+  const ArrayT dy = features.dy().template cast<T>();
+  const ArrayT mx = features.match_x().template cast<T>();
+  const ArrayT my = features.match_y().template cast<T>();
+  const ArrayT xx = x * x;
+  const ArrayT xy = x * y;
+  const ArrayT yy = y * y;
+  const ArrayT m2 = mx * mx + my * my;
+
+  monomials_.resize(features.size(), NUM_FEATURE_MONOMIALS);
+  auto col = [this](FeatureMonomial monomial) {
+    return monomials_.col(monomial).array();
+  };
+
+  col(MONOMIAL_1).setOnes();
+  col(MONOMIAL_X) = x;
+  col(MONOMIAL_Y) = y;
+  col(MONOMIAL_XX) = xx;
+  col(MONOMIAL_XY) = xy;
+  col(MONOMIAL_YY) = yy;
+  col(MONOMIAL_DX) = dx;
+  col(MONOMIAL_DY) = dy;
+  col(MONOMIAL_X_DX) = x * dx;
+  col(MONOMIAL_Y_DX) = y * dx;
+  col(MONOMIAL_X_DY) = x * dy;
+  col(MONOMIAL_Y_DY) = y * dy;
+  col(MONOMIAL_MX) = mx;
+  col(MONOMIAL_MY) = my;
+  col(MONOMIAL_X_MX) = x * mx;
+  col(MONOMIAL_Y_MX) = y * mx;
+  col(MONOMIAL_X_MY) = x * my;
+  col(MONOMIAL_Y_MY) = y * my;
+  col(MONOMIAL_XX_MX) = xx * mx;
+  col(MONOMIAL_XY_MX) = xy * mx;
+  col(MONOMIAL_YY_MX) = yy * mx;
+  col(MONOMIAL_XX_MY) = xx * my;
+  col(MONOMIAL_XY_MY) = xy * my;
+  col(MONOMIAL_YY_MY) = yy * my;
+  col(MONOMIAL_X_M2) = x * m2;
+  col(MONOMIAL_Y_M2) = y * m2;
+  col(MONOMIAL_XX_M2) = xx * m2;
+  col(MONOMIAL_XY_M2) = xy * m2;
+  col(MONOMIAL_YY_M2) = yy * m2;
+}
+
+template <class T>
+typename FeatureMonomials<T>::Moments FeatureMonomials<T>::WeightedMoments(
+    const Eigen::ArrayXf& weights) const {
+  CHECK_EQ(weights.size(), monomials_.rows());
+  return monomials_.transpose() * weights.cast<T>().matrix();
+}
+
+template <class T>
+typename FeatureMonomials<T>::MomentsBatch
+FeatureMonomials<T>::WeightedMomentsBatch(
+    const Eigen::MatrixXf& weights) const {
+  CHECK_EQ(weights.rows(), monomials_.rows());
+  return monomials_.transpose() * weights.cast<T>();
+}
+
+template <class T>
+bool SolveLinearSimilarity(
+    const typename FeatureMonomials<T>::Moments& moments,
+    LinearSimilarityModel* model) {
+  CHECK(model != nullptr);
+  const T w = moments(MONOMIAL_1);
+  const T x_w = moments(MONOMIAL_X);
+  const T y_w = moments(MONOMIAL_Y);
+  const T xx_yy_w = moments(MONOMIAL_XX) + moments(MONOMIAL_YY);
+
+  // J = {1, 0, x,  -y,
+  //      0, 1, y,   x}, see LinearSimilarityL2SolveSystem.
+  Eigen::Matrix<T, 4, 4> matrix;
+  matrix << w, 0, x_w, -y_w,  //
+      0, w, y_w, x_w,         //
+      x_w, y_w, xx_yy_w, 0,   //
+      -y_w, x_w, 0, xx_yy_w;
+
+  // Using identity parametrization.
+  Eigen::Matrix<T, 4, 1> rhs;
+  rhs << moments(MONOMIAL_DX), moments(MONOMIAL_DY),
+      moments(MONOMIAL_X_DX) + moments(MONOMIAL_Y_DY),
+      moments(MONOMIAL_X_DY) - moments(MONOMIAL_Y_DX);
+
+  const Eigen::Matrix<T, 4, 1> solution =
+      matrix.colPivHouseholderQr().solve(rhs);
+  if (!(matrix * solution).isApprox(rhs, kPrecision)) {
+    return false;
+  }
+
+  model->set_dx(solution(0));
+  model->set_dy(solution(1));
+  model->set_a(solution(2) + 1.0);
+  model->set_b(solution(3));
+  return true;
+}
+
+template <class T>
+bool SolveAffine(const typename FeatureMonomials<T>::Moments& moments,
+                 AffineModel* model) {
+  CHECK(model != nullptr);
+  const T w = moments(MONOMIAL_1);
+  const T x = moments(MONOMIAL_X);
+  const T y = moments(MONOMIAL_Y);
+  const T xx = moments(MONOMIAL_XX);
+  const T xy = moments(MONOMIAL_XY);
+  const T yy = moments(MONOMIAL_YY);
+
+  // J = {1, 0, x, y, 0, 0,
+  //      0, 1, 0, 0, x, y}, see EstimateAffineModelIRLS.
+  Eigen::Matrix<T, 6, 6> matrix;
+  matrix << w, 0, x, y, 0, 0,  //
+      0, w, 0, 0, x, y,        //
+      x, 0, xx, xy, 0, 0,      //
+      y, 0, xy, yy, 0, 0,      //
+      0, x, 0, 0, xx, xy,      //
+      0, y, 0, 0, xy, yy;
+
+  Eigen::Matrix<T, 6, 1> rhs;
+  rhs << moments(MONOMIAL_MX), moments(MONOMIAL_MY), moments(MONOMIAL_X_MX),
+      moments(MONOMIAL_Y_MX), moments(MONOMIAL_X_MY), moments(MONOMIAL_Y_MY);
+
+  const Eigen::Matrix<T, 6, 1> solution =
+      matrix.colPivHouseholderQr().solve(rhs);
+  if (!(matrix * solution).isApprox(rhs, kPrecision)) {
+    return false;
+  }
+
+  model->set_dx(solution(0));
+  model->set_dy(solution(1));
+  model->set_a(solution(2));
+  model->set_b(solution(3));
+  model->set_c(solution(4));
+  model->set_d(solution(5));
+  return true;
+}
+
+template <class T>
+bool SolveHomography(const typename FeatureMonomials<T>::Moments& moments,
+                     float perspective_regularizer, Homography* model) {
+  CHECK(model != nullptr);
+  const T w = moments(MONOMIAL_1);
+  const T x = moments(MONOMIAL_X);
+  const T y = moments(MONOMIAL_Y);
+  const T xx = moments(MONOMIAL_XX);
+  const T xy = moments(MONOMIAL_XY);
+  const T yy = moments(MONOMIAL_YY);
+  const T x_mx = moments(MONOMIAL_X_MX);
+  const T y_mx = moments(MONOMIAL_Y_MX);
+  const T x_my = moments(MONOMIAL_X_MY);
+  const T y_my = moments(MONOMIAL_Y_MY);
+  const T xx_mx = moments(MONOMIAL_XX_MX);
+  const T xy_mx = moments(MONOMIAL_XY_MX);
+  const T yy_mx = moments(MONOMIAL_YY_MX);
+  const T xx_my = moments(MONOMIAL_XX_MY);
+  const T xy_my = moments(MONOMIAL_XY_MY);
+  const T yy_my = moments(MONOMIAL_YY_MY);
+  const T xx_m2 = moments(MONOMIAL_XX_M2);
+  const T xy_m2 = moments(MONOMIAL_XY_M2);
+  const T yy_m2 = moments(MONOMIAL_YY_M2);
+
+  // J = {x, y, 1,  0,  0,   0, -x * mx, -y * mx,
+  //      0, 0, 0,  x,  y,   1, -x * my, -y * my},
+  // see HomographyL2NormalEquationSolve.
+  Eigen::Matrix<T, 8, 8> matrix;
+  matrix << xx, xy, x, 0, 0, 0, -xx_mx, -xy_mx,                //
+      xy, yy, y, 0, 0, 0, -xy_mx, -yy_mx,                      //
+      x, y, w, 0, 0, 0, -x_mx, -y_mx,                          //
+      0, 0, 0, xx, xy, x, -xx_my, -xy_my,                      //
+      0, 0, 0, xy, yy, y, -xy_my, -yy_my,                      //
+      0, 0, 0, x, y, w, -x_my, -y_my,                          //
+      -xx_mx, -xy_mx, -x_mx, -xx_my, -xy_my, -x_my, xx_m2, xy_m2,  //
+      -xy_mx, -yy_mx, -y_mx, -xy_my, -yy_my, -y_my, xy_m2, yy_m2;
+
+  Eigen::Matrix<T, 8, 1> rhs;
+  rhs << x_mx, y_mx, moments(MONOMIAL_MX), x_my, y_my, moments(MONOMIAL_MY),
+      -moments(MONOMIAL_X_M2), -moments(MONOMIAL_Y_M2);
+
+  if (perspective_regularizer > 0) {
+    // C = {0, 0, 0, 0, 0, 0, r, r}, add C^t * C.
+    const T sq_r = perspective_regularizer * perspective_regularizer;
+    matrix.template bottomRightCorner<2, 2>().array() += sq_r;
+  }
+
+  const Eigen::Matrix<T, 8, 1> solution =
+      matrix.colPivHouseholderQr().solve(rhs);
+  if (!(matrix * solution).isApprox(rhs, kPrecision)) {
+    return false;
+  }
+
+  model->set_h_00(solution(0));
+  model->set_h_01(solution(1));
+  model->set_h_02(solution(2));
+  model->set_h_10(solution(3));
+  model->set_h_11(solution(4));
+  model->set_h_12(solution(5));
+  model->set_h_20(solution(6));
+  model->set_h_21(solution(7));
+  return true;
+}
+
+bool SolveHomographyExact(const PackedRegionFlowFeatures& features,
+                          const Eigen::ArrayXf& weights,
+                          float perspective_regularizer, Homography* model) {
+  CHECK(model != nullptr);
+  const int num_features = features.size();
+  CHECK_EQ(weights.size(), num_features);
+  if (weights.cast<double>().sum() > kMaxCondition) {
+    return false;
+  }
+
+  const int num_rows =
+      2 * num_features + (perspective_regularizer == 0 ? 0 : 1);
+  Eigen::Matrix<float, Eigen::Dynamic, 8> matrix =
+      Eigen::Matrix<float, Eigen::Dynamic, 8>::Zero(num_rows, 8);
+  Eigen::VectorXf rhs = Eigen::VectorXf::Zero(num_rows);
+
+  // Rows 2 * i and 2 * i + 1 hold the Jacobian of the i'th feature, each
+  // column is filled at once.
+  auto even_rows = [&matrix, num_features](int col) {
+    return InterleavedRows(matrix.col(col).data(), num_features);
+  };
+  auto odd_rows = [&matrix, num_features](int col) {
+    return InterleavedRows(matrix.col(col).data() + 1, num_features);
+  };
+
+  const Eigen::ArrayXf x_w = features.x() * weights;
+  const Eigen::ArrayXf y_w = features.y() * weights;
+  even_rows(0) = x_w;
+  even_rows(1) = y_w;
+  even_rows(2) = weights;
+  even_rows(6) = -x_w * features.match_x();
+  even_rows(7) = -y_w * features.match_x();
+  odd_rows(3) = x_w;
+  odd_rows(4) = y_w;
+  odd_rows(5) = weights;
+  odd_rows(6) = -x_w * features.match_y();
+  odd_rows(7) = -y_w * features.match_y();
+  InterleavedRows(rhs.data(), num_features) = features.match_x() * weights;
+  InterleavedRows(rhs.data() + 1, num_features) =
+      features.match_y() * weights;
+
+  if (perspective_regularizer > 0) {
+    matrix(num_rows - 1, 6) = matrix(num_rows - 1, 7) = perspective_regularizer;
+  }
+
+  const Eigen::Matrix<float, 8, 1> solution =
+      matrix.colPivHouseholderQr().solve(rhs);
+  if (!(matrix * solution).isApprox(rhs, kPrecision)) {
+    return false;
+  }
+
+  *model = HomographyAdapter::FromFloatPointer(solution.data(), false);
+  return true;
+}
+
+void HomographyDenominatorScale(const PackedRegionFlowFeatures& features,
+                                const Homography& prev_solution,
+                                Eigen::ArrayXf* scale) {
+  CHECK(scale != nullptr);
+  const Eigen::ArrayXf denom = prev_solution.h_20() * features.x() +
+                               prev_solution.h_21() * features.y() + 1.0f;
+  *scale = (denom.abs() > 1e-5f).select(denom.inverse(), 0.0f);
+}
+
+void LinearSimilarityResiduals(const PackedRegionFlowFeatures& features,
+                               const LinearSimilarityModel& model,
+                               const LinearSimilarityModel& irls_transform,
+                               Eigen::ArrayXf* residuals) {
+  CHECK(residuals != nullptr);
+  Eigen::ArrayXf trans_x;
+  Eigen::ArrayXf trans_y;
+  TransformPoints(model, features.x(), features.y(), &trans_x, &trans_y);
+
+  // Express residual in irls domain.
+  Eigen::ArrayXf residual_x;
+  Eigen::ArrayXf residual_y;
+  TransformPoints(irls_transform, trans_x - features.match_x(),
+                  trans_y - features.match_y(), &residual_x, &residual_y);
+  *residuals = (residual_x.square() + residual_y.square()).sqrt();
+}
+
+void AffineResiduals(const PackedRegionFlowFeatures& features,
+                     const AffineModel& model,
+                     const LinearSimilarityModel& irls_transform,
+                     Eigen::ArrayXf* residuals) {
+  CHECK(residuals != nullptr);
+  const Eigen::ArrayXf trans_x =
+      model.a() * features.x() + model.b() * features.y() + model.dx();
+  const Eigen::ArrayXf trans_y =
+      model.c() * features.x() + model.d() * features.y() + model.dy();
+
+  // Express residual in irls domain.
+  Eigen::ArrayXf residual_x;
+  Eigen::ArrayXf residual_y;
+  TransformPoints(irls_transform, trans_x - features.match_x(),
+                  trans_y - features.match_y(), &residual_x, &residual_y);
+  *residuals = (residual_x.square() + residual_y.square()).sqrt();
+}
+
+void HomographyResiduals(const PackedRegionFlowFeatures& features,
+                         const Homography& model,
+                         const LinearSimilarityModel& irls_transform,
+                         Eigen::ArrayXf* residuals) {
+  CHECK(residuals != nullptr);
+  const Eigen::ArrayXf& x = features.x();
+  const Eigen::ArrayXf& y = features.y();
+  Eigen::ArrayXf z = model.h_20() * x + model.h_21() * y + 1.0f;
+
+  // Enforce z can not assume very small values, see
+  // HomographyAdapter::TransformPoint.
+  constexpr float kEps = 1e-12f;
+  const Eigen::ArrayXf signed_eps =
+      (z >= 0).select(Eigen::ArrayXf::Constant(z.size(), kEps), -kEps);
+  z = (z.abs() < kEps).select(signed_eps, z);
+  const Eigen::ArrayXf trans_x =
+      (model.h_00() * x + model.h_01() * y + model.h_02()) / z;
+  const Eigen::ArrayXf trans_y =
+      (model.h_10() * x + model.h_11() * y + model.h_12()) / z;
+
+  // Map both points to irls domain. First two components of the cross
+  // product (lhs_x, lhs_y, 1) x (rhs_x, rhs_y, 1) are lhs_y - rhs_y and
+  // rhs_x - lhs_x, i.e. the norm equals the distance of both points.
+  Eigen::ArrayXf lhs_x;
+  Eigen::ArrayXf lhs_y;
+  TransformPoints(irls_transform, trans_x, trans_y, &lhs_x, &lhs_y);
+  Eigen::ArrayXf rhs_x;
+  Eigen::ArrayXf rhs_y;
+  TransformPoints(irls_transform, features.match_x(), features.match_y(),
+                  &rhs_x, &rhs_y);
+  *residuals = ((lhs_y - rhs_y).square() + (rhs_x - lhs_x).square()).sqrt();
+}
+
+void UpdateIRLSWeights(const Eigen::ArrayXf& residuals, float residual_scale,
+                       bool use_l0_norm, float irls_eps, float alpha,
+                       const std::vector<float>* priors,
+                       Eigen::ArrayXf* irls_weights) {
+  CHECK(irls_weights != nullptr);
+  CHECK_EQ(residuals.size(), irls_weights->size());
+
+  Eigen::ArrayXf numerator;
+  if (alpha == 0.0f) {
+    numerator.setOnes(residuals.size());
+  } else {
+    CHECK(priors != nullptr);
+    CHECK_EQ(priors->size(), residuals.size());
+    const Eigen::Map<const Eigen::ArrayXf> prior_map(priors->data(),
+                                                     priors->size());
+    numerator = prior_map * alpha + (1.0f - alpha);
+  }
+
+  Eigen::ArrayXf updated;
+  if (use_l0_norm) {
+    updated = numerator / (residuals * residual_scale + irls_eps);
+  } else {
+    // Square root is evaluated in double precision, same as the proto based
+    // estimation.
+    updated = (numerator.cast<double>() /
+               ((residuals * residual_scale).cast<double>().sqrt() + irls_eps))
+                  .cast<float>();
+  }
+
+  // Features with zero weight are ignored.
+  *irls_weights = (*irls_weights == 0.0f).select(0.0f, updated);
+}
+
+template <class T>
+void SolveMotionModelsBatch(const FeatureMonomials<T>& monomials,
+                            const Eigen::ArrayXf& weights,
+                            float perspective_regularizer,
+                            MotionModelsBatch* models) {
+  CHECK(models != nullptr);
+  // The affine system is scaled by the weights, i.e. uses squared weights.
+  Eigen::MatrixXf batch_weights(weights.size(), 2);
+  batch_weights.col(0) = weights.matrix();
+  batch_weights.col(1) = weights.square().matrix();
+  const typename FeatureMonomials<T>::MomentsBatch moments =
+      monomials.WeightedMomentsBatch(batch_weights);
+
+  *models = MotionModelsBatch();
+  models->linear_similarity_success = SolveLinearSimilarity<T>(
+      moments.col(0), &models->linear_similarity);
+  models->affine_success = SolveAffine<T>(moments.col(1), &models->affine);
+  models->homography_success = SolveHomography<T>(
+      moments.col(0), perspective_regularizer, &models->homography);
+}
+
+// Explicit instantiations for float and double accuracy.
+#define INSTANTIATE_PACKED_REGION_FLOW(T)                                    \
+  template class FeatureMonomials<T>;                                        \
+  template bool SolveLinearSimilarity<T>(                                    \
+      const FeatureMonomials<T>::Moments& moments,                           \
+      LinearSimilarityModel* model);                                         \
+  template bool SolveAffine<T>(const FeatureMonomials<T>::Moments& moments, \
+                               AffineModel* model);                          \
+  template bool SolveHomography<T>(                                          \
+      const FeatureMonomials<T>::Moments& moments,                           \
+      float perspective_regularizer, Homography* model);                     \
+  template void SolveMotionModelsBatch<T>(                                   \
+      const FeatureMonomials<T>& monomials, const Eigen::ArrayXf& weights,   \
+      float perspective_regularizer, MotionModelsBatch* models);
+
+INSTANTIATE_PACKED_REGION_FLOW(float)
+INSTANTIATE_PACKED_REGION_FLOW(double)
+
+#undef INSTANTIATE_PACKED_REGION_FLOW
+
+}  // namespace mediapipe
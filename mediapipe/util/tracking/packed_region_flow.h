@@ -0,0 +1,232 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Structure-of-arrays (SoA) representation of a RegionFlowFeatureList and
+// vectorized kernels for iteratively reweighted least squares (IRLS) motion
+// estimation.
+//
+// Instead of rebuilding the normal equations feature by feature from protos
+// in each IRLS round, features are packed once into contiguous arrays. All
+// per-feature monomials of the normal equations (x, x * y, x * dx, ...) are
+// computed once as well, reducing each round to a single matrix-vector
+// product with the current weights. Estimating several models (or a single
+// model under several weightings) over the same features becomes a single
+// matrix-matrix product.
+//
+// Usage example:
+// PackedRegionFlowFeatures packed(feature_list);
+// FeatureMonomials<double> monomials(packed);
+// for (int r = 0; r < irls_rounds; ++r) {
+//   LinearSimilarityModel model;
+//   if (!SolveLinearSimilarity<double>(
+//           monomials.WeightedMoments(packed.irls_weights()), &model)) {
+//     break;
+//   }
+//   Eigen::ArrayXf residuals;
+//   LinearSimilarityResiduals(packed, model, irls_transform, &residuals);
+//   UpdateIRLSWeights(residuals, ..., packed.mutable_irls_weights());
+// }
+// packed.CopyIRLSWeightsTo(&feature_list);
+
+#ifndef MEDIAPIPE_UTIL_TRACKING_PACKED_REGION_FLOW_H_
+#define MEDIAPIPE_UTIL_TRACKING_PACKED_REGION_FLOW_H_
+
+#include <vector>
+
+#include "Eigen/Core"
+#include "mediapipe/util/tracking/motion_models.pb.h"
+#include "mediapipe/util/tracking/region_flow.pb.h"
+
+namespace mediapipe {
+
+// Packed copy of the RegionFlowFeature fields read during IRLS estimation.
+class PackedRegionFlowFeatures {
+ public:
+  explicit PackedRegionFlowFeatures(const RegionFlowFeatureList& feature_list);
+
+  int size() const { return x_.size(); }
+
+  // Feature locations and flow.
+  const Eigen::ArrayXf& x() const { return x_; }
+  const Eigen::ArrayXf& y() const { return y_; }
+  const Eigen::ArrayXf& dx() const { return dx_; }
+  const Eigen::ArrayXf& dy() const { return dy_; }
+
+  // Matching locations, i.e. location + flow.
+  const Eigen::ArrayXf& match_x() const { return match_x_; }
+  const Eigen::ArrayXf& match_y() const { return match_y_; }
+
+  const Eigen::ArrayXf& irls_weights() const { return irls_weights_; }
+  Eigen::ArrayXf* mutable_irls_weights() { return &irls_weights_; }
+
+  // Writes the (updated) IRLS weights back to the features of feature_list,
+  // which needs to be the list this object was created from.
+  void CopyIRLSWeightsTo(RegionFlowFeatureList* feature_list) const;
+
+ private:
+  Eigen::ArrayXf x_;
+  Eigen::ArrayXf y_;
+  Eigen::ArrayXf dx_;
+  Eigen::ArrayXf dy_;
+  Eigen::ArrayXf match_x_;
+  Eigen::ArrayXf match_y_;
+  Eigen::ArrayXf irls_weights_;
+};
+
+// Per-feature monomials, from whose weighted sums (moments) the normal
+// equations of linear similarities, affines and homographies are assembled.
+// With (mx, my) denoting the matching location and m2 = mx * mx + my * my.
+enum FeatureMonomial {
+  MONOMIAL_1 = 0,
+  MONOMIAL_X,
+  MONOMIAL_Y,
+  MONOMIAL_XX,
+  MONOMIAL_XY,
+  MONOMIAL_YY,
+  // Flow terms for the linear similarity (identity parametrization).
+  MONOMIAL_DX,
+  MONOMIAL_DY,
+  MONOMIAL_X_DX,
+  MONOMIAL_Y_DX,
+  MONOMIAL_X_DY,
+  MONOMIAL_Y_DY,
+  // Matching location terms for affines and homographies.
+  MONOMIAL_MX,
+  MONOMIAL_MY,
+  MONOMIAL_X_MX,
+  MONOMIAL_Y_MX,
+  MONOMIAL_X_MY,
+  MONOMIAL_Y_MY,
+  // Perspective terms for homographies.
+  MONOMIAL_XX_MX,
+  MONOMIAL_XY_MX,
+  MONOMIAL_YY_MX,
+  MONOMIAL_XX_MY,
+  MONOMIAL_XY_MY,
+  MONOMIAL_YY_MY,
+  MONOMIAL_X_M2,
+  MONOMIAL_Y_M2,
+  MONOMIAL_XX_M2,
+  MONOMIAL_XY_M2,
+  MONOMIAL_YY_M2,
+  NUM_FEATURE_MONOMIALS,
+};
+
+// Template class T specifies the accuracy of the accumulation, use float or
+// double.
+template <class T>
+class FeatureMonomials {
+ public:
+  typedef Eigen::Matrix<T, NUM_FEATURE_MONOMIALS, 1> Moments;
+  typedef Eigen::Matrix<T, NUM_FEATURE_MONOMIALS, Eigen::Dynamic> MomentsBatch;
+
+  explicit FeatureMonomials(const PackedRegionFlowFeatures& features);
+
+  // Returns sum_i weights[i] * monomial(feature_i) for each monomial.
+  Moments WeightedMoments(const Eigen::ArrayXf& weights) const;
+
+  // Same as above for several weightings at once, one per column of weights
+  // (num_features x num_weightings).
+  MomentsBatch WeightedMomentsBatch(const Eigen::MatrixXf& weights) const;
+
+ private:
+  // Column major num_features x NUM_FEATURE_MONOMIALS matrix.
+  Eigen::Matrix<T, Eigen::Dynamic, NUM_FEATURE_MONOMIALS> monomials_;
+};
+
+// Assembles the normal equations of the respective model from moments and
+// solves them via QR decomposition, mirroring the proto based solvers in
+// motion_estimation.cc. Returns false if the system could not be solved, in
+// which case the model is left unchanged.
+// The linear similarity expects moments of the IRLS weights; the affine
+// expects moments of the squared IRLS weights (rows of its system are scaled
+// by the weight); the homography expects moments of the IRLS weights scaled by
+// the optional denominator, see HomographyDenominatorScale below.
+template <class T>
+bool SolveLinearSimilarity(
+    const typename FeatureMonomials<T>::Moments& moments,
+    LinearSimilarityModel* model);
+
+template <class T>
+bool SolveAffine(const typename FeatureMonomials<T>::Moments& moments,
+                 AffineModel* model);
+
+template <class T>
+bool SolveHomography(const typename FeatureMonomials<T>::Moments& moments,
+                     float perspective_regularizer, Homography* model);
+
+// Solves for a homography via the over-determined (2N x 8) system of the
+// weighted Jacobians instead of normal equations, which is better conditioned
+// but slower. Weights are expected to be scaled as for SolveHomography.
+bool SolveHomographyExact(const PackedRegionFlowFeatures& features,
+                          const Eigen::ArrayXf& weights,
+                          float perspective_regularizer, Homography* model);
+
+// Computes for each feature the factor its weight is scaled with to minimize
+// the geometric error when solving for a homography, given the previous
+// solution (see HomographyL2QRSolve in motion_estimation.cc).
+void HomographyDenominatorScale(const PackedRegionFlowFeatures& features,
+                                const Homography& prev_solution,
+                                Eigen::ArrayXf* scale);
+
+// Computes the norm of each feature's residual w.r.t. the model, expressed in
+// the domain of irls_transform.
+void LinearSimilarityResiduals(const PackedRegionFlowFeatures& features,
+                               const LinearSimilarityModel& model,
+                               const LinearSimilarityModel& irls_transform,
+                               Eigen::ArrayXf* residuals);
+
+void AffineResiduals(const PackedRegionFlowFeatures& features,
+                     const AffineModel& model,
+                     const LinearSimilarityModel& irls_transform,
+                     Eigen::ArrayXf* residuals);
+
+// Uses the geometric residual (H * p) x q.
+void HomographyResiduals(const PackedRegionFlowFeatures& features,
+                         const Homography& model,
+                         const LinearSimilarityModel& irls_transform,
+                         Eigen::ArrayXf* residuals);
+
+// Updates all non-zero IRLS weights from residuals as
+//   numerator / (f(residual * residual_scale) + irls_eps),
+// where f is the identity for use_l0_norm and the square root otherwise. The
+// numerator is one if alpha is zero, else priors[i] * alpha + 1 - alpha.
+void UpdateIRLSWeights(const Eigen::ArrayXf& residuals, float residual_scale,
+                       bool use_l0_norm, float irls_eps, float alpha,
+                       const std::vector<float>* priors,
+                       Eigen::ArrayXf* irls_weights);
+
+// Result of SolveMotionModelsBatch. Models for which the corresponding
+// success flag is false are left at identity.
+struct MotionModelsBatch {
+  LinearSimilarityModel linear_similarity;
+  AffineModel affine;
+  Homography homography;
+  bool linear_similarity_success = false;
+  bool affine_success = false;
+  bool homography_success = false;
+};
+
+// Solves for a linear similarity, an affine and a homography (via normal
+// equations, without denominator scaling) under the same weights. All models
+// share a single pass over the features.
+template <class T>
+void SolveMotionModelsBatch(const FeatureMonomials<T>& monomials,
+                            const Eigen::ArrayXf& weights,
+                            float perspective_regularizer,
+                            MotionModelsBatch* models);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TRACKING_PACKED_REGION_FLOW_H_
@@ -0,0 +1,264 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/packed_region_flow.h"
+
+#include <cmath>
+#include <random>
+
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/vector.h"
+#include "mediapipe/util/tracking/motion_estimation.h"
+#include "mediapipe/util/tracking/motion_estimation.pb.h"
+#include "mediapipe/util/tracking/motion_models.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kFrameWidth = 640;
+constexpr int kFrameHeight = 360;
+
+// Returns features in normalized coordinates whose flow is described by
+// homography, with outlier_fraction of the features displaced randomly.
+RegionFlowFeatureList CreateFeatures(const Homography& homography,
+                                     int num_features, float outlier_fraction,
+                                     int seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> location(0.0f, 1.0f);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::normal_distribution<float> noise(0.0f, 1e-3f);
+  std::uniform_real_distribution<float> outlier(-0.05f, 0.05f);
+
+  RegionFlowFeatureList feature_list;
+  for (int i = 0; i < num_features; ++i) {
+    const Vector2_f pt(location(rng), location(rng) * kFrameHeight /
+                                          static_cast<float>(kFrameWidth));
+    const Vector2_f match = HomographyAdapter::TransformPoint(homography, pt);
+    RegionFlowFeature* feature = feature_list.add_feature();
+    feature->set_x(pt.x());
+    feature->set_y(pt.y());
+    if (unit(rng) < outlier_fraction) {
+      feature->set_dx(outlier(rng));
+      feature->set_dy(outlier(rng));
+    } else {
+      feature->set_dx(match.x() - pt.x() + noise(rng));
+      feature->set_dy(match.y() - pt.y() + noise(rng));
+    }
+    feature->set_irls_weight(1.0f);
+  }
+  return feature_list;
+}
+
+Homography GroundTruthHomography() {
+  return HomographyAdapter::FromArgs(1.02f, 0.01f, 0.03f,   // Row 1.
+                                     -0.01f, 0.98f, 0.01f,  // Row 2.
+                                     0.02f, -0.01f);        // Perspective.
+}
+
+MotionEstimationOptions ParityOptions(bool packed) {
+  MotionEstimationOptions options;
+  options.set_irls_use_packed_features(packed);
+  return options;
+}
+
+// Compares parameters relative to their magnitude, as translations are
+// expressed in pixels.
+template <class Model>
+void ExpectModelsNear(const Model& lhs, const Model& rhs) {
+  typedef ModelAdapter<Model> Adapter;
+  for (int p = 0; p < Adapter::NumParameters(); ++p) {
+    const float param = Adapter::GetParameter(lhs, p);
+    EXPECT_NEAR(param, Adapter::GetParameter(rhs, p),
+                2e-3f * (1.0f + std::abs(param)))
+        << "at parameter " << p;
+  }
+}
+
+void ExpectWeightsNear(const RegionFlowFeatureList& lhs,
+                       const RegionFlowFeatureList& rhs) {
+  ASSERT_EQ(lhs.feature_size(), rhs.feature_size());
+  for (int i = 0; i < lhs.feature_size(); ++i) {
+    const float weight = lhs.feature(i).irls_weight();
+    EXPECT_NEAR(weight, rhs.feature(i).irls_weight(), 1e-3f * (1.0f + weight))
+        << "at feature " << i;
+  }
+}
+
+TEST(PackedRegionFlowTest, PackFeatures) {
+  RegionFlowFeatureList feature_list =
+      CreateFeatures(GroundTruthHomography(), 100, 0.0f, 1);
+  PackedRegionFlowFeatures packed(feature_list);
+  ASSERT_EQ(feature_list.feature_size(), packed.size());
+  for (int i = 0; i < packed.size(); ++i) {
+    const RegionFlowFeature& feature = feature_list.feature(i);
+    EXPECT_EQ(feature.x(), packed.x()[i]);
+    EXPECT_EQ(feature.dy(), packed.dy()[i]);
+    EXPECT_EQ(feature.x() + feature.dx(), packed.match_x()[i]);
+    EXPECT_EQ(feature.y() + feature.dy(), packed.match_y()[i]);
+  }
+
+  packed.mutable_irls_weights()->setConstant(0.5f);
+  packed.CopyIRLSWeightsTo(&feature_list);
+  for (const auto& feature : feature_list.feature()) {
+    EXPECT_EQ(0.5f, feature.irls_weight());
+  }
+}
+
+TEST(PackedRegionFlowTest, RecoversModels) {
+  const Homography homography = GroundTruthHomography();
+  const RegionFlowFeatureList feature_list =
+      CreateFeatures(homography, 500, 0.0f, 2);
+  PackedRegionFlowFeatures packed(feature_list);
+  FeatureMonomials<double> monomials(packed);
+
+  Homography solved;
+  ASSERT_TRUE(SolveHomography<double>(
+      monomials.WeightedMoments(packed.irls_weights()), 0, &solved));
+  for (int p = 0; p < 8; ++p) {
+    EXPECT_NEAR(HomographyAdapter::GetParameter(homography, p),
+                HomographyAdapter::GetParameter(solved, p), 2e-2f);
+  }
+
+  Homography solved_exact;
+  ASSERT_TRUE(
+      SolveHomographyExact(packed, packed.irls_weights(), 0, &solved_exact));
+  for (int p = 0; p < 8; ++p) {
+    EXPECT_NEAR(HomographyAdapter::GetParameter(solved, p),
+                HomographyAdapter::GetParameter(solved_exact, p), 1e-3f);
+  }
+
+  // Batch estimation agrees with individual estimation.
+  MotionModelsBatch batch;
+  SolveMotionModelsBatch(monomials, packed.irls_weights(), 0, &batch);
+  ASSERT_TRUE(batch.linear_similarity_success);
+  ASSERT_TRUE(batch.affine_success);
+  ASSERT_TRUE(batch.homography_success);
+  LinearSimilarityModel similarity;
+  ASSERT_TRUE(SolveLinearSimilarity<double>(
+      monomials.WeightedMoments(packed.irls_weights()), &similarity));
+  AffineModel affine;
+  ASSERT_TRUE(SolveAffine<double>(
+      monomials.WeightedMoments(packed.irls_weights().square()), &affine));
+  for (int p = 0; p < 8; ++p) {
+    EXPECT_FLOAT_EQ(HomographyAdapter::GetParameter(solved, p),
+                    HomographyAdapter::GetParameter(batch.homography, p));
+  }
+  for (int p = 0; p < 6; ++p) {
+    EXPECT_FLOAT_EQ(AffineAdapter::GetParameter(affine, p),
+                    AffineAdapter::GetParameter(batch.affine, p));
+  }
+  for (int p = 0; p < 4; ++p) {
+    EXPECT_FLOAT_EQ(
+        LinearSimilarityAdapter::GetParameter(similarity, p),
+        LinearSimilarityAdapter::GetParameter(batch.linear_similarity, p));
+  }
+}
+
+// Packed and proto based IRLS estimation need to agree up to accumulation
+// order.
+TEST(PackedRegionFlowTest, ParityWithProtoEstimation) {
+  const RegionFlowFeatureList input =
+      CreateFeatures(GroundTruthHomography(), 400, 0.2f, 3);
+
+  for (const bool exact_homography : {true, false}) {
+    for (const bool highest_accuracy : {true, false}) {
+      SCOPED_TRACE(testing::Message()
+                   << "exact_homography: " << exact_homography
+                   << " highest_accuracy: " << highest_accuracy);
+      MotionEstimationOptions options = ParityOptions(false);
+      options.set_use_exact_homography_estimation(exact_homography);
+      options.set_use_highest_accuracy_for_normal_equations(highest_accuracy);
+      MotionEstimation proto_estimation(options, kFrameWidth, kFrameHeight);
+      options.set_irls_use_packed_features(true);
+      MotionEstimation packed_estimation(options, kFrameWidth, kFrameHeight);
+
+      RegionFlowFeatureList proto_features = input;
+      RegionFlowFeatureList packed_features = input;
+      CameraMotion proto_motion;
+      CameraMotion packed_motion;
+
+      ASSERT_TRUE(proto_estimation.EstimateLinearSimilarityModel(
+          &proto_features, &proto_motion));
+      ASSERT_TRUE(packed_estimation.EstimateLinearSimilarityModel(
+          &packed_features, &packed_motion));
+      ExpectModelsNear(proto_motion.linear_similarity(),
+                       packed_motion.linear_similarity());
+      ExpectWeightsNear(proto_features, packed_features);
+
+      proto_features = input;
+      packed_features = input;
+      ASSERT_TRUE(
+          proto_estimation.EstimateAffineModel(&proto_features, &proto_motion));
+      ASSERT_TRUE(packed_estimation.EstimateAffineModel(&packed_features,
+                                                        &packed_motion));
+      ExpectModelsNear(proto_motion.affine(), packed_motion.affine());
+      ExpectWeightsNear(proto_features, packed_features);
+
+      proto_features = input;
+      packed_features = input;
+      ASSERT_TRUE(
+          proto_estimation.EstimateHomography(&proto_features, &proto_motion));
+      ASSERT_TRUE(packed_estimation.EstimateHomography(&packed_features,
+                                                       &packed_motion));
+      ExpectModelsNear(proto_motion.homography(), packed_motion.homography());
+      // Solving for homographies in float precision is sensitive to rounding
+      // of the weights, which is amplified over the IRLS rounds. Weights are
+      // only compared for double precision normal equations.
+      if (!exact_homography && highest_accuracy) {
+        ExpectWeightsNear(proto_features, packed_features);
+      }
+    }
+  }
+}
+
+void BM_EstimateHomography(benchmark::State& state) {
+  const RegionFlowFeatureList input =
+      CreateFeatures(GroundTruthHomography(), state.range(2), 0.2f, 4);
+  MotionEstimationOptions options = ParityOptions(state.range(0) != 0);
+  options.set_use_exact_homography_estimation(state.range(1) != 0);
+  MotionEstimation estimation(options, kFrameWidth, kFrameHeight);
+  for (auto _ : state) {
+    RegionFlowFeatureList feature_list = input;
+    CameraMotion camera_motion;
+    estimation.EstimateHomography(&feature_list, &camera_motion);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(2));
+}
+// Args: packed features, exact estimation, number of features.
+BENCHMARK(BM_EstimateHomography)
+    ->Args({0, 1, 2000})
+    ->Args({1, 1, 2000})
+    ->Args({0, 0, 500})
+    ->Args({1, 0, 500})
+    ->Args({0, 0, 2000})
+    ->Args({1, 0, 2000});
+
+void BM_EstimateLinearSimilarity(benchmark::State& state) {
+  const RegionFlowFeatureList input =
+      CreateFeatures(GroundTruthHomography(), state.range(1), 0.2f, 5);
+  MotionEstimationOptions options = ParityOptions(state.range(0) != 0);
+  MotionEstimation estimation(options, kFrameWidth, kFrameHeight);
+  for (auto _ : state) {
+    RegionFlowFeatureList feature_list = input;
+    CameraMotion camera_motion;
+    estimation.EstimateLinearSimilarityModel(&feature_list, &camera_motion);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+// Args: packed features, number of features.
+BENCHMARK(BM_EstimateLinearSimilarity)->Args({0, 2000})->Args({1, 2000});
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,639 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/packed_tracking_data.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/util/tracking/motion_models.h"
+
+namespace mediapipe {
+namespace packed_tracking_data_internal {
+
+struct FileHeader {
+  char magic[4];
+  uint32 version;
+  uint32 num_frames;
+  uint32 chunk_flags;
+  uint64 index_offset;
+};
+
+struct IndexEntry {
+  int64 timestamp_usec;
+  int64 prev_timestamp_usec;
+  uint64 offset;
+  uint32 size;
+  int32 frame_idx;
+};
+
+struct FrameHeader {
+  uint32 field_mask;
+  int32 frame_flags;
+  int32 domain_width;
+  int32 domain_height;
+  float frame_aspect;
+  float background_model[8];
+  uint32 global_feature_count;
+  float average_motion_magnitude;
+  float vector_scale;
+  int32 num_elements;
+  int32 num_vectors;
+  int32 num_col_starts;
+  int32 num_track_ids;
+  int32 num_discarded_ids;
+  int32 num_descriptors;
+  uint32 descriptor_bytes;
+  uint32 reserved;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0, "FileHeader not aligned");
+static_assert(sizeof(IndexEntry) % 8 == 0, "IndexEntry not aligned");
+static_assert(sizeof(FrameHeader) % 8 == 0, "FrameHeader not aligned");
+
+}  // namespace packed_tracking_data_internal
+
+namespace {
+
+using packed_tracking_data_internal::FileHeader;
+using packed_tracking_data_internal::FrameHeader;
+using packed_tracking_data_internal::IndexEntry;
+
+constexpr char kMagic[4] = {'M', 'P', 'T', 'D'};
+constexpr uint32 kVersion = 1;
+
+constexpr int kMaxQuantizedValue = 32767;
+
+enum ChunkFlags {
+  CHUNK_FIRST = 1,
+  CHUNK_LAST = 2,
+};
+
+// Presence of optional TrackingData fields.
+enum FieldMask {
+  FIELD_FRAME_FLAGS = 1 << 0,
+  FIELD_DOMAIN_WIDTH = 1 << 1,
+  FIELD_DOMAIN_HEIGHT = 1 << 2,
+  FIELD_FRAME_ASPECT = 1 << 3,
+  FIELD_BACKGROUND_MODEL = 1 << 4,
+  FIELD_MOTION_DATA = 1 << 5,
+  FIELD_NUM_ELEMENTS = 1 << 6,
+  FIELD_GLOBAL_FEATURE_COUNT = 1 << 7,
+  FIELD_AVERAGE_MOTION_MAGNITUDE = 1 << 8,
+};
+
+int64 AlignUp(int64 size) { return (size + 7) & ~int64{7}; }
+
+// Byte offsets of each section w.r.t. the start of the frame.
+struct FrameLayout {
+  explicit FrameLayout(const FrameHeader& header) {
+    col_starts = sizeof(FrameHeader);
+    track_ids = col_starts + sizeof(int32) * int64{header.num_col_starts};
+    discarded_ids = track_ids + sizeof(int32) * int64{header.num_track_ids};
+    descriptor_offsets =
+        discarded_ids + sizeof(int32) * int64{header.num_discarded_ids};
+    const int64 num_offsets =
+        header.num_descriptors > 0 ? header.num_descriptors + 1 : 0;
+    row_indices = descriptor_offsets + sizeof(uint32) * num_offsets;
+    vectors = row_indices + sizeof(uint16) * int64{header.num_vectors};
+    descriptor_data = vectors + 2 * sizeof(int16) * int64{header.num_vectors};
+    size = AlignUp(descriptor_data + header.descriptor_bytes);
+  }
+
+  int64 col_starts;
+  int64 track_ids;
+  int64 discarded_ids;
+  int64 descriptor_offsets;
+  int64 row_indices;
+  int64 vectors;
+  int64 descriptor_data;
+  int64 size;
+};
+
+template <class T>
+void AppendValues(const T* values, int64 num_values, std::string* data) {
+  data->append(reinterpret_cast<const char*>(values), sizeof(T) * num_values);
+}
+
+void AppendPadding(std::string* data) {
+  data->resize(AlignUp(data->size()), '\0');
+}
+
+void PackTrackingData(const TrackingData& tracking_data, std::string* data) {
+  const auto& motion_data = tracking_data.motion_data();
+  const int num_vectors = motion_data.row_indices_size();
+  CHECK_EQ(2 * num_vectors, motion_data.vector_data_size());
+  CHECK(motion_data.track_id_size() == 0 ||
+        motion_data.track_id_size() == num_vectors)
+      << "Track ids need to be specified for all or none of the vectors.";
+
+  FrameHeader header;
+  memset(&header, 0, sizeof(header));
+  header.field_mask =
+      (tracking_data.has_frame_flags() ? FIELD_FRAME_FLAGS : 0) |
+      (tracking_data.has_domain_width() ? FIELD_DOMAIN_WIDTH : 0) |
+      (tracking_data.has_domain_height() ? FIELD_DOMAIN_HEIGHT : 0) |
+      (tracking_data.has_frame_aspect() ? FIELD_FRAME_ASPECT : 0) |
+      (tracking_data.has_background_model() ? FIELD_BACKGROUND_MODEL : 0) |
+      (tracking_data.has_motion_data() ? FIELD_MOTION_DATA : 0) |
+      (motion_data.has_num_elements() ? FIELD_NUM_ELEMENTS : 0) |
+      (tracking_data.has_global_feature_count() ? FIELD_GLOBAL_FEATURE_COUNT
+                                                : 0) |
+      (tracking_data.has_average_motion_magnitude()
+           ? FIELD_AVERAGE_MOTION_MAGNITUDE
+           : 0);
+  header.frame_flags = tracking_data.frame_flags();
+  header.domain_width = tracking_data.domain_width();
+  header.domain_height = tracking_data.domain_height();
+  header.frame_aspect = tracking_data.frame_aspect();
+  for (int p = 0; p < 8; ++p) {
+    header.background_model[p] =
+        HomographyAdapter::GetParameter(tracking_data.background_model(), p);
+  }
+  header.global_feature_count = tracking_data.global_feature_count();
+  header.average_motion_magnitude = tracking_data.average_motion_magnitude();
+  header.num_elements = motion_data.num_elements();
+  header.num_vectors = num_vectors;
+  header.num_col_starts = motion_data.col_starts_size();
+  header.num_track_ids = motion_data.track_id_size();
+  header.num_discarded_ids = motion_data.actively_discarded_tracked_ids_size();
+  header.num_descriptors = motion_data.feature_descriptors_size();
+
+  float max_magnitude = 0;
+  for (const float value : motion_data.vector_data()) {
+    max_magnitude = std::max(max_magnitude, std::abs(value));
+  }
+  header.vector_scale =
+      max_magnitude > 0 ? max_magnitude / kMaxQuantizedValue : 1.0f;
+
+  std::vector<uint32> descriptor_offsets;
+  if (header.num_descriptors > 0) {
+    descriptor_offsets.reserve(header.num_descriptors + 1);
+    descriptor_offsets.push_back(0);
+    for (const auto& descriptor : motion_data.feature_descriptors()) {
+      descriptor_offsets.push_back(descriptor_offsets.back() +
+                                   descriptor.data().size());
+    }
+    header.descriptor_bytes = descriptor_offsets.back();
+  }
+
+  const int64 frame_start = data->size();
+  AppendValues(&header, 1, data);
+  AppendValues(motion_data.col_starts().data(), header.num_col_starts, data);
+  AppendValues(motion_data.track_id().data(), header.num_track_ids, data);
+  AppendValues(motion_data.actively_discarded_tracked_ids().data(),
+               header.num_discarded_ids, data);
+  AppendValues(descriptor_offsets.data(), descriptor_offsets.size(), data);
+
+  std::vector<uint16> row_indices(num_vectors);
+  for (int i = 0; i < num_vectors; ++i) {
+    const int row = motion_data.row_indices(i);
+    CHECK(row >= 0 && row <= std::numeric_limits<uint16>::max())
+        << "Row index out of range: " << row;
+    row_indices[i] = row;
+  }
+  AppendValues(row_indices.data(), num_vectors, data);
+
+  std::vector<int16> vectors(2 * num_vectors);
+  for (int i = 0; i < 2 * num_vectors; ++i) {
+    const int quantized =
+        std::lround(motion_data.vector_data(i) / header.vector_scale);
+    vectors[i] = std::max(-kMaxQuantizedValue,
+                          std::min(kMaxQuantizedValue, quantized));
+  }
+  AppendValues(vectors.data(), vectors.size(), data);
+
+  for (const auto& descriptor : motion_data.feature_descriptors()) {
+    data->append(descriptor.data());
+  }
+  AppendPadding(data);
+  DCHECK_EQ(FrameLayout(header).size, data->size() - frame_start);
+}
+
+template <class T>
+const T* SectionAt(const char* frame_start, int64 offset) {
+  return reinterpret_cast<const T*>(frame_start + offset);
+}
+
+}  // namespace.
+
+void PackTrackingDataChunk(const TrackingDataChunk& chunk, std::string* data) {
+  CHECK(data != nullptr);
+  data->clear();
+
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(header.magic));
+  header.version = kVersion;
+  header.num_frames = chunk.item_size();
+  header.chunk_flags = (chunk.first_chunk() ? CHUNK_FIRST : 0) |
+                       (chunk.last_chunk() ? CHUNK_LAST : 0);
+  AppendValues(&header, 1, data);
+
+  std::vector<IndexEntry> index(chunk.item_size());
+  for (int f = 0; f < chunk.item_size(); ++f) {
+    const TrackingDataChunk::Item& item = chunk.item(f);
+    IndexEntry& entry = index[f];
+    memset(&entry, 0, sizeof(entry));
+    entry.timestamp_usec = item.timestamp_usec();
+    entry.prev_timestamp_usec = item.prev_timestamp_usec();
+    entry.frame_idx = item.frame_idx();
+    entry.offset = data->size();
+    PackTrackingData(item.tracking_data(), data);
+    entry.size = data->size() - entry.offset;
+  }
+
+  // Index is written last, so that frames can be streamed out.
+  const uint64 index_offset = data->size();
+  AppendValues(index.data(), index.size(), data);
+  memcpy(&(*data)[offsetof(FileHeader, index_offset)], &index_offset,
+         sizeof(index_offset));
+}
+
+bool IsPackedTrackingData(absl::string_view data) {
+  return data.size() >= sizeof(FileHeader) &&
+         memcmp(data.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+int PackedTrackingDataFrame::frame_flags() const {
+  return header_->frame_flags;
+}
+
+int PackedTrackingDataFrame::domain_width() const {
+  return header_->domain_width;
+}
+
+int PackedTrackingDataFrame::domain_height() const {
+  return header_->domain_height;
+}
+
+float PackedTrackingDataFrame::frame_aspect() const {
+  return header_->frame_aspect;
+}
+
+Homography PackedTrackingDataFrame::background_model() const {
+  return HomographyAdapter::FromFloatPointer(header_->background_model, false);
+}
+
+uint32 PackedTrackingDataFrame::global_feature_count() const {
+  return header_->global_feature_count;
+}
+
+float PackedTrackingDataFrame::average_motion_magnitude() const {
+  return header_->average_motion_magnitude;
+}
+
+int PackedTrackingDataFrame::num_vectors() const {
+  return header_->num_vectors;
+}
+
+int PackedTrackingDataFrame::num_columns() const {
+  return std::max(0, header_->num_col_starts - 1);
+}
+
+bool PackedTrackingDataFrame::has_track_ids() const {
+  return header_->num_track_ids > 0;
+}
+
+void PackedTrackingDataFrame::ToTrackingData(
+    TrackingData* tracking_data) const {
+  CHECK(tracking_data != nullptr);
+  tracking_data->Clear();
+  const uint32 mask = header_->field_mask;
+  if (mask & FIELD_FRAME_FLAGS) {
+    tracking_data->set_frame_flags(header_->frame_flags);
+  }
+  if (mask & FIELD_DOMAIN_WIDTH) {
+    tracking_data->set_domain_width(header_->domain_width);
+  }
+  if (mask & FIELD_DOMAIN_HEIGHT) {
+    tracking_data->set_domain_height(header_->domain_height);
+  }
+  if (mask & FIELD_FRAME_ASPECT) {
+    tracking_data->set_frame_aspect(header_->frame_aspect);
+  }
+  if (mask & FIELD_BACKGROUND_MODEL) {
+    *tracking_data->mutable_background_model() = background_model();
+  }
+  if (mask & FIELD_GLOBAL_FEATURE_COUNT) {
+    tracking_data->set_global_feature_count(header_->global_feature_count);
+  }
+  if (mask & FIELD_AVERAGE_MOTION_MAGNITUDE) {
+    tracking_data->set_average_motion_magnitude(
+        header_->average_motion_magnitude);
+  }
+  if (!(mask & FIELD_MOTION_DATA)) {
+    return;
+  }
+
+  auto* motion_data = tracking_data->mutable_motion_data();
+  if (mask & FIELD_NUM_ELEMENTS) {
+    motion_data->set_num_elements(header_->num_elements);
+  }
+  const int num_vectors = header_->num_vectors;
+  motion_data->mutable_vector_data()->Reserve(2 * num_vectors);
+  motion_data->mutable_row_indices()->Reserve(num_vectors);
+  for (int i = 0; i < num_vectors; ++i) {
+    motion_data->add_vector_data(dx(i));
+    motion_data->add_vector_data(dy(i));
+    motion_data->add_row_indices(row_indices_[i]);
+  }
+  motion_data->mutable_col_starts()->Add(
+      col_starts_, col_starts_ + header_->num_col_starts);
+  motion_data->mutable_track_id()->Add(track_ids_,
+                                       track_ids_ + header_->num_track_ids);
+  motion_data->mutable_actively_discarded_tracked_ids()->Add(
+      discarded_ids_, discarded_ids_ + header_->num_discarded_ids);
+  for (int d = 0; d < header_->num_descriptors; ++d) {
+    motion_data->add_feature_descriptors()->set_data(
+        descriptor_data_ + descriptor_offsets_[d],
+        descriptor_offsets_[d + 1] - descriptor_offsets_[d]);
+  }
+}
+
+bool PackedTrackingDataChunk::Init(absl::string_view data) {
+  data_ = absl::string_view();
+  num_frames_ = 0;
+  index_ = nullptr;
+  frames_.clear();
+
+  if (!IsPackedTrackingData(data)) {
+    LOG(ERROR) << "Not packed tracking data.";
+    return false;
+  }
+  if (reinterpret_cast<uintptr_t>(data.data()) % 8 != 0) {
+    LOG(ERROR) << "Packed tracking data needs to be 8 byte aligned.";
+    return false;
+  }
+
+  const FileHeader& header = *reinterpret_cast<const FileHeader*>(data.data());
+  if (header.version != kVersion) {
+    LOG(ERROR) << "Unsupported version: " << header.version;
+    return false;
+  }
+  if (header.index_offset % 8 != 0 || header.index_offset > data.size() ||
+      (data.size() - header.index_offset) / sizeof(IndexEntry) <
+          header.num_frames) {
+    LOG(ERROR) << "Corrupted index.";
+    return false;
+  }
+
+  const IndexEntry* index =
+      reinterpret_cast<const IndexEntry*>(data.data() + header.index_offset);
+  std::vector<PackedTrackingDataFrame> frames(header.num_frames);
+  for (int f = 0; f < header.num_frames; ++f) {
+    const IndexEntry& entry = index[f];
+    if (entry.offset % 8 != 0 || entry.offset < sizeof(FileHeader) ||
+        entry.offset > header.index_offset ||
+        entry.size > header.index_offset - entry.offset ||
+        entry.size < sizeof(FrameHeader)) {
+      LOG(ERROR) << "Corrupted index entry for frame " << f;
+      return false;
+    }
+
+    const char* frame_start = data.data() + entry.offset;
+    const FrameHeader* frame_header =
+        reinterpret_cast<const FrameHeader*>(frame_start);
+    if (frame_header->num_vectors < 0 || frame_header->num_col_starts < 0 ||
+        frame_header->num_discarded_ids < 0 ||
+        frame_header->num_descriptors < 0 ||
+        (frame_header->num_track_ids != 0 &&
+         frame_header->num_track_ids != frame_header->num_vectors) ||
+        (frame_header->num_descriptors == 0 &&
+         frame_header->descriptor_bytes != 0)) {
+      LOG(ERROR) << "Corrupted header for frame " << f;
+      return false;
+    }
+    const FrameLayout layout(*frame_header);
+    if (layout.size > entry.size) {
+      LOG(ERROR) << "Truncated frame " << f;
+      return false;
+    }
+
+    PackedTrackingDataFrame& frame = frames[f];
+    frame.header_ = frame_header;
+    frame.col_starts_ = SectionAt<int32>(frame_start, layout.col_starts);
+    frame.track_ids_ = SectionAt<int32>(frame_start, layout.track_ids);
+    frame.discarded_ids_ = SectionAt<int32>(frame_start, layout.discarded_ids);
+    frame.descriptor_offsets_ =
+        SectionAt<uint32>(frame_start, layout.descriptor_offsets);
+    frame.row_indices_ = SectionAt<uint16>(frame_start, layout.row_indices);
+    frame.vectors_ = SectionAt<int16>(frame_start, layout.vectors);
+    frame.descriptor_data_ = frame_start + layout.descriptor_data;
+    frame.vector_scale_ = frame_header->vector_scale;
+
+    // Column starts and descriptor offsets are used to index into the frame,
+    // validate them once here.
+    for (int c = 0; c < frame_header->num_col_starts; ++c) {
+      if (frame.col_starts_[c] < (c == 0 ? 0 : frame.col_starts_[c - 1]) ||
+          frame.col_starts_[c] > frame_header->num_vectors) {
+        LOG(ERROR) << "Corrupted column starts for frame " << f;
+        return false;
+      }
+    }
+    for (int d = 0; d < frame_header->num_descriptors; ++d) {
+      if (frame.descriptor_offsets_[d] > frame.descriptor_offsets_[d + 1]) {
+        LOG(ERROR) << "Corrupted descriptors for frame " << f;
+        return false;
+      }
+    }
+    if (frame_header->num_descriptors > 0 &&
+        (frame.descriptor_offsets_[0] != 0 ||
+         frame.descriptor_offsets_[frame_header->num_descriptors] !=
+             frame_header->descriptor_bytes)) {
+      LOG(ERROR) << "Corrupted descriptors for frame " << f;
+      return false;
+    }
+  }
+
+  data_ = data;
+  num_frames_ = header.num_frames;
+  chunk_flags_ = header.chunk_flags;
+  index_ = index;
+  frames_ = std::move(frames);
+  return true;
+}
+
+bool PackedTrackingDataChunk::first_chunk() const {
+  return chunk_flags_ & CHUNK_FIRST;
+}
+
+bool PackedTrackingDataChunk::last_chunk() const {
+  return chunk_flags_ & CHUNK_LAST;
+}
+
+int64 PackedTrackingDataChunk::timestamp_usec(int f) const {
+  return index_[f].timestamp_usec;
+}
+
+int64 PackedTrackingDataChunk::prev_timestamp_usec(int f) const {
+  return index_[f].prev_timestamp_usec;
+}
+
+int PackedTrackingDataChunk::frame_idx(int f) const {
+  return index_[f].frame_idx;
+}
+
+int PackedTrackingDataChunk::LowerBoundFrame(int64 timestamp_usec) const {
+  return std::lower_bound(index_, index_ + num_frames_, timestamp_usec,
+                          [](const IndexEntry& entry, int64 timestamp) {
+                            return entry.timestamp_usec < timestamp;
+                          }) -
+         index_;
+}
+
+void PackedTrackingDataChunk::ToTrackingDataChunk(
+    TrackingDataChunk* chunk) const {
+  CHECK(chunk != nullptr);
+  chunk->Clear();
+  for (int f = 0; f < num_frames_; ++f) {
+    TrackingDataChunk::Item* item = chunk->add_item();
+    frames_[f].ToTrackingData(item->mutable_tracking_data());
+    item->set_frame_idx(index_[f].frame_idx);
+    item->set_timestamp_usec(index_[f].timestamp_usec);
+    item->set_prev_timestamp_usec(index_[f].prev_timestamp_usec);
+  }
+  if (first_chunk()) {
+    chunk->set_first_chunk(true);
+  }
+  if (last_chunk()) {
+    chunk->set_last_chunk(true);
+  }
+}
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG(ERROR) << "Could not open " << path;
+    return nullptr;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    LOG(ERROR) << "Could not stat " << path;
+    close(fd);
+    return nullptr;
+  }
+
+  const size_t size = file_stat.st_size;
+  if (size == 0) {
+    close(fd);
+    return std::unique_ptr<MappedFile>(new MappedFile(absl::string_view()));
+  }
+
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // Mapping stays valid after closing the descriptor.
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    LOG(ERROR) << "Could not map " << path;
+    return nullptr;
+  }
+
+  return std::unique_ptr<MappedFile>(
+      new MappedFile(absl::string_view(static_cast<char*>(mapped), size)));
+}
+
+MappedFile::~MappedFile() {
+  if (!data_.empty()) {
+    munmap(const_cast<char*>(data_.data()), data_.size());
+  }
+}
+
+void MotionVectorFrameFromPackedTrackingData(
+    const PackedTrackingDataFrame& frame,
+    MotionVectorFrame* motion_vector_frame) {
+  CHECK(motion_vector_frame != nullptr);
+
+  float aspect_ratio = frame.frame_aspect();
+  if (aspect_ratio < 0.1 || aspect_ratio > 10.0f) {
+    LOG(ERROR) << "Aspect ratio : " << aspect_ratio << " is out of bounds. "
+               << "Resetting to 1.0.";
+    aspect_ratio = 1.0f;
+  }
+
+  float scale_x, scale_y;
+  // Normalize longest dimension to 1 under aspect ratio preserving scaling.
+  ScaleFromAspect(aspect_ratio, false, &scale_x, &scale_y);
+
+  scale_x /= frame.domain_width();
+  scale_y /= frame.domain_height();
+
+  const bool use_background_model =
+      !(frame.frame_flags() & TrackingData::FLAG_BACKGROUND_UNSTABLE);
+
+  Homography homog_scale = HomographyAdapter::Embed(
+      AffineAdapter::FromArgs(0, 0, scale_x, 0, 0, scale_y));
+
+  Homography inv_homog_scale = HomographyAdapter::Embed(
+      AffineAdapter::FromArgs(0, 0, 1.0f / scale_x, 0, 0, 1.0f / scale_y));
+
+  // Might be just the identity if not set.
+  const Homography background_model = frame.background_model();
+  const Homography background_model_scaled =
+      ModelCompose3(homog_scale, background_model, inv_homog_scale);
+
+  motion_vector_frame->background_model.CopyFrom(background_model_scaled);
+  motion_vector_frame->valid_background_model = use_background_model;
+  motion_vector_frame->is_duplicated =
+      frame.frame_flags() & TrackingData::FLAG_DUPLICATED;
+  motion_vector_frame->is_chunk_boundary =
+      frame.frame_flags() & TrackingData::FLAG_CHUNK_BOUNDARY;
+  motion_vector_frame->aspect_ratio = frame.frame_aspect();
+
+  motion_vector_frame->motion_vectors.clear();
+  motion_vector_frame->motion_vectors.reserve(frame.num_vectors());
+  const bool long_tracks = frame.has_track_ids();
+
+  for (int c = 0; c < frame.num_columns(); ++c) {
+    const float x = c;
+    const float scaled_x = x * scale_x;
+
+    for (int r = frame.col_start(c), r_end = frame.col_start(c + 1); r < r_end;
+         ++r) {
+      MotionVector motion_vector;
+
+      const float y = frame.row_index(r);
+      const float scaled_y = y * scale_y;
+
+      if (use_background_model) {
+        Vector2_f loc(x, y);
+        Vector2_f background_motion =
+            HomographyAdapter::TransformPoint(background_model, loc) - loc;
+        motion_vector.background = Vector2_f(background_motion.x() * scale_x,
+                                             background_motion.y() * scale_y);
+      }
+
+      motion_vector.pos = Vector2_f(scaled_x, scaled_y);
+      motion_vector.object =
+          Vector2_f(frame.dx(r) * scale_x, frame.dy(r) * scale_y);
+
+      if (long_tracks) {
+        motion_vector.track_id = frame.track_id(r);
+      }
+      motion_vector_frame->motion_vectors.push_back(motion_vector);
+    }
+  }
+}
+
+}  // namespace mediapipe
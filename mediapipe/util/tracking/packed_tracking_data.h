@@ -0,0 +1,178 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Fixed layout binary format for TrackingDataChunk's, designed to be memory
+// mapped and accessed randomly by frame index without parsing the whole chunk.
+//
+// Layout (LITTLE ENDIAN, all sections 8 byte aligned):
+// { header             : magic "MPTD", version, number of frames, chunk flags
+//                        and offset of the index.
+//   frames             : per frame a fixed size header (flags, domain,
+//                        aspect, background model, counts) followed by
+//                        col_starts (32 bit int), track ids (32 bit int),
+//                        actively discarded track ids (32 bit int),
+//                        descriptor offsets (32 bit uint),
+//                        row indices (16 bit uint),
+//                        motion vectors (2 x 16 bit int, quantized with a
+//                        per frame scale) and descriptor bytes.
+//   index              : per frame timestamp, previous timestamp, frame index
+//                        and location of the frame.
+// }
+//
+// Motion vectors are quantized to 16 bit w.r.t. the largest magnitude within
+// each frame, i.e. the error per component is bounded by
+// max_magnitude / 65534.
+//
+// Usage example:
+// std::string data;
+// PackTrackingDataChunk(chunk, &data);   // Write data to file.
+//
+// std::unique_ptr<MappedFile> file = MappedFile::Open(path);
+// PackedTrackingDataChunk packed;
+// if (file && packed.Init(file->data())) {
+//   const int f = packed.LowerBoundFrame(timestamp_usec);
+//   MotionVectorFrame mvf;
+//   MotionVectorFrameFromPackedTrackingData(packed.frame(f), &mvf);
+// }
+
+#ifndef MEDIAPIPE_UTIL_TRACKING_PACKED_TRACKING_DATA_H_
+#define MEDIAPIPE_UTIL_TRACKING_PACKED_TRACKING_DATA_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/util/tracking/flow_packager.pb.h"
+#include "mediapipe/util/tracking/motion_models.pb.h"
+#include "mediapipe/util/tracking/tracking.h"
+
+namespace mediapipe {
+
+// Serializes chunk to the packed format, replacing the contents of data.
+void PackTrackingDataChunk(const TrackingDataChunk& chunk, std::string* data);
+
+// Returns true if data starts with the header of the packed format.
+bool IsPackedTrackingData(absl::string_view data);
+
+namespace packed_tracking_data_internal {
+struct FrameHeader;
+struct IndexEntry;
+}  // namespace packed_tracking_data_internal
+
+// Read-only view of a single packed TrackingData. All accessors read directly
+// from the underlying buffer.
+class PackedTrackingDataFrame {
+ public:
+  int frame_flags() const;
+  int domain_width() const;
+  int domain_height() const;
+  float frame_aspect() const;
+  // Identity if not set.
+  Homography background_model() const;
+  uint32 global_feature_count() const;
+  float average_motion_magnitude() const;
+
+  // Number of motion vectors.
+  int num_vectors() const;
+  // Number of columns of the sparse motion data, i.e. #col_starts - 1.
+  int num_columns() const;
+  int col_start(int c) const { return col_starts_[c]; }
+  int row_index(int i) const { return row_indices_[i]; }
+  float dx(int i) const { return vectors_[2 * i] * vector_scale_; }
+  float dy(int i) const { return vectors_[2 * i + 1] * vector_scale_; }
+
+  // Track ids are either present for all vectors or none.
+  bool has_track_ids() const;
+  int track_id(int i) const { return track_ids_[i]; }
+
+  // Decodes to TrackingData (lossy only w.r.t. quantization of vectors).
+  void ToTrackingData(TrackingData* tracking_data) const;
+
+ private:
+  friend class PackedTrackingDataChunk;
+
+  const packed_tracking_data_internal::FrameHeader* header_ = nullptr;
+  const int32* col_starts_ = nullptr;
+  const int32* track_ids_ = nullptr;
+  const int32* discarded_ids_ = nullptr;
+  const uint32* descriptor_offsets_ = nullptr;
+  const uint16* row_indices_ = nullptr;
+  const int16* vectors_ = nullptr;
+  const char* descriptor_data_ = nullptr;
+  float vector_scale_ = 0;
+};
+
+// Read-only view of a packed TrackingDataChunk.
+class PackedTrackingDataChunk {
+ public:
+  PackedTrackingDataChunk() = default;
+
+  // Initializes view from data, which is not copied and needs to outlive
+  // this object. Validates the layout, returns false for corrupted data.
+  bool Init(absl::string_view data);
+
+  int num_frames() const { return num_frames_; }
+  bool first_chunk() const;
+  bool last_chunk() const;
+
+  int64 timestamp_usec(int f) const;
+  int64 prev_timestamp_usec(int f) const;
+  int frame_idx(int f) const;
+
+  // Returns index of the first frame with timestamp >= timestamp_usec, or
+  // num_frames() if no such frame exists.
+  int LowerBoundFrame(int64 timestamp_usec) const;
+
+  const PackedTrackingDataFrame& frame(int f) const { return frames_[f]; }
+
+  // Decodes to TrackingDataChunk.
+  void ToTrackingDataChunk(TrackingDataChunk* chunk) const;
+
+ private:
+  absl::string_view data_;
+  int num_frames_ = 0;
+  uint32 chunk_flags_ = 0;
+  const packed_tracking_data_internal::IndexEntry* index_ = nullptr;
+  std::vector<PackedTrackingDataFrame> frames_;
+};
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  // Returns nullptr if file could not be opened or mapped.
+  static std::unique_ptr<MappedFile> Open(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  absl::string_view data() const { return data_; }
+
+ private:
+  explicit MappedFile(absl::string_view data) : data_(data) {}
+
+  absl::string_view data_;
+};
+
+// Same as MotionVectorFrameFromTrackingData, reading directly from packed
+// data without decoding to TrackingData first.
+void MotionVectorFrameFromPackedTrackingData(
+    const PackedTrackingDataFrame& frame,
+    MotionVectorFrame* motion_vector_frame);
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TRACKING_PACKED_TRACKING_DATA_H_
@@ -0,0 +1,290 @@
+// Copyright 2019 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/packed_tracking_data.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/tracking/motion_models.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kDomainWidth = 120;
+constexpr int kDomainHeight = 68;
+
+// Returns TrackingData with num_vectors random motion vectors.
+TrackingData CreateTrackingData(int num_vectors, bool with_track_ids,
+                                int seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> column(0, kDomainWidth - 1);
+  std::uniform_int_distribution<int> row(0, kDomainHeight - 1);
+  std::uniform_real_distribution<float> motion(-8.0f, 8.0f);
+
+  TrackingData tracking_data;
+  tracking_data.set_frame_flags(TrackingData::FLAG_PROFILE_HIGH);
+  tracking_data.set_domain_width(kDomainWidth);
+  tracking_data.set_domain_height(kDomainHeight);
+  tracking_data.set_frame_aspect(16.0f / 9.0f);
+  *tracking_data.mutable_background_model() =
+      HomographyAdapter::FromArgs(1.01f, 0.02f, 1.5f, -0.01f, 0.99f, -2.0f,
+                                  1e-4f, 2e-4f);
+  tracking_data.set_global_feature_count(num_vectors);
+
+  // Sparse column storage, vectors within each column sorted by row.
+  std::vector<std::vector<int>> rows_per_column(kDomainWidth);
+  for (int i = 0; i < num_vectors; ++i) {
+    rows_per_column[column(rng)].push_back(row(rng));
+  }
+
+  auto* motion_data = tracking_data.mutable_motion_data();
+  motion_data->set_num_elements(num_vectors);
+  motion_data->add_col_starts(0);
+  for (auto& rows : rows_per_column) {
+    std::sort(rows.begin(), rows.end());
+    for (const int r : rows) {
+      motion_data->add_row_indices(r);
+      motion_data->add_vector_data(motion(rng));
+      motion_data->add_vector_data(motion(rng));
+      if (with_track_ids) {
+        motion_data->add_track_id(motion_data->row_indices_size() * 3);
+      }
+    }
+    motion_data->add_col_starts(motion_data->row_indices_size());
+  }
+  motion_data->add_actively_discarded_tracked_ids(7);
+  motion_data->add_actively_discarded_tracked_ids(11);
+  return tracking_data;
+}
+
+TrackingDataChunk CreateChunk(int num_frames, int num_vectors) {
+  TrackingDataChunk chunk;
+  for (int f = 0; f < num_frames; ++f) {
+    TrackingDataChunk::Item* item = chunk.add_item();
+    *item->mutable_tracking_data() =
+        CreateTrackingData(num_vectors, f % 2 == 0, f);
+    item->set_frame_idx(100 + f);
+    item->set_timestamp_usec(33333 * (f + 1));
+    item->set_prev_timestamp_usec(33333 * f);
+  }
+  // Frame without any motion data.
+  chunk.add_item()->set_timestamp_usec(33333 * (num_frames + 1));
+  chunk.set_last_chunk(true);
+  return chunk;
+}
+
+// Heap allocated strings satisfy the alignment requirements of
+// PackedTrackingDataChunk::Init.
+std::string PackChunk(const TrackingDataChunk& chunk) {
+  std::string data;
+  PackTrackingDataChunk(chunk, &data);
+  return data;
+}
+
+void ExpectTrackingDataNear(const TrackingData& expected,
+                            const TrackingData& actual) {
+  TrackingData expected_without_vectors = expected;
+  TrackingData actual_without_vectors = actual;
+  expected_without_vectors.mutable_motion_data()->clear_vector_data();
+  actual_without_vectors.mutable_motion_data()->clear_vector_data();
+  if (!expected.has_motion_data()) {
+    expected_without_vectors.clear_motion_data();
+    actual_without_vectors.clear_motion_data();
+  }
+  EXPECT_EQ(expected_without_vectors.SerializeAsString(),
+            actual_without_vectors.SerializeAsString());
+
+  const auto& expected_vectors = expected.motion_data().vector_data();
+  const auto& actual_vectors = actual.motion_data().vector_data();
+  ASSERT_EQ(expected_vectors.size(), actual_vectors.size());
+  float max_magnitude = 0;
+  for (const float value : expected_vectors) {
+    max_magnitude = std::max(max_magnitude, std::abs(value));
+  }
+  for (int i = 0; i < expected_vectors.size(); ++i) {
+    EXPECT_NEAR(expected_vectors[i], actual_vectors[i],
+                max_magnitude / 65534.0f * 1.01f);
+  }
+}
+
+TEST(PackedTrackingDataTest, RoundTrip) {
+  TrackingDataChunk chunk = CreateChunk(4, 200);
+  auto* descriptors =
+      chunk.mutable_item(1)->mutable_tracking_data()->mutable_motion_data();
+  for (int i = 0; i < descriptors->row_indices_size(); ++i) {
+    descriptors->add_feature_descriptors()->set_data(
+        std::string(i % 5, static_cast<char>('a' + i % 26)));
+  }
+
+  const std::string data = PackChunk(chunk);
+  ASSERT_TRUE(IsPackedTrackingData(data));
+  PackedTrackingDataChunk packed;
+  ASSERT_TRUE(packed.Init(data));
+  EXPECT_EQ(chunk.item_size(), packed.num_frames());
+  EXPECT_FALSE(packed.first_chunk());
+  EXPECT_TRUE(packed.last_chunk());
+
+  TrackingDataChunk decoded;
+  packed.ToTrackingDataChunk(&decoded);
+  ASSERT_EQ(chunk.item_size(), decoded.item_size());
+  EXPECT_EQ(chunk.last_chunk(), decoded.last_chunk());
+  EXPECT_EQ(chunk.first_chunk(), decoded.first_chunk());
+  for (int f = 0; f < chunk.item_size(); ++f) {
+    SCOPED_TRACE(absl::StrCat("frame ", f));
+    EXPECT_EQ(chunk.item(f).frame_idx(), decoded.item(f).frame_idx());
+    EXPECT_EQ(chunk.item(f).timestamp_usec(), decoded.item(f).timestamp_usec());
+    EXPECT_EQ(chunk.item(f).prev_timestamp_usec(),
+              decoded.item(f).prev_timestamp_usec());
+    ExpectTrackingDataNear(chunk.item(f).tracking_data(),
+                           decoded.item(f).tracking_data());
+  }
+}
+
+TEST(PackedTrackingDataTest, RandomAccess) {
+  const TrackingDataChunk chunk = CreateChunk(10, 50);
+  const std::string data = PackChunk(chunk);
+  PackedTrackingDataChunk packed;
+  ASSERT_TRUE(packed.Init(data));
+
+  EXPECT_EQ(0, packed.LowerBoundFrame(0));
+  EXPECT_EQ(3, packed.LowerBoundFrame(chunk.item(3).timestamp_usec()));
+  EXPECT_EQ(4, packed.LowerBoundFrame(chunk.item(3).timestamp_usec() + 1));
+  EXPECT_EQ(packed.num_frames(),
+            packed.LowerBoundFrame(chunk.item(10).timestamp_usec() + 1));
+
+  const TrackingData& tracking_data = chunk.item(5).tracking_data();
+  const PackedTrackingDataFrame& frame = packed.frame(5);
+  EXPECT_EQ(tracking_data.domain_width(), frame.domain_width());
+  EXPECT_EQ(tracking_data.domain_height(), frame.domain_height());
+  EXPECT_EQ(tracking_data.frame_aspect(), frame.frame_aspect());
+  EXPECT_EQ(tracking_data.motion_data().row_indices_size(),
+            frame.num_vectors());
+  EXPECT_EQ(kDomainWidth, frame.num_columns());
+  EXPECT_FALSE(frame.has_track_ids());
+  for (int i = 0; i < frame.num_vectors(); ++i) {
+    EXPECT_EQ(tracking_data.motion_data().row_indices(i), frame.row_index(i));
+  }
+  EXPECT_TRUE(packed.frame(4).has_track_ids());
+}
+
+// Motion vector frames are identical whether obtained from packed data
+// directly or from the decoded TrackingData.
+TEST(PackedTrackingDataTest, MotionVectorFrameParity) {
+  const TrackingDataChunk chunk = CreateChunk(2, 300);
+  const std::string data = PackChunk(chunk);
+  PackedTrackingDataChunk packed;
+  ASSERT_TRUE(packed.Init(data));
+
+  for (int f = 0; f < 2; ++f) {
+    TrackingData decoded;
+    packed.frame(f).ToTrackingData(&decoded);
+    MotionVectorFrame expected;
+    MotionVectorFrameFromTrackingData(decoded, &expected);
+    MotionVectorFrame actual;
+    MotionVectorFrameFromPackedTrackingData(packed.frame(f), &actual);
+
+    EXPECT_EQ(expected.aspect_ratio, actual.aspect_ratio);
+    EXPECT_EQ(expected.valid_background_model, actual.valid_background_model);
+    for (int p = 0; p < 8; ++p) {
+      EXPECT_EQ(HomographyAdapter::GetParameter(expected.background_model, p),
+                HomographyAdapter::GetParameter(actual.background_model, p));
+    }
+    ASSERT_EQ(expected.motion_vectors.size(), actual.motion_vectors.size());
+    for (int i = 0; i < expected.motion_vectors.size(); ++i) {
+      const MotionVector& lhs = expected.motion_vectors[i];
+      const MotionVector& rhs = actual.motion_vectors[i];
+      EXPECT_EQ(lhs.pos, rhs.pos);
+      EXPECT_EQ(lhs.object, rhs.object);
+      EXPECT_EQ(lhs.background, rhs.background);
+      EXPECT_EQ(lhs.track_id, rhs.track_id);
+    }
+  }
+}
+
+TEST(PackedTrackingDataTest, RejectsCorruptedData) {
+  const std::string data = PackChunk(CreateChunk(3, 50));
+  PackedTrackingDataChunk packed;
+  EXPECT_FALSE(packed.Init(""));
+  EXPECT_FALSE(packed.Init(data.substr(0, data.size() / 2)));
+
+  std::string wrong_magic = data;
+  wrong_magic[0] = 'X';
+  EXPECT_FALSE(IsPackedTrackingData(wrong_magic));
+  EXPECT_FALSE(packed.Init(wrong_magic));
+
+  // Serialized protos are not mistaken for packed data.
+  EXPECT_FALSE(IsPackedTrackingData(CreateChunk(1, 10).SerializeAsString()));
+}
+
+TEST(PackedTrackingDataTest, MappedFile) {
+  const TrackingDataChunk chunk = CreateChunk(3, 50);
+  const std::string data = PackChunk(chunk);
+  const std::string path =
+      absl::StrCat(getenv("TEST_TMPDIR"), "/packed_tracking_data");
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  ASSERT_EQ(data.size(), fwrite(data.data(), 1, data.size(), file));
+  fclose(file);
+
+  std::unique_ptr<MappedFile> mapped_file = MappedFile::Open(path);
+  ASSERT_NE(nullptr, mapped_file);
+  EXPECT_EQ(data, mapped_file->data());
+  PackedTrackingDataChunk packed;
+  ASSERT_TRUE(packed.Init(mapped_file->data()));
+  EXPECT_EQ(chunk.item_size(), packed.num_frames());
+
+  EXPECT_EQ(nullptr, MappedFile::Open(path + "_missing"));
+}
+
+// Seeks to a single frame of a chunk, decoding either the whole chunk from its
+// serialized proto or only the requested frame from packed data.
+void BM_SeekFrame(benchmark::State& state) {
+  const bool packed_format = state.range(0) != 0;
+  const TrackingDataChunk chunk = CreateChunk(75, 1000);
+  std::string data;
+  if (packed_format) {
+    PackTrackingDataChunk(chunk, &data);
+  } else {
+    chunk.SerializeToString(&data);
+  }
+
+  int frame = 0;
+  for (auto _ : state) {
+    MotionVectorFrame mvf;
+    if (packed_format) {
+      PackedTrackingDataChunk packed;
+      packed.Init(data);
+      MotionVectorFrameFromPackedTrackingData(packed.frame(frame), &mvf);
+    } else {
+      TrackingDataChunk parsed;
+      parsed.ParseFromString(data);
+      MotionVectorFrameFromTrackingData(parsed.item(frame).tracking_data(),
+                                        &mvf);
+    }
+    // Skips the last frame without motion data.
+    frame = (frame + 7) % (chunk.item_size() - 1);
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+// Args: packed format.
+BENCHMARK(BM_SeekFrame)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace mediapipe
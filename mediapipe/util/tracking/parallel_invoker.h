@@ -69,6 +69,8 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 
 #include "absl/synchronization/mutex.h"
@@ -86,11 +88,14 @@
 
 // Specifies parallelization implementation to use.
 enum PARALLEL_INVOKER_MODE {
-  PARALLEL_INVOKER_NONE = 0,         // Uses single threaded execution
-  PARALLEL_INVOKER_THREAD_POOL = 1,  // Uses //thread/threadpool
-  PARALLEL_INVOKER_OPENMP = 2,       // Uses OpenMP (requires compiler support)
-  PARALLEL_INVOKER_GCD = 3,          // Uses GCD (Apple)
-  PARALLEL_INVOKER_MAX_VALUE = 4,    // Increase when adding more modes
+  PARALLEL_INVOKER_NONE = 0,           // Uses single threaded execution
+  PARALLEL_INVOKER_THREAD_POOL = 1,    // Uses //thread/threadpool
+  PARALLEL_INVOKER_OPENMP = 2,         // Uses OpenMP (requires compiler
+                                       // support)
+  PARALLEL_INVOKER_GCD = 3,            // Uses GCD (Apple)
+  PARALLEL_INVOKER_WORK_STEALING = 4,  // Uses chunked work-stealing over the
+                                       // persistent //thread/threadpool
+  PARALLEL_INVOKER_MAX_VALUE = 5,      // Increase when adding more modes
 };
 
 extern int flags_parallel_invoker_mode;
@@ -140,6 +145,87 @@ class BlockedRange2D {
 // Singleton ThreadPool for parallel invoker.
 ThreadPool* ParallelInvokerThreadPool();
 
+// Number of chunks per participating thread the iteration range is split into
+// in PARALLEL_INVOKER_WORK_STEALING mode. More chunks balance uneven
+// per-iteration cost better at the expense of more atomic operations.
+constexpr int kParallelInvokerChunksPerThread = 4;
+
+// Shared state of a single work-stealing loop. Owned jointly by the calling
+// thread and all scheduled workers, as workers may only get to run after the
+// loop has completed.
+struct ParallelInvokerWorkStealingLoop {
+  std::atomic<int> next_chunk{0};
+  absl::Mutex mutex;
+  absl::CondVar completed;
+  int chunks_remain ABSL_GUARDED_BY(mutex) = 0;
+};
+
+// Executes invoker over [start, end) by splitting the range into chunks of
+// multiples of grain_size, which the calling thread and the workers of
+// ParallelInvokerThreadPool() claim dynamically until none are left.
+// As the calling thread participates and only waits for claimed chunks to
+// finish (instead of scheduled tasks), nested invocation cannot deadlock.
+template <class Invoker>
+void ParallelForWorkStealing(size_t start, size_t end, size_t grain_size,
+                             const Invoker& invoker) {
+  const int num_grains = (end - start + grain_size - 1) / grain_size;
+  CHECK_GT(num_grains, 0);
+  ThreadPool* pool = ParallelInvokerThreadPool();
+  const int num_workers = std::min(pool->num_threads(), num_grains - 1);
+  if (num_workers <= 0) {
+    // Execute invoker serially.
+    invoker(BlockedRange(start, end, 1));
+    return;
+  }
+
+  const int grains_per_chunk = std::max(
+      1, num_grains / (kParallelInvokerChunksPerThread * (num_workers + 1)));
+  const int num_chunks = (num_grains + grains_per_chunk - 1) / grains_per_chunk;
+  const size_t chunk_size = grains_per_chunk * grain_size;
+
+  auto loop = std::make_shared<ParallelInvokerWorkStealingLoop>();
+  {
+    absl::MutexLock lock(&loop->mutex);
+    loop->chunks_remain = num_chunks;
+  }
+
+  // Claims and executes chunks until the range is exhausted.
+  auto run_chunks = [start, end, chunk_size, num_chunks](
+                        const Invoker& local_invoker,
+                        ParallelInvokerWorkStealingLoop* loop) {
+    int num_executed = 0;
+    for (int chunk = loop->next_chunk.fetch_add(1); chunk < num_chunks;
+         chunk = loop->next_chunk.fetch_add(1)) {
+      const size_t chunk_start = start + chunk * chunk_size;
+      const size_t chunk_end = std::min(end, chunk_start + chunk_size);
+      local_invoker(BlockedRange(chunk_start, chunk_end, 1));
+      ++num_executed;
+    }
+
+    if (num_executed > 0) {
+      absl::MutexLock lock(&loop->mutex);
+      loop->chunks_remain -= num_executed;
+      if (loop->chunks_remain == 0) {
+        loop->completed.SignalAll();
+      }
+    }
+  };
+
+  for (int w = 0; w < num_workers; ++w) {
+    // Each worker uses its local copy of invoker.
+    pool->Schedule(
+        [loop, invoker, run_chunks]() { run_chunks(invoker, loop.get()); });
+  }
+
+  run_chunks(invoker, loop.get());
+
+  // Wait on termination of all claimed chunks.
+  absl::MutexLock lock(&loop->mutex);
+  while (loop->chunks_remain > 0) {
+    loop->completed.Wait(&loop->mutex);
+  }
+}
+
 #ifdef __APPLE__
 // Enable to allow GCD as an option beside ThreadPool.
 #define USE_PARALLEL_INVOKER_GCD 1
@@ -231,6 +317,7 @@ inline void CheckAndSetInvokerOptions() {
   // ThreadPool otherwise.
   if (flags_parallel_invoker_mode != PARALLEL_INVOKER_NONE &&
       flags_parallel_invoker_mode != PARALLEL_INVOKER_THREAD_POOL &&
+      flags_parallel_invoker_mode != PARALLEL_INVOKER_WORK_STEALING &&
       flags_parallel_invoker_mode != PARALLEL_INVOKER_OPENMP) {
 #if defined(_OPENMP)
     LOG(WARNING) << "Unsupported invoker mode selected on Android. "
@@ -252,6 +339,7 @@ inline void CheckAndSetInvokerOptions() {
 #if defined(USE_PARALLEL_INVOKER_GCD)
       flags_parallel_invoker_mode != PARALLEL_INVOKER_GCD &&
 #endif  // USE_PARALLEL_INVOKER_GCD
+      flags_parallel_invoker_mode != PARALLEL_INVOKER_WORK_STEALING &&
       flags_parallel_invoker_mode != PARALLEL_INVOKER_THREAD_POOL) {
     LOG(WARNING) << "Unsupported invoker mode selected on iOS. "
                  << "Falling back to ThreadPool mode";
@@ -260,7 +348,11 @@ inline void CheckAndSetInvokerOptions() {
 #endif  // __APPLE__ || __EMSCRIPTEN__
 
 #if !defined(__APPLE__) && !defined(__EMSCRIPTEN__) && !defined(__ANDROID__)
-  flags_parallel_invoker_mode = PARALLEL_INVOKER_THREAD_POOL;
+  // Only ThreadPool based modes are supported, default to work-stealing.
+  if (flags_parallel_invoker_mode != PARALLEL_INVOKER_THREAD_POOL &&
+      flags_parallel_invoker_mode != PARALLEL_INVOKER_WORK_STEALING) {
+    flags_parallel_invoker_mode = PARALLEL_INVOKER_WORK_STEALING;
+  }
 #endif  // !__APPLE__ && !__EMSCRIPTEN__ && !__ANDROID__
 
   // If OpenMP is requested, make sure we can actually use it, and fall back
@@ -368,6 +460,11 @@ void ParallelFor(size_t start, size_t end, size_t grain_size,
       break;
     }
 
+    case PARALLEL_INVOKER_WORK_STEALING: {
+      ParallelForWorkStealing(start, end, grain_size, invoker);
+      break;
+    }
+
     case PARALLEL_INVOKER_OPENMP: {
       // Use thread-local copy of invoker.
       Invoker local_invoker(invoker);
@@ -475,6 +572,16 @@ void ParallelFor2D(size_t start_row, size_t end_row, size_t start_col,
       break;
     }
 
+    case PARALLEL_INVOKER_WORK_STEALING: {
+      // Partition across rows, each chunk spans all columns.
+      ParallelForWorkStealing(
+          start_row, end_row, grain_size,
+          [start_col, end_col, invoker](const BlockedRange& rows) {
+            invoker(BlockedRange2D(rows, BlockedRange(start_col, end_col, 1)));
+          });
+      break;
+    }
+
     case PARALLEL_INVOKER_OPENMP: {
       // Use thread-local copy of invoker.
       Invoker local_invoker(invoker);
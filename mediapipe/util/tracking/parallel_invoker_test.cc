@@ -56,5 +56,39 @@ TEST(ParallelInvokerTest, ThreadPoolTest) {
   RunParallelTest();
 }
 
+TEST(ParallelInvokerTest, WorkStealingTest) {
+  flags_parallel_invoker_mode = PARALLEL_INVOKER_WORK_STEALING;
+
+  RunParallelTest();
+}
+
+TEST(ParallelInvokerTest, WorkStealingNestedTest) {
+  flags_parallel_invoker_mode = PARALLEL_INVOKER_WORK_STEALING;
+
+  // Nested invocations must not deadlock, even if all workers of the pool are
+  // busy executing the outer loop.
+  const int kOuterSize = 64;
+  const int kInnerSize = 100;
+  std::vector<int> sums(kOuterSize, 0);
+  ParallelFor(0, kOuterSize, 1, [&sums](const BlockedRange& outer) {
+    for (int i = outer.begin(); i != outer.end(); ++i) {
+      absl::Mutex sum_mutex;
+      int sum = 0;
+      ParallelFor(0, kInnerSize, 1,
+                  [&sum_mutex, &sum](const BlockedRange& inner) {
+                    for (int k = inner.begin(); k != inner.end(); ++k) {
+                      absl::MutexLock lock(&sum_mutex);
+                      sum += k;
+                    }
+                  });
+      sums[i] = sum;
+    }
+  });
+
+  for (int sum : sums) {
+    EXPECT_EQ(kInnerSize * (kInnerSize - 1) / 2, sum);
+  }
+}
+
 }  // namespace
 }  // namespace mediapipe
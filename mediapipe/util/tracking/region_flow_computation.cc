@@ -1633,6 +1633,57 @@ inline void SetMaskNeighborhood(int mask_x, int mask_y, cv::Mat* mask) {
   }
 }
 
+// Computes the Harris or minimum eigenvalue corner response of image into
+// response (preallocated to image's size) over horizontal bands of tile_rows
+// rows via ParallelFor. Each band is computed over a view padded by a few rows
+// and only its interior is copied, so that results are identical to a single
+// call over the whole image.
+void ComputeCornerResponseTiled(const cv::Mat& image, bool use_harris,
+                                int block_size, double harris_k, int tile_rows,
+                                cv::Mat* response) {
+  CHECK_EQ(response->rows, image.rows);
+  CHECK_EQ(response->cols, image.cols);
+
+  const int num_tiles =
+      tile_rows > 0 ? (image.rows + tile_rows - 1) / tile_rows : 1;
+  if (num_tiles <= 1) {
+    if (use_harris) {
+      cv::cornerHarris(image, *response, block_size, block_size, harris_k);
+    } else {
+      cv::cornerMinEigenVal(image, *response, block_size);
+    }
+    return;
+  }
+
+  // Derivatives are computed on the view and therefore read outside rows from
+  // the image, the subsequent box filter however does not. Padding by the
+  // block size covers both.
+  const int padding = block_size;
+  ParallelFor(0, num_tiles, 1, [&](const BlockedRange& range) {
+    cv::Mat tile_response;
+    for (int tile = range.begin(); tile < range.end(); ++tile) {
+      const int tile_start = tile * tile_rows;
+      const int tile_end = min(image.rows, tile_start + tile_rows);
+      const int padded_start = max(0, tile_start - padding);
+      const int padded_end = min(image.rows, tile_end + padding);
+      const cv::Mat tile_view(image, cv::Range(padded_start, padded_end),
+                              cv::Range::all());
+      if (use_harris) {
+        cv::cornerHarris(tile_view, tile_response, block_size, block_size,
+                         harris_k);
+      } else {
+        cv::cornerMinEigenVal(tile_view, tile_response, block_size);
+      }
+
+      cv::Mat dst_view(*response, cv::Range(tile_start, tile_end),
+                       cv::Range::all());
+      tile_response
+          .rowRange(tile_start - padded_start, tile_end - padded_start)
+          .copyTo(dst_view);
+    }
+  });
+}
+
 }  // namespace.
 
 void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
@@ -1706,10 +1757,10 @@ void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
 
       if (use_fast) {
         fast_detector->detect(image, fast_keypoints);
-      } else if (use_harris) {
-        cv::cornerHarris(image, *eig_image, kBlockSize, kBlockSize, kHarrisK);
       } else {
-        cv::cornerMinEigenVal(image, *eig_image, kBlockSize);
+        ComputeCornerResponseTiled(image, use_harris, kBlockSize, kHarrisK,
+                                   tracking_options.corner_response_tile_rows(),
+                                   eig_image);
       }
     } else {
       // Compute corner response on a down-scaled image and upsample.
@@ -1727,12 +1778,9 @@ void RegionFlowComputation::AdaptiveGoodFeaturesToTrack(
       } else {
         // Use tmp_image to compute eigen-values on resized images.
         cv::Mat eig_view(*tmp_image, cv::Range(0, rows), cv::Range(0, cols));
-
-        if (use_harris) {
-          cv::cornerHarris(image, eig_view, kBlockSize, kBlockSize, kHarrisK);
-        } else {
-          cv::cornerMinEigenVal(image, eig_view, kBlockSize);
-        }
+        ComputeCornerResponseTiled(image, use_harris, kBlockSize, kHarrisK,
+                                   tracking_options.corner_response_tile_rows(),
+                                   &eig_view);
 
         // Upsample (without interpolation) eig_view to match frame size.
         eig_image->setTo(0);
@@ -2496,6 +2544,64 @@ int RegionFlowComputation::InplaceFeatureSelection(
   return num_selected_features;
 }
 
+#if CV_MAJOR_VERSION >= 3
+namespace {
+
+// Tracks prev_points from prev_pyramid to next_pyramid via
+// cv::calcOpticalFlowPyrLK, processing tiles of tile_size features in parallel.
+// As each feature is tracked independently, results are identical to a single
+// call over all features. Outputs are resized to the number of features; if
+// cv::OPTFLOW_USE_INITIAL_FLOW is set, next_points needs to be initialized.
+// Tiling requires prebuilt pyramids, as plain images would otherwise be
+// converted into pyramids once per tile.
+void CalcOpticalFlowPyrLKTiled(const cv::_InputArray& prev_pyramid,
+                               const cv::_InputArray& next_pyramid,
+                               const std::vector<cv::Point2f>& prev_points,
+                               std::vector<cv::Point2f>* next_points,
+                               std::vector<uint8>* status,
+                               std::vector<float>* error,
+                               const cv::Size& window_size, int max_level,
+                               const cv::TermCriteria& criteria, int flags,
+                               int tile_size) {
+  const int num_points = prev_points.size();
+  if (tile_size <= 0 || num_points <= tile_size ||
+      prev_pyramid.kind() != cv::_InputArray::STD_VECTOR_MAT ||
+      next_pyramid.kind() != cv::_InputArray::STD_VECTOR_MAT) {
+    cv::calcOpticalFlowPyrLK(prev_pyramid, next_pyramid, prev_points,
+                             *next_points, *status, *error, window_size,
+                             max_level, criteria, flags);
+    return;
+  }
+
+  next_points->resize(num_points);
+  status->resize(num_points);
+  error->resize(num_points);
+
+  // Wrap each tile as cv::Mat header into the preallocated outputs, so that
+  // OpenCV writes results in place.
+  const int num_tiles = (num_points + tile_size - 1) / tile_size;
+  ParallelFor(0, num_tiles, 1, [&](const BlockedRange& range) {
+    for (int tile = range.begin(); tile < range.end(); ++tile) {
+      const int tile_start = tile * tile_size;
+      const int tile_points =
+          min(num_points, tile_start + tile_size) - tile_start;
+      const cv::Mat prev_tile(
+          tile_points, 1, CV_32FC2,
+          const_cast<cv::Point2f*>(prev_points.data() + tile_start));
+      cv::Mat next_tile(tile_points, 1, CV_32FC2,
+                        next_points->data() + tile_start);
+      cv::Mat status_tile(tile_points, 1, CV_8U, status->data() + tile_start);
+      cv::Mat error_tile(tile_points, 1, CV_32F, error->data() + tile_start);
+      cv::calcOpticalFlowPyrLK(prev_pyramid, next_pyramid, prev_tile,
+                               next_tile, status_tile, error_tile, window_size,
+                               max_level, criteria, flags);
+    }
+  });
+}
+
+}  // namespace.
+#endif  // CV_MAJOR_VERSION >= 3
+
 void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
                                           FrameTrackingData* to_data_ptr,
                                           bool* gain_correction_ptr,
@@ -2610,10 +2716,10 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
 
     if (options_.tracking_options().klt_tracker_implementation() ==
         TrackingOptions::KLT_OPENCV) {
-      cv::calcOpticalFlowPyrLK(input_frame1, input_frame2, features1, features2,
-                               feature_status_, feature_track_error_,
-                               cv_window_size, pyramid_levels_, cv_criteria,
-                               tracking_flags);
+      CalcOpticalFlowPyrLKTiled(
+          input_frame1, input_frame2, features1, &features2, &feature_status_,
+          &feature_track_error_, cv_window_size, pyramid_levels_, cv_criteria,
+          tracking_flags, options_.tracking_options().klt_tile_features());
     } else {
       LOG(ERROR) << "Tracking method unspecified.";
       return;
@@ -2789,10 +2895,11 @@ void RegionFlowComputation::TrackFeatures(FrameTrackingData* from_data_ptr,
 
     if (use_cv_tracking_) {
 #if CV_MAJOR_VERSION >= 3
-      cv::calcOpticalFlowPyrLK(input_frame2, input_frame1, verify_features,
-                               verify_features_tracked, feature_status_,
-                               verify_track_error, cv_window_size,
-                               pyramid_levels_, cv_criteria, tracking_flags);
+      CalcOpticalFlowPyrLKTiled(
+          input_frame2, input_frame1, verify_features, &verify_features_tracked,
+          &feature_status_, &verify_track_error, cv_window_size,
+          pyramid_levels_, cv_criteria, tracking_flags,
+          options_.tracking_options().klt_tile_features());
 #endif
     } else {
       LOG(ERROR) << "only cv tracking is supported.";
@@ -3046,17 +3153,20 @@ void RegionFlowComputation::ComputeBlockBasedFlow(
   const int num_overlaps = options_.fast_estimation_overlap_grids();
   const int num_grids = block_levels_ * num_overlaps * num_overlaps;
 
-  // Put all features into region bins.
-  std::vector<TrackedFeatureMap> grid_feature_views(num_grids);
+  // Describes the block size and shift of each grid.
+  struct GridLayout {
+    int block_width;
+    int block_height;
+    int shift_x;
+    int shift_y;
+  };
+  std::vector<GridLayout> grid_layouts;
+  grid_layouts.reserve(num_grids);
 
-  int grid_idx = 0;
   int block_width = block_width_;
   int block_height = block_height_;
 
   for (int level = 0; level < block_levels_; ++level) {
-    const float inv_block_width = 1.0f / block_width;
-    const float inv_block_height = 1.0f / block_height;
-
     for (int overlap_y = 0; overlap_y < num_overlaps; ++overlap_y) {
       // |    |    |    |  <- unshifted
       // | |    |    |  |  <- shifted
@@ -3070,29 +3180,13 @@ void RegionFlowComputation::ComputeBlockBasedFlow(
               ? 0
               : (block_height - block_height * overlap_y / num_overlaps);
 
-      for (int overlap_x = 0; overlap_x < num_overlaps;
-           ++overlap_x, ++grid_idx) {
+      for (int overlap_x = 0; overlap_x < num_overlaps; ++overlap_x) {
         const int grid_shift_x =
             overlap_x == 0
                 ? 0
                 : (block_width - block_width * overlap_x / num_overlaps);
-
-        const int bins_per_row =
-            std::ceil((original_width_ + grid_shift_x) * inv_block_width);
-        const int bins_per_column =
-            std::ceil((original_height_ + grid_shift_y) * inv_block_height);
-        TrackedFeatureMap& feature_view = grid_feature_views[grid_idx];
-        feature_view.resize(bins_per_row * bins_per_column);
-
-        for (auto feature_ptr : inlier_view) {
-          const int x = feature_ptr->point.x() + 0.5f + grid_shift_x;
-          const int y = feature_ptr->point.y() + 0.5f + grid_shift_y;
-          const int block_x = x * inv_block_width;
-          const int block_y = y * inv_block_height;
-
-          int block_id = block_y * bins_per_row + block_x;
-          feature_view[block_id].push_back(feature_ptr);
-        }
+        grid_layouts.push_back(
+            {block_width, block_height, grid_shift_x, grid_shift_y});
       }
     }
 
@@ -3103,6 +3197,33 @@ void RegionFlowComputation::ComputeBlockBasedFlow(
     }
   }
 
+  // Put all features into region bins. Grids are independent, bin in
+  // parallel.
+  std::vector<TrackedFeatureMap> grid_feature_views(num_grids);
+  ParallelFor(0, num_grids, 1, [&](const BlockedRange& range) {
+    for (int grid_idx = range.begin(); grid_idx < range.end(); ++grid_idx) {
+      const GridLayout& layout = grid_layouts[grid_idx];
+      const float inv_block_width = 1.0f / layout.block_width;
+      const float inv_block_height = 1.0f / layout.block_height;
+      const int bins_per_row =
+          std::ceil((original_width_ + layout.shift_x) * inv_block_width);
+      const int bins_per_column =
+          std::ceil((original_height_ + layout.shift_y) * inv_block_height);
+      TrackedFeatureMap& feature_view = grid_feature_views[grid_idx];
+      feature_view.resize(bins_per_row * bins_per_column);
+
+      for (auto feature_ptr : inlier_view) {
+        const int x = feature_ptr->point.x() + 0.5f + layout.shift_x;
+        const int y = feature_ptr->point.y() + 0.5f + layout.shift_y;
+        const int block_x = x * inv_block_width;
+        const int block_y = y * inv_block_height;
+
+        int block_id = block_y * bins_per_row + block_x;
+        feature_view[block_id].push_back(feature_ptr);
+      }
+    }
+  });
+
   for (int k = 0; k < num_grids; ++k) {
     TrackedFeatureMap& region_features = grid_feature_views[k];
     const int min_inliers = GetMinNumFeatureInliers(region_features);
@@ -24,6 +24,7 @@
 #include "absl/flags/flag.h"
 #include "absl/time/clock.h"
 #include "mediapipe/framework/deps/file_path.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/file_helpers.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/logging.h"
@@ -32,6 +33,7 @@
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/vector.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 #include "mediapipe/util/tracking/region_flow.h"
 #include "mediapipe/util/tracking/region_flow.pb.h"
 
@@ -300,5 +302,59 @@ TEST_P(RegionFlowComputationTest, ResolutionTests) {
   }
 }
 
+// Measures frames per second of feature extraction and tracking over a 1080p
+// video panning across the test image, for the invoker mode given as argument.
+void BM_ComputeRegionFlow1080p(benchmark::State& state) {
+  flags_parallel_invoker_mode = state.range(0);
+
+  std::string png_data;
+  MEDIAPIPE_CHECK_OK(file::GetContents(
+      file::JoinPath("./", "/mediapipe/util/tracking/testdata/",
+                     "stabilize_test.png"),
+      &png_data));
+  std::vector<char> buffer(png_data.begin(), png_data.end());
+  const cv::Mat image = cv::imdecode(cv::Mat(buffer), 1);
+  CHECK(!image.empty());
+
+  constexpr int kFrameWidth = 1920;
+  constexpr int kFrameHeight = 1080;
+  constexpr int kBorder = 40;
+  constexpr int kNumFrames = 30;
+  cv::Mat source;
+  cv::resize(image, source,
+             cv::Size(kFrameWidth + 2 * kBorder, kFrameHeight + 2 * kBorder));
+
+  // Pan diagonally by 2 pixels per frame.
+  std::vector<cv::Mat> movie(kNumFrames);
+  for (int f = 0; f < kNumFrames; ++f) {
+    const int offset = (2 * f) % (2 * kBorder);
+    source(cv::Rect(offset, offset, kFrameWidth, kFrameHeight))
+        .copyTo(movie[f]);
+  }
+
+  RegionFlowComputationOptions options;
+  options.set_image_format(RegionFlowComputationOptions::FORMAT_RGB);
+
+  int64 num_frames = 0;
+  for (auto _ : state) {
+    RegionFlowComputation flow_computation(options, kFrameWidth, kFrameHeight);
+    for (const cv::Mat& frame : movie) {
+      flow_computation.AddImage(frame, 0);
+      std::unique_ptr<RegionFlowFrame> region_flow_frame(
+          flow_computation.RetrieveRegionFlow());
+      benchmark::DoNotOptimize(region_flow_frame);
+    }
+    num_frames += kNumFrames;
+  }
+  state.counters["fps"] =
+      benchmark::Counter(num_frames, benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_ComputeRegionFlow1080p)
+    ->Arg(PARALLEL_INVOKER_THREAD_POOL)
+    ->Arg(PARALLEL_INVOKER_WORK_STEALING)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
 }  // namespace
 }  // namespace mediapipe
@@ -26,6 +26,8 @@
 #include "Eigen/SVD"
 #include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/opencv_calib3d_inc.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
@@ -33,6 +35,7 @@
 #include "mediapipe/util/tracking/flow_packager.pb.h"
 #include "mediapipe/util/tracking/measure_time.h"
 #include "mediapipe/util/tracking/motion_models.h"
+#include "mediapipe/util/tracking/parallel_invoker.h"
 
 namespace mediapipe {
 
@@ -1125,6 +1128,34 @@ bool MotionBox::TrackStep(int from_frame,
   }
 }
 
+void TrackStepMultiple(int from_frame, const MotionVectorFrame& motion_vectors,
+                       bool forward, bool parallel,
+                       const std::vector<MotionBox*>& boxes,
+                       std::vector<MotionBoxTrackStepResult>* results) {
+  CHECK(results != nullptr);
+  results->clear();
+  results->resize(boxes.size());
+  if (boxes.empty()) {
+    return;
+  }
+
+  auto track_range = [&](const BlockedRange& range) {
+    for (int k = range.begin(); k < range.end(); ++k) {
+      const absl::Time start_time = absl::Now();
+      (*results)[k].success =
+          boxes[k]->TrackStep(from_frame, motion_vectors, forward);
+      (*results)[k].track_time_us =
+          absl::ToInt64Microseconds(absl::Now() - start_time);
+    }
+  };
+
+  if (parallel) {
+    ParallelFor(0, boxes.size(), 1, track_range);
+  } else {
+    track_range(BlockedRange(0, boxes.size(), 1));
+  }
+}
+
 namespace {
 
 Vector2_f SpatialPriorPosition(const Vector2_f& location,
@@ -2898,7 +2929,6 @@ void MotionBox::TrackStepImplDeNormalized(
         [&motion_frame](int id) {
           return !motion_frame.actively_discarded_tracked_ids->contains(id);
         });
-    motion_frame.actively_discarded_tracked_ids->clear();
   }
   const int num_inliers = next_pos->inlier_ids_size();
   // Must be in [0, 1].
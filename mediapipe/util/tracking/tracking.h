@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/vector.h"
 #include "mediapipe/util/tracking/flow_packager.pb.h"
 #include "mediapipe/util/tracking/motion_models.h"
@@ -223,7 +224,9 @@ struct MotionVectorFrame {
 
   // Stores the tracked ids that have been discarded actively. This information
   // will be used to avoid misjudgement on tracking continuity.
-  absl::flat_hash_set<int>* actively_discarded_tracked_ids = nullptr;
+  // Only read during tracking, owner is expected to clear the set once all
+  // boxes have been tracked w.r.t. this frame.
+  const absl::flat_hash_set<int>* actively_discarded_tracked_ids = nullptr;
 };
 
 // Transforms TrackingData to MotionVectorFrame, ready to be used by tracking
@@ -643,6 +646,24 @@ class MotionBox {
   MotionBoxState initial_state_;
 };
 
+// Result of tracking a single MotionBox via TrackStepMultiple.
+struct MotionBoxTrackStepResult {
+  bool success = false;
+  // Wall time spent in MotionBox::TrackStep.
+  int64 track_time_us = 0;
+};
+
+// Tracks each of the passed boxes by one frame, equivalent to calling
+// box->TrackStep(from_frame, motion_vectors, forward) for every box. All boxes
+// share motion_vectors, i.e. TrackingData is converted to a MotionVectorFrame
+// and sorted only once per frame. MotionBoxes do not share any state, if
+// parallel is set boxes are tracked concurrently via ParallelFor.
+// Outputs one result per box, in the order of boxes.
+void TrackStepMultiple(int from_frame, const MotionVectorFrame& motion_vectors,
+                       bool forward, bool parallel,
+                       const std::vector<MotionBox*>& boxes,
+                       std::vector<MotionBoxTrackStepResult>* results);
+
 }  // namespace mediapipe.
 
 #endif  // MEDIAPIPE_UTIL_TRACKING_TRACKING_H_